@@ -4,12 +4,17 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+# Domyslnie bez GUI ( main.cpp - przebieg modelu w konsoli ). GUI ( gui/ ) nie
+# bylo jeszcze kompilowane z Qt5 - tylko na zadanie:
+#
+#   qmake CONFIG+=dme_gui DME-kit.pro && make
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+QT       -= core gui
 
 TARGET = DME-kit
 TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which has been marked as deprecated (the exact warnings
@@ -23,15 +28,24 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 
-SOURCES += \
-        main.cpp \
+INCLUDEPATH += fdm
 
+include ( fdm/fdm.pri )
 
-INCLUDEPATH += gui \
-               fdm
+dme_gui {
+    QT += core gui
+    greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-include ( gui/gui.pri )
-include ( fdm/fdm.pri )
+    CONFIG -= console
+
+    INCLUDEPATH += gui
+
+    SOURCES += gui/main.cpp
+
+    include ( gui/gui.pri )
+} else {
+    SOURCES += main.cpp
+}
 
 HEADERS += \
     data.h
@@ -23,7 +23,174 @@
 
 #include "Atmosphere.h"
 
+namespace
+{
+    double const R_air = 287.05287;     ///< [J/kgK] - stala gazowa ISA
+    double const k_air = 1.4;
+}
+
+double const Atmosphere::H_min = -1000.0;
+double const Atmosphere::H_max = 32000.0;
+double const Atmosphere::dH    = 25.0;
+
 Atmosphere::Atmosphere()
 {
+    mode = Table;
+
+    H_b[0] = 0.0;       L_b[0] = -0.0065;
+    H_b[1] = 11000.0;   L_b[1] =  0.0;
+    H_b[2] = 20000.0;   L_b[2] =  0.001;
+    H_b[3] = 32000.0;
+
+    set( T0 , p0 );
+    update( 0.0 );
+}
+
+void Atmosphere::set(double Temp0, double press0)
+{
+    T0 = Temp0;
+    p0 = press0;
+
+    T_b[0] = T0;
+    p_b[0] = p0;
+
+    for( int i = 1 ; i < Layers ; i++ )
+    {
+        double h = H_b[i] - H_b[i-1];
+        T_b[i] = T_b[i-1] + L_b[i-1] * h;
+
+        if( L_b[i-1] != 0.0 )
+            p_b[i] = p_b[i-1] * pow( T_b[i] / T_b[i-1] , -gn / ( L_b[i-1] * R_air ) );
+        else
+            p_b[i] = p_b[i-1] * exp( -gn * h / ( R_air * T_b[i-1] ) );
+    }
+
+    ro0 = p0 / ( R_air * T0 );
+    a0  = sqrt( k_air * R_air * T0 );
+
+    build_table();
+}
+
+void Atmosphere::exact(double H_alt, double &T_h, double &p_h) const
+{
+    H_alt = H_alt < H_min ? H_min : ( H_alt > H_max ? H_max : H_alt );
+
+    int i = 0;
+    while( i < Layers - 1 && H_alt >= H_b[i+1] ) i++;
+
+    double h = H_alt - H_b[i];
+    T_h = T_b[i] + L_b[i] * h;
+
+    if( L_b[i] != 0.0 )
+        p_h = p_b[i] * pow( T_h / T_b[i] , -gn / ( L_b[i] * R_air ) );
+    else
+        p_h = p_b[i] * exp( -gn * h / ( R_air * T_b[i] ) );
+}
+
+void Atmosphere::build_table()
+{
+    rows   = int( ( H_max - H_min ) / dH + 0.5 ) + 1;
+    inv_dH = 1.0 / dH;
+    tab.resize( rows );
+
+    for( int j = 0 ; j < rows ; j++ )
+    {
+        Row &r = tab[j];
+        exact( H_min + j * dH , r.T , r.p );
+        r.ro = r.p / ( R_air * r.T );
+        r.a  = sqrt( k_air * R_air * r.T );
+    }
+
+    for( int j = 0 ; j < rows ; j++ )
+    {
+        Row &r = tab[j];
+        Row const &q = tab[ j + 1 < rows ? j + 1 : j ];
+        r.dT  = q.T  - r.T;
+        r.dp  = q.p  - r.p;
+        r.dro = q.ro - r.ro;
+        r.da  = q.a  - r.a;
+    }
+}
+
+void Atmosphere::update(double H_alt)
+{
+    if( mode == Exact )
+    {
+        exact( H_alt , T , p );
+        ro = p / ( R_air * T );
+        a  = sqrt( k_air * R_air * T );
+    }
+    else
+        update( &H_alt , 1 , &T , &p , &ro , &a );
+
+    T_celc = T - C2K;
+}
+
+void Atmosphere::update(const double *H_alt, int n,
+                        double *T_out, double *p_out, double *ro_out, double *a_out) const
+{
+    batch( H_alt , n , T_out , p_out , ro_out , a_out );
+}
+
+void Atmosphere::update(const float *H_alt, int n,
+                        float *T_out, float *p_out, float *ro_out, float *a_out) const
+{
+    batch( H_alt , n , T_out , p_out , ro_out , a_out );
+}
+
+template <class S>
+void Atmosphere::batch(const S *H_alt, int n,
+                       S *T_out, S *p_out, S *ro_out, S *a_out) const
+{
+    if( mode == Exact )
+    {
+        for( int i = 0 ; i < n ; i++ )
+        {
+            double T_h , p_h;
+            exact( H_alt[i] , T_h , p_h );
+            if( T_out )  T_out[i]  = S( T_h );
+            if( p_out )  p_out[i]  = S( p_h );
+            if( ro_out ) ro_out[i] = S( p_h / ( R_air * T_h ) );
+            if( a_out )  a_out[i]  = S( sqrt( k_air * R_air * T_h ) );
+        }
+        return;
+    }
+
+    Row const *t = &tab[0];
+    double const x_max = double( rows - 1 );
+
+    /// bez rozgalezien - obciecie przez min / max , jeden wiersz na odczyt
+    if( T_out && p_out && ro_out && a_out )
+    {
+        for( int i = 0 ; i < n ; i++ )
+        {
+            double x = ( H_alt[i] - H_min ) * inv_dH;
+            x = x < 0.0 ? 0.0 : ( x > x_max ? x_max : x );
+
+            int    j = int( x );
+            double w = x - j;
+            Row const &r = t[j];
+
+            T_out[i]  = S( r.T  + r.dT  * w );
+            p_out[i]  = S( r.p  + r.dp  * w );
+            ro_out[i] = S( r.ro + r.dro * w );
+            a_out[i]  = S( r.a  + r.da  * w );
+        }
+        return;
+    }
+
+    for( int i = 0 ; i < n ; i++ )
+    {
+        double x = ( H_alt[i] - H_min ) * inv_dH;
+        x = x < 0.0 ? 0.0 : ( x > x_max ? x_max : x );
+
+        int    j = int( x );
+        double w = x - j;
+        Row const &r = t[j];
 
+        if( T_out )  T_out[i]  = S( r.T  + r.dT  * w );
+        if( p_out )  p_out[i]  = S( r.p  + r.dp  * w );
+        if( ro_out ) ro_out[i] = S( r.ro + r.dro * w );
+        if( a_out )  a_out[i]  = S( r.a  + r.da  * w );
+    }
 }
@@ -25,25 +25,79 @@
 #define ATMOSPHERE_H
 #include <math.h>
 #include <data.h>
+#include <Fun.h>
+#include <vector>
 
 using namespace units;
 using namespace std;
 
+/// Atmosfera wzorcowa ISA do 32 km ( warstwy 0-11 km , 11-20 km , 20-32 km ).
+///
+/// set( T0 , p0 ) ustawia warunki na poziomie morza - dzien nieatmosferyczny
+/// przesuwa temperature wszystkich warstw o T0 - 288.15 K, cisnienie liczone
+/// jest hydrostatycznie z przesunietej temperatury.
+///
+/// Domyslnie wartosci odczytywane sa z tablicy liczonej raz przy set():
+/// siatka co dH = 25 m od H_min do H_max , w kazdym wierszu wartosc i przyrost
+/// do nastepnego wiersza ( jedna linia cache na odczyt ). Temperatura jest
+/// liniowa w warstwach, a granice warstw leza na siatce - T jest dokladna do
+/// zaokraglen, a ma blad wzgledny < 1e-7. Dla p i ro blad interpolacji liniowej
+/// funkcji wykladniczej jest ograniczony przez dH^2 / ( 8 Hs^2 ) , Hs = R T / g :
+/// 2.0e-6 dla ISA ( Hs >= 6.3 km ) , 2.6e-6 dla ISA - 20 K.
+/// Wysokosci spoza [ H_min , H_max ] sa obcinane w obu trybach.
+/// Tryb Exact liczy wzory warstw wprost - do walidacji.
 class Atmosphere
 {
 public:
     Atmosphere();
 
+    enum Mode
+    {
+        Table = 0,
+        Exact
+    };
+
     void update( double H_alt  );
 
+    /// Wsadowo dla n wysokosci - dowolny z wskaznikow wyjsciowych moze byc 0
+    void update( const double *H_alt , int n ,
+                 double *T_out , double *p_out , double *ro_out , double *a_out ) const;
+
+    /// To samo dla float ( tablica i interpolacja w double , wynik zaokraglany )
+    void update( const float *H_alt , int n ,
+                 float *T_out , float *p_out , float *ro_out , float *a_out ) const;
+
     void set( double Temp0 , double press0 );
 
+    void set_mode( Mode m ) { mode = m; }
+    Mode get_mode() const   { return mode; }
+
+    /// Stan do migawki ( Snapshot.h ); inne warunki na poziomie morza
+    /// przebudowuja tablice przy odczycie
+    template <class Archive> void serialize( Archive &ar )
+    {
+        double T_0 = T0 , p_0 = p0;
+        ar & T_0 & p_0;
+        if( ar.loading() && ar.ok() && ( T_0 != T0 || p_0 != p0 ) ) set( T_0 , p_0 );
+        ar & p & T & ro & a & T_celc & mode;
+    }
+
     double get_a(){ return a;}
     double get_T(){ return T;}
     double get_p(){ return p;}
     double get_ro(){ return ro;}
 
+    static double const H_min;      ///< [m] - dolna granica tablicy
+    static double const H_max;      ///< [m] - gorna granica tablicy
+    static double const dH;         ///< [m] - krok tablicy
+
 private:
+    void build_table();
+    void exact( double H_alt , double &T_h , double &p_h ) const;
+
+    template <class S> void batch( const S *H_alt , int n ,
+                                   S *T_out , S *p_out , S *ro_out , S *a_out ) const;
+
     double p;
     double T;
     double ro;
@@ -56,6 +110,19 @@ private:
     double p0 = 101325;       ///< [Pa]
     double a0 = 340.3;        ///< [m/s]
 
+    Mode mode;
+
+    static int const Layers = 3;
+    double H_b[Layers+1];     ///< [m] - podstawy warstw
+    double L_b[Layers];       ///< [K/m] - gradient temperatury w warstwie
+    double T_b[Layers];       ///< [K]  - temperatura u podstawy warstwy
+    double p_b[Layers];       ///< [Pa] - cisnienie u podstawy warstwy
+
+    /// 64 B - wiersz w jednej linii cache
+    struct Row { double T , dT , p , dp , ro , dro , a , da; };
+    std::vector< Row , AlignedAllocator<Row> > tab;
+    double inv_dH;
+    int    rows;
 };
 
 #endif // ATMOSPHERE_H
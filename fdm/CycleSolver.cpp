@@ -0,0 +1,516 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "CycleSolver.h"
+#include <Dual.h>
+#include <Station.h>
+#include <math.h>
+
+using namespace EngineConst;
+
+namespace
+{
+
+/// Uklad 3x3 metoda Gaussa z wyborem elementu glownego; false - osobliwy
+bool solve3( double A[3][3] , double b[3] , double x[3] )
+{
+    double M[3][4];
+    for( int i = 0 ; i < 3 ; i++ )
+    {
+        for( int j = 0 ; j < 3 ; j++ ) M[i][j] = A[i][j];
+        M[i][3] = b[i];
+    }
+
+    for( int c = 0 ; c < 3 ; c++ )
+    {
+        int p = c;
+        for( int i = c + 1 ; i < 3 ; i++ )
+            if( fabs( M[i][c] ) > fabs( M[p][c] ) ) p = i;
+        if( fabs( M[p][c] ) < 1.0e-300 ) return false;
+
+        for( int j = 0 ; j < 4 ; j++ ) { double t = M[c][j]; M[c][j] = M[p][j]; M[p][j] = t; }
+
+        for( int i = c + 1 ; i < 3 ; i++ )
+        {
+            double f = M[i][c] / M[c][c];
+            for( int j = c ; j < 4 ; j++ ) M[i][j] -= f * M[c][j];
+        }
+    }
+
+    for( int i = 2 ; i >= 0 ; i-- )
+    {
+        double s = M[i][3];
+        for( int j = i + 1 ; j < 3 ; j++ ) s -= M[i][j] * x[j];
+        x[i] = s / M[i][i];
+    }
+    return true;
+}
+
+double norm_inf( double const r[3] )
+{
+    double m = fabs( r[0] );
+    if( fabs( r[1] ) > m ) m = fabs( r[1] );
+    if( fabs( r[2] ) > m ) m = fabs( r[2] );
+    return m;
+}
+
+double const Cp_air = k_p / ( k_p - 1.0 ) * R_p;     ///< [J/kgK]
+
+}
+
+CycleSolver::CycleSolver( std::weak_ptr<EngineData> Dat )
+{
+    dat = Dat.lock();
+
+    par[P_Mach]     = 0.0;
+    par[P_throttle] = 0.0;
+    par[P_sigma_H1] = Station::sigma_H1;
+    par[P_eta_S]    = 1.0;
+    par[P_sig_34]   = Station::sig_34;
+    par[P_eta_ks]   = 1.0;
+    par[P_eta_Twc]  = Station::eta_Twc;
+    par[P_sprez]    = 1.0;
+    par[P_mZR]      = 1.0;
+    par[P_mTwc]     = 1.0;
+
+    exact     = true;
+    use_cache = true;
+    solved   = false;
+    x_sol[0] = x_sol[1] = x_sol[2] = 0.0;
+
+    tol      = 1.0e-9;
+    max_iter = 50;
+
+    set_guess( 3000.0 , 2.0 , 1000.0 );
+    set_quantization( 250.0 , 0.02 , 0.01 );
+
+    TH = T0; pH = p0; T2 = T0; p2 = p0; q_pal = 0.0;
+
+    diag = Diagnostics();
+    bind_tables();
+}
+
+void CycleSolver::set_guess( double n_wc , double epsT , double T4s )
+{
+    guess[0] = n_wc;
+    guess[1] = epsT;
+    guess[2] = T4s;
+
+    x_ref[0] = n_wc;
+    x_ref[1] = epsT;
+    x_ref[2] = T4s;
+}
+
+void CycleSolver::set_quantization( double dH , double dMa , double dthr )
+{
+    q_H = dH;
+    q_M = dMa;
+    q_t = dthr;
+    cache.clear();
+}
+
+void CycleSolver::bind_tables()
+{
+    double const * const comp_cols[3] = { dat->sprez_tab , dat->eta_tab , dat->mZR_tab };
+    double const * const trb_cols[1]  = { dat->mTwc_zr_tab };
+    double const * const fuel_cols[1] = { dat->q_pal_tab };
+
+    comp_map.bind( dat->rpm_tab , comp_cols , dat->sk , dat->inv_rpm_tab );
+    trb_map.bind( dat->rpm_tab_t , trb_cols , dat->tk , dat->inv_rpm_tab_t );
+    fuel_map.bind( dat->q_pal_thr , fuel_cols , dat->ck , dat->inv_q_pal_thr );
+    cache.clear();
+}
+
+void CycleSolver::set_inlet( Atmosphere *atm , double H_alt )
+{
+    atm->update( &H_alt , 1 , &TH , &pH , 0 , 0 );
+
+    inlet( par , T2 , p2 , q_pal );
+}
+
+void CycleSolver::set_point( Atmosphere *atm , double H_alt , double Mach , double throttle )
+{
+    par[P_Mach]     = Mach;
+    par[P_throttle] = throttle;
+    par[P_eta_ks]   = dat->eta_ks;
+
+    set_inlet( atm , H_alt );
+}
+
+void CycleSolver::inlet_point( Point &out ) const
+{
+    out.TH    = TH;
+    out.pH    = pH;
+    out.T2s   = T2;
+    out.p2s   = p2;
+    out.q_pal = q_pal;
+}
+
+/// wlot - jak Intake::update_intake , paliwo z przepustnicy
+template <class S> void CycleSolver::inlet( S const p[Params] , S &T2_ , S &p2_ , S &q_ )
+{
+    S b_Ma2 = 1.0 + ( ( k_p - 1.0 ) / 2.0 ) * p[P_Mach] * p[P_Mach];
+    T2_ = TH * b_Ma2;
+    p2_ = p[P_sigma_H1] * pH * pow( b_Ma2 , k_p / ( k_p - 1.0 ) );
+
+    fuel_map.lookup( p[P_throttle] , &q_ , fuel_cur );
+}
+
+template <class S> void CycleSolver::cycle( S const x[3] , S const p[Params] , S const &T2_ , S const &p2_ ,
+                                            S const &q_ , S r[3] , Stations<S> *st )
+{
+    S const &n_wc = x[0];
+    S const &epsT = x[1];
+    S const &T4   = x[2];
+
+    /// sprezarka - wzory Station , jak Compressor::update_compressor
+    S nzr_rpm = n_wc * sqrt( T0 / T2_ ) * rads2rpm;
+    S val[3];
+    comp_map.lookup( nzr_rpm , val , comp_cur );
+
+    S T3 , p3 , m3;
+    Station::compressor( T2_ , p2_ , val[0] * p[P_sprez] , val[1] * p[P_eta_S] , val[2] * p[P_mZR] , T3 , p3 , m3 );
+
+    /// komora
+    S p4 = p[P_sig_34] * p3;
+    S m4 = m3 + q_;
+    S T4_fuel = T3 + q_ * p[P_eta_ks] * dat->W_opal / ( dat->Cp * m3 );
+
+    /// turbina wirnika
+    S T5 = T4 * ( 1.0 - ( 1.0 - pow( epsT , ( 1.0 - k_s ) / k_s ) ) * p[P_eta_Twc] );
+    S p5 = p4 / epsT;
+
+    S nT_rpm = n_wc * sqrt( T0 / T4 ) * rads2rpm;
+    S m_map;
+    trb_map.lookup( nT_rpm , &m_map , trb_cur );
+    m_map *= p[P_mTwc];
+
+    S P_c = m3 * Cp_air * ( T3 - T2_ );
+    S P_t = m4 * dat->Cp * ( T4 - T5 );
+
+    r[0] = ( T4 - T4_fuel ) / T0;
+    r[1] = m4 * sqrt( T4 / T0 ) / ( p4 / p0 ) - m_map;
+    r[2] = ( P_c - P_t ) / ( m3 * Cp_air * T0 );
+
+    if( st )
+    {
+        st->T3 = T3;  st->p3 = p3;  st->m3 = m3;
+        st->p4 = p4;  st->m4 = m4;
+        st->T5 = T5;  st->p5 = p5;
+        S wpt;
+        Station::turbine_f( p5 , T5 , S( dat->Cp ) , st->T6 , wpt );
+        st->P_c    = P_c;
+        st->P_t    = P_t;
+        st->P_free = m4 * wpt;
+    }
+}
+
+void CycleSolver::evaluate( double const x[3] , double r[3] , Point *out )
+{
+    Stations<double> st;
+    cycle( x , par , T2 , p2 , q_pal , r , out ? &st : 0 );
+
+    diag.evaluations++;
+
+    if( out )
+    {
+        out->n_wc = x[0];  out->epsT = x[1];  out->T4s = x[2];
+        out->TH   = TH;    out->pH   = pH;
+        out->T2s  = T2;    out->p2s  = p2;
+        out->T3s  = st.T3; out->p3s  = st.p3; out->m3 = st.m3;
+        out->q_pal = q_pal;
+        out->p4s  = st.p4; out->m4   = st.m4;
+        out->T5s  = st.T5; out->p5s  = st.p5;
+        out->T6s  = st.T6;
+        out->P_compressor = st.P_c;
+        out->P_turbine    = st.P_t;
+        out->P_free       = st.P_free;
+    }
+}
+
+void CycleSolver::clamp( double x[3] ) const
+{
+    if( x[0] < 1.0 )      x[0] = 1.0;
+    if( x[1] < 1.0001 )   x[1] = 1.0001;
+    if( x[2] < T2 )       x[2] = T2;
+}
+
+void CycleSolver::jacobian( double const x[3] , double const r[3] , double J[3][3] )
+{
+    diag.jacobians++;
+
+    if( exact )
+    {
+        typedef Dual<3> D;
+
+        D xd[3] = { D::var( x[0] , 0 ) , D::var( x[1] , 1 ) , D::var( x[2] , 2 ) };
+        D pd[Params];
+        for( int k = 0 ; k < Params ; k++ ) pd[k] = D( par[k] );
+
+        D rd[3];
+        cycle( xd , pd , D( T2 ) , D( p2 ) , D( q_pal ) , rd , ( Stations<D>* )0 );
+        diag.evaluations++;
+
+        for( int i = 0 ; i < 3 ; i++ )
+            for( int j = 0 ; j < 3 ; j++ )
+                J[i][j] = rd[i].d[j];
+        return;
+    }
+
+    for( int j = 0 ; j < 3 ; j++ )
+    {
+        double xp[3] = { x[0] , x[1] , x[2] };
+        double h = 1.0e-6 * x_ref[j];
+        xp[j] += h;
+
+        double rp[3];
+        evaluate( xp , rp );
+
+        for( int i = 0 ; i < 3 ; i++ )
+            J[i][j] = ( rp[i] - r[i] ) / h;
+    }
+}
+
+uint64_t CycleSolver::key( int iH , int iM , int it ) const
+{
+    return ( uint64_t( uint32_t( iH ) & 0x1FFFFF ) << 42 ) |
+           ( uint64_t( uint32_t( iM ) & 0x1FFFFF ) << 21 ) |
+             uint64_t( uint32_t( it ) & 0x1FFFFF );
+}
+
+bool CycleSolver::lookup( double H_alt , double Mach , double throttle , double x[3] ) const
+{
+    int iH = int( floor( H_alt / q_H + 0.5 ) );
+    int iM = int( floor( Mach / q_M + 0.5 ) );
+    int it = int( floor( throttle / q_t + 0.5 ) );
+
+    /// najpierw wlasna komorka, potem sasiednie
+    for( int d = 0 ; d <= 1 ; d++ )
+        for( int a = -d ; a <= d ; a++ )
+            for( int b = -d ; b <= d ; b++ )
+                for( int c = -d ; c <= d ; c++ )
+                {
+                    std::unordered_map<uint64_t , Entry>::const_iterator e =
+                        cache.find( key( iH + a , iM + b , it + c ) );
+                    if( e != cache.end() )
+                    {
+                        x[0] = e->second.x[0];
+                        x[1] = e->second.x[1];
+                        x[2] = e->second.x[2];
+                        return true;
+                    }
+                }
+    return false;
+}
+
+bool CycleSolver::solve( Atmosphere *atm , double H_alt , double Mach , double throttle , Point &out )
+{
+    double p[Params];
+    for( int k = 0 ; k < Params ; k++ ) p[k] = par[k];
+
+    p[P_Mach]     = Mach;
+    p[P_throttle] = throttle;
+    p[P_eta_ks]   = dat->eta_ks;
+
+    return solve( atm , H_alt , p , out );
+}
+
+bool CycleSolver::solve( Atmosphere *atm , double H_alt , double const p[Params] , Point &out )
+{
+    diag   = Diagnostics();
+    solved = false;
+
+    for( int k = 0 ; k < Params ; k++ ) par[k] = p[k];
+    double const Mach     = par[P_Mach];
+    double const throttle = par[P_throttle];
+
+    set_inlet( atm , H_alt );
+
+    double x[3] = { guess[0] , guess[1] , guess[2] };
+    diag.warm = use_cache && lookup( H_alt , Mach , throttle , x );
+
+    double r[3];
+    evaluate( x , r );
+    double f = norm_inf( r );
+
+    double J[3][3];
+    bool fresh = false;
+
+    if( f > tol )
+    {
+        jacobian( x , r , J );
+        fresh = true;
+    }
+
+    while( f > tol && diag.iterations < max_iter )
+    {
+        diag.iterations++;
+
+        double mr[3] = { -r[0] , -r[1] , -r[2] };
+        double dx[3];
+
+        if( !solve3( J , mr , dx ) )
+        {
+            if( fresh ) break;
+            jacobian( x , r , J );
+            fresh = true;
+            continue;
+        }
+
+        /// tlumienie: polowienie kroku az residuum zmaleje
+        double lambda = 1.0;
+        double xn[3] , rn[3] , fn = f;
+        for( int k = 0 ; k < 6 ; k++ )
+        {
+            for( int i = 0 ; i < 3 ; i++ ) xn[i] = x[i] + lambda * dx[i];
+            clamp( xn );
+            evaluate( xn , rn );
+            fn = norm_inf( rn );
+            if( fn < f ) break;
+            lambda *= 0.5;
+        }
+
+        if( !( fn < f ) )
+        {
+            if( fresh ) break;
+            jacobian( x , r , J );
+            fresh = true;
+            continue;
+        }
+
+        /// poprawka Broydena: J += ( dr - J s ) s^T / ( s^T s )
+        double s[3] , y[3] , ss = 0.0;
+        for( int i = 0 ; i < 3 ; i++ )
+        {
+            s[i] = ( xn[i] - x[i] ) / x_ref[i];
+            y[i] = rn[i] - r[i];
+            ss  += s[i] * s[i];
+        }
+        if( ss > 0.0 )
+        {
+            for( int i = 0 ; i < 3 ; i++ )
+            {
+                double Js = 0.0;
+                for( int j = 0 ; j < 3 ; j++ ) Js += J[i][j] * s[j] * x_ref[j];
+                double u = ( y[i] - Js ) / ss;
+                for( int j = 0 ; j < 3 ; j++ ) J[i][j] += u * s[j] / x_ref[j];
+            }
+        }
+        fresh = false;
+
+        for( int i = 0 ; i < 3 ; i++ ) { x[i] = xn[i]; r[i] = rn[i]; }
+        f = fn;
+    }
+
+    diag.residual  = f;
+    diag.converged = f <= tol;
+
+    evaluate( x , r , &out );
+    diag.evaluations--;                 ///< ostatnie tylko wypelnia wynik
+
+    if( diag.converged )
+    {
+        solved = true;
+        x_sol[0] = x[0];
+        x_sol[1] = x[1];
+        x_sol[2] = x[2];
+    }
+
+    if( diag.converged && use_cache )
+    {
+        int iH = int( floor( H_alt / q_H + 0.5 ) );
+        int iM = int( floor( Mach / q_M + 0.5 ) );
+        int it = int( floor( throttle / q_t + 0.5 ) );
+
+        Entry &c = cache[ key( iH , iM , it ) ];
+        c.x[0] = x[0];
+        c.x[1] = x[1];
+        c.x[2] = x[2];
+    }
+
+    return diag.converged;
+}
+
+bool CycleSolver::sensitivities( Sensitivity &s )
+{
+    if( !solved ) return false;
+
+    enum { M = 3 + Params };
+    typedef Dual<M> D;
+
+    /// niewiadome na pozycjach 0..2 , parametry na 3..
+    D xd[3] , pd[Params];
+    for( int j = 0 ; j < 3 ; j++ )      xd[j] = D::var( x_sol[j] , j );
+    for( int k = 0 ; k < Params ; k++ ) pd[k] = D::var( par[k] , 3 + k );
+
+    D T2d , p2d , qd;
+    inlet( pd , T2d , p2d , qd );
+
+    D rd[3];
+    Stations<D> st;
+    cycle( xd , pd , T2d , p2d , qd , rd , &st );
+
+    double Jx[3][3];
+    for( int i = 0 ; i < 3 ; i++ )
+        for( int j = 0 ; j < 3 ; j++ )
+            Jx[i][j] = rd[i].d[j];
+
+    /// dx/dp - kolumna po kolumnie
+    double dx[3][Params];
+    for( int k = 0 ; k < Params ; k++ )
+    {
+        double b[3] = { -rd[0].d[3+k] , -rd[1].d[3+k] , -rd[2].d[3+k] };
+        double c[3];
+        if( !solve3( Jx , b , c ) ) return false;
+        for( int j = 0 ; j < 3 ; j++ ) dx[j][k] = c[j];
+    }
+
+    D const *y[Outputs] = { &xd[0] , &xd[1] , &xd[2] , &st.T5 , &st.T6 , &st.m3 , &st.P_t , &st.P_free };
+
+    for( int o = 0 ; o < Outputs ; o++ )
+    {
+        s.y[o] = y[o]->v;
+        for( int k = 0 ; k < Params ; k++ )
+        {
+            double d = y[o]->d[3+k];
+            for( int j = 0 ; j < 3 ; j++ ) d += y[o]->d[j] * dx[j][k];
+            s.dy[o][k] = d;
+        }
+    }
+    return true;
+}
+
+const char *CycleSolver::param_name( Param p )
+{
+    static const char * const names[Params] =
+        { "Mach" , "throttle" , "sigma_H1" , "eta_S" , "sig_34" , "eta_ks" , "eta_Twc" ,
+          "sprez" , "mZR" , "mTwc" };
+    return p >= 0 && p < Params ? names[p] : "";
+}
+
+const char *CycleSolver::output_name( Output y )
+{
+    static const char * const names[Outputs] =
+        { "n_wc" , "epsT" , "T4s" , "T5s" , "T6s" , "m3" , "P_turbine" , "P_free" };
+    return y >= 0 && y < Outputs ? names[y] : "";
+}
@@ -0,0 +1,217 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef CYCLESOLVER_H
+#define CYCLESOLVER_H
+
+#include <Atmosphere.h>
+#include <enginedata.h>
+#include <Table.h>
+#include <memory>
+#include <unordered_map>
+#include <stdint.h>
+
+/// Dopasowanie ustalonego punktu pracy silnika turbowalowego.
+///
+/// Niewiadome: predkosc wirnika n_wc [rad/s] , rozprez turbiny epsT = p4 / p5 [-]
+/// i temperatura przed turbina T4 [K]. Dla zadanych H , Mach , throttle
+/// zerowane sa trzy residua ( bezwymiarowe ):
+///   r0 - bilans energii komory:   T4 - ( T3 + q_pal eta_ks W_opal / ( Cp m3 ) )
+///   r1 - przepustowosc turbiny:   m4 sqrt( T4 / T0 ) / ( p4 / p0 ) - mTwc_zr( n_zr )
+///   r2 - bilans mocy wirnika:     P_sprezarki - P_turbiny
+/// Metoda Broydena: jakobian poczatkowy dokladny ( jeden przebieg obiegu na
+/// liczbach dualnych , Dual.h ) albo z roznic skonczonych ( 3 obliczenia ),
+/// potem poprawki rzedu 1 bez dodatkowych obliczen, z tlumieniem kroku.
+/// Gdy krok nie zmniejsza residuum, jakobian jest liczony od nowa.
+///
+/// Obieg jest szablonem typu liczby - ten sam kod liczy residua w double,
+/// jakobian i pochodne ustalonego punktu wzgledem parametrow ( sensitivities ).
+///
+/// Zbiezne punkty trafiaja do pamieci podrecznej kluczowanej skwantowanymi
+/// ( H , Mach , throttle ); kolejne rozwiazanie w tej samej albo sasiedniej
+/// komorce startuje z zapamietanego punktu.
+class CycleSolver
+{
+public:
+    /// Parametry obiegu , wzgledem ktorych liczone sa pochodne
+    enum Param
+    {
+        P_Mach = 0 ,
+        P_throttle ,
+        P_sigma_H1 ,                        ///< straty wlotu
+        P_eta_S ,                           ///< mnoznik sprawnosci z charakterystyki sprezarki
+        P_sig_34 ,                          ///< straty cisnienia komory
+        P_eta_ks ,                          ///< sprawnosc spalania ( z decku )
+        P_eta_Twc ,                         ///< sprawnosc turbiny wirnika
+        P_sprez ,                           ///< mnoznik sprezu z charakterystyki sprezarki
+        P_mZR ,                             ///< mnoznik przeplywu zredukowanego sprezarki
+        P_mTwc ,                            ///< mnoznik przepustowosci turbiny
+        Params
+    };
+
+    /// Wielkosci ustalonego punktu , ktorych pochodne sa liczone
+    enum Output
+    {
+        Y_n_wc = 0 ,
+        Y_epsT ,
+        Y_T4s ,
+        Y_T5s ,
+        Y_T6s ,
+        Y_m3 ,
+        Y_P_turbine ,
+        Y_P_free ,
+        Outputs
+    };
+
+    struct Sensitivity
+    {
+        double y[Outputs];                  ///< wartosci w punkcie
+        double dy[Outputs][Params];         ///< dy / dp przy zachowanych bilansach ( r = 0 )
+    };
+
+    struct Point
+    {
+        double n_wc , epsT , T4s;           ///< niewiadome
+        double TH , pH;
+        double T2s , p2s;
+        double T3s , p3s , m3;
+        double q_pal;
+        double p4s , m4;
+        double T5s , p5s;
+        double T6s;
+        double P_compressor;                ///< [W]
+        double P_turbine;                   ///< [W] - turbina wirnika
+        double P_free;                      ///< [W] - turbina swobodna ( moc na wale )
+    };
+
+    struct Diagnostics
+    {
+        bool   converged;
+        bool   warm;                        ///< start z pamieci podrecznej
+        int    iterations;
+        int    evaluations;                 ///< liczba obliczen obiegu
+        int    jacobians;                   ///< liczba jakobianow liczonych od nowa
+        double residual;                    ///< max | r_i |
+    };
+
+    CycleSolver( std::weak_ptr<EngineData> Dat );
+
+    /// Wiazanie charakterystyk z deckiem - w konstruktorze; ponownie tylko po
+    /// zmianie tablic decku ( czysci tez pamiec podreczna rozwiazan )
+    void bind_tables();
+
+    bool solve( Atmosphere *atm , double H_alt , double Mach , double throttle , Point &out );
+
+    /// Wszystkie parametry podane ( p[P_eta_ks] zamiast eta_ks z decku ) -
+    /// do rozrzutu parametrow bez zmiany wspolnego decku ( MonteCarlo )
+    bool solve( Atmosphere *atm , double H_alt , double const p[Params] , Point &out );
+
+    Diagnostics const & get_diag() const { return diag; }
+
+    void set_tolerance( double Tol )   { tol = Tol; }
+    void set_max_iter( int N )         { max_iter = N; }
+    void set_guess( double n_wc , double epsT , double T4s );
+    void set_quantization( double dH , double dMa , double dthr );
+
+    /// Jakobian dokladny ( domyslnie ) albo z roznic skonczonych
+    void set_exact_jacobian( bool On ) { exact = On; }
+
+    /// sigma_H1 , eta_S , sig_34 , eta_Twc , mnozniki charakterystyk;
+    /// Mach , throttle i eta_ks ustawia solve()
+    void   set_param( Param p , double v ) { par[p] = v; }
+    double get_param( Param p ) const      { return par[p]; }
+
+    /// Pochodne punktu z ostatniego zbieznego solve() wzgledem wszystkich
+    /// parametrow - jeden przebieg obiegu na Dual<3+Params>, potem
+    /// dx/dp = -( dr/dx )^-1 dr/dp ( twierdzenie o funkcji uwiklanej ).
+    /// false - brak zbieznego punktu albo osobliwy jakobian.
+    bool sensitivities( Sensitivity &s );
+
+    static const char *param_name( Param p );
+    static const char *output_name( Output y );
+
+    /// Bez pamieci podrecznej kazde rozwiazanie startuje z set_guess() -
+    /// wynik nie zalezy od kolejnosci wywolan
+    void   set_cache( bool On )   { use_cache = On; }
+    void   clear_cache()      { cache.clear(); }
+    size_t cache_size() const { return cache.size(); }
+
+    /// Warunki punktu bez rozwiazywania - dla evaluate() poza solve() ( Dynamics )
+    void set_point( Atmosphere *atm , double H_alt , double Mach , double throttle );
+
+    /// Wielkosci punktu z set_point() dane wzorami zamknietymi: TH , pH , T2s , p2s , q_pal
+    void inlet_point( Point &out ) const;
+
+    /// Residua obiegu dla niewiadomych x = { n_wc , epsT , T4s } - jedno obliczenie
+    void evaluate( double const x[3] , double r[3] , Point *out = 0 );
+
+private:
+    /// Przekroje obiegu w typie S ( double albo Dual )
+    template <class S> struct Stations
+    {
+        S T3 , p3 , m3;
+        S p4 , m4;
+        S T5 , p5 , T6;
+        S P_c , P_t , P_free;
+    };
+
+    template <class S> void inlet( S const p[Params] , S &T2_ , S &p2_ , S &q_ );
+    template <class S> void cycle( S const x[3] , S const p[Params] , S const &T2_ , S const &p2_ ,
+                                   S const &q_ , S r[3] , Stations<S> *st );
+
+    void set_inlet( Atmosphere *atm , double H_alt );
+    void jacobian( double const x[3] , double const r[3] , double J[3][3] );
+    void clamp( double x[3] ) const;
+
+    uint64_t key( int iH , int iM , int it ) const;
+    bool     lookup( double H_alt , double Mach , double throttle , double x[3] ) const;
+
+    std::shared_ptr<EngineData> dat;
+
+    MultiTable<double,3> comp_map;
+    MultiTable<double,1> trb_map;
+    MultiTable<double,1> fuel_map;
+    TableCursor<double>  comp_cur , trb_cur , fuel_cur;
+
+    double TH , pH , T2 , p2 , q_pal;       ///< warunki biezacego punktu
+
+    double par[Params];
+
+    bool   exact;
+    bool   solved;                          ///< x_sol jest zbiezny
+    double x_sol[3];
+
+    double tol;
+    int    max_iter;
+    double guess[3];
+    double x_ref[3];                        ///< skale niewiadomych
+
+    double q_H , q_M , q_t;                 ///< kroki kwantyzacji klucza
+
+    struct Entry { double x[3]; };
+    std::unordered_map<uint64_t , Entry> cache;
+    bool use_cache;
+
+    Diagnostics diag;
+};
+
+#endif // CYCLESOLVER_H
@@ -0,0 +1,169 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <math.h>
+
+/// Liczba dualna z N pochodnymi czastkowymi - rozniczkowanie w przod.
+///
+/// Kazde dzialanie liczy wartosc tak samo jak double ( v jest identyczne z
+/// obliczeniem w double ) i pochodne z reguly lancuchowej - petle po d[N]
+/// o stalej dlugosci kompilator wektoryzuje. Zmienne niezalezne: var( x , i )
+/// ( d[i] = 1 ), stale: Dual( x ). Porownania wg wartosci - rozgalezienia
+/// i przedzialy tablic wybierane sa tak jak w double.
+///
+///     typedef Dual<2> D;
+///     D a = D::var( 2.0 , 0 ) , b = D::var( 3.0 , 1 );
+///     D f = a * sqrt( b );            // f.d[0] = sqrt( 3 ) , f.d[1] = 2 / ( 2 sqrt( 3 ) )
+template <int N> struct Dual
+{
+    enum { Size = N };
+
+    double v;                   ///< wartosc
+    double d[N];                ///< pochodne czastkowe
+
+    Dual() : v( 0.0 ) { zero(); }
+    Dual( double x ) : v( x ) { zero(); }
+
+    static Dual var( double x , int i ) { Dual r( x ); r.d[i] = 1.0; return r; }
+
+    /// Sama wartosc - tylko jawnie ( indeksowanie tablic , wydruk )
+    explicit operator double() const { return v; }
+
+    Dual &operator+=( Dual const &b ) { v += b.v; for( int i = 0 ; i < N ; i++ ) d[i] += b.d[i]; return *this; }
+    Dual &operator-=( Dual const &b ) { v -= b.v; for( int i = 0 ; i < N ; i++ ) d[i] -= b.d[i]; return *this; }
+    Dual &operator*=( Dual const &b ) { *this = *this * b; return *this; }
+    Dual &operator/=( Dual const &b ) { *this = *this / b; return *this; }
+
+    friend Dual operator-( Dual const &a )
+    { Dual r; r.v = -a.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = -a.d[i]; return r; }
+
+    friend Dual operator+( Dual const &a , Dual const &b )
+    { Dual r; r.v = a.v + b.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = a.d[i] + b.d[i]; return r; }
+    friend Dual operator+( Dual const &a , double b )
+    { Dual r( a ); r.v = a.v + b; return r; }
+    friend Dual operator+( double a , Dual const &b )
+    { Dual r( b ); r.v = a + b.v; return r; }
+
+    friend Dual operator-( Dual const &a , Dual const &b )
+    { Dual r; r.v = a.v - b.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = a.d[i] - b.d[i]; return r; }
+    friend Dual operator-( Dual const &a , double b )
+    { Dual r( a ); r.v = a.v - b; return r; }
+    friend Dual operator-( double a , Dual const &b )
+    { Dual r; r.v = a - b.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = -b.d[i]; return r; }
+
+    friend Dual operator*( Dual const &a , Dual const &b )
+    { Dual r; r.v = a.v * b.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = a.d[i] * b.v + a.v * b.d[i]; return r; }
+    friend Dual operator*( Dual const &a , double b )
+    { Dual r; r.v = a.v * b; for( int i = 0 ; i < N ; i++ ) r.d[i] = a.d[i] * b; return r; }
+    friend Dual operator*( double a , Dual const &b )
+    { Dual r; r.v = a * b.v; for( int i = 0 ; i < N ; i++ ) r.d[i] = a * b.d[i]; return r; }
+
+    /// ( a / b )' = ( a' - ( a / b ) b' ) / b
+    friend Dual operator/( Dual const &a , Dual const &b )
+    {
+        Dual r; r.v = a.v / b.v;
+        double ib = 1.0 / b.v;
+        for( int i = 0 ; i < N ; i++ ) r.d[i] = ( a.d[i] - r.v * b.d[i] ) * ib;
+        return r;
+    }
+    friend Dual operator/( Dual const &a , double b )
+    { Dual r; r.v = a.v / b; double ib = 1.0 / b; for( int i = 0 ; i < N ; i++ ) r.d[i] = a.d[i] * ib; return r; }
+    friend Dual operator/( double a , Dual const &b )
+    {
+        Dual r; r.v = a / b.v;
+        double k = -r.v / b.v;
+        for( int i = 0 ; i < N ; i++ ) r.d[i] = k * b.d[i];
+        return r;
+    }
+
+    friend bool operator< ( Dual const &a , Dual const &b ) { return a.v <  b.v; }
+    friend bool operator<=( Dual const &a , Dual const &b ) { return a.v <= b.v; }
+    friend bool operator> ( Dual const &a , Dual const &b ) { return a.v >  b.v; }
+    friend bool operator>=( Dual const &a , Dual const &b ) { return a.v >= b.v; }
+
+private:
+    void zero() { for( int i = 0 ; i < N ; i++ ) d[i] = 0.0; }
+};
+
+/// Wartosc bez pochodnych - dla double to samo
+inline double value_of( double x ) { return x; }
+template <int N> inline double value_of( Dual<N> const &x ) { return x.v; }
+
+template <int N> inline Dual<N> sqrt( Dual<N> const &x )
+{
+    Dual<N> r; r.v = sqrt( x.v );
+    double k = 0.5 / r.v;
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = k * x.d[i];
+    return r;
+}
+
+template <int N> inline Dual<N> exp( Dual<N> const &x )
+{
+    Dual<N> r; r.v = exp( x.v );
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = r.v * x.d[i];
+    return r;
+}
+
+template <int N> inline Dual<N> log( Dual<N> const &x )
+{
+    Dual<N> r; r.v = log( x.v );
+    double k = 1.0 / x.v;
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = k * x.d[i];
+    return r;
+}
+
+template <int N> inline Dual<N> fabs( Dual<N> const &x )
+{
+    return x.v < 0.0 ? -x : x;
+}
+
+/// x^e , e stale: ( x^e )' = e x^( e - 1 ) x'
+template <int N> inline Dual<N> pow( Dual<N> const &x , double e )
+{
+    Dual<N> r; r.v = pow( x.v , e );
+    double k = e * pow( x.v , e - 1.0 );
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = k * x.d[i];
+    return r;
+}
+
+/// x^y = exp( y ln x ) : ( x^y )' = x^y ( y' ln x + y x' / x )
+template <int N> inline Dual<N> pow( Dual<N> const &x , Dual<N> const &y )
+{
+    Dual<N> r; r.v = pow( x.v , y.v );
+    double lx = log( x.v );
+    double k  = r.v * y.v / x.v;
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = r.v * lx * y.d[i] + k * x.d[i];
+    return r;
+}
+
+template <int N> inline Dual<N> pow( double x , Dual<N> const &y )
+{
+    Dual<N> r; r.v = pow( x , y.v );
+    double k = r.v * log( x );
+    for( int i = 0 ; i < N ; i++ ) r.d[i] = k * y.d[i];
+    return r;
+}
+
+#endif // DUAL_H
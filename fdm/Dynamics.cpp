@@ -0,0 +1,372 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Dynamics.h"
+#include <math.h>
+
+using namespace EngineConst;
+
+namespace
+{
+
+/// Dormand-Prince 5(4)
+double const c2 = 1.0/5.0 , c3 = 3.0/10.0 , c4 = 4.0/5.0 , c5 = 8.0/9.0;
+
+double const a21 = 1.0/5.0;
+double const a31 = 3.0/40.0 ,       a32 = 9.0/40.0;
+double const a41 = 44.0/45.0 ,      a42 = -56.0/15.0 ,      a43 = 32.0/9.0;
+double const a51 = 19372.0/6561.0 , a52 = -25360.0/2187.0 , a53 = 64448.0/6561.0 , a54 = -212.0/729.0;
+double const a61 = 9017.0/3168.0 ,  a62 = -355.0/33.0 ,     a63 = 46732.0/5247.0 , a64 = 49.0/176.0 ,
+             a65 = -5103.0/18656.0;
+double const a71 = 35.0/384.0 ,     a73 = 500.0/1113.0 ,    a74 = 125.0/192.0 ,    a75 = -2187.0/6784.0 ,
+             a76 = 11.0/84.0;
+
+/// blad: rozwiazanie rzedu 5 minus rzedu 4
+double const e1 = 71.0/57600.0 , e3 = -71.0/16695.0 , e4 = 71.0/1920.0 , e5 = -17253.0/339200.0 ,
+             e6 = 22.0/525.0 ,   e7 = -1.0/40.0;
+
+/// Skale stanu do bledu i przyrostow w jakobianie
+double const x_scale[Dynamics::States] = { 1000.0 , T0 , 10.0 };
+
+double const n_min   = 1.0;             ///< [rad/s]
+double const T4_min  = 100.0;           ///< [K]
+double const eps_max = 50.0;
+
+/// Uklad States x States metoda Gaussa z wyborem elementu glownego; false - osobliwy
+bool solve_lin( double A[Dynamics::States][Dynamics::States] , double b[Dynamics::States] )
+{
+    int const n = Dynamics::States;
+    for( int c = 0 ; c < n ; c++ )
+    {
+        int p = c;
+        for( int i = c + 1 ; i < n ; i++ )
+            if( fabs( A[i][c] ) > fabs( A[p][c] ) ) p = i;
+        if( fabs( A[p][c] ) < 1.0e-300 ) return false;
+
+        for( int j = 0 ; j < n ; j++ ) { double t = A[c][j]; A[c][j] = A[p][j]; A[p][j] = t; }
+        double t = b[c]; b[c] = b[p]; b[p] = t;
+
+        for( int i = c + 1 ; i < n ; i++ )
+        {
+            double f = A[i][c] / A[c][c];
+            for( int j = c ; j < n ; j++ ) A[i][j] -= f * A[c][j];
+            b[i] -= f * b[c];
+        }
+    }
+    for( int i = n - 1 ; i >= 0 ; i-- )
+    {
+        for( int j = i + 1 ; j < n ; j++ ) b[i] -= A[i][j] * b[j];
+        b[i] /= A[i][i];
+    }
+    return true;
+}
+
+}
+
+Dynamics::Dynamics( std::weak_ptr<EngineData> Dat ) : cycle( Dat )
+{
+    dat = Dat.lock();
+
+    scheme  = RK4;
+    inertia = 0.03;
+    tau     = tau_ks;
+    h       = 0.001;
+    h_next  = h;
+    h_max   = 1.0;
+    rtol    = 1.0e-6;
+
+    input.H_alt    = 0.0;
+    input.Mach     = 0.0;
+    input.throttle = 0.5;
+
+    t = 0.0;
+    x[X_n_gg]  = 0.0;
+    x[X_T4]    = T0;
+    x[X_Omega] = rot.get_Omega();
+    fsal = false;
+
+    stats = Stats();
+}
+
+void Dynamics::set_state( double T , double const X[States] )
+{
+    t = T;
+    for( int i = 0 ; i < States ; i++ ) x[i] = X[i];
+    fsal = false;
+}
+
+bool Dynamics::trim( Atmosphere *atm , double t0 )
+{
+    Input in = schedule ? schedule( t0 ) : input;
+
+    CycleSolver::Point p;
+    if( !cycle.solve( atm , in.H_alt , in.Mach , in.throttle , p ) ) return false;
+
+    /// eta_g P_free = P_ref ( ... ) ( Omega / Omega_ref )^3
+    double L = rot.load( rot.get_Omega_ref() );
+    double P = rot.get_eta_g() * p.P_free;
+    double W = P > 0.0 && L > 0.0 ? rot.get_Omega_ref() * cbrt( P / L ) : 0.0;
+    rot.init( W );
+
+    double X[States] = { p.n_wc , p.T4s , W };
+    set_state( t0 , X );
+    h_next = h;
+    return true;
+}
+
+void Dynamics::derivatives( Atmosphere *atm , double tt , double const X[States] , double dX[States] , Output *out )
+{
+    Input in = schedule ? schedule( tt ) : input;
+    cycle.set_point( atm , in.H_alt , in.Mach , in.throttle );
+    stats.evaluations++;
+
+    /// stany posrednie duzych krokow bywa daleko od fizycznych - ograniczenia
+    /// ( takze NaN ) , zeby tablice nie dostaly nieokreslonych argumentow
+    double n  = X[X_n_gg] > n_min  ? X[X_n_gg] : n_min;
+    double T4 = X[X_T4]   > T4_min ? X[X_T4]   : T4_min;
+
+    /// epsT nie wplywa na r0 , r1 ani na stan przed turbina
+    CycleSolver::Point p;
+    double xc[3] = { n , 2.0 , T4 } , r[3];
+    cycle.evaluate( xc , r , &p );
+
+    double dn = 1.0e-6 * n;
+    double xd[3] = { n + dn , 2.0 , T4 } , rd[3];
+    cycle.evaluate( xd , rd );
+    double dr1 = ( rd[1] - r[1] ) / dn;
+
+    /// krok Newtona do predkosci ustalonej , ograniczony do polowy predkosci
+    double n_err = dr1 != 0.0 ? -r[1] / dr1 : 0.0;
+    if( n_err >  0.5 * n ) n_err =  0.5 * n;
+    if( n_err < -0.5 * n ) n_err = -0.5 * n;
+
+    double P_c   = p.P_compressor > 1.0 ? p.P_compressor : 1.0;
+    double n_dot = n_err * P_c / ( inertia * n * n );
+
+    /// model zastepczy ( Dynamics.h ): epsT dobrany do przyspieszenia z n_err ,
+    /// nie przyspieszenie z mocy turbiny
+    double P_t = P_c + inertia * n * n_dot;
+    double Cp  = dat->Cp;
+    double eta = cycle.get_param( CycleSolver::P_eta_Twc );
+    double w   = 1.0 - ( P_t / ( p.m4 * Cp * T4 ) ) / eta;
+    double epsT = w > pow( eps_max , ( 1.0 - k_s ) / k_s ) ? pow( w , k_s / ( 1.0 - k_s ) ) : eps_max;
+    if( epsT < 1.0001 ) epsT = 1.0001;
+
+    double T5 = T4 * ( 1.0 - ( 1.0 - pow( epsT , ( 1.0 - k_s ) / k_s ) ) * eta );
+    double p5 = p.p4s / epsT;
+    double T6 = T5 * pow( p0 / p5 , ( k_s - 1.0 ) / k_s );
+    double P_free = p.m4 * Cp * ( T5 - T6 );
+
+    dX[X_n_gg]  = n_dot;
+    dX[X_T4]    = -r[0] * T0 / tau;
+    dX[X_Omega] = rot.accel( P_free , X[X_Omega] );
+
+    if( out )
+    {
+        out->n_gg   = X[X_n_gg];
+        out->T4     = T4;
+        out->Omega  = X[X_Omega];
+        out->n_ft   = rot.get_ratio() * X[X_Omega];
+        out->dn_gg  = n_dot;
+        out->epsT   = epsT;
+        out->T3     = p.T3s;  out->p3 = p.p3s;  out->m3 = p.m3;
+        out->p4     = p.p4s;  out->m4 = p.m4;
+        out->T5     = T5;     out->p5 = p5;     out->T6 = T6;
+        out->P_c    = p.P_compressor;
+        out->P_t    = p.m4 * Cp * ( T4 - T5 );
+        out->P_free = P_free;
+        out->P_load = rot.load( X[X_Omega] );
+    }
+}
+
+double Dynamics::scale( int i , double a , double b ) const
+{
+    double m = fabs( a ) > fabs( b ) ? fabs( a ) : fabs( b );
+    return rtol * ( x_scale[i] + m );
+}
+
+void Dynamics::step_rk4( Atmosphere *atm , double dt )
+{
+    double q1[States] , q2[States] , q3[States] , q4[States] , y[States];
+
+    derivatives( atm , t , x , q1 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + 0.5 * dt * q1[i];
+    derivatives( atm , t + 0.5 * dt , y , q2 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + 0.5 * dt * q2[i];
+    derivatives( atm , t + 0.5 * dt , y , q3 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * q3[i];
+    derivatives( atm , t + dt , y , q4 );
+
+    for( int i = 0 ; i < States ; i++ )
+        x[i] += dt / 6.0 * ( q1[i] + 2.0 * q2[i] + 2.0 * q3[i] + q4[i] );
+    t += dt;
+}
+
+bool Dynamics::step_rk45( Atmosphere *atm , double dt , double &err )
+{
+    double q2[States] , q3[States] , q4[States] , q5[States] , q6[States] , q7[States];
+    double y[States] , x5[States];
+
+    if( !fsal )
+    {
+        derivatives( atm , t , x , k1 );
+        fsal = true;
+    }
+
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * a21 * k1[i];
+    derivatives( atm , t + c2 * dt , y , q2 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * ( a31 * k1[i] + a32 * q2[i] );
+    derivatives( atm , t + c3 * dt , y , q3 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * ( a41 * k1[i] + a42 * q2[i] + a43 * q3[i] );
+    derivatives( atm , t + c4 * dt , y , q4 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * ( a51 * k1[i] + a52 * q2[i] + a53 * q3[i] + a54 * q4[i] );
+    derivatives( atm , t + c5 * dt , y , q5 );
+    for( int i = 0 ; i < States ; i++ ) y[i] = x[i] + dt * ( a61 * k1[i] + a62 * q2[i] + a63 * q3[i] + a64 * q4[i] + a65 * q5[i] );
+    derivatives( atm , t + dt , y , q6 );
+    for( int i = 0 ; i < States ; i++ ) x5[i] = x[i] + dt * ( a71 * k1[i] + a73 * q3[i] + a74 * q4[i] + a75 * q5[i] + a76 * q6[i] );
+    derivatives( atm , t + dt , x5 , q7 );
+
+    err = 0.0;
+    for( int i = 0 ; i < States ; i++ )
+    {
+        double e = dt * ( e1 * k1[i] + e3 * q3[i] + e4 * q4[i] + e5 * q5[i] + e6 * q6[i] + e7 * q7[i] );
+        double r = fabs( e ) / scale( i , x[i] , x5[i] );
+        if( r > err || r != r ) err = r;
+    }
+    if( !( err <= 1.0 ) ) return false;
+
+    for( int i = 0 ; i < States ; i++ )
+    {
+        x[i]  = x5[i];
+        k1[i] = q7[i];
+    }
+    t += dt;
+    return true;
+}
+
+bool Dynamics::step_implicit( Atmosphere *atm , double dt , double &err )
+{
+    /// x1 = x0 + dt f( x1 ) ; start z kroku jawnego , jakobian raz na krok
+    double f0[States] , x1[States] , f1[States];
+
+    derivatives( atm , t , x , f0 );
+    for( int i = 0 ; i < States ; i++ ) x1[i] = x[i] + dt * f0[i];
+    derivatives( atm , t + dt , x1 , f1 );
+
+    double A[States][States];
+    for( int j = 0 ; j < States ; j++ )
+    {
+        double d = 1.0e-7 * ( x_scale[j] + fabs( x1[j] ) );
+        double xj[States] , fj[States];
+        for( int i = 0 ; i < States ; i++ ) xj[i] = x1[i];
+        xj[j] += d;
+        derivatives( atm , t + dt , xj , fj );
+
+        for( int i = 0 ; i < States ; i++ )
+            A[i][j] = ( i == j ? 1.0 : 0.0 ) - dt * ( fj[i] - f1[i] ) / d;
+    }
+
+    bool converged = false;
+    for( int it = 0 ; it < 8 && !converged ; it++ )
+    {
+        stats.newton++;
+
+        double M[States][States] , b[States];
+        for( int i = 0 ; i < States ; i++ )
+        {
+            for( int j = 0 ; j < States ; j++ ) M[i][j] = A[i][j];
+            b[i] = -( x1[i] - x[i] - dt * f1[i] );
+        }
+        if( !solve_lin( M , b ) ) break;
+
+        converged = true;
+        for( int i = 0 ; i < States ; i++ )
+        {
+            x1[i] += b[i];
+            if( !( fabs( b[i] ) <= 1.0e-10 * ( x_scale[i] + fabs( x1[i] ) ) ) ) converged = false;
+        }
+        derivatives( atm , t + dt , x1 , f1 );
+    }
+
+    /// blad lokalny niejawnego Eulera ~ dt^2 / 2 x'' ~ dt / 2 ( f1 - f0 )
+    err = converged ? 0.0 : NAN;
+    for( int i = 0 ; i < States && converged ; i++ )
+    {
+        double r = 0.5 * dt * fabs( f1[i] - f0[i] ) / scale( i , x[i] , x1[i] );
+        if( r > err || r != r ) err = r;
+    }
+
+    if( !( err <= 1.0 ) ) return false;
+
+    for( int i = 0 ; i < States ; i++ ) x[i] = x1[i];
+    t += dt;
+    return true;
+}
+
+void Dynamics::advance( Atmosphere *atm , double t_end )
+{
+    while( t_end - t > 1.0e-12 * ( 1.0 + fabs( t ) ) )
+    {
+        double left = t_end - t;
+
+        if( scheme == RK4 )
+        {
+            step_rk4( atm , h < left ? h : left );
+            stats.steps++;
+            continue;
+        }
+
+        double dt = h_next < h_max ? h_next : h_max;
+        bool cut = dt >= left;
+        if( cut ) dt = left;
+
+        double err;
+        bool ok = scheme == RK45 ? step_rk45( atm , dt , err ) : step_implicit( atm , dt , err );
+
+        /// nowy krok z bledu ( RK45 rzad 5 , Implicit rzad 2 ) , zmiana 0.2 .. 5 razy
+        double q = scheme == RK45 ? -0.2 : -0.5;
+        double f = err != err ? 0.2 : err > 0.0 ? 0.9 * pow( err , q ) : 5.0;
+        if( f > 5.0 ) f = 5.0;
+        if( f < 0.2 ) f = 0.2;
+
+        if( ok )
+        {
+            stats.steps++;
+            /// krok skrocony do t_end nie zmniejsza nastepnego
+            double hn = dt * f;
+            h_next = cut && hn < h_next ? h_next : hn;
+        }
+        else
+        {
+            stats.rejected++;
+            h_next = dt * f;
+            if( h_next < 1.0e-9 ) h_next = 1.0e-9;
+        }
+    }
+}
+
+void Dynamics::output( Atmosphere *atm , Output &out )
+{
+    double dX[States];
+    derivatives( atm , t , x , dX , &out );
+}
@@ -0,0 +1,161 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#include <CycleSolver.h>
+#include <Rotor.h>
+#include <functional>
+
+/// Dynamika silnika turbowalowego jako uklad rownan rozniczkowych , z wybieranym
+/// schematem calkowania.
+///
+/// Stan x = { n_gg , T4 , Omega }:
+///   n_gg  [rad/s] - wirnik wytwornicy gazu ,
+///   T4    [K]     - temperatura przed turbina , opoznienie cieplne komory:
+///                   dT4/dt = ( T4_paliwo - T4 ) / tau ,
+///   Omega [rad/s] - wirnik nosny ( Rotor ) , turbina swobodna kreci sie ratio * Omega.
+///
+/// n_gg NIE wynika z bilansu mocy wirnika J n dn/dt = P_t - P_c - to model
+/// zastepczy pierwszego rzedu. Predkosc ustalona n* ( dla biezacego T4 ) wyznacza
+/// przepustowosc turbiny ( r1 w CycleSolver ) , a n_gg dochodzi do niej ze stala
+/// czasowa bezwladnosci tau_n = J n^2 / P_c:
+///   dn/dt = ( n* - n ) / tau_n   ( n* - n z jednego kroku Newtona na r1 ).
+/// epsT jest potem dobierany tak , by P_t = P_c + J n dn/dt , wiec bilans mocy
+/// jest spelniony z definicji , a nie wyznacza przyspieszenia. Reszta spadku
+/// entalpii napedza turbine swobodna i wirnik nosny. Dla dx/dt = 0 to dokladnie
+/// punkt CycleSolver.
+///
+/// Prawdziwy bilans nie daje sie zbudowac z danych decku: z epsT z charakterystyki
+/// turbiny ( epsT_roz ) rownowaga P_t = P_c jest niestabilna albo jej nie ma , a powyzej
+/// konca charakterystyki sprezarki P_c i T4 nie zaleza od n ( brak momentu
+/// przywracajacego ). Potrzebna bylaby przepustowosc turbiny swobodnej , ktorej
+/// deck nie ma. Przebiegi przejsciowe n_gg sa wiec jakosciowe ( stala czasowa
+/// tau_n ) , nie z fizyki wirnika.
+///
+/// Schematy:
+///   RK4      - staly krok , do pracy w czasie rzeczywistym,
+///   RK45     - Dormand-Prince z kontrola bledu ( FSAL ) - krok rosnie , gdy nic
+///              sie nie dzieje , wiec czas liczenia misji zalezy od zmian , nie od
+///              jej dlugosci ,
+///   Implicit - niejawny Euler , Newton z jakobianem z roznic , krok z bledu
+///              lokalnego dt / 2 | f1 - f0 | - krok nie jest ograniczony stala
+///              czasowa komory ( uklad sztywny ) , tylko dokladnoscia.
+class Dynamics
+{
+public:
+    enum State  { X_n_gg = 0 , X_T4 , X_Omega , States };
+    enum Scheme { RK4 , RK45 , Implicit };
+
+    struct Input
+    {
+        double H_alt;                       ///< [m]
+        double Mach;
+        double throttle;
+    };
+
+    /// Wejscia w funkcji czasu - np. Scenario::at
+    typedef std::function<Input( double t )> Schedule;
+
+    struct Output
+    {
+        double n_gg , T4 , Omega , n_ft;
+        double dn_gg;                       ///< [rad/s2]
+        double epsT;
+        double T3 , p3 , m3 , p4 , m4;
+        double T5 , p5 , T6;
+        double P_c , P_t , P_free , P_load; ///< [W]
+    };
+
+    struct Stats
+    {
+        long steps;
+        long rejected;                      ///< kroki odrzucone ( RK45 , Implicit )
+        long evaluations;                   ///< obliczenia pochodnych
+        long newton;                        ///< Implicit - iteracje Newtona
+    };
+
+    Dynamics( std::weak_ptr<EngineData> Dat );
+
+    void   set_scheme( Scheme S )    { scheme = S; fsal = false; }
+    Scheme get_scheme() const        { return scheme; }
+    void   set_step( double H )      { h = H; h_next = H; }     ///< [s] - RK4 ; pierwszy krok RK45 , Implicit
+    void   set_max_step( double H )  { h_max = H; }             ///< [s] - RK45 , Implicit
+    void   set_tolerance( double R ) { rtol = R; }              ///< blad wzgledny kroku RK45 , Implicit
+    void   set_inertia( double J )   { inertia = J; fsal = false; }   ///< [kg m2] - wirnik wytwornicy
+    void   set_tau( double Tau )     { tau = Tau; fsal = false; }     ///< [s] - stala czasowa komory
+
+    Rotor       & rotor()       { fsal = false; return rot; }
+    Rotor const & rotor() const { return rot; }
+
+    /// Stale wejscia; harmonogram ( set_schedule ) ma pierwszenstwo
+    void set_input( Input const &In )  { input = In; fsal = false; }
+    void set_schedule( Schedule S )    { schedule = S; fsal = false; }
+
+    /// Stan ustalony dla wejsc w chwili t0 ( CycleSolver ) , Omega z rownowagi
+    /// wirnika nosnego. false - brak zbieznosci
+    bool trim( Atmosphere *atm , double t0 = 0.0 );
+
+    /// Calkowanie od biezacego czasu do t_end
+    void advance( Atmosphere *atm , double t_end );
+
+    double        get_t() const { return t; }
+    double const *get_x() const { return x; }
+    void          set_state( double T , double const X[States] );
+
+    /// Wielkosci w biezacym stanie
+    void output( Atmosphere *atm , Output &out );
+
+    /// dx/dt w ( tt , X ) ; out - wielkosci przekrojow
+    void derivatives( Atmosphere *atm , double tt , double const X[States] , double dX[States] , Output *out = 0 );
+
+    Stats const & get_stats() const { return stats; }
+    void reset_stats()              { stats = Stats(); }
+
+private:
+    void step_rk4( Atmosphere *atm , double dt );
+    bool step_rk45( Atmosphere *atm , double dt , double &err );
+    bool step_implicit( Atmosphere *atm , double dt , double &err );
+
+    double scale( int i , double a , double b ) const;
+
+    std::shared_ptr<EngineData> dat;
+    CycleSolver cycle;
+    Rotor rot;
+
+    Scheme scheme;
+    double inertia , tau;
+    double h , h_next , h_max , rtol;
+
+    Input input;
+    Schedule schedule;
+
+    double t;
+    double x[States];
+    double k1[States];                      ///< RK45 - pochodna na poczatku kroku ( FSAL )
+    bool   fsal;
+
+    Stats stats;
+};
+
+#endif // DYNAMICS_H
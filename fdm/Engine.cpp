@@ -22,13 +22,46 @@
 ******************************************************************************/
 
 #include "Engine.h"
+#include <Profiler.h>
+#include <Station.h>
 #include <assert.h>
+#include <string.h>
 
 using namespace EngineConst;
 
+namespace
+{
+
+/// Naglowek migawki silnika
+struct SnapHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bytes;             ///< dlugosc calej migawki - wykrywa obciecie
+    uint32_t flags;
+    int32_t  sk , ck , tk;      ///< rozmiary tablic decku
+};
+
+uint32_t const snap_magic   = 0x53454D44;       ///< "DMES"
+uint32_t const snap_version = 2;
+uint32_t const snap_atm     = 1;                ///< migawka zawiera atmosfere
+
+}
+
 Engine::Engine( std::weak_ptr<EngineData> Dat )
 {
     dat = Dat.lock();
+
+    Mach     = 0.0;
+    n_wc     = 0.0;
+    throttle = 0.0;
+
+    temp  = Temp();
+    press = Press();
+    mS    = MassFlow();
+    speed = Speed();
+    P_turbine = 0.0;
+    P_free    = 0.0;
 }
 
 Engine::~Engine()
@@ -41,44 +74,111 @@ void Engine::init_Engine()
 {
     cout << "init Engine" << endl;
 
+    /// deck wspoldzielony ( TurboShaftEngine( deck ) , EngineDeck::open ) jest
+    /// tylko do odczytu - nowy blok zwolnilby tablice innych silnikow
+    if( dat->is_sealed() )
+    {
+        cerr << "Engine::init_Engine: deck is sealed - not reallocated" << endl;
+        return;
+    }
 
-    dat->sk = 8;
-    dat->ck = 13;
-    dat->tk = 10;
+    /// wszystkie tablice w jednym bloku - EngineData::allocate
+    dat->allocate( 8 , 13 , 10 );
 
     assert( dat->sk );
     assert( dat->ck );
     assert( dat->tk );
 
-    if( dat->sk > 0 )
-    {
-        dat->rpm_tab   = new double [ dat->sk ];
-        dat->sprez_tab = new double [ dat->sk ];
-        dat->eta_tab   = new double [ dat->sk ];
-        dat->mZR_tab   = new double [ dat->sk ];
-    }
+    EngineData::Builder b( *dat );
+    b.W_opal = 41868000.0;
+    b.Cp     = 1172.30;
+    b.eta_ks = 0.96;
+
+    /// nowy blok - elementy zbudowane wczesniej wskazuja jeszcze na stary
+    if( compressor ) compressor->init_compressor();
+}
 
-    dat->W_opal = 41868000.0;
-    dat->Cp     = 1172.30;
-    dat->eta_ks = 0.96;
+void Engine::update(Atmosphere *atm , double dt )
+{
+    DME_PROFILE_ROOT( Profiler::Engine );
 
-    if( dat->ck > 0 )
-    {
-        dat->q_pal_thr = new double [dat->ck];
-        dat->q_pal_tab = new double [dat->ck];
-    }
+    if( !intake || !compressor || !combchamber || !turbine || !turbine_f )
+        return;
 
-    if( dat->tk )
-    {
-        dat->rpm_tab_t = new double [ dat->tk ];
-        dat->epsT_roz_tab = new double [ dat->tk ];
-    }
+    intake->update_intake( atm->get_T() , atm->get_p() , Mach );
+
+    temp.TH  = intake->get_TH();
+    press.ph = intake->get_pH();
+    temp.T1s = temp.T2s  = intake->get_T1_s();
+    press.p1s = press.p2s = intake->get_p1_s();
+    speed.c1 = speed.c2 = intake->get_c1();
+
+    compressor->update_compressor( press.p2s , temp.T2s , speed.c2 , n_wc , throttle );
 
+    temp.T3s  = compressor->get_T3_s();
+    press.p3s = compressor->get_p3_s();
+    mS.m1 = mS.m2 = mS.m3 = compressor->get_m3();
+    speed.c3  = compressor->get_c3();
+
+    combchamber->update_comchamber( press.p3s , temp.T3s , mS.m3 , speed.c3 , throttle , dt );
+
+    temp.T4s  = combchamber->get_T4_s();
+    press.p4s = combchamber->get_p4_s();
+    mS.m4     = combchamber->get_m4();
+    speed.c4  = combchamber->get_c4();
+
+    turbine->update_turbine( press.p4s , temp.T4s , mS.m4 , speed.c4 , n_wc );
+
+    temp.T5s  = turbine->get_T5_s();
+    press.p5s = turbine->get_p5_s();
+    mS.m5     = mS.m4;
+    speed.c5  = turbine->get_c5();
+    P_turbine = turbine->get_Pt();
+
+    turbine_f->update_turbine_f( press.p5s , temp.T5s , mS.m5 , speed.c5 , n_wc );
+
+    P_free = mS.m5 * turbine_f->get_wpt();
 }
 
-void Engine::update(Atmosphere *)
+bool Engine::save( Snapshot &s , Atmosphere *atm )
 {
+    if( !intake || !compressor || !combchamber || !turbine || !turbine_f )
+        return false;
+
+    SnapHeader h = { snap_magic , snap_version , 0 , atm ? snap_atm : 0u , dat->sk , dat->ck , dat->tk };
 
+    s.clear();
+    SnapshotWriter ar( s );
+    ar & h;
+    serialize( ar );
+    if( atm ) atm->serialize( ar );
+
+    h.bytes = uint32_t( s.size() );
+    memcpy( s.data() , &h , sizeof( h ) );
+    return true;
+}
+
+bool Engine::restore( Snapshot const &s , Atmosphere *atm )
+{
+    if( !intake || !compressor || !combchamber || !turbine || !turbine_f )
+        return false;
+
+    SnapshotReader ar( s );
+    SnapHeader h;
+    ar & h;
+
+    /// wszystko sprawdzone przed odczytem stanu - zla migawka niczego nie zmienia
+    if( !ar.ok() || h.magic != snap_magic || h.version != snap_version || h.bytes != s.size() )
+        return false;
+    if( h.sk != dat->sk || h.ck != dat->ck || h.tk != dat->tk )
+        return false;
+    if( atm && !( h.flags & snap_atm ) )
+        return false;
+
+    serialize( ar );
+    if( atm ) atm->serialize( ar );
+
+    return ar.ok();
 }
 
 Engine *EngineConstruct::CreateEngine(EngineBuilder &builder)
@@ -91,8 +191,7 @@ Engine *EngineConstruct::CreateEngine(EngineBuilder &builder)
 
     builder.BuildTurbineFree();
 
-
-
+    return builder.GetEngine().lock().get();
 }
 
 TurboShaftEngine::TurboShaftEngine()
@@ -106,6 +205,14 @@ TurboShaftEngine::TurboShaftEngine()
 
 }
 
+TurboShaftEngine::TurboShaftEngine( std::shared_ptr<EngineData> Dat )
+{
+    /// deck wspoldzielony - tablice tylko do odczytu
+    dat = Dat;
+
+    TurboShaftEng = std::make_shared<Engine>(dat);
+}
+
 TurboShaftEngine::~TurboShaftEngine()
 {
     TurboShaftEng.reset();
@@ -123,26 +230,31 @@ TurboShaftEngine::~TurboShaftEngine()
 void TurboShaftEngine::BuildIntake()
 {
     intake = std::make_shared<Intake> ( dat );
+    TurboShaftEng->set_intake( intake );
 }
 
 void TurboShaftEngine::BuildCompressor( )
 {
     compressor = std::make_shared<Compressor> ( dat );
+    TurboShaftEng->set_compressor( compressor );
 }
 
 void TurboShaftEngine::BuildCombustionChamber( )
 {
     combchamber = std::make_shared<CombustionChamber> ( dat );
+    TurboShaftEng->set_combchamber( combchamber );
 }
 
 void TurboShaftEngine::BuildTurbine()
 {
     turbine = std::make_shared<Turbine> ( dat );
+    TurboShaftEng->set_turbine( turbine );
 }
 
 void TurboShaftEngine::BuildTurbineFree( )
 {
     turbine_f = std::make_shared<Turbine_f>( dat );
+    TurboShaftEng->set_turbine_f( turbine_f );
 }
 
 Intake::Intake( std::weak_ptr<EngineData> Dat)
@@ -167,22 +279,16 @@ Intake::~Intake()
 
 void Intake::update_intake(const double T_H, const double p_H, const double Ma_H)
 {
+    DME_PROFILE_SCOPE( Profiler::Intake );
+
     TH   = T_H;
     pH   = p_H;
     Mach = Ma_H;
 
-    sigma_H1 = 0.96;
-
-    double k_Ma2 = ((k_p - 1.0) / 2.0) * Mach*Mach;
-    double b_Ma2 = ( 1.0 + k_Ma2 );
-    double k_div_k1 = k_p / ( k_p - 1.0 );
-    double b_Ma2_k = pow( b_Ma2 , k_div_k1 );
+    sigma_H1 = Station::sigma_H1;
 
-    T1_s = TH_s = TH * ( b_Ma2 );
-    pH_s = pH * ( b_Ma2_k );
-    p1_s = sigma_H1 * pH_s;
-
-    c1 = sqrt ( (T1_s - TH) * 2.0 * k_p / ( k_p - 1.0 ) * R_p );
+    Station::intake( TH , pH , Mach , sigma_H1 , T1_s , pH_s , p1_s , c1 );
+    TH_s = T1_s;
 }
 
 
@@ -216,6 +322,8 @@ Compressor::Compressor( std::weak_ptr<EngineData> Dat )
     A1_S = intake_aera_0;
     A2_II_S = out_aera_0;
 
+    init_compressor();
+
 
     sigma_s_wc = 0.98;         /// Wpolczynnik strat cisnienia spietrzenia str 43 pdf Wiatrek
 
@@ -231,32 +339,35 @@ void Compressor::init_compressor()
 {
     sigma_s_wc = 0.98;         /// Wpolczynnik strat cisnienia spietrzenia str 43 pdf Wiatrek
 
+    double const * const cols[3] = { dat->sprez_tab , dat->eta_tab , dat->mZR_tab };
+    map.bind( dat->rpm_tab , cols , dat->sk , dat->inv_rpm_tab );
 }
 
 void Compressor::update_compressor(const double p2_s, const double T2_s, const double c2, const double n_wc, const double throttle)
 {
+    DME_PROFILE_SCOPE( Profiler::Compressor );
+
     double T_red = sqrt( T0 / T2_s );
     n_zrS = n_wc * T_red;
     double nzr_rpm = n_zrS * rads2rpm;
-    int const k = 8;
 
+    double val[3];
+    map.lookup( nzr_rpm , val );
 
-    sprezS_s = Interpolation( nzr_rpm , dat->sprez_tab , dat->rpm_tab , k );
-    eta_S    = Interpolation( nzr_rpm , dat->eta_tab   , dat->rpm_tab , k );
-    mS_zr    = Interpolation( nzr_rpm , dat->mZR_tab   , dat->rpm_tab , k );
+    sprezS_s = val[0];
+    eta_S    = val[1];
+    mS_zr    = val[2];
 
-    mS = mS_zr * ( p2_s / p0 ) * sqrt( T0 / T2_s );
-    p3_s = sprezS_s * p2_s;
+    Station::compressor( T2_s , p2_s , sprezS_s , eta_S , mS_zr , T3_s , p3_s , mS );
 
-    double SPREZ_k = pow( sprezS_s ,  (k_p - 1.0 ) / k_p     );
-    T3_s = T2_s * ( 1.0 + ( SPREZ_k - 1.0 ) * 1.0 / (eta_S )  );
+    c3 = c2;                   /// stala predkosc osiowa w sprezarce
 
     double N_s = n_wc * rads2rpm;
     double N_szr = n_zrS * rads2rpm;
 
 }
 
-CombustionChamber::CombustionChamber(std::weak_ptr<EngineData> Dat)
+CombustionChamber::CombustionChamber(std::weak_ptr<EngineData> Dat) : lag( EngineConst::tau_ks )
 {
     dat = Dat.lock();
 
@@ -269,7 +380,9 @@ CombustionChamber::CombustionChamber(std::weak_ptr<EngineData> Dat)
     W_opal = 0.0;
     Cp_wl = 0.0;
     m_ks = 0.0;
-    sig_34 = 0.9578;
+    T_ch = 0.0;
+    primed = false;
+    sig_34 = Station::sig_34;
 }
 
 CombustionChamber::~CombustionChamber()
@@ -281,24 +394,23 @@ CombustionChamber::~CombustionChamber()
 
 void CombustionChamber::init_combchamber()
 {
-    sig_34 = 0.9578;
+    sig_34 = Station::sig_34;
+    primed = false;
 }
 
-void CombustionChamber::update_comchamber(const double p3_s, const double T3_s, const double mS, const double c3, const double throttle)
+void CombustionChamber::update_comchamber(const double p3_s, const double T3_s, const double mS, const double c3, const double throttle, const double dt)
 {
-    p4_s = sig_34 * p3_s;
-
-    double mS_t = 1.0 / mS;
+    DME_PROFILE_SCOPE( Profiler::CombustionChamber );
 
-    double T4_tt = mS_t * ( q_pal  * dat->eta_ks * dat->W_opal   ) /  ( dat->Cp ) + T3_s  ;
-    T4_s = T4_tt;
+    q_pal = cursor.interpolate( throttle , dat->q_pal_tab , dat->q_pal_thr , dat->ck );
 
-    c4 = ( 1.0 - p4_s / p3_s ) * R_s * T3_s / c3 + c3;
+    double T4_tt;
+    Station::chamber( p3_s , T3_s , mS , c3 , q_pal , sig_34 , dat->eta_ks , dat->W_opal , dat->Cp ,
+                      p4_s , T4_tt , c4 , m_ks );
 
-    static double T_ch = ( T4_tt );
-    T_ch += ((T4_s - T_ch  ) / 1.0) * 0.1;
+    if( !primed ) { T_ch = T4_tt; primed = true; }
+    T_ch += ( T4_tt - T_ch ) * lag( dt );
     T4_s = T_ch;
-    m_ks = mS + q_pal ;
 
 }
 
@@ -307,12 +419,14 @@ Turbine::Turbine(std::weak_ptr<EngineData> Dat)
     dat = Dat.lock();
 
     p5_s     = 0.0;
-    eta_Twc  = 0.99;
+    eta_Twc  = Station::eta_Twc;
     n_zrT_wc = 0.0;
     mTwc_zr  = 0.0;
     nT_wc_s  = 0.0;
     mT_wc    = 0.0;
     T5_s     = 0.0;
+    P_turbine = 0.0;
+    c5       = 0.0;
 }
 
 Turbine::~Turbine()
@@ -329,30 +443,20 @@ void Turbine::init_turbine()
 
 void Turbine::update_turbine(const double p4_s, const double T4_s, const double mS, const double c4, const double n_wc)
 {
-    int const k = 10;
+    DME_PROFILE_SCOPE( Profiler::Turbine );
+
     double T_sqrt = sqrt( T0 / T4_s );
     n_zrT_wc = n_wc * T_sqrt;           /// [rad/ s]
 
     double n_wc_rpm_zr = n_zrT_wc * rads2rpm;
 
-    double epsT_roz = Interpolation( n_wc_rpm_zr , dat->epsT_roz_tab , dat->rpm_tab_t , k  );
+    double epsT_roz = cursor.interpolate( n_wc_rpm_zr , dat->epsT_roz_tab , dat->rpm_tab_t , dat->tk );
 
-    p5_s = p4_s / epsT_roz;
+    /// p5 z T5 poprzedniego kroku
+    Station::turbine( p4_s , T4_s , mS , epsT_roz , eta_Twc , dat->A_turbine , dat->Cp ,
+                      p5_s , T5_s , c5 , P_turbine );
 
-    double p5_SS = p4_s * pow( T5_s / T4_s  , k_s / ( k_s - 1.0 ) );
-    p5_s = p5_SS;
-
-    double T5_static = T5_s - c5 * c5 / ( 2.0 * dat->Cp );
-    double Ma = c5 / sqrt( k_p * R_p * T5_static );
-    double p5_static = p5_s / (pow( (1.0 + (k_p + 1.0) / 2.0 * Ma * Ma) , (k_p / ( k_p - 1.0 )) ));
-
-    double mTwc_zr_tab[k]= { 2.0 , 1.17, 1.23, 1.28, 1.31,1.33, 1.34, 1.35,   1.35,    1.35    };
-
-    T5_s = T4_s * ( 1.0 -   ( 1.0 - pow( epsT_roz , (1.0 - k_s )/k_s ) ) * eta_Twc  ) ;
-
-    double ro_T = p5_s / ( R_s * T5_s );
-
-    c5 = mS /( ro_T * dat->A_turbine );
+    mT_wc = mS;
 }
 
 Turbine_f::Turbine_f(std::weak_ptr<EngineData> Dat)
@@ -365,6 +469,7 @@ Turbine_f::Turbine_f(std::weak_ptr<EngineData> Dat)
     T6_s = 0.0;
     c6 = 0.0;
     m6 = 0.0;
+    wpt = 0.0;
 }
 
 Turbine_f::~Turbine_f()
@@ -375,11 +480,11 @@ Turbine_f::~Turbine_f()
 
 void Turbine_f::update_turbine_f(const double p5_s, const double T5_s, const double mS, const double c5, const double n_wc)
 {
-    p6_s = p0;
+    DME_PROFILE_SCOPE( Profiler::Turbine_f );
 
-    T6_s = T5_s * pow(( p6_s / p5_s ) , ( k_s - 1.0) / k_s );
+    p6_s = p0;
 
-    double wpt = dat->Cp * ( T5_s - T6_s );
+    Station::turbine_f( p5_s , T5_s , dat->Cp , T6_s , wpt );
 }
 
 void Turbine_f::init_turbine_f()
@@ -390,6 +495,7 @@ void Turbine_f::init_turbine_f()
     T6_s  = 0.0;
     c6    = 0.0;
     m6    = 0.0;
+    wpt   = 0.0;
 }
 
 EngineBuilder::EngineBuilder()
@@ -27,6 +27,8 @@
 #include <iostream>
 #include <Atmosphere.h>
 #include <enginedata.h>
+#include <Snapshot.h>
+#include <Table.h>
 #include <memory>
 
 using namespace std;
@@ -44,6 +46,11 @@ public:
     double get_p1_s(){ return p1_s; }
     double get_T1_s(){ return T1_s; }
     double get_c1() { return  c1;}
+    double get_TH() { return  TH;}
+    double get_pH() { return  pH;}
+
+    template <class Archive> void serialize( Archive &ar )
+    { ar & T1_s & TH_s & TH & Mach & pH_s & pH & p1_s & sigma_H1 & c1; }
 
 private:
 
@@ -64,10 +71,24 @@ class Compressor
 public:
     Compressor( std::weak_ptr<EngineData> Dat );
     ~Compressor();
+
+    /// Wiazanie charakterystyki z deckiem - w konstruktorze; ponownie tylko po
+    /// zmianie tablic decku ( EngineData::allocate na tym samym obiekcie )
     void init_compressor();
 
     void update_compressor( double const p2_s, double const T2_s, const double c2 , double const n_wc, double const throttle  );
 
+    double get_p3_s() { return p3_s; }
+    double get_T3_s() { return T3_s; }
+    double get_m3()   { return mS;   }
+    double get_c3()   { return c3;   }
+
+    template <class Archive> void serialize( Archive &ar )
+    {
+        ar & p3_s & sprezS_s & n_zrS & mS_zr & mS & eta_S & T3_s & A1_S & A2_II_S
+           & ro1_S & ro2_II_S & sigma_s_wc & c3;
+    }
+
 private:
     double p3_s;
     double sprezS_s;
@@ -81,6 +102,8 @@ private:
     double sigma_s_wc;
     double c3;
 
+    MultiTable<double,3> map;   ///< rpm -> sprezS_s , eta_S , mS_zr
+
     std::shared_ptr<EngineData> dat;
 };
 
@@ -92,7 +115,24 @@ public:
     void init_combchamber();
     void update_comchamber( double const p3_s , double const T3_s ,
                                 double const mS ,  double const c3,
-                                double const throttle  );
+                                double const throttle ,
+                                double const dt = EngineConst::dt_ref );
+
+    void   set_tau( double tau ) { lag.set_tau( tau ); }   ///< [s] - stala czasowa T4
+    double get_tau() const { return lag.get_tau(); }
+
+    double get_p4_s() { return p4_s; }
+    double get_T4_s() { return T4_s; }
+    double get_m4()   { return m_ks; }
+    double get_c4()   { return c4;   }
+    double get_q_pal(){ return q_pal;}
+
+    template <class Archive> void serialize( Archive &ar )
+    {
+        ar & p4_s & sig_34 & T4_s & q_pal & eta_ks & W_opal & Cp_wl & m_ks & c4 & T_ch & primed;
+        lag.serialize( ar );
+        cursor.serialize( ar );
+    }
 
 private:
     double p4_s;
@@ -104,6 +144,10 @@ private:
     double Cp_wl;
     double m_ks;
     double c4;
+    double T_ch;                ///< [K] - T4 po opoznieniu ( stan instancji )
+    bool   primed;              ///< T_ch zainicjowane pierwszym krokiem
+    LagGain lag;                ///< opoznienie cieplne komory
+    TableCursor<double> cursor; ///< przedzial charakterystyki q_pal_thr
     std::shared_ptr<EngineData> dat ;
 
 };
@@ -125,6 +169,12 @@ public:
     double get_Pt() {return P_turbine; }
     double get_c5() { return  c5; }
 
+    template <class Archive> void serialize( Archive &ar )
+    {
+        ar & p5_s & eta_Twc & n_zrT_wc & mTwc_zr & nT_wc_s & mT_wc & T5_s & P_turbine & c5;
+        cursor.serialize( ar );
+    }
+
 private:
     double p5_s;
     double eta_Twc;
@@ -135,6 +185,7 @@ private:
     double T5_s;
     double P_turbine;
     double c5;
+    TableCursor<double> cursor; ///< przedzial charakterystyki rpm_tab_t
     std::shared_ptr<EngineData> dat ;
 };
 
@@ -153,12 +204,17 @@ public:
     double get_T6_s() { return  T6_s; }
     double get_p6_s() { return  p6_s; }
     double get_c6()   { return  c6;   }
+    double get_wpt()  { return  wpt;  }
+
+    template <class Archive> void serialize( Archive &ar )
+    { ar & omega & eta_T & p6_s & T6_s & c6 & m6 & wpt; }
 
 private:
     double omega;
     double eta_T;
     double p6_s , T6_s , c6;
     double m6;
+    double wpt;                 ///< [J/kg] - praca jednostkowa turbiny swobodnej
 
     std::shared_ptr<EngineData> dat;
 };
@@ -170,11 +226,73 @@ public:
     ~Engine();
 
     void init_Engine();
-    void update( Atmosphere * );
+    void update( Atmosphere * , double dt = EngineConst::dt_ref );   ///< dt [s]
+
+    void set_intake     ( std::shared_ptr<Intake>            Intk ) { intake      = Intk; }
+    void set_compressor ( std::shared_ptr<Compressor>        Comp ) { compressor  = Comp; }
+    void set_combchamber( std::shared_ptr<CombustionChamber> Comb ) { combchamber = Comb; }
+    void set_turbine    ( std::shared_ptr<Turbine>           Turb ) { turbine     = Turb; }
+    void set_turbine_f  ( std::shared_ptr<Turbine_f>         Trbf ) { turbine_f   = Trbf; }
+
+    void set_Mach    ( double Ma  ) { Mach     = Ma;  }
+    void set_n_wc    ( double n   ) { n_wc     = n;   }   ///< [rad/s]
+    void set_throttle( double thr ) { throttle = thr; }
+
+    double get_Mach()     const { return Mach;     }
+    double get_n_wc()     const { return n_wc;     }
+    double get_throttle() const { return throttle; }
+
+    struct Temp     { double TH  , T1s , T2s , T3s , T4s , T5s;  };
+    struct Press    { double ph  , p1s , p2s , p3s , p4s , p5s;  };
+    struct MassFlow { double mh  , m1  , m2  , m3  , m4  , m5;   };
+    struct Speed    { double ch  , c1  , c2  , c3  , c4  , c5;   };
+
+    Temp     const & get_temp()  const { return temp;  }
+    Press    const & get_press() const { return press; }
+    MassFlow const & get_mS()    const { return mS;    }
+    Speed    const & get_speed() const { return speed; }
+    double           get_Pt()    const { return P_turbine; }   ///< [W] - moc turbiny
+    double           get_P_free() const { return P_free; }     ///< [W] - moc na wale turbiny swobodnej
+
+    /// Migawka calego stanu: wejscia , przekroje , stan elementow ( opoznienie
+    /// komory , kursory tablic ) i opcjonalnie atmosfera. Bez alokacji , gdy
+    /// bufor juz raz pomiescil stan. Odtworzyc mozna w dowolnym silniku
+    /// zbudowanym na tym samym decku - np. wiele kontynuacji jednego rozbiegu
+    /// liczonych rownolegle. false - brak elementow , inny deck albo migawka
+    /// innego formatu; przy bledzie stan silnika nie jest zmieniany.
+    bool save( Snapshot &s , Atmosphere *atm = 0 );
+    bool restore( Snapshot const &s , Atmosphere *atm = 0 );
+
+    template <class Archive> void serialize( Archive &ar )
+    {
+        ar & Mach & n_wc & throttle & temp & press & mS & speed & P_turbine & P_free;
+        intake->serialize( ar );
+        compressor->serialize( ar );
+        combchamber->serialize( ar );
+        turbine->serialize( ar );
+        turbine_f->serialize( ar );
+    }
 
 private:
     std::shared_ptr<EngineData> dat;
 
+    std::shared_ptr<Intake>            intake;
+    std::shared_ptr<Compressor>        compressor;
+    std::shared_ptr<CombustionChamber> combchamber;
+    std::shared_ptr<Turbine>           turbine;
+    std::shared_ptr<Turbine_f>         turbine_f;
+
+    double Mach;
+    double n_wc;
+    double throttle;
+
+    Temp temp;
+    Press press;
+    MassFlow mS;
+    Speed speed;
+    double P_turbine;
+    double P_free;
+
 };
 
 typedef std::weak_ptr<Engine> Eptr;
@@ -220,6 +338,7 @@ class TurboShaftEngine : public EngineBuilder
 {
 public:
     TurboShaftEngine();
+    TurboShaftEngine( std::shared_ptr<EngineData> Dat );
     ~TurboShaftEngine() ;
     virtual void BuildIntake( );             // TH - T1
     virtual void BuildCompressor();          // T1 - T2
@@ -242,16 +361,6 @@ private:
     std::shared_ptr<Turbine>           turbine;
     std::shared_ptr<Turbine_f>         turbine_f;
 
-    struct Temp     { double TH  , T1s , T2s , T3s , T4s , T5s;  };
-    struct Press    { double ph  , p1s , p2s , p3s , p4s , p5s;  };
-    struct MassFlow { double mh  , m1  , m2  , m3  , m4  , m5;   };
-    struct Speed    { double ch  , c1  , c2  , c3  , c4  , c5;   };
-
-    Temp temp;
-    Press press;
-    MassFlow mS;
-    Speed speed;
-
 };
 
 
@@ -0,0 +1,322 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "EngineDeck.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace EngineDeck
+{
+
+namespace
+{
+
+static const char     Magic[8] = { 'D','M','E','D','E','C','K',0 };
+static const uint32_t Endian   = 0x01020304u;
+
+static_assert( sizeof( FileHeader ) == CacheLine , "FileHeader - jedna linia cache" );
+
+bool fail( const char *path , const char *why )
+{
+    cerr << "EngineDeck: " << path << " - " << why << endl;
+    return false;
+}
+
+/// Sprawdzenie naglowka pliku i zgodnosci bloku z DeckHeader
+bool check( FileHeader const &fh , void const *block , uint64_t avail , const char *path )
+{
+    if( memcmp( fh.magic , Magic , sizeof( Magic ) ) ) return fail( path , "not an engine deck" );
+    if( fh.endian != Endian )                          return fail( path , "byte order mismatch" );
+    if( fh.version != Version )                        return fail( path , "unsupported version" );
+    if( fh.bytes > avail || fh.bytes < sizeof( DeckHeader ) ) return fail( path , "truncated" );
+
+    DeckHeader const *h = static_cast<DeckHeader const*>( block );
+    if( uint64_t( h->bytes ) != fh.bytes || !h->sealed ) return fail( path , "corrupt header" );
+    if( h->sk < 2 || h->ck < 2 || h->tk < 2 )            return fail( path , "corrupt header" );
+
+    int64_t n[DeckHeader::Tables];
+    n[DeckHeader::RPM]   = n[DeckHeader::SPREZ] = n[DeckHeader::ETA] = n[DeckHeader::MZR] = h->sk;
+    n[DeckHeader::Q_THR] = n[DeckHeader::Q_TAB] = h->ck;
+    n[DeckHeader::RPM_T] = n[DeckHeader::EPST]  = n[DeckHeader::MTWC] = h->tk;
+    n[DeckHeader::INV_RPM]   = h->sk;
+    n[DeckHeader::INV_Q_THR] = h->ck;
+    n[DeckHeader::INV_RPM_T] = h->tk;
+
+    for( int t = 0 ; t < DeckHeader::Tables ; t++ )
+    {
+        int64_t off = h->offset[t];
+        if( off < int64_t( sizeof( DeckHeader ) ) || off % CacheLine ||
+            off + n[t] * int64_t( sizeof( double ) ) > h->bytes )
+            return fail( path , "corrupt table offsets" );
+    }
+    return true;
+}
+
+/// Zwolnienie EngineData razem z mapowaniem pliku
+struct Release
+{
+    void  *base;
+    size_t len;
+
+    void operator()( EngineData *dat ) const
+    {
+        delete dat;
+#if defined( _WIN32 )
+        aligned_free( base );
+#else
+        munmap( base , len );
+#endif
+    }
+};
+
+/// Wiersz bez komentarza , separatory CSV zamienione na spacje
+std::string clean( std::string line )
+{
+    size_t c = line.find( '#' );
+    if( c != std::string::npos ) line.erase( c );
+    for( size_t i = 0 ; i < line.size() ; i++ )
+        if( line[i] == ',' || line[i] == ';' || line[i] == '\t' || line[i] == '\r' ) line[i] = ' ';
+    return line;
+}
+
+bool increasing( std::vector<double> const &x )
+{
+    for( size_t i = 1 ; i < x.size() ; i++ ) if( !( x[i] > x[i-1] ) ) return false;
+    return true;
+}
+
+}
+
+uint64_t checksum( void const *block , size_t bytes )
+{
+    uint64_t const *w = static_cast<uint64_t const*>( block );
+    uint64_t sum = 14695981039346656037ull;
+
+    for( size_t i = 0 ; i < bytes / sizeof( uint64_t ) ; i++ )
+    {
+        sum ^= w[i];
+        sum *= 1099511628211ull;
+    }
+    return sum;
+}
+
+bool write( EngineData const &dat , const char *path , const char *name )
+{
+    if( !dat.is_sealed() ) return fail( path , "deck not sealed" );
+
+    FileHeader fh;
+    memset( &fh , 0 , sizeof( fh ) );
+    memcpy( fh.magic , Magic , sizeof( Magic ) );
+    fh.version  = Version;
+    fh.endian   = Endian;
+    fh.bytes    = dat.arena_bytes();
+    fh.checksum = checksum( dat.header() , fh.bytes );
+    if( name ) strncpy( fh.name , name , sizeof( fh.name ) - 1 );
+
+    std::ofstream out( path , std::ios::binary );
+    if( !out ) return fail( path , "cannot create" );
+
+    out.write( reinterpret_cast<const char*>( &fh ) , sizeof( fh ) );
+    out.write( reinterpret_cast<const char*>( dat.header() ) , std::streamsize( fh.bytes ) );
+
+    return out.good() ? true : fail( path , "write error" );
+}
+
+std::shared_ptr<EngineData> open( const char *path , bool Verify )
+{
+    std::shared_ptr<EngineData> none;
+    void  *base = 0;
+    size_t len  = 0;
+
+#if defined( _WIN32 )
+    /// bez mmap - jedno czytanie do bloku wyrownanego
+    std::ifstream in( path , std::ios::binary | std::ios::ate );
+    if( !in ) { fail( path , "cannot open" ); return none; }
+    len = size_t( in.tellg() );
+    if( len < sizeof( FileHeader ) + sizeof( DeckHeader ) ) { fail( path , "truncated" ); return none; }
+    base = aligned_malloc( len , CacheLine );
+    in.seekg( 0 );
+    in.read( static_cast<char*>( base ) , std::streamsize( len ) );
+    if( !in ) { aligned_free( base ); fail( path , "read error" ); return none; }
+#else
+    int fd = ::open( path , O_RDONLY );
+    if( fd < 0 ) { fail( path , "cannot open" ); return none; }
+
+    struct stat st;
+    if( fstat( fd , &st ) || size_t( st.st_size ) < sizeof( FileHeader ) + sizeof( DeckHeader ) )
+    {
+        ::close( fd );
+        fail( path , "truncated" );
+        return none;
+    }
+
+    len  = size_t( st.st_size );
+    base = mmap( 0 , len , PROT_READ , MAP_PRIVATE , fd , 0 );
+    ::close( fd );
+    if( base == MAP_FAILED ) { fail( path , "mmap failed" ); return none; }
+#endif
+
+    Release release = { base , len };
+    FileHeader const &fh = *static_cast<FileHeader const*>( base );
+    void *block = static_cast<char*>( base ) + sizeof( FileHeader );
+
+    bool ok = check( fh , block , len - sizeof( FileHeader ) , path );
+    if( ok && Verify && checksum( block , size_t( fh.bytes ) ) != fh.checksum )
+        ok = fail( path , "checksum mismatch" );
+
+    if( !ok )
+    {
+        release( 0 );
+        return none;
+    }
+
+    EngineData *dat = new EngineData( 0 );
+    dat->bind( block , false );
+    return std::shared_ptr<EngineData>( dat , release );
+}
+
+std::shared_ptr<EngineData> read_text( const char *path )
+{
+    std::shared_ptr<EngineData> none;
+
+    std::ifstream in( path );
+    if( !in ) { fail( path , "cannot open" ); return none; }
+
+    enum Section { Scalars , Compressor , Chamber , Turbine } sec = Scalars;
+    static const int cols[] = { 0 , 4 , 2 , 3 };
+
+    std::vector<double> comp[4] , comb[2] , trb[3];
+    std::vector<double> *tab[] = { 0 , comp , comb , trb };
+
+    double scal[9] = { 0 };
+    static const char * const names[9] = { "eta_ks" , "Cp" , "W_opal" ,
+                                            "A_compressor" , "D_compressor" , "Dw_compressor" ,
+                                            "D_turbine" , "Dw_turbine" , "A_turbine" };
+
+    std::string line;
+    int row = 0;
+    while( std::getline( in , line ) )
+    {
+        row++;
+        line = clean( line );
+
+        std::istringstream ss( line );
+        std::string word;
+        if( !( ss >> word ) ) continue;
+
+        if( word[0] == '[' )
+        {
+            if(      word == "[compressor]" ) sec = Compressor;
+            else if( word == "[chamber]" )    sec = Chamber;
+            else if( word == "[turbine]" )    sec = Turbine;
+            else { fail( path , ( "unknown section " + word ).c_str() ); return none; }
+            continue;
+        }
+
+        char *end = 0;
+        double v = strtod( word.c_str() , &end );
+
+        if( *end )
+        {
+            /// nazwa wartosc
+            int k = 0;
+            while( k < 9 && word != names[k] ) k++;
+            if( k == 9 || !( ss >> scal[k] ) )
+            {
+                fail( path , ( "bad entry at line " + std::to_string( row ) ).c_str() );
+                return none;
+            }
+            continue;
+        }
+
+        if( sec == Scalars ) { fail( path , ( "data outside section at line " + std::to_string( row ) ).c_str() ); return none; }
+
+        std::vector<double> vals( 1 , v );
+        while( ss >> v ) vals.push_back( v );
+
+        if( int( vals.size() ) != cols[sec] || !ss.eof() )
+        {
+            fail( path , ( "wrong column count at line " + std::to_string( row ) ).c_str() );
+            return none;
+        }
+        for( int c = 0 ; c < cols[sec] ; c++ ) tab[sec][c].push_back( vals[c] );
+    }
+
+    int sk = int( comp[0].size() ) , ck = int( comb[0].size() ) , tk = int( trb[0].size() );
+    if( sk < 2 || ck < 2 || tk < 2 ) { fail( path , "each table needs at least 2 rows" ); return none; }
+    if( !increasing( comp[0] ) || !increasing( comb[0] ) || !increasing( trb[0] ) )
+    {
+        fail( path , "table arguments must be increasing" );
+        return none;
+    }
+
+    std::shared_ptr<EngineData> dat = std::make_shared<EngineData>( 0 );
+    dat->allocate( sk , ck , tk );
+
+    EngineData::Builder b( *dat );
+    for( int i = 0 ; i < sk ; i++ )
+    {
+        b.rpm_tab[i]   = comp[0][i];
+        b.sprez_tab[i] = comp[1][i];
+        b.eta_tab[i]   = comp[2][i];
+        b.mZR_tab[i]   = comp[3][i];
+    }
+    for( int i = 0 ; i < ck ; i++ )
+    {
+        b.q_pal_thr[i] = comb[0][i];
+        b.q_pal_tab[i] = comb[1][i];
+    }
+    for( int i = 0 ; i < tk ; i++ )
+    {
+        b.rpm_tab_t[i]    = trb[0][i];
+        b.epsT_roz_tab[i] = trb[1][i];
+        b.mTwc_zr_tab[i]  = trb[2][i];
+    }
+
+    b.eta_ks = scal[0];
+    b.Cp     = scal[1];
+    b.W_opal = scal[2];
+
+    b.A_compressor  = scal[3];
+    b.D_compressor  = scal[4];
+    b.Dw_compressor = scal[5];
+    b.D_turbine     = scal[6];
+    b.Dw_turbine    = scal[7];
+    b.A_turbine     = scal[8];
+
+    dat->seal();
+    return dat;
+}
+
+}
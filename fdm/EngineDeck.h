@@ -0,0 +1,77 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef ENGINEDECK_H
+#define ENGINEDECK_H
+
+#include <enginedata.h>
+#include <memory>
+#include <stdint.h>
+
+/// Binarny deck silnika - plik mapowany do pamieci i uzywany w miejscu.
+///
+/// Plik = FileHeader ( jedna linia cache ) + blok EngineData w postaci
+/// zapieczetowanej ( DeckHeader + tablice , przesuniecia wzgledem poczatku
+/// bloku ). open() mapuje plik tylko do odczytu i wiaze wskazniki
+/// EngineData z mapowaniem - bez parsowania i bez kopiowania; strony
+/// wczytywane sa przy pierwszym dostepie. Mapowanie zwalniane jest razem
+/// z ostatnim shared_ptr do EngineData.
+///
+/// Tekstowy deck ( read_text ) - sekcje [compressor] , [chamber] , [turbine]
+/// z wierszami liczb oraz pary "nazwa wartosc" dla wielkosci skalarnych;
+/// separatorem moze byc spacja , tabulator , przecinek albo srednik
+/// ( CSV ). Komentarz od '#' do konca wiersza:
+///
+///     Cp 1172.30
+///     A_turbine 0.05
+///     [compressor]        # rpm , sprez , eta , mZR
+///     10000 , 1.2 , 0.60 , 0.30
+///     [chamber]           # throttle , q_pal
+///     [turbine]           # rpm , epsT_roz , mTwc_zr
+namespace EngineDeck
+{
+    static const uint32_t Version = 1;
+
+    struct FileHeader
+    {
+        char     magic[8];          ///< "DMEDECK"
+        uint32_t version;
+        uint32_t endian;            ///< 0x01020304 w porzadku bajtow zapisu
+        uint64_t bytes;             ///< rozmiar bloku ( DeckHeader::bytes )
+        uint64_t checksum;          ///< suma bloku - checksum()
+        char     name[32];          ///< nazwa wariantu ( opcjonalnie )
+    };
+
+    /// Zapis zapieczetowanego decku; false - blad zapisu albo deck nie zapieczetowany
+    bool write( EngineData const &dat , const char *path , const char *name = 0 );
+
+    /// Mapowanie pliku; Verify - sprawdzenie sumy ( czyta caly blok ). 0 - blad
+    std::shared_ptr<EngineData> open( const char *path , bool Verify = true );
+
+    /// Deck tekstowy / CSV -> EngineData ( zapieczetowany ). 0 - blad
+    std::shared_ptr<EngineData> read_text( const char *path );
+
+    /// Suma kontrolna bloku ( FNV-1a po slowach 64-bit )
+    uint64_t checksum( void const *block , size_t bytes );
+}
+
+#endif // ENGINEDECK_H
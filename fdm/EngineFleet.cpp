@@ -0,0 +1,275 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "EngineFleet.h"
+#include <Station.h>
+#include <StationKernels.h>
+#include <assert.h>
+#include <string.h>
+
+using namespace EngineConst;
+
+namespace
+{
+
+/// Charakterystyki w typie obliczen T , kolejnosc jak DeckHeader::Table :
+/// rpm , sprez , eta , mZR , q_thr , q_tab , rpm_t , epsT , mTwc.
+/// double - kolumny decku , float - kopia w store.
+template <class T> struct Columns;
+
+template <> struct Columns<double>
+{
+    double const *col[9];
+
+    Columns( EngineData const &d , std::vector<double> & )
+    {
+        double const * const c[9] = { d.rpm_tab , d.sprez_tab , d.eta_tab , d.mZR_tab ,
+                                       d.q_pal_thr , d.q_pal_tab ,
+                                       d.rpm_tab_t , d.epsT_roz_tab , d.mTwc_zr_tab };
+        for( int k = 0 ; k < 9 ; k++ ) col[k] = c[k];
+    }
+};
+
+template <> struct Columns<float>
+{
+    float const *col[9];
+
+    Columns( EngineData const &d , std::vector<float> &store )
+    {
+        double const * const c[9] = { d.rpm_tab , d.sprez_tab , d.eta_tab , d.mZR_tab ,
+                                       d.q_pal_thr , d.q_pal_tab ,
+                                       d.rpm_tab_t , d.epsT_roz_tab , d.mTwc_zr_tab };
+        int const len[9] = { d.sk , d.sk , d.sk , d.sk , d.ck , d.ck , d.tk , d.tk , d.tk };
+
+        store.resize( 4 * d.sk + 2 * d.ck + 3 * d.tk );
+        float *p = store.empty() ? 0 : &store[0];
+        for( int k = 0 ; k < 9 ; k++ )
+        {
+            for( int i = 0 ; i < len[k] ; i++ ) p[i] = float( c[k][i] );
+            col[k] = p;
+            p += len[k];
+        }
+    }
+};
+
+template <class T> StationKernels::BasicTable<T> const &kernels( StationKernels::Isa isa );
+
+template <> StationKernels::Table const &kernels<double>( StationKernels::Isa isa ) { return StationKernels::table( isa ); }
+template <> StationKernels::TableF const &kernels<float>( StationKernels::Isa isa ) { return StationKernels::table_f( isa ); }
+
+}
+
+template <class T>
+BasicEngineFleet<T>::BasicEngineFleet( std::weak_ptr<EngineData> Dat , int N ) : lag( tau_ks )
+{
+    dat = Dat.lock();
+
+    n      = 0;
+    cap    = 0;
+    stride = 0;
+    ncols  = 0;
+    block  = 0;
+    kern   = &kernels<T>( StationKernels::active() );
+
+    sigma_H1 = Station::sigma_H1;
+    sig_34   = Station::sig_34;
+    eta_Twc  = Station::eta_Twc;
+
+    allocate( N );
+    bind_tables();
+}
+
+template <class T>
+BasicEngineFleet<T>::~BasicEngineFleet()
+{
+    aligned_free( block );
+    dat.reset();
+}
+
+template <class T>
+void BasicEngineFleet<T>::resize( int N )
+{
+    allocate( N );
+    bind_tables();
+}
+
+template <class T>
+void BasicEngineFleet<T>::set_active( int N )
+{
+    assert( N >= 0 && N <= cap );
+    n = N;
+}
+
+template <class T>
+void BasicEngineFleet<T>::allocate( int N )
+{
+    assert( N >= 0 );
+
+    T ** const cols[] =
+    {
+        &in.Mach ,  &in.n_wc ,  &in.throttle , &in.H_alt ,
+        &temp.TH ,  &temp.T1s , &temp.T2s , &temp.T3s , &temp.T4s , &temp.T5s ,
+        &press.ph , &press.p1s, &press.p2s, &press.p3s, &press.p4s, &press.p5s,
+        &mS.mh ,    &mS.m1 ,    &mS.m2 ,    &mS.m3 ,    &mS.m4 ,    &mS.m5 ,
+        &speed.ch , &speed.c1 , &speed.c2 , &speed.c3 , &speed.c4 , &speed.c5 ,
+        &comp.n_zrS , &comp.sprezS_s , &comp.eta_S , &comp.mS_zr ,
+        &comb.q_pal , &comb.T_ch , &comb.primed ,
+        &trb.n_zrT_wc , &trb.epsT_roz , &trb.P_turbine ,
+        &trbf.p6_s , &trbf.T6_s , &trbf.wpt
+    };
+    aligned_free( block );
+
+    ncols  = sizeof( cols ) / sizeof( cols[0] );
+    n      = N;
+    cap    = N;
+    stride = round_up( N > 0 ? N : 1 , CacheLine / sizeof( T ) );
+    block  = static_cast<T*>( aligned_malloc( sizeof( T ) * stride * ncols ) );
+    assert( block );
+
+    for( int c = 0 ; c < ncols ; c++ )
+        *cols[c] = block + c * stride;
+
+    init_fleet();
+}
+
+template <class T>
+void BasicEngineFleet<T>::init_fleet()
+{
+    memset( block , 0 , sizeof( T ) * stride * ncols );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update( Atmosphere *atm , double dt )
+{
+    T const T_H = T( atm->get_T() );
+    T const p_H = T( atm->get_p() );
+
+    for( int i = 0 ; i < n ; i++ )
+    {
+        temp.TH[i]  = T_H;
+        press.ph[i] = p_H;
+    }
+
+    step( dt );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_alt( Atmosphere *atm , double dt )
+{
+    atm->update( in.H_alt , n , temp.TH , press.ph , 0 , 0 );
+
+    step( dt );
+}
+
+template <class T>
+void BasicEngineFleet<T>::bind_tables()
+{
+    Columns<T> c( *dat , tabs );
+
+    T const * const comp_cols[3] = { c.col[1] , c.col[2] , c.col[3] };
+    T const * const trb_cols[1]  = { c.col[7] };
+    T const * const fuel_cols[1] = { c.col[5] };
+
+    StationKernels::make_map( dat->sk , c.col[0] , comp_cols , 3 , comp_store , comp_map );
+    StationKernels::make_map( dat->tk , c.col[6] , trb_cols , 1 , trb_store , trb_map );
+    StationKernels::make_map( dat->ck , c.col[4] , fuel_cols , 1 , fuel_store , fuel_map );
+}
+
+template <class T>
+void BasicEngineFleet<T>::step( double dt )
+{
+    /// kilka silnikow - wektor z maska kosztuje wiecej niz petla skalarna
+    kern = &kernels<T>( n < SmallN ? StationKernels::Scalar : StationKernels::active() );
+
+    update_intake();
+    update_compressor();
+    update_comchamber( dt );
+    update_turbine();
+    update_turbine_f();
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_intake()
+{
+    kern->intake( n , temp.TH , press.ph , in.Mach , sigma_H1 ,
+                  temp.T1s , press.p1s , speed.c1 );
+
+    memcpy( temp.T2s , temp.T1s , sizeof( T ) * n );
+    memcpy( press.p2s, press.p1s, sizeof( T ) * n );
+    memcpy( speed.c2 , speed.c1 , sizeof( T ) * n );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_compressor()
+{
+    T * const val[3] = { comp.sprezS_s , comp.eta_S , comp.mS_zr };
+    kern->map( n , in.n_wc , temp.T2s , T( rads2rpm ) , comp.n_zrS , comp_map , val );
+
+    kern->compressor( n , temp.T2s , press.p2s , comp.sprezS_s , comp.eta_S , comp.mS_zr ,
+                      temp.T3s , press.p3s , mS.m3 );
+
+    memcpy( mS.m1 , mS.m3 , sizeof( T ) * n );
+    memcpy( mS.m2 , mS.m3 , sizeof( T ) * n );
+    memcpy( speed.c3 , speed.c2 , sizeof( T ) * n );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_comchamber( double dt )
+{
+    T const q_k = T( dat->eta_ks * dat->W_opal / dat->Cp );
+    T const k_T = T( lag( dt ) );
+
+    T * const q = comb.q_pal;
+    kern->map( n , in.throttle , 0 , T( 1 ) , 0 , fuel_map , &q );
+
+    /// silnik jeszcze nie liczony ( comb.primed == 0 ) startuje z T4 bez opoznienia
+    kern->chamber( n , press.p3s , temp.T3s , mS.m3 , speed.c3 , comb.q_pal ,
+                   q_k , sig_34 , k_T , comb.primed , comb.T_ch ,
+                   press.p4s , temp.T4s , mS.m4 , speed.c4 );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_turbine()
+{
+    T * const eps = trb.epsT_roz;
+    kern->map( n , in.n_wc , temp.T4s , T( rads2rpm ) , trb.n_zrT_wc , trb_map , &eps );
+
+    /// cisnienie p5 liczone z temperatury T5 poprzedniego kroku - jak w Turbine
+    kern->turbine( n , press.p4s , temp.T4s , mS.m4 , trb.epsT_roz , eta_Twc ,
+                   T( dat->A_turbine ) , T( dat->Cp ) ,
+                   press.p5s , temp.T5s , speed.c5 , trb.P_turbine );
+
+    memcpy( mS.m5 , mS.m4 , sizeof( T ) * n );
+}
+
+template <class T>
+void BasicEngineFleet<T>::update_turbine_f()
+{
+    for( int i = 0 ; i < n ; i++ )
+        trbf.p6_s[i] = K::p0;
+
+    kern->turbine_f( n , press.p5s , temp.T5s , T( dat->Cp ) , trbf.T6_s , trbf.wpt );
+}
+
+template class BasicEngineFleet<double>;
+template class BasicEngineFleet<float>;
@@ -0,0 +1,290 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Executive.h"
+#include <fstream>
+#include <math.h>
+
+#if defined( __linux__ )
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <string.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+using namespace std;
+
+namespace
+{
+
+/// [ns] - zegar monotoniczny
+inline long long now_ns()
+{
+#if defined( __linux__ )
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC , &ts );
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+/// Uspienie do bezwzglednej chwili t [ns]
+inline void sleep_until_ns( long long t )
+{
+#if defined( __linux__ )
+    timespec ts;
+    ts.tv_sec  = t / 1000000000LL;
+    ts.tv_nsec = t % 1000000000LL;
+    while( clock_nanosleep( CLOCK_MONOTONIC , TIMER_ABSTIME , &ts , 0 ) == EINTR ) {}
+#else
+    this_thread::sleep_until( chrono::steady_clock::time_point( chrono::nanoseconds( t ) ) );
+#endif
+}
+
+}
+
+Histogram::Histogram( double Bin_ns , int Bins )
+{
+    bin_ns = Bin_ns;
+    bins.assign( Bins + 1 , 0 );
+    reset();
+}
+
+void Histogram::reset()
+{
+    for( size_t i = 0 ; i < bins.size() ; i++ ) bins[i] = 0;
+    n = 0;
+    sum = 0.0;
+    v_min = 0.0;
+    v_max = 0.0;
+}
+
+void Histogram::add( double ns )
+{
+    if( ns < 0.0 ) ns = 0.0;
+
+    int i = int( ns / bin_ns );
+    int last = int( bins.size() ) - 1;
+    bins[ i < last ? i : last ]++;
+
+    if( !n || ns < v_min ) v_min = ns;
+    if( !n || ns > v_max ) v_max = ns;
+    sum += ns;
+    n++;
+}
+
+double Histogram::percentile( double p ) const
+{
+    if( !n ) return 0.0;
+
+    long target = long( ceil( p / 100.0 * n ) );
+    if( target < 1 ) target = 1;
+
+    long acc = 0;
+    for( size_t i = 0 ; i < bins.size() ; i++ )
+    {
+        acc += bins[i];
+        if( acc >= target )
+            return ( i + 1 == bins.size() ) ? v_max : ( i + 1 ) * bin_ns;
+    }
+    return v_max;
+}
+
+void Histogram::write( std::ostream &out , const char *name ) const
+{
+    out << "# " << name << " [ns]: n=" << n
+        << " min=" << min() << " mean=" << mean()
+        << " p50=" << percentile( 50.0 ) << " p99=" << percentile( 99.0 )
+        << " p99.9=" << percentile( 99.9 ) << " max=" << max() << "\n";
+
+    for( size_t i = 0 ; i < bins.size() ; i++ )
+    {
+        if( !bins[i] ) continue;
+        out << name << " " << i * bin_ns << " " << bins[i] << "\n";
+    }
+}
+
+Executive::Executive()
+    : jitter( 1000.0 , 2000 ) , exec( 1000.0 , 2000 ) , frame( 1000.0 , 4000 )
+{
+    period_ns     = 1.0e6;
+    period0_ns    = period_ns;
+    cpu           = -1;
+    fifo          = false;
+    priority      = 80;
+    lock_memory   = false;
+    policy        = Skip;
+    max_catchup   = 10;
+    degrade_after = 5;
+
+    stop_req   = false;
+    frames_run = 0;
+    overruns   = 0;
+    skipped    = 0;
+    degrades   = 0;
+}
+
+void Executive::set_rate( double Hz )
+{
+    period_ns  = 1.0e9 / Hz;
+    period0_ns = period_ns;
+}
+
+void Executive::setup_thread()
+{
+#if defined( __linux__ )
+    if( lock_memory && mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 )
+        cout << "Executive: mlockall failed - " << strerror( errno ) << endl;
+
+    if( cpu >= 0 )
+    {
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        CPU_SET( cpu , &set );
+        int err = pthread_setaffinity_np( pthread_self() , sizeof( set ) , &set );
+        if( err ) cout << "Executive: CPU " << cpu << " pinning failed - " << strerror( err ) << endl;
+    }
+
+    if( fifo )
+    {
+        sched_param sp;
+        sp.sched_priority = priority;
+        int err = pthread_setschedparam( pthread_self() , SCHED_FIFO , &sp );
+        if( err ) cout << "Executive: SCHED_FIFO failed - " << strerror( err ) << endl;
+    }
+#else
+    if( lock_memory || cpu >= 0 || fifo )
+        cout << "Executive: real-time options not supported on this platform" << endl;
+#endif
+}
+
+void Executive::run( std::function<void( double )> const &step , long frames )
+{
+    setup_thread();
+
+    period_ns  = period0_ns;
+    frames_run = 0;
+    overruns   = 0;
+    skipped    = 0;
+    degrades   = 0;
+    jitter.reset();
+    exec.reset();
+    frame.reset();
+
+    long long deadline   = now_ns() + (long long)period_ns;
+    long long last_start = 0;
+    double    dt         = period_ns * 1.0e-9;
+    int       in_row     = 0;
+
+    while( !stop_req && ( frames < 0 || frames_run < frames ) )
+    {
+        sleep_until_ns( deadline );
+
+        long long start = now_ns();
+        jitter.add( double( start - deadline ) );
+        if( last_start ) frame.add( double( start - last_start ) );
+        last_start = start;
+
+        step( dt );
+        frames_run++;
+
+        long long end = now_ns();
+        exec.add( double( end - start ) );
+
+        deadline += (long long)period_ns;
+        dt = period_ns * 1.0e-9;
+
+        if( end <= deadline )
+        {
+            in_row = 0;
+            continue;
+        }
+
+        /// przekroczenie - liczba calych okresow, ktore juz minely
+        long missed = long( ( end - deadline ) / (long long)period_ns ) + 1;
+        overruns++;
+        in_row++;
+
+        switch( policy )
+        {
+        case Skip:
+            skipped  += missed;
+            deadline += missed * (long long)period_ns;
+            break;
+
+        case CatchUp:
+        {
+            long n = missed < max_catchup ? missed : max_catchup;
+            for( long k = 0 ; k < n && !stop_req && ( frames < 0 || frames_run < frames ) ; k++ )
+            {
+                long long t = now_ns();
+                step( dt );
+                frames_run++;
+                exec.add( double( now_ns() - t ) );
+            }
+            skipped  += missed - n;
+            deadline += missed * (long long)period_ns;
+            break;
+        }
+
+        case Degrade:
+            dt       += missed * period_ns * 1.0e-9;
+            deadline += missed * (long long)period_ns;
+            if( in_row >= degrade_after )
+            {
+                period_ns *= 2.0;
+                in_row = 0;
+                degrades++;
+            }
+            break;
+        }
+    }
+
+    /// zadanie zatrzymania obsluzone - nastepny run() startuje normalnie
+    stop_req = false;
+}
+
+void Executive::write_report( std::ostream &out ) const
+{
+    out << "# Executive: rate=" << get_rate() << " Hz frames=" << frames_run
+        << " overruns=" << overruns << " skipped=" << skipped << " degraded=" << degrades << "\n";
+
+    jitter.write( out , "jitter" );
+    exec.write( out , "exec" );
+    frame.write( out , "frame" );
+}
+
+bool Executive::export_report( const char *path ) const
+{
+    std::ofstream out( path );
+    if( !out ) return false;
+    write_report( out );
+    return bool( out );
+}
@@ -0,0 +1,135 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef EXECUTIVE_H
+#define EXECUTIVE_H
+
+#include <functional>
+#include <atomic>
+#include <vector>
+#include <iostream>
+
+/// Histogram czasow [ns] o stalej szerokosci przedzialu, z przepelnieniem.
+/// Dodawanie bez alokacji - mozna uzywac w petli czasu rzeczywistego.
+class Histogram
+{
+public:
+    Histogram( double Bin_ns = 1000.0 , int Bins = 2000 );
+
+    void reset();
+    void add( double ns );
+
+    long   count() const { return n; }
+    double min()   const { return n ? v_min : 0.0; }
+    double max()   const { return n ? v_max : 0.0; }
+    double mean()  const { return n ? sum / n : 0.0; }
+    double percentile( double p ) const;       ///< p w [ 0 , 100 ] - dokladnosc do przedzialu
+
+    void write( std::ostream &out , const char *name ) const;
+
+private:
+    double bin_ns;
+    std::vector<long> bins;     ///< ostatni przedzial - przepelnienie
+    long   n;
+    double sum;
+    double v_min , v_max;
+};
+
+/// Wykonawca czasu rzeczywistego ze stalym krokiem.
+///
+/// Ramki startuja w chwilach t0 + k * T ( bezwzgledne terminy, bez narastania
+/// bledu ). Po kazdej ramce mierzone jest opoznienie wybudzenia ( jitter )
+/// i czas wykonania kroku. Jesli krok skonczy sie po terminie nastepnej ramki
+/// ( przekroczenie ), dalsze postepowanie wybiera Overrun:
+///   Skip    - pominiete ramki przepadaja, nastepna ramka w najblizszym terminie,
+///   CatchUp - pominiete ramki liczone od razu jedna po drugiej ( max. max_catchup ),
+///   Degrade - pominiety czas doliczany do dt nastepnego kroku, a po degrade_after
+///             kolejnych przekroczeniach okres ramki jest podwajany ( get_degrades() ).
+/// Ramki nadrabiane ( CatchUp ) wchodza do histogramu czasu kroku.
+/// W petli ramek nic nie jest wypisywane - liczniki podaje write_report().
+/// Przypiecie do procesora, SCHED_FIFO i mlockall sa opcjonalne - gdy system
+/// nie pozwala ( brak uprawnien ), wykonawca wypisuje ostrzezenie i dziala dalej.
+class Executive
+{
+public:
+    enum Overrun
+    {
+        Skip = 0,
+        CatchUp,
+        Degrade
+    };
+
+    Executive();
+
+    void set_rate( double Hz );                         ///< [Hz]
+    void set_cpu( int Cpu )               { cpu = Cpu; }          ///< -1 - bez przypiecia
+    void set_fifo( bool Fifo , int Prio = 80 ) { fifo = Fifo; priority = Prio; }
+    void set_lock_memory( bool Lock )     { lock_memory = Lock; }
+    void set_policy( Overrun Policy )     { policy = Policy; }
+    void set_max_catchup( int N )         { max_catchup = N; }
+    void set_degrade_after( int N )       { degrade_after = N; }
+
+    /// Petla ramek: step( dt ) co okres; frames < 0 - do wywolania stop()
+    void run( std::function<void( double )> const &step , long frames = -1 );
+
+    /// Z dowolnego watku; stop() przed run() konczy najblizszy run() bez ramek
+    void stop() { stop_req = true; }
+
+    double get_rate()    const { return 1.0e9 / period_ns; }   ///< [Hz] - aktualna ( po degradacji )
+    long   get_frames()  const { return frames_run; }
+    long   get_overruns()const { return overruns; }
+    long   get_skipped() const { return skipped; }
+    long   get_degrades()const { return degrades; }                 ///< liczba podwojen okresu
+
+    Histogram const & get_jitter()  const { return jitter; }    ///< opoznienie wybudzenia
+    Histogram const & get_exec()    const { return exec; }      ///< czas kroku
+    Histogram const & get_frame()   const { return frame; }     ///< odstep miedzy startami ramek
+
+    void write_report( std::ostream &out ) const;
+    bool export_report( const char *path ) const;
+
+private:
+    void setup_thread();
+
+    double period_ns;
+    double period0_ns;
+    int    cpu;
+    bool   fifo;
+    int    priority;
+    bool   lock_memory;
+    Overrun policy;
+    int    max_catchup;
+    int    degrade_after;
+
+    std::atomic<bool> stop_req;
+
+    long frames_run;
+    long overruns;
+    long skipped;
+    long degrades;
+
+    Histogram jitter;
+    Histogram exec;
+    Histogram frame;
+};
+
+#endif // EXECUTIVE_H
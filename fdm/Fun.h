@@ -24,9 +24,95 @@
 #define FUN_H
 
 #include <iostream>
+#include <cstdlib>
+#include <cstddef>
+#include <cmath>
+#include <new>
+#if defined( _WIN32 )
+#include <malloc.h>
+#endif
 
 using namespace std;
 
+static const std::size_t CacheLine = 64;     ///< [B] - rozmiar linii cache
+
+/// Alokacja bloku pamieci wyrownanego do Align bajtow ( Align - potega 2 )
+static inline void *aligned_malloc( std::size_t size , std::size_t Align = CacheLine )
+{
+    void *ptr = 0;
+#if defined( _WIN32 )
+    ptr = _aligned_malloc( size , Align );
+#else
+    if( posix_memalign( &ptr , Align , size ) ) ptr = 0;
+#endif
+    return ptr;
+}
+
+static inline void aligned_free( void *ptr )
+{
+#if defined( _WIN32 )
+    _aligned_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+/// Zaokraglenie n w gore do wielokrotnosci m
+static inline int round_up( int n , int m )
+{
+    return ( ( n + m - 1 ) / m ) * m;
+}
+
+/// Alokator std::vector na aligned_malloc - poczatek danych na granicy linii cache
+template <class T> struct AlignedAllocator
+{
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template <class U> AlignedAllocator( AlignedAllocator<U> const & ) {}
+
+    T *allocate( std::size_t n )
+    {
+        void *p = aligned_malloc( n * sizeof( T ) );
+        if( !p ) throw std::bad_alloc();
+        return static_cast<T*>( p );
+    }
+    void deallocate( T *p , std::size_t ) { aligned_free( p ); }
+};
+
+template <class T , class U> bool operator==( AlignedAllocator<T> const & , AlignedAllocator<U> const & ) { return true;  }
+template <class T , class U> bool operator!=( AlignedAllocator<T> const & , AlignedAllocator<U> const & ) { return false; }
+
+/// Wzmocnienie czlonu inercyjnego I rzedu dla kroku dt ( dyskretyzacja dokladna ):
+///     y += ( u - y ) * k ,  k = 1 - exp( -dt / tau )
+/// Odpowiedz nie zalezy od kroku - n krokow dt daje to samo co jeden krok n * dt.
+/// k liczone ponownie tylko przy zmianie dt albo tau ( zwykle raz ).
+class LagGain
+{
+public:
+    explicit LagGain( double Tau ) : tau( Tau ) , dt( -1.0 ) , k( 1.0 ) {}
+
+    void   set_tau( double Tau ) { tau = Tau; dt = -1.0; }
+    double get_tau() const { return tau; }
+
+    template <class Archive> void serialize( Archive &ar ) { ar & tau & dt & k; }
+
+    double operator()( double Dt )
+    {
+        if( Dt != dt )
+        {
+            dt = Dt;
+            k  = ( tau > 0.0 ) ? -std::expm1( -dt / tau ) : 1.0;
+        }
+        return k;
+    }
+
+private:
+    double tau;     ///< [s] - stala czasowa
+    double dt;      ///< [s] - krok , dla ktorego policzono k
+    double k;
+};
+
 template<class TYPE>
 static void erase( TYPE *ptr )
 {
@@ -50,7 +136,7 @@ template <class TYP> static TYP Interpolation( TYP x  , TYP y_val[] ,  TYP x_dat
        zs = z;
    }
 
-   return ( y_val[zs] + ( y_val[zs] - y_val[zs] ) / ( x_data[zk] - x_data[zs] ) * ( x - x_data[zs] ) );
+   return ( y_val[zs] + ( y_val[zk] - y_val[zs] ) / ( x_data[zk] - x_data[zs] ) * ( x - x_data[zs] ) );
 }
 
 
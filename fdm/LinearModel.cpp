@@ -0,0 +1,488 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "LinearModel.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <stdint.h>
+
+static_assert( sizeof( LinearModel ) == LinearModel::Words * sizeof( double ) , "LinearModel - same liczby double" );
+static_assert( LinearModel::Nx == 3 , "LPVModel::step - uklad 3x3" );
+
+namespace
+{
+
+const char *names[LinearModel::Ny] = { "T3s" , "p3s" , "T4s" , "p4s" , "T5s" , "p5s" , "T6s" , "P_turbine" , "P_free" };
+
+struct FileHeader { uint32_t magic , version , nx , nu , ny , nH , nM , nT; };
+
+uint32_t const file_magic = 0x4C454D44;     ///< "DMEL"
+uint32_t const version    = 1;
+
+/// Wezel i waga osi ( poza osia - krawedz )
+void axis( std::vector<double> const &a , double v , TableCursor<double> &cur , int &i , double &w )
+{
+    int n = int( a.size() );
+    if( n < 2 ) { i = 0; w = 0.0; return; }
+
+    i = cur.locate( v , a.data() , n );
+    w = ( v - a[i] ) / ( a[i+1] - a[i] );
+    if( w < 0.0 ) w = 0.0;
+    if( w > 1.0 ) w = 1.0;
+}
+
+}
+
+const char *LinearModel::output_name( int y )
+{
+    return y >= 0 && y < Ny ? names[y] : "?";
+}
+
+void LinearModel::outputs( Dynamics::Output const &o , double y[Ny] )
+{
+    y[Y_T3] = o.T3;
+    y[Y_p3] = o.p3;
+    y[Y_T4] = o.T4;
+    y[Y_p4] = o.p4;
+    y[Y_T5] = o.T5;
+    y[Y_p5] = o.p5;
+    y[Y_T6] = o.T6;
+    y[Y_P_turbine] = o.P_t;
+    y[Y_P_free]    = o.P_free;
+}
+
+bool LinearModel::extract( Dynamics &d , Atmosphere *atm , double H_alt , double Mach , double throttle )
+{
+    Dynamics::Input in = { H_alt , Mach , throttle };
+    d.set_schedule( Dynamics::Schedule() );
+    d.set_input( in );
+    if( !d.trim( atm ) ) return false;
+
+    for( int i = 0 ; i < Nx ; i++ ) x0[i] = d.get_x()[i];
+    u0[0] = throttle;
+
+    Dynamics::Output o;
+    double f[Nx];
+    d.derivatives( atm , 0.0 , x0 , f , &o );
+    outputs( o , y0 );
+
+    double xp[Nx] , xm[Nx] , fp[Nx] , fm[Nx] , yp[Ny] , ym[Ny];
+
+    for( int j = 0 ; j < Nx ; j++ )
+    {
+        double h = 1.0e-5 * ( fabs( x0[j] ) > 1.0 ? fabs( x0[j] ) : 1.0 );
+        for( int i = 0 ; i < Nx ; i++ ) xp[i] = xm[i] = x0[i];
+        xp[j] += h;
+        xm[j] -= h;
+
+        d.derivatives( atm , 0.0 , xp , fp , &o );  outputs( o , yp );
+        d.derivatives( atm , 0.0 , xm , fm , &o );  outputs( o , ym );
+
+        for( int i = 0 ; i < Nx ; i++ ) A[i][j] = ( fp[i] - fm[i] ) / ( 2.0 * h );
+        for( int i = 0 ; i < Ny ; i++ ) C[i][j] = ( yp[i] - ym[i] ) / ( 2.0 * h );
+    }
+
+    double hu = 1.0e-4;
+    Dynamics::Input ip = { H_alt , Mach , throttle + hu } , im = { H_alt , Mach , throttle - hu };
+
+    d.set_input( ip );  d.derivatives( atm , 0.0 , x0 , fp , &o );  outputs( o , yp );
+    d.set_input( im );  d.derivatives( atm , 0.0 , x0 , fm , &o );  outputs( o , ym );
+    d.set_input( in );
+
+    for( int i = 0 ; i < Nx ; i++ ) B[i][0] = ( fp[i] - fm[i] ) / ( 2.0 * hu );
+    for( int i = 0 ; i < Ny ; i++ ) D[i][0] = ( yp[i] - ym[i] ) / ( 2.0 * hu );
+    return true;
+}
+
+LPVSchedule::LPVSchedule()
+{
+    refine_tol = 1.0e-3;
+    max_nodes  = 129;
+}
+
+bool LPVSchedule::build( std::weak_ptr<EngineData> Dat , std::vector<double> const &H ,
+                         std::vector<double> const &Mach , std::vector<double> const &throttle )
+{
+    models.clear();
+    if( H.empty() || Mach.empty() || throttle.empty() ) return false;
+
+    H_axis = H;
+    M_axis = Mach;
+
+    Dynamics d( Dat );
+    Atmosphere atm;
+    size_t nHM = H.size() * Mach.size();
+
+    /// modele jednego wezla przepustnicy we wszystkich ( H , Mach ); report - opis na cerr
+    auto column = [&]( double thr , std::vector<LinearModel> &c , bool report )
+    {
+        c.resize( nHM );
+        bool ok = true;
+        for( size_t iH = 0 ; iH < H.size() ; iH++ )
+            for( size_t iM = 0 ; iM < Mach.size() ; iM++ )
+                if( !c[ iH * Mach.size() + iM ].extract( d , &atm , H[iH] , Mach[iM] , thr ) )
+                {
+                    if( report )
+                        std::cerr << "LPVSchedule: no steady point at H = " << H[iH] << " , Mach = " << Mach[iM]
+                                  << " , throttle = " << thr << std::endl;
+                    ok = false;
+                }
+        return ok;
+    };
+
+    std::vector<double> thr( throttle );
+    std::vector< std::vector<LinearModel> > col( thr.size() );
+    bool ok = true;
+    for( size_t it = 0 ; it < thr.size() ; it++ )
+        ok = column( thr[it] , col[it] , true ) && ok;
+    if( !ok ) return false;
+
+    /// zageszczenie: srodek przedzialu , ktorego punkt ustalony odbiega od interpolacji
+    /// koncow ( zalamanie charakterystyki w przedziale ) , staje sie wezlem
+    std::vector<LinearModel> c;
+    for( bool split = refine_tol > 0.0 ; split ; )
+    {
+        split = false;
+        for( size_t it = 0 ; it + 1 < thr.size() && int( thr.size() ) < max_nodes ; it++ )
+        {
+            double mid = 0.5 * ( thr[it] + thr[it+1] );
+            if( thr[it+1] - thr[it] < 2.0 * MinWidth || !column( mid , c , false ) ) continue;
+            if( deviation( col[it] , c , col[it+1] ) <= refine_tol ) continue;
+
+            thr.insert( thr.begin() + it + 1 , mid );
+            col.insert( col.begin() + it + 1 , c );
+            it++;
+            split = true;
+        }
+    }
+
+    thr_axis = thr;
+    models.resize( nHM * thr.size() );
+    for( size_t it = 0 ; it < thr.size() ; it++ )
+        for( size_t iH = 0 ; iH < H.size() ; iH++ )
+            for( size_t iM = 0 ; iM < Mach.size() ; iM++ )
+                models[ index( int( iH ) , int( iM ) , int( it ) ) ] = col[it][ iH * Mach.size() + iM ];
+    return true;
+}
+
+double LPVSchedule::deviation( std::vector<LinearModel> const &a , std::vector<LinearModel> const &m ,
+                               std::vector<LinearModel> const &b )
+{
+    double e = 0.0;
+    for( size_t k = 0 ; k < m.size() ; k++ )
+    {
+        double const *pa[2] = { a[k].x0 , a[k].y0 } , *pm[2] = { m[k].x0 , m[k].y0 } , *pb[2] = { b[k].x0 , b[k].y0 };
+        int const n[2] = { LinearModel::Nx , LinearModel::Ny };
+
+        for( int v = 0 ; v < 2 ; v++ )
+            for( int i = 0 ; i < n[v] ; i++ )
+            {
+                double y = fabs( pm[v][i] );
+                if( y > 0.0 ) e = std::max( e , fabs( pm[v][i] - 0.5 * ( pa[v][i] + pb[v][i] ) ) / y );
+            }
+    }
+    return e;
+}
+
+bool LPVSchedule::save( const char *path ) const
+{
+    std::ofstream f( path , std::ios::binary | std::ios::trunc );
+    if( !f )
+    {
+        std::cerr << "LPVSchedule: " << path << ": cannot open" << std::endl;
+        return false;
+    }
+
+    FileHeader h = { file_magic , version , LinearModel::Nx , LinearModel::Nu , LinearModel::Ny ,
+                     uint32_t( H_axis.size() ) , uint32_t( M_axis.size() ) , uint32_t( thr_axis.size() ) };
+    f.write( reinterpret_cast<const char*>( &h ) , sizeof( h ) );
+    f.write( reinterpret_cast<const char*>( H_axis.data() )   , H_axis.size()   * sizeof( double ) );
+    f.write( reinterpret_cast<const char*>( M_axis.data() )   , M_axis.size()   * sizeof( double ) );
+    f.write( reinterpret_cast<const char*>( thr_axis.data() ) , thr_axis.size() * sizeof( double ) );
+    f.write( reinterpret_cast<const char*>( models.data() )   , models.size()   * sizeof( LinearModel ) );
+
+    if( !f )
+    {
+        std::cerr << "LPVSchedule: " << path << ": write error" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LPVSchedule::load( const char *path )
+{
+    std::ifstream f( path , std::ios::binary );
+    FileHeader h;
+
+    if( !f || !f.read( reinterpret_cast<char*>( &h ) , sizeof( h ) ) || h.magic != file_magic || h.version != version ||
+        h.nx != LinearModel::Nx || h.nu != LinearModel::Nu || h.ny != LinearModel::Ny ||
+        !h.nH || !h.nM || !h.nT || h.nH > 4096 || h.nM > 4096 || h.nT > 4096 )
+    {
+        std::cerr << "LPVSchedule: " << path << ": not a model schedule" << std::endl;
+        return false;
+    }
+
+    std::vector<double> H( h.nH ) , M( h.nM ) , T( h.nT );
+    std::vector<LinearModel> m( size_t( h.nH ) * h.nM * h.nT );
+
+    f.read( reinterpret_cast<char*>( H.data() ) , H.size() * sizeof( double ) );
+    f.read( reinterpret_cast<char*>( M.data() ) , M.size() * sizeof( double ) );
+    f.read( reinterpret_cast<char*>( T.data() ) , T.size() * sizeof( double ) );
+    f.read( reinterpret_cast<char*>( m.data() ) , m.size() * sizeof( LinearModel ) );
+
+    if( !f )
+    {
+        std::cerr << "LPVSchedule: " << path << ": truncated" << std::endl;
+        return false;
+    }
+
+    H_axis.swap( H );
+    M_axis.swap( M );
+    thr_axis.swap( T );
+    models.swap( m );
+    return true;
+}
+
+double LPVSchedule::level( double H , double Mach , double n_gg , TableCursor<double> cur[3] ) const
+{
+    int iH , iM;
+    double wH , wM;
+    axis( H_axis , H    , cur[0] , iH , wH );
+    axis( M_axis , Mach , cur[1] , iM , wM );
+
+    int nH = H_axis.size() > 1 ? 1 : 0 , nM = M_axis.size() > 1 ? 1 : 0;
+    int nt = int( thr_axis.size() );
+
+    /// ustalona n_gg w ( H , Mach ) dla wezla przepustnicy
+    auto n_at = [&]( int it )
+    {
+        double a = models[ index( iH , iM , it ) ].x0[0] * ( 1.0 - wH ) + models[ index( iH + nH , iM , it ) ].x0[0] * wH;
+        double b = models[ index( iH , iM + nM , it ) ].x0[0] * ( 1.0 - wH ) + models[ index( iH + nH , iM + nM , it ) ].x0[0] * wH;
+        return a * ( 1.0 - wM ) + b * wM;
+    };
+
+    double lo = n_at( 0 );
+    if( nt < 2 || n_gg <= lo ) return thr_axis[0];
+
+    for( int it = 1 ; it < nt ; it++ )
+    {
+        double hi = n_at( it );
+        if( n_gg < hi )
+            return thr_axis[it-1] + ( thr_axis[it] - thr_axis[it-1] ) * ( n_gg - lo ) / ( hi - lo );
+        lo = hi;
+    }
+    return thr_axis[nt-1];
+}
+
+void LPVSchedule::interpolate( double H , double Mach , double throttle , LinearModel &m ,
+                               TableCursor<double> cur[3] , int words ) const
+{
+    int iH , iM , it;
+    double wH , wM , wt;
+    axis( H_axis   , H        , cur[0] , iH , wH );
+    axis( M_axis   , Mach     , cur[1] , iM , wM );
+    axis( thr_axis , throttle , cur[2] , it , wt );
+
+    double *out = reinterpret_cast<double*>( &m );
+    for( int k = 0 ; k < words ; k++ ) out[k] = 0.0;
+
+    for( int c = 0 ; c < 8 ; c++ )
+    {
+        int dH = c & 1 , dM = ( c >> 1 ) & 1 , dt = ( c >> 2 ) & 1;
+        double w = ( dH ? wH : 1.0 - wH ) * ( dM ? wM : 1.0 - wM ) * ( dt ? wt : 1.0 - wt );
+        if( w == 0.0 ) continue;
+
+        double const *p = reinterpret_cast<double const*>( &models[ index( iH + dH , iM + dM , it + dt ) ] );
+        for( int k = 0 ; k < words ; k++ ) out[k] += w * p[k];
+    }
+}
+
+void LPVSchedule::slice( double H , double Mach , std::vector<LinearModel> &out ,
+                         TableCursor<double> cur[2] ) const
+{
+    int iH , iM;
+    double wH , wM;
+    axis( H_axis , H    , cur[0] , iH , wH );
+    axis( M_axis , Mach , cur[1] , iM , wM );
+
+    int nt = int( thr_axis.size() );
+
+    /// naroza przekroju: pierwszy model , waga , sqrt( T0 / T2 ) ( n_gg -> predkosc zredukowana )
+    int    first[4];
+    double w[4] , red[4];
+    int    nc = 0;
+    Atmosphere atm;
+
+    for( int c = 0 ; c < 4 ; c++ )
+    {
+        int dH = c & 1 , dM = ( c >> 1 ) & 1;
+        double wc = ( dH ? wH : 1.0 - wH ) * ( dM ? wM : 1.0 - wM );
+        if( wc == 0.0 ) continue;
+
+        double Ma = M_axis[ iM + dM ];
+        atm.update( H_axis[ iH + dH ] );
+
+        first[nc] = index( iH + dH , iM + dM , 0 );
+        w[nc]     = wc;
+        red[nc]   = sqrt( EngineConst::T0 / ( atm.get_T() * ( 1.0 + 0.5 * ( EngineConst::k_p - 1.0 ) * Ma * Ma ) ) );
+        nc++;
+    }
+
+    /// poziomy: predkosci zredukowane wezlow wszystkich narozy we wspolnym zakresie
+    double q_lo = -HUGE_VAL , q_hi = HUGE_VAL;
+    std::vector<double> q;
+    for( int c = 0 ; c < nc ; c++ )
+    {
+        q_lo = std::max( q_lo , models[ first[c] ].x0[0] * red[c] );
+        q_hi = std::min( q_hi , models[ first[c] + nt - 1 ].x0[0] * red[c] );
+        for( int it = 0 ; it < nt ; it++ ) q.push_back( models[ first[c] + it ].x0[0] * red[c] );
+    }
+    if( q_lo > q_hi ) q_lo = q_hi = 0.5 * ( q_lo + q_hi );
+
+    for( size_t k = 0 ; k < q.size() ; k++ ) q[k] = std::min( std::max( q[k] , q_lo ) , q_hi );
+    std::sort( q.begin() , q.end() );
+    q.erase( std::unique( q.begin() , q.end() , []( double a , double b ) { return b - a <= 1.0e-9 * fabs( b ); } ) , q.end() );
+
+    /// model poziomu: w kazdym narozu liniowo miedzy jego wezlami o tej samej
+    /// predkosci zredukowanej , potem wagi ( H , Mach ) - zalamanie charakterystyki
+    /// sprezarki ( stala predkosc zredukowana ) wypada we wszystkich narozach razem
+    out.resize( q.size() );
+    for( size_t k = 0 ; k < q.size() ; k++ )
+    {
+        double *o = reinterpret_cast<double*>( &out[k] );
+        for( int i = 0 ; i < LinearModel::Words ; i++ ) o[i] = 0.0;
+
+        for( int c = 0 ; c < nc ; c++ )
+        {
+            LinearModel const *m = &models[ first[c] ];
+            int it = 0;
+            while( it + 2 < nt && m[it+1].x0[0] * red[c] < q[k] ) it++;
+
+            double a = m[it].x0[0] * red[c];
+            double b = nt > 1 ? m[it+1].x0[0] * red[c] : a;
+            double t = b > a ? ( q[k] - a ) / ( b - a ) : 0.0;
+            if( t < 0.0 ) t = 0.0;
+            if( t > 1.0 ) t = 1.0;
+
+            double const *pa = reinterpret_cast<double const*>( &m[it] );
+            double const *pb = reinterpret_cast<double const*>( &m[ nt > 1 ? it + 1 : it ] );
+            for( int i = 0 ; i < LinearModel::Words ; i++ )
+                o[i] += w[c] * ( pa[i] * ( 1.0 - t ) + pb[i] * t );
+        }
+    }
+}
+
+LPVModel::LPVModel( LPVSchedule const &S ) : sched( S )
+{
+    H_alt = 0.0;
+    Mach  = 0.0;
+    thr   = 0.0;
+    for( int i = 0 ; i < LinearModel::Nx ; i++ ) x[i] = 0.0;
+}
+
+void LPVModel::init( double H , double Ma , double throttle )
+{
+    set_input( H , Ma , throttle );
+    sched.interpolate( H_alt , Mach , thr , m , cur , LinearModel::StepWords );
+    for( int i = 0 ; i < LinearModel::Nx ; i++ ) x[i] = m.x0[i];
+}
+
+void LPVModel::set_input( double H , double Ma , double throttle )
+{
+    if( sl.empty() || H != H_alt || Ma != Mach )
+    {
+        sched.slice( H , Ma , sl , cur );
+        n_lvl.resize( sl.size() );
+        for( size_t i = 0 ; i < sl.size() ; i++ ) n_lvl[i] = sl[i].x0[0];
+    }
+
+    H_alt = H;
+    Mach  = Ma;
+    thr   = throttle;
+}
+
+void LPVModel::select( int words ) const
+{
+    /// jak LPVSchedule::level + interpolate: n_gg liniowo miedzy wezlami , poza osia krawedz
+    int i;
+    double w;
+    axis( n_lvl , x[0] , cur[2] , i , w );
+
+    double const *a = reinterpret_cast<double const*>( &sl[i] );
+    double const *b = n_lvl.size() > 1 ? reinterpret_cast<double const*>( &sl[i+1] ) : a;
+    double *out = reinterpret_cast<double*>( &m );
+    for( int k = 0 ; k < words ; k++ ) out[k] = a[k] * ( 1.0 - w ) + b[k] * w;
+}
+
+void LPVModel::step( double dt )
+{
+    select( LinearModel::StepWords );
+
+    /// ( I - dt A ) dx = dt ( A ( x - x0 ) + B ( u - u0 ) ) - regula Cramera
+    double r[3] , M[3][3];
+    double du = thr - m.u0[0];
+    for( int i = 0 ; i < 3 ; i++ )
+    {
+        r[i] = m.B[i][0] * du;
+        for( int j = 0 ; j < 3 ; j++ )
+        {
+            r[i] += m.A[i][j] * ( x[j] - m.x0[j] );
+            M[i][j] = ( i == j ? 1.0 : 0.0 ) - dt * m.A[i][j];
+        }
+        r[i] *= dt;
+    }
+
+    double c0 = M[1][1] * M[2][2] - M[1][2] * M[2][1];
+    double c1 = M[1][0] * M[2][2] - M[1][2] * M[2][0];
+    double c2 = M[1][0] * M[2][1] - M[1][1] * M[2][0];
+    double det = M[0][0] * c0 - M[0][1] * c1 + M[0][2] * c2;
+    if( det == 0.0 ) return;
+
+    double d0 = r[0] * c0
+              - M[0][1] * ( r[1] * M[2][2] - M[1][2] * r[2] )
+              + M[0][2] * ( r[1] * M[2][1] - M[1][1] * r[2] );
+    double d1 = M[0][0] * ( r[1] * M[2][2] - M[1][2] * r[2] )
+              - r[0] * c1
+              + M[0][2] * ( M[1][0] * r[2] - r[1] * M[2][0] );
+    double d2 = M[0][0] * ( M[1][1] * r[2] - r[1] * M[2][1] )
+              - M[0][1] * ( M[1][0] * r[2] - r[1] * M[2][0] )
+              + r[0] * c2;
+
+    x[0] += d0 / det;
+    x[1] += d1 / det;
+    x[2] += d2 / det;
+}
+
+void LPVModel::output( double y[LinearModel::Ny] ) const
+{
+    select( LinearModel::Words );
+
+    double du = thr - m.u0[0];
+    for( int i = 0 ; i < LinearModel::Ny ; i++ )
+    {
+        y[i] = m.y0[i] + m.D[i][0] * du;
+        for( int j = 0 ; j < LinearModel::Nx ; j++ ) y[i] += m.C[i][j] * ( x[j] - m.x0[j] );
+    }
+}
@@ -0,0 +1,169 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef LINEARMODEL_H
+#define LINEARMODEL_H
+
+#include <Dynamics.h>
+#include <Table.h>
+#include <vector>
+
+/// Model liniowy w otoczeniu punktu ustalonego:
+///     dx/dt = A ( x - x0 ) + B ( u - u0 )
+///     y     = y0 + C ( x - x0 ) + D ( u - u0 )
+/// Stan jak w Dynamics ( n_gg , T4 , Omega ) , wejscie - przepustnica ,
+/// wyjscia - temperatury i cisnienia przekrojow oraz moce turbin.
+/// Same liczby double ( bez wskaznikow ) - interpolowane i zapisywane jako
+/// tablica; czesc potrzebna do kroku ( x0 , u0 , A , B ) jest na poczatku.
+struct LinearModel
+{
+    enum { Nx = Dynamics::States , Nu = 1 };
+
+    enum Output { Y_T3 = 0 , Y_p3 , Y_T4 , Y_p4 , Y_T5 , Y_p5 , Y_T6 , Y_P_turbine , Y_P_free , Ny };
+
+    double x0[Nx];
+    double u0[Nu];
+    double A[Nx][Nx];
+    double B[Nx][Nu];
+
+    double y0[Ny];
+    double C[Ny][Nx];
+    double D[Ny][Nu];
+
+    enum { StepWords = Nx + Nu + Nx * Nx + Nx * Nu ,
+           Words     = StepWords + Ny + Ny * Nx + Ny * Nu };
+
+    static const char *output_name( int y );
+
+    /// Wyjscia wybrane z wielkosci modelu dynamicznego
+    static void outputs( Dynamics::Output const &o , double y[Ny] );
+
+    /// Model w punkcie ustalonym ( H , Mach , throttle ) - roznice centralne
+    /// pochodnych Dynamics. Zmienia wejscia i stan d. false - brak punktu ustalonego
+    bool extract( Dynamics &d , Atmosphere *atm , double H_alt , double Mach , double throttle );
+};
+
+/// Modele liniowe na siatce ( H , Mach , przepustnica ) z interpolacja
+/// trzyliniowa. Poza siatka wartosci z krawedzi. Poziom mocy ( level ) to
+/// przepustnica , przy ktorej ustalona predkosc wytwornicy jest rowna danej -
+/// po nim LPVModel wybiera model.
+///
+/// Os przepustnicy jest zageszczana w build(): przedzial jest dzielony na pol ,
+/// gdy punkt ustalony w srodku ( x0 , y0 ) odbiega od interpolacji koncow o
+/// wiecej niz tol ( wzglednie , w ktorymkolwiek wezle H , Mach ). Tak wezly
+/// skupiaja sie przy zalamaniach - koniec charakterystyki sprezarki , za ktorym
+/// T3 i p3 przestaja rosnac - gdzie modele dalekich wezlow interpoluja sie zle.
+class LPVSchedule
+{
+public:
+    LPVSchedule();
+
+    /// Zageszczanie osi przepustnicy: tol ( 0 - bez ) , najwiecej wezlow osi
+    void set_refinement( double Tol , int MaxNodes ) { refine_tol = Tol; max_nodes = MaxNodes; }
+
+    /// Modele we wszystkich wezlach siatki ( osie rosnace ) i w wezlach dodanych
+    /// przy zageszczaniu; false - brak punktu ustalonego w ktoryms wezle podanym
+    /// ( opis na cerr )
+    bool build( std::weak_ptr<EngineData> Dat , std::vector<double> const &H ,
+                std::vector<double> const &Mach , std::vector<double> const &throttle );
+
+    bool save( const char *path ) const;
+    bool load( const char *path );
+
+    bool empty() const { return models.empty(); }
+    int  points() const { return int( models.size() ); }
+
+    std::vector<double> const & get_H()        const { return H_axis;   }
+    std::vector<double> const & get_Mach()     const { return M_axis;   }
+    std::vector<double> const & get_throttle() const { return thr_axis; }
+
+    LinearModel const & model( int iH , int iM , int it ) const { return models[ index( iH , iM , it ) ]; }
+
+    /// Przepustnica punktu ustalonego o predkosci n_gg ( w zakresie osi ) -
+    /// n_gg ustalone rosnie z przepustnica
+    double level( double H , double Mach , double n_gg , TableCursor<double> cur[3] ) const;
+
+    /// Interpolacja pierwszych words liczb modelu ( StepWords - tylko do kroku );
+    /// cur - trzy kursory osi , wlasne dla kazdego uzytkownika ( watku )
+    void interpolate( double H , double Mach , double throttle , LinearModel &m ,
+                      TableCursor<double> cur[3] , int words = LinearModel::Words ) const;
+
+    /// Modele wszystkich wezlow przepustnicy interpolowane w ( H , Mach ) -
+    /// przekroj siatki , po ktorym LPVModel wybiera model wg poziomu mocy
+    void slice( double H , double Mach , std::vector<LinearModel> &out ,
+                TableCursor<double> cur[2] ) const;
+
+private:
+    static constexpr double MinWidth = 1.0e-3;     ///< [-] - najmniejszy przedzial przepustnicy
+
+    int index( int iH , int iM , int it ) const
+    { return ( iH * int( M_axis.size() ) + iM ) * int( thr_axis.size() ) + it; }
+
+    /// Najwieksze wzgledne odchylenie x0 , y0 srodka m od sredniej koncow a , b
+    static double deviation( std::vector<LinearModel> const &a , std::vector<LinearModel> const &m ,
+                             std::vector<LinearModel> const &b );
+
+    std::vector<double> H_axis , M_axis , thr_axis;
+    std::vector<LinearModel> models;
+
+    double refine_tol;
+    int    max_nodes;
+};
+
+/// Symulacja LPV: model liniowy interpolowany w biezacym punkcie ( H , Mach ,
+/// poziom mocy z biezacej n_gg ) - stan jest blisko x0 modelu , wiec liniowa
+/// jest tylko odchylka T4 , Omega i przepustnicy , a nie caly przebieg predkosci.
+/// Krok niejawnym Eulerem - stabilny dla kazdego dt , wiec mozna liczyc krokami
+/// duzo wiekszymi niz stala czasowa komory.
+///
+/// Przekroj siatki w ( H , Mach ) i os poziomu mocy ( ustalona n_gg wezlow )
+/// liczone sa tylko przy zmianie H albo Mach; krok to wyszukanie n_gg na osi
+/// i interpolacja liniowa dwoch modeli przekroju.
+class LPVModel
+{
+public:
+    explicit LPVModel( LPVSchedule const &S );
+
+    void init( double H , double Mach , double throttle );       ///< stan ustalony w punkcie
+    void set_input( double H , double Mach , double throttle );
+    void step( double dt );                                      ///< [s]
+
+    void output( double y[LinearModel::Ny] ) const;
+
+    double const *get_x() const { return x; }
+
+private:
+    /// Model dla biezacej n_gg - pierwsze words liczb
+    void select( int words ) const;
+
+    LPVSchedule const &sched;
+    double H_alt , Mach , thr;
+    double x[LinearModel::Nx];
+
+    std::vector<LinearModel> sl;            ///< przekroj w ( H_alt , Mach )
+    std::vector<double> n_lvl;              ///< ustalona n_gg wezlow przekroju - rosnaca
+
+    mutable LinearModel m;
+    mutable TableCursor<double> cur[3];     ///< H , Mach , poziom mocy
+};
+
+#endif // LINEARMODEL_H
@@ -0,0 +1,327 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "MonteCarlo.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+
+namespace
+{
+
+double const pi = 3.14159265358979323846;
+
+/// Wielkosc y punktu solvera
+double output( CycleSolver::Point const &p , int y )
+{
+    switch( y )
+    {
+    case CycleSolver::Y_n_wc:      return p.n_wc;
+    case CycleSolver::Y_epsT:      return p.epsT;
+    case CycleSolver::Y_T4s:       return p.T4s;
+    case CycleSolver::Y_T5s:       return p.T5s;
+    case CycleSolver::Y_T6s:       return p.T6s;
+    case CycleSolver::Y_m3:        return p.m3;
+    case CycleSolver::Y_P_turbine: return p.P_turbine;
+    case CycleSolver::Y_P_free:    return p.P_free;
+    }
+    return 0.0;
+}
+
+/// Wartosc nominalna rozkladu - punkt startowy solvera
+double nominal( MonteCarlo::Input const &in )
+{
+    switch( in.dist )
+    {
+    case MonteCarlo::Uniform:    return 0.5 * ( in.a + in.b );
+    case MonteCarlo::Triangular: return in.b;
+    default:                     return in.a;
+    }
+}
+
+}
+
+void MonteCarlo::Moments::add( double x )
+{
+    if( n == 0 || x < min ) min = x;
+    if( n == 0 || x > max ) max = x;
+
+    n++;
+    double d = x - mean;
+    mean += d / double( n );
+    m2   += d * ( x - mean );
+}
+
+/// Chan i in. - laczenie srednich i sum kwadratow odchylen
+void MonteCarlo::Moments::merge( Moments const &o )
+{
+    if( o.n == 0 ) return;
+    if( n == 0 )
+    {
+        *this = o;
+        return;
+    }
+
+    double na = double( n ) , nb = double( o.n ) , nt = na + nb;
+    double d  = o.mean - mean;
+
+    mean += d * ( nb / nt );
+    m2   += o.m2 + d * d * ( na * nb / nt );
+    if( o.min < min ) min = o.min;
+    if( o.max > max ) max = o.max;
+    n += o.n;
+}
+
+MonteCarlo::MonteCarlo( std::weak_ptr<EngineData> Dat )
+{
+    dat = Dat.lock();
+
+    CycleSolver cs( dat );
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+        set_fixed( CycleSolver::Param( k ) , cs.get_param( CycleSolver::Param( k ) ) );
+    set_fixed( CycleSolver::P_eta_ks , dat->eta_ks );
+
+    H     = 0.0;
+    alpha = 1.0e-4;
+    rng   = Philox( 0 );
+
+    x_nom[0] = x_nom[1] = x_nom[2] = 0.0;
+    time_s = 0.0;
+    last_n = 0;
+
+    reset();
+}
+
+void MonteCarlo::set_point( double H_alt , double Mach , double throttle )
+{
+    H = H_alt;
+    set_fixed( CycleSolver::P_Mach , Mach );
+    set_fixed( CycleSolver::P_throttle , throttle );
+}
+
+void MonteCarlo::set_fixed( CycleSolver::Param p , double v )
+{
+    Input in = { Fixed , v , 0.0 , 0.0 };
+    inputs[p] = in;
+}
+
+void MonteCarlo::set_uniform( CycleSolver::Param p , double lo , double hi )
+{
+    Input in = { Uniform , lo , hi , 0.0 };
+    inputs[p] = in;
+}
+
+void MonteCarlo::set_normal( CycleSolver::Param p , double mean , double sd , double clip )
+{
+    Input in = { Normal , mean , sd , clip };
+    inputs[p] = in;
+}
+
+void MonteCarlo::set_triangular( CycleSolver::Param p , double lo , double mode , double hi )
+{
+    Input in = { Triangular , lo , mode , hi };
+    inputs[p] = in;
+}
+
+void MonteCarlo::set_alpha( double Alpha )
+{
+    alpha = Alpha;
+    reset();
+}
+
+void MonteCarlo::reset()
+{
+    stats.assign( CycleSolver::Outputs , Stats( alpha ) );
+    samples = 0;
+    failed  = 0;
+}
+
+/// Parametr k probki i - licznik ( i , k , proba ) , proba > 0 tylko przy
+/// odrzuceniu poza obcieciem rozkladu normalnego
+double MonteCarlo::draw( Input const &in , uint64_t i , int k ) const
+{
+    double u[2];
+
+    switch( in.dist )
+    {
+    case Fixed:
+        return in.a;
+
+    case Uniform:
+        rng.uniform2( i , uint32_t( k ) , 0 , u );
+        return in.a + ( in.b - in.a ) * u[0];
+
+    case Normal:
+        for( uint32_t j = 0 ; j < 64 ; j++ )
+        {
+            rng.uniform2( i , uint32_t( k ) , j , u );
+            double z = sqrt( -2.0 * log( u[0] ) ) * cos( 2.0 * pi * u[1] );
+            if( in.c <= 0.0 || fabs( z ) <= in.c ) return in.a + in.b * z;
+        }
+        return in.a;
+
+    case Triangular:
+    {
+        rng.uniform2( i , uint32_t( k ) , 0 , u );
+        double w = in.c - in.a;
+        if( w <= 0.0 ) return in.b;
+        if( u[0] < ( in.b - in.a ) / w )
+            return in.a + sqrt( u[0] * w * ( in.b - in.a ) );
+        return in.c - sqrt( ( 1.0 - u[0] ) * w * ( in.c - in.b ) );
+    }
+    }
+    return in.a;
+}
+
+void MonteCarlo::sample( uint64_t i , double p[CycleSolver::Params] ) const
+{
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+        p[k] = draw( inputs[k] , i , k );
+}
+
+bool MonteCarlo::run( ThreadPool &pool , Atmosphere *atm , long n )
+{
+    if( n <= 0 ) return true;
+
+    /// punkt nominalny - wspolny start wszystkich probek
+    double nom[CycleSolver::Params];
+    for( int k = 0 ; k < CycleSolver::Params ; k++ ) nom[k] = nominal( inputs[k] );
+
+    CycleSolver cs( dat );
+    CycleSolver::Point pt;
+    cs.set_cache( false );
+    if( !cs.solve( atm , H , nom , pt ) )
+    {
+        cerr << "MonteCarlo: nominal point does not converge" << endl;
+        return false;
+    }
+    x_nom[0] = pt.n_wc;
+    x_nom[1] = pt.epsT;
+    x_nom[2] = pt.T4s;
+
+    workers.resize( pool.size() );
+    for( size_t w = 0 ; w < workers.size() ; w++ )
+    {
+        Worker &wk = workers[w];
+        if( !wk.solver ) wk.solver = std::make_shared<CycleSolver>( dat );
+        wk.solver->set_cache( false );
+        wk.solver->set_guess( x_nom[0] , x_nom[1] , x_nom[2] );
+        wk.sketch.assign( CycleSolver::Outputs , QuantileSketch( alpha ) );
+        wk.failed = 0;
+    }
+
+    uint64_t first = samples;
+    uint64_t end   = samples + uint64_t( n );
+    long nb = ( n + Block - 1 ) / Block;
+    blocks.assign( size_t( nb ) * CycleSolver::Outputs , Moments() );
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    pool.parallel_for( nb , 1 , [&]( long b , long e , int w )
+    {
+        run_blocks( b , e , w , first , end , atm );
+    } );
+
+    /// bloki w kolejnosci indeksow - wynik nie zalezy od podzialu na watki
+    for( long b = 0 ; b < nb ; b++ )
+        for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+            stats[y].merge( blocks[ size_t( b ) * CycleSolver::Outputs + y ] );
+
+    for( size_t w = 0 ; w < workers.size() ; w++ )
+    {
+        for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+            stats[y].sketch.merge( workers[w].sketch[y] );
+        failed += workers[w].failed;
+    }
+
+    samples += uint64_t( n );
+
+    time_s = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+    last_n = n;
+
+    cout << "MonteCarlo: " << n << " samples on " << pool.size() << " threads in "
+         << time_s << " s - " << get_rate() << " samples/s" << endl;
+    return true;
+}
+
+void MonteCarlo::run_blocks( long b , long e , int w , uint64_t first , uint64_t end , Atmosphere *atm )
+{
+    Worker &wk = workers[w];
+    double p[CycleSolver::Params];
+    CycleSolver::Point pt;
+
+    for( long bl = b ; bl < e ; bl++ )
+    {
+        Moments *m = &blocks[ size_t( bl ) * CycleSolver::Outputs ];
+
+        uint64_t i0 = first + uint64_t( bl ) * Block;
+        uint64_t i1 = i0 + Block < end ? i0 + Block : end;
+
+        for( uint64_t i = i0 ; i < i1 ; i++ )
+        {
+            sample( i , p );
+
+            if( !wk.solver->solve( atm , H , p , pt ) )
+            {
+                wk.failed++;
+                continue;
+            }
+
+            for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+            {
+                double v = output( pt , y );
+                m[y].add( v );
+                wk.sketch[y].add( v );
+            }
+        }
+    }
+}
+
+bool MonteCarlo::write( const char *path ) const
+{
+    std::ofstream out( path );
+    if( !out ) return false;
+
+    static const char * const dist_name[] = { "fixed" , "uniform" , "normal" , "triangular" };
+
+    out << "# samples " << samples << " failed " << failed << " H_alt " << H << " alpha " << alpha << "\n";
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+    {
+        Input const &in = inputs[k];
+        out << "# " << CycleSolver::param_name( CycleSolver::Param( k ) ) << " " << dist_name[ in.dist ]
+            << " " << in.a << " " << in.b << " " << in.c << "\n";
+    }
+    out << "# output n mean sd min p01 p05 p50 p95 p99 max\n";
+    out.precision( 10 );
+
+    for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+    {
+        Stats const &s = stats[y];
+        out << CycleSolver::output_name( CycleSolver::Output( y ) ) << " " << s.n << " "
+            << s.mean << " " << sqrt( s.variance() ) << " " << s.min << " "
+            << s.quantile( 0.01 ) << " " << s.quantile( 0.05 ) << " " << s.quantile( 0.5 ) << " "
+            << s.quantile( 0.95 ) << " " << s.quantile( 0.99 ) << " " << s.max << "\n";
+    }
+    return bool( out );
+}
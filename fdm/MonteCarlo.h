@@ -0,0 +1,155 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <CycleSolver.h>
+#include <Philox.h>
+#include <QuantileSketch.h>
+#include <ThreadPool.h>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+/// Propagacja niepewnosci parametrow przez ustalony punkt pracy ( CycleSolver ).
+///
+/// Kazdy parametr obiegu ( sprawnosci , straty cisnienia , sprawnosc spalania
+/// z decku , mnozniki charakterystyk - rozrzut map ) ma rozklad: staly ,
+/// jednostajny , normalny obciety albo trojkatny. Probka i bierze parametr k
+/// z generatora Philox pod licznikiem ( i , k ) - ta sama probka ma te same
+/// parametry niezaleznie od watku. Deck nie jest zmieniany: solver probki
+/// dostaje pelny wektor parametrow.
+///
+/// Probki dzielone sa na bloki po Block kolejnych indeksow. Srednia i wariancja
+/// ( Welford ) liczone sa w bloku , a bloki laczone w kolejnosci indeksow ;
+/// kwantyle ( QuantileSketch ) to liczniki calkowite , laczone dokladnie.
+/// Wynik jest wiec bit w bit ten sam dla dowolnej liczby watkow. Kazda probka
+/// startuje z punktu nominalnego ( bez pamieci podrecznej solvera ).
+///
+/// run( n ) dokleja kolejne n probek do statystyk - mozna je czytac miedzy
+/// wywolaniami; probki nie sa przechowywane.
+class MonteCarlo
+{
+public:
+    enum { Block = 1024 };
+
+    enum Dist
+    {
+        Fixed = 0,
+        Uniform,
+        Normal,
+        Triangular
+    };
+
+    /// Fixed: a ; Uniform: [ a , b ] ; Normal: srednia a , odchylenie b ,
+    /// obciecie do +- c odchylen ; Triangular: [ a , c ] , moda b
+    struct Input
+    {
+        Dist   dist;
+        double a , b , c;
+    };
+
+    struct Moments
+    {
+        uint64_t n;
+        double mean , m2;
+        double min , max;
+
+        Moments() : n( 0 ) , mean( 0.0 ) , m2( 0.0 ) , min( 0.0 ) , max( 0.0 ) {}
+
+        void   add( double x );
+        void   merge( Moments const &o );
+        double variance() const { return n > 1 ? m2 / double( n - 1 ) : 0.0; }
+    };
+
+    struct Stats : Moments
+    {
+        QuantileSketch sketch;
+
+        explicit Stats( double Alpha = 1.0e-4 ) : sketch( Alpha ) {}
+        double quantile( double q ) const { return sketch.quantile( q ); }
+    };
+
+    MonteCarlo( std::weak_ptr<EngineData> Dat );
+
+    void set_point( double H_alt , double Mach , double throttle );      ///< Mach i throttle stale
+    void set_altitude( double H_alt ) { H = H_alt; }
+
+    void set_input( CycleSolver::Param p , Input const &in ) { inputs[p] = in; }
+    void set_fixed( CycleSolver::Param p , double v );
+    void set_uniform( CycleSolver::Param p , double lo , double hi );
+    void set_normal( CycleSolver::Param p , double mean , double sd , double clip = 4.0 );
+    void set_triangular( CycleSolver::Param p , double lo , double mode , double hi );
+    Input const & get_input( CycleSolver::Param p ) const { return inputs[p]; }
+
+    void set_seed( uint64_t Seed ) { rng = Philox( Seed ); }
+    void set_alpha( double Alpha );                 ///< dokladnosc kwantyli , zeruje statystyki
+
+    void reset();                                   ///< zeruje statystyki i licznik probek
+
+    /// Kolejne n probek; false - punkt nominalny nie jest zbiezny
+    bool run( ThreadPool &pool , Atmosphere *atm , long n );
+
+    /// Parametry probki i
+    void sample( uint64_t i , double p[CycleSolver::Params] ) const;
+
+    Stats const & get_stats( CycleSolver::Output y ) const { return stats[y]; }
+    uint64_t get_samples() const { return samples; }
+    uint64_t get_failed()  const { return failed; }    ///< probki bez zbieznosci - poza statystykami
+
+    double get_time() const { return time_s; }                          ///< [s] ostatniego run()
+    double get_rate() const { return time_s > 0.0 ? last_n / time_s : 0.0; }  ///< [probki/s]
+
+    bool write( const char *path ) const;          ///< tekst , jedna wielkosc na wiersz
+
+private:
+    double draw( Input const &in , uint64_t i , int k ) const;
+    void   run_blocks( long b , long e , int w , uint64_t first , uint64_t end , Atmosphere *atm );
+
+    std::shared_ptr<EngineData> dat;
+
+    double H;
+    Input  inputs[CycleSolver::Params];
+    Philox rng;
+    double alpha;
+
+    double x_nom[3];                                ///< punkt nominalny - start kazdej probki
+
+    struct Worker
+    {
+        std::shared_ptr<CycleSolver> solver;
+        std::vector<QuantileSketch> sketch;         ///< po jednym na wielkosc
+        uint64_t failed;
+    };
+    std::vector<Worker>  workers;
+    std::vector<Moments> blocks;                    ///< [ blok * Outputs + wielkosc ] biezacego run()
+
+    std::vector<Stats> stats;
+    uint64_t samples;
+    uint64_t failed;
+
+    double time_s;
+    long   last_n;
+};
+
+#endif // MONTECARLO_H
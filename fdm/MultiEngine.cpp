@@ -0,0 +1,223 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "MultiEngine.h"
+#include <chrono>
+#include <thread>
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace EngineConst;
+
+namespace
+{
+
+inline double now_ns()
+{
+    return double( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+/// Przypiecie biezacego watku; false - system nie pozwala
+bool pin( int c )
+{
+#if defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( c , &set );
+    return pthread_setaffinity_np( pthread_self() , sizeof( set ) , &set ) == 0;
+#else
+    (void)c;
+    return false;
+#endif
+}
+
+}
+
+void MultiEngine::Governor::update( double e , double dt )
+{
+    /// bez calkowania , gdy wyjscie jest nasycone w strone bledu
+    double u = thr0 + Kp * e + Ki * ( integ + e * dt );
+    if( u > 0.0 && u < 1.0 ) integ += e * dt;
+
+    thr = thr0 + Kp * e + Ki * integ;
+    if( thr < 0.0 ) thr = 0.0;
+    if( thr > 1.0 ) thr = 1.0;
+}
+
+MultiEngine::MultiEngine( std::weak_ptr<EngineData> Dat , int N )
+{
+    dat = Dat.lock();
+
+    /// n_wc poczatkowe - srodek charakterystyki sprezarki
+    double n0 = 0.5 * ( dat->rpm_tab[0] + dat->rpm_tab[ dat->sk - 1 ] ) * n_PI_30;
+
+    for( int i = 0 ; i < N ; i++ )
+    {
+        EngineConstruct construct;
+        TurboShaftEngine builder( dat );
+        construct.CreateEngine( builder );
+
+        std::shared_ptr<Engine> e = builder.GetEngine().lock();
+        e->set_n_wc( n0 );
+        engines.push_back( e );
+    }
+
+    trim.assign( N , 1.0 );
+    power.assign( N , 0.0 );
+    slots.resize( N );
+
+    set_governor( 5.0 , 2.0 , 0.5 );
+
+    threaded   = true;
+    cpu        = -1;
+    frames_run = 0;
+}
+
+MultiEngine::~MultiEngine()
+{
+    engines.clear();
+    dat.reset();
+}
+
+void MultiEngine::set_Mach( double Ma )
+{
+    for( size_t i = 0 ; i < engines.size() ; i++ ) engines[i]->set_Mach( Ma );
+}
+
+void MultiEngine::set_governor( double Kp , double Ki , double thr0 )
+{
+    gov.Kp    = Kp;
+    gov.Ki    = Ki;
+    gov.thr0  = thr0;
+    gov.integ = 0.0;
+    gov.thr   = thr0;
+}
+
+/// Wspolna czesc ramki - liczona tak samo na kazdym watku
+void MultiEngine::frame_sum( long f , Rotor &r , Governor &g , double dt ) const
+{
+    double P = 0.0;
+    for( size_t i = 0 ; i < slots.size() ; i++ ) P += slots[i].P[ f & 1 ];
+
+    r.update( P , dt );
+    g.update( ( r.get_Omega_ref() - r.get_Omega() ) / r.get_Omega_ref() , dt );
+}
+
+void MultiEngine::run_engine( int i , Atmosphere *atm , long frames , double dt , SpinBarrier *bar )
+{
+    if( cpu >= 0 && !pin( cpu + i ) )
+        cerr << "MultiEngine: cannot pin engine " << i << " to cpu " << cpu + i << endl;
+
+    Engine &e = *engines[i];
+    Slot   &s = slots[i];
+
+    /// wlasne kopie wirnika i regulatora - wszystkie watki licza je identycznie
+    Rotor    r = rot;
+    Governor g = gov;
+
+    for( long f = 0 ; f < frames ; f++ )
+    {
+        double thr = g.thr * trim[i];
+        e.set_throttle( thr < 1.0 ? thr : 1.0 );
+
+        /// trim 0 - silnik wylaczony: bez kroku , moc 0
+        double t0 = now_ns();
+        if( trim[i] > 0.0 ) e.update( atm , dt );
+        s.P[ f & 1 ] = trim[i] > 0.0 ? e.get_P_free() : 0.0;
+        double t1 = now_ns();
+
+        bar->wait();
+        double t2 = now_ns();
+
+        frame_sum( f , r , g , dt );
+
+        s.step.add( t1 - t0 );
+        s.wait.add( t2 - t1 );
+    }
+
+    if( i == 0 )
+    {
+        rot = r;
+        gov = g;
+    }
+}
+
+void MultiEngine::run( Atmosphere *atm , long frames , double dt )
+{
+    int n = size();
+    if( frames <= 0 || n == 0 ) return;
+
+    for( int i = 0 ; i < n ; i++ )
+    {
+        slots[i].step.reset();
+        slots[i].wait.reset();
+    }
+
+    /// pierwszy krok silnika liczy turbine z zerowego stanu poprzedniego
+    /// kroku ( p5 z T5 = 0 ) - robiony przed sprzezeniem , poza ramkami
+    if( frames_run == 0 )
+        for( int i = 0 ; i < n ; i++ )
+        {
+            double thr = gov.thr * trim[i];
+            engines[i]->set_throttle( thr < 1.0 ? thr : 1.0 );
+            engines[i]->update( atm , dt );
+        }
+
+    if( !threaded || n == 1 )
+    {
+        for( long f = 0 ; f < frames ; f++ )
+        {
+            for( int i = 0 ; i < n ; i++ )
+            {
+                double thr = gov.thr * trim[i];
+                engines[i]->set_throttle( thr < 1.0 ? thr : 1.0 );
+
+                double t0 = now_ns();
+                if( trim[i] > 0.0 ) engines[i]->update( atm , dt );
+                slots[i].P[ f & 1 ] = trim[i] > 0.0 ? engines[i]->get_P_free() : 0.0;
+                slots[i].step.add( now_ns() - t0 );
+            }
+            frame_sum( f , rot , gov , dt );
+        }
+    }
+    else
+    {
+        SpinBarrier bar( n );
+        std::vector<std::thread> th;
+
+        for( int i = 1 ; i < n ; i++ )
+            th.push_back( std::thread( &MultiEngine::run_engine , this , i , atm , frames , dt , &bar ) );
+
+        /// silnik 0 na watku wywolujacym
+        run_engine( 0 , atm , frames , dt , &bar );
+
+        for( size_t k = 0 ; k < th.size() ; k++ ) th[k].join();
+    }
+
+    for( int i = 0 ; i < n ; i++ ) power[i] = slots[i].P[ ( frames - 1 ) & 1 ];
+    frames_run += frames;
+}
@@ -0,0 +1,118 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef MULTIENGINE_H
+#define MULTIENGINE_H
+
+#include <Engine.h>
+#include <Executive.h>
+#include <Rotor.h>
+#include <SpinBarrier.h>
+#include <memory>
+#include <vector>
+
+/// N silnikow napedzajacych jeden wirnik przez wspolna przekladnie.
+///
+/// Kazdy silnik liczony jest na wlasnym watku ( opcjonalnie przypietym do
+/// rdzenia ). Ramka: silnik i robi krok z biezaca przepustnica i wpisuje moc
+/// turbiny swobodnej do swojej komorki , potem wszystkie watki spotykaja sie
+/// na barierze ( SpinBarrier - jedna na ramke ). Po barierze kazdy watek sumuje
+/// moce w kolejnosci silnikow i liczy ten sam krok wirnika i regulatora
+/// obrotow ( PI na Omega -> przepustnica ) - bez drugiej bariery i bez
+/// watku nadrzednego. Komorki mocy sa podwojne ( parzysta / nieparzysta
+/// ramka ) , wiec zapis nastepnej ramki nie koliduje z odczytem biezacej.
+///
+/// Wynik nie zalezy od liczby watkow ani kolejnosci ich dojscia do bariery:
+/// set_threaded( false ) liczy to samo na jednym watku bit w bit.
+/// Czasy kroku i czekania na barierze zbierane sa osobno dla kazdego silnika.
+class MultiEngine
+{
+public:
+    MultiEngine( std::weak_ptr<EngineData> Dat , int N );
+    ~MultiEngine();
+
+    int size() const { return int( engines.size() ); }
+
+    std::shared_ptr<Engine> engine( int i ) { return engines[i]; }
+    Rotor       & rotor()       { return rot; }
+    Rotor const & rotor() const { return rot; }
+
+    void set_Mach( double Ma );
+    void set_n_wc( int i , double n ) { engines[i]->set_n_wc( n ); }    ///< [rad/s]
+    /// Mnoznik przepustnicy silnika i; 0 - silnik wylaczony: nie jest liczony ,
+    /// jego moc w sumie wirnika to 0 ( stan zostaje z ostatniego kroku - po
+    /// ponownym wlaczeniu silnik startuje z niego , bez modelu rozruchu )
+    void set_trim( int i , double k ) { trim[i] = k; }
+
+    /// Regulator obrotow wirnika: thr = thr0 + Kp e + Ki int( e ) , e = ( Omega_ref - Omega ) / Omega_ref
+    void set_governor( double Kp , double Ki , double thr0 );
+    double get_throttle() const { return gov.thr; }
+
+    void set_threaded( bool On ) { threaded = On; }
+    void set_cpu( int First ) { cpu = First; }             ///< silnik i na rdzeniu First + i ; -1 - bez przypiecia
+
+    /// frames ramek o kroku dt [s]; atmosfera tylko czytana. Histogramy
+    /// czasow dotycza ostatniego run()
+    void run( Atmosphere *atm , long frames , double dt = EngineConst::dt_ref );
+
+    double get_power( int i ) const { return power[i]; }  ///< [W] - ostatnia moc turbiny swobodnej
+    long   get_frames() const { return frames_run; }
+
+    Histogram const & get_step( int i ) const { return slots[i].step; }   ///< [ns] - krok silnika
+    Histogram const & get_wait( int i ) const { return slots[i].wait; }   ///< [ns] - czekanie na barierze
+
+private:
+    struct Governor
+    {
+        double Kp , Ki , thr0;
+        double integ;
+        double thr;
+
+        void update( double e , double dt );
+    };
+
+    struct alignas( 64 ) Slot
+    {
+        double P[2];                ///< moc w ramce parzystej / nieparzystej
+        Histogram step , wait;
+
+        Slot() : step( 50.0 , 4000 ) , wait( 50.0 , 4000 ) { P[0] = P[1] = 0.0; }
+    };
+
+    void frame_sum( long f , Rotor &r , Governor &g , double dt ) const;
+    void run_engine( int i , Atmosphere *atm , long frames , double dt , SpinBarrier *bar );
+
+    std::shared_ptr<EngineData> dat;
+    std::vector<std::shared_ptr<Engine>> engines;
+    std::vector<double> trim;
+    std::vector<double> power;
+    std::vector<Slot>   slots;
+
+    Rotor    rot;
+    Governor gov;
+
+    bool threaded;
+    int  cpu;
+    long frames_run;
+};
+
+#endif // MULTIENGINE_H
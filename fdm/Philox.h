@@ -0,0 +1,88 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+
+/// Generator licznikowy Philox4x32-10 ( Salmon i in. , SC'11 ).
+///
+/// Nie ma stanu: liczby sa funkcja klucza ( ziarno ) i licznika , wiec
+/// probka i strumien k daja zawsze te same liczby niezaleznie od tego ,
+/// ktory watek i w jakiej kolejnosci je liczy. Jeden blok to 4 slowa
+/// 32-bitowe ( 2 liczby double ).
+class Philox
+{
+public:
+    struct Block { uint32_t w[4]; };
+
+    explicit Philox( uint64_t Seed = 0 )
+    {
+        key[0] = uint32_t( Seed );
+        key[1] = uint32_t( Seed >> 32 );
+    }
+
+    /// Blok dla licznika ( c0 , c1 , c2 , c3 )
+    Block operator()( uint32_t c0 , uint32_t c1 , uint32_t c2 , uint32_t c3 ) const
+    {
+        uint32_t c[4] = { c0 , c1 , c2 , c3 };
+        uint32_t k[2] = { key[0] , key[1] };
+
+        for( int r = 0 ; r < 10 ; r++ )
+        {
+            uint64_t p0 = uint64_t( 0xD2511F53u ) * c[0];
+            uint64_t p1 = uint64_t( 0xCD9E8D57u ) * c[2];
+
+            uint32_t n0 = uint32_t( p1 >> 32 ) ^ c[1] ^ k[0];
+            uint32_t n2 = uint32_t( p0 >> 32 ) ^ c[3] ^ k[1];
+            c[0] = n0;
+            c[1] = uint32_t( p1 );
+            c[2] = n2;
+            c[3] = uint32_t( p0 );
+
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+
+        Block b = { { c[0] , c[1] , c[2] , c[3] } };
+        return b;
+    }
+
+    /// Dwie liczby z ( 0 , 1 ) - 53 bity , nigdy 0 ani 1
+    void uniform2( uint64_t counter , uint32_t stream , uint32_t extra , double u[2] ) const
+    {
+        Block b = ( *this )( uint32_t( counter ) , uint32_t( counter >> 32 ) , stream , extra );
+        u[0] = to_unit( ( uint64_t( b.w[0] ) << 32 ) | b.w[1] );
+        u[1] = to_unit( ( uint64_t( b.w[2] ) << 32 ) | b.w[3] );
+    }
+
+    static double to_unit( uint64_t x )
+    {
+        return ( double( x >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+    }
+
+private:
+    uint32_t key[2];
+};
+
+#endif // PHILOX_H
@@ -0,0 +1,246 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Atmosphere.h>
+#include <enginedata.h>
+#include <Station.h>
+#include <Table.h>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+/// Silnik skladany w czasie kompilacji - alternatywa dla EngineBuilder.
+///
+/// Pipeline< S1 , S2 , ... > to statyczna sekwencja stopni: wyjscie stopnia
+/// ( Stage::Flow - T , p , m , c przekroju ) przekazywane jest przez wartosc
+/// do nastepnego, a caly krok step() rozwija sie w jedna funkcje bez wywolan
+/// wirtualnych i bez shared_ptr. Stopnie wywoluja te same wzory co Intake ,
+/// Compressor , CombustionChamber , Turbine i Turbine_f ( Station.h ) - wyniki
+/// sa identyczne z Engine::update dla jednego silnika. EngineBuilder zostaje do skladania silnika w czasie pracy.
+///
+///     TurboShaftPipeline pipe( deck );
+///     pipe.set_inputs( Ma , n_wc , throttle );
+///     pipe.step( atm );
+///     double T5 = pipe.get<3>().out.T;
+
+#if defined( __GNUC__ )
+#define DME_INLINE inline __attribute__(( always_inline ))
+#else
+#define DME_INLINE inline
+#endif
+
+namespace Stage
+{
+    /// Stan przekroju - wyjscie stopnia , wejscie nastepnego
+    struct Flow
+    {
+        double T;               ///< [K]    - temperatura spietrzenia
+        double p;               ///< [Pa]   - cisnienie spietrzenia
+        double m;               ///< [kg/s] - wydatek
+        double c;               ///< [m/s]  - predkosc
+    };
+
+    /// Wejscia kroku wspolne dla wszystkich stopni
+    struct Inputs
+    {
+        double TH , pH;         ///< [K] , [Pa] - otoczenie
+        double Mach;
+        double n_wc;            ///< [rad/s]
+        double throttle;
+        double dt;              ///< [s] - krok
+    };
+
+    /// T1 , p1 , c1 ( Intake::update_intake )
+    struct Intake
+    {
+        Flow out;
+        explicit Intake( EngineData const & ) : out() {}
+
+        DME_INLINE Flow operator()( Flow , Inputs const &u )
+        {
+            double pH_s;
+            Station::intake( u.TH , u.pH , u.Mach , Station::sigma_H1 , out.T , pH_s , out.p , out.c );
+            out.m = 0.0;
+            return out;
+        }
+    };
+
+    /// T3 , p3 , m3 ( Compressor::update_compressor )
+    struct Compressor
+    {
+        Flow out;
+        double n_zrS , sprezS_s , eta_S , mS_zr;
+
+        explicit Compressor( EngineData const &dat ) : out() , n_zrS( 0 ) , sprezS_s( 1.0 ) , eta_S( 0.5 ) , mS_zr( 0 )
+        {
+            double const * const cols[3] = { dat.sprez_tab , dat.eta_tab , dat.mZR_tab };
+            map.bind( dat.rpm_tab , cols , dat.sk , dat.inv_rpm_tab );
+        }
+
+        DME_INLINE Flow operator()( Flow in , Inputs const &u )
+        {
+            using namespace EngineConst;
+
+            n_zrS = u.n_wc * sqrt( T0 / in.T );
+
+            double val[3];
+            map.lookup( n_zrS * rads2rpm , val , cursor );
+            sprezS_s = val[0];
+            eta_S    = val[1];
+            mS_zr    = val[2];
+
+            Station::compressor( in.T , in.p , sprezS_s , eta_S , mS_zr , out.T , out.p , out.m );
+            out.c = in.c;
+            return out;
+        }
+
+    private:
+        MultiTable<double,3> map;
+        TableCursor<double>  cursor;
+    };
+
+    /// T4 , p4 , m4 , c4 ( CombustionChamber::update_comchamber ) - opoznienie T4 wlasne dla instancji
+    struct CombustionChamber
+    {
+        Flow out;
+        double q_pal , T_ch;
+        LagGain lag;            ///< opoznienie cieplne - stala czasowa lag.set_tau()
+
+        explicit CombustionChamber( EngineData const &Dat ) : out() , q_pal( 0 ) , T_ch( 0 ) , lag( EngineConst::tau_ks ) , primed( false ) , dat( &Dat ) {}
+
+        DME_INLINE Flow operator()( Flow in , Inputs const &u )
+        {
+            q_pal = cursor.interpolate( u.throttle , dat->q_pal_tab , dat->q_pal_thr , dat->ck );
+
+            double T4_tt;
+            Station::chamber( in.p , in.T , in.m , in.c , q_pal , Station::sig_34 ,
+                              dat->eta_ks , dat->W_opal , dat->Cp , out.p , T4_tt , out.c , out.m );
+
+            if( !primed ) { T_ch = T4_tt; primed = true; }
+            T_ch += ( T4_tt - T_ch ) * lag( u.dt );
+
+            out.T = T_ch;
+            return out;
+        }
+
+    private:
+        bool primed;
+        EngineData const *dat;
+        TableCursor<double> cursor;
+    };
+
+    /// T5 , p5 , c5 ( Turbine::update_turbine ) - p5 liczone z T5 poprzedniego kroku
+    struct Turbine
+    {
+        Flow out;
+        double epsT_roz , P_turbine;
+
+        explicit Turbine( EngineData const &Dat ) : out() , epsT_roz( 0 ) , P_turbine( 0 ) , dat( &Dat ) {}
+
+        DME_INLINE Flow operator()( Flow in , Inputs const &u )
+        {
+            using namespace EngineConst;
+
+            epsT_roz = cursor.interpolate( u.n_wc * sqrt( T0 / in.T ) * rads2rpm ,
+                                           dat->epsT_roz_tab , dat->rpm_tab_t , dat->tk );
+
+            /// out.T na wejsciu - T5 poprzedniego kroku
+            Station::turbine( in.p , in.T , in.m , epsT_roz , Station::eta_Twc , dat->A_turbine , dat->Cp ,
+                              out.p , out.T , out.c , P_turbine );
+            out.m = in.m;
+            return out;
+        }
+
+    private:
+        EngineData const *dat;
+        TableCursor<double> cursor;
+    };
+
+    /// T6 , wpt - rozprezanie do p0 ( Turbine_f::update_turbine_f )
+    struct Turbine_f
+    {
+        Flow out;
+        double wpt;
+
+        explicit Turbine_f( EngineData const &Dat ) : out() , wpt( 0 ) , dat( &Dat ) {}
+
+        DME_INLINE Flow operator()( Flow in , Inputs const & )
+        {
+            out.p = EngineConst::p0;
+            out.m = in.m;
+            out.c = in.c;
+
+            Station::turbine_f( in.p , in.T , dat->Cp , out.T , wpt );
+            return out;
+        }
+
+    private:
+        EngineData const *dat;
+    };
+}
+
+template <class... S> class Pipeline
+{
+public:
+    enum { Stages = sizeof...( S ) };
+
+    explicit Pipeline( std::shared_ptr<EngineData> Dat )
+        : dat( Dat ) , stages( S( *Dat )... )
+    {
+        in = Stage::Inputs();
+    }
+
+    void set_inputs( double Ma , double n , double thr ) { in.Mach = Ma; in.n_wc = n; in.throttle = thr; }
+
+    /// Jeden krok calego silnika
+    Stage::Flow step( Atmosphere *atm , double dt = EngineConst::dt_ref )
+    {
+        in.dt = dt;
+        in.TH = atm->get_T();
+        in.pH = atm->get_p();
+        return run( Stage::Flow() , std::integral_constant<int,0>() );
+    }
+
+    /// Stopien I ( jego wyjscie - get<I>().out )
+    template <int I> typename std::tuple_element<I, std::tuple<S...> >::type & get() { return std::get<I>( stages ); }
+
+    Stage::Inputs const & get_inputs() const { return in; }
+
+private:
+    template <int I> DME_INLINE Stage::Flow run( Stage::Flow f , std::integral_constant<int,I> )
+    {
+        return run( std::get<I>( stages )( f , in ) , std::integral_constant<int,I+1>() );
+    }
+    DME_INLINE Stage::Flow run( Stage::Flow f , std::integral_constant<int,Stages> ) { return f; }
+
+    std::shared_ptr<EngineData> dat;
+    std::tuple<S...> stages;
+    Stage::Inputs in;
+};
+
+typedef Pipeline< Stage::Intake , Stage::Compressor , Stage::CombustionChamber ,
+                  Stage::Turbine , Stage::Turbine_f > TurboShaftPipeline;
+
+#endif // PIPELINE_H
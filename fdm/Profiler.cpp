@@ -0,0 +1,342 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Profiler.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <math.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <x86intrin.h>
+#define DME_PROFILE_TSC 1
+#endif
+
+namespace Profiler
+{
+
+namespace
+{
+
+std::atomic<ThreadStats*> head( 0 );   ///< lista statystyk watkow ( tylko dopisywanie )
+std::atomic<int>          period( 256 );
+
+/// Punkt odniesienia do kalibracji taktow - kalibracja przy zapisie raportu
+struct Origin
+{
+    uint64_t tick;
+    std::chrono::steady_clock::time_point time;
+
+    Origin() : tick( now() ) , time( std::chrono::steady_clock::now() )
+    {
+        /// koszt pary odczytow zegara - odejmowany od kazdego pomiaru
+        uint64_t best = ~uint64_t( 0 );
+        for( int i = 0 ; i < 1000 ; i++ )
+        {
+            uint64_t a = now();
+            uint64_t b = now();
+            if( b - a < best ) best = b - a;
+        }
+        overhead = best;
+    }
+};
+
+Origin const &origin()
+{
+    static Origin o;
+    return o;
+}
+
+const char *txt_file  = 0;
+const char *json_file = 0;
+
+void at_exit()
+{
+    if( txt_file )
+    {
+        std::ofstream out( txt_file );
+        write_text( out );
+    }
+    if( json_file )
+    {
+        std::ofstream out( json_file );
+        write_json( out );
+    }
+}
+
+/// Polaczone statystyki strefy
+struct Merged
+{
+    uint64_t calls , steps , samples , ticks , max;
+    uint64_t hist[Bins];
+};
+
+void clear( ThreadStats *st )
+{
+    for( int z = 0 ; z < Zones ; z++ )
+    {
+        st->calls[z] = 0; st->steps[z] = 0; st->samples[z] = 0; st->ticks[z] = 0; st->max[z] = 0;
+        for( int b = 0 ; b < Bins ; b++ ) st->hist[z][b] = 0;
+    }
+}
+
+int merge( Merged m[Zones] )
+{
+    memset( m , 0 , sizeof( Merged ) * Zones );
+
+    int threads = 0;
+    for( ThreadStats *st = head.load( std::memory_order_acquire ) ; st ; st = st->next , threads++ )
+        for( int z = 0 ; z < Zones ; z++ )
+        {
+            m[z].calls   += st->calls[z].load( std::memory_order_relaxed );
+            m[z].steps   += st->steps[z].load( std::memory_order_relaxed );
+            m[z].samples += st->samples[z].load( std::memory_order_relaxed );
+            m[z].ticks   += st->ticks[z].load( std::memory_order_relaxed );
+
+            uint64_t mx = st->max[z].load( std::memory_order_relaxed );
+            if( mx > m[z].max ) m[z].max = mx;
+
+            for( int b = 0 ; b < Bins ; b++ )
+                m[z].hist[b] += st->hist[z][b].load( std::memory_order_relaxed );
+        }
+    return threads;
+}
+
+/// Dolna granica przedzialu b [takty]
+double bin_low( int b )
+{
+    if( b < 8 ) return b;
+    int e = b / 4 + 1;
+    return ( 4 + b % 4 ) * ldexp( 1.0 , e - 2 );
+}
+
+/// Percentyl p z histogramu - srodek przedzialu [takty]
+double percentile( Merged const &m , double p )
+{
+    if( !m.samples ) return 0.0;
+
+    uint64_t target = uint64_t( p / 100.0 * ( m.samples - 1 ) ) + 1;
+    uint64_t acc = 0;
+    for( int b = 0 ; b < Bins ; b++ )
+    {
+        acc += m.hist[b];
+        if( acc >= target )
+        {
+            double mid = 0.5 * ( bin_low( b ) + bin_low( b + 1 ) );
+            return mid < double( m.max ) ? mid : double( m.max );
+        }
+    }
+    return double( m.max );
+}
+
+/// Wiersz raportu [ns]
+struct Row
+{
+    double mean , p50 , p99 , max;
+    double per_step;            ///< czas strefy na krok ROOT
+    double share;               ///< [%] - udzial w kroku ROOT
+};
+
+/// Wiersze wszystkich stref; ROOT - strefy z calls > 0
+void rows( Merged const m[Zones] , Row r[Zones] )
+{
+    double k = ns_per_tick();
+
+    uint64_t steps = 0 , root_samples = 0 , root_ticks = 0;
+    for( int z = 0 ; z < Zones ; z++ )
+        if( m[z].calls )
+        {
+            steps        += m[z].steps;
+            root_samples += m[z].samples;
+            root_ticks   += m[z].ticks;
+        }
+    double root_mean = root_samples ? k * root_ticks / root_samples : 0.0;
+
+    for( int z = 0 ; z < Zones ; z++ )
+    {
+        r[z].mean = m[z].samples ? k * m[z].ticks / m[z].samples : 0.0;
+        r[z].p50  = k * percentile( m[z] , 50.0 );
+        r[z].p99  = k * percentile( m[z] , 99.0 );
+        r[z].max  = k * m[z].max;
+
+        r[z].per_step = m[z].calls ? r[z].mean : ( steps ? k * m[z].ticks / steps : 0.0 );
+        r[z].share    = root_mean > 0.0 ? 100.0 * r[z].per_step / root_mean : 0.0;
+    }
+}
+
+}
+
+uint64_t overhead = 0;
+
+#if defined( __GNUC__ )
+__thread ThreadStats *tls = 0;
+#else
+thread_local ThreadStats *tls = 0;
+#endif
+
+const char *name( int zone )
+{
+    static const char * const names[Zones] = { "Engine::update" , "Intake" , "Compressor" ,
+                                               "CombustionChamber" , "Turbine" , "Turbine_f" };
+    return zone >= 0 && zone < Zones ? names[zone] : "?";
+}
+
+ThreadStats &attach()
+{
+    origin();
+
+    /// zostaje do konca programu - raport po zakonczeniu watkow
+    ThreadStats *st = new ThreadStats;
+    clear( st );
+    st->countdown = 0;
+    st->reload    = 1;
+    st->phase     = 0;
+    st->inner     = 0;
+
+    st->next = head.load( std::memory_order_relaxed );
+    while( !head.compare_exchange_weak( st->next , st , std::memory_order_release , std::memory_order_relaxed ) ) {}
+
+    tls = st;
+    return *st;
+}
+
+void set_period( int N ) { period.store( N < 1 ? 1 : N , std::memory_order_relaxed ); }
+int  get_period()        { return period.load( std::memory_order_relaxed ); }
+
+uint64_t now()
+{
+#if defined( DME_PROFILE_TSC )
+    return __rdtsc();
+#else
+    return uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+}
+
+double ns_per_tick()
+{
+#if defined( DME_PROFILE_TSC )
+    Origin const &o = origin();
+    uint64_t t = now();
+    double ns = std::chrono::duration<double,std::nano>( std::chrono::steady_clock::now() - o.time ).count();
+    return t > o.tick && ns > 1.0e6 ? ns / double( t - o.tick ) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+void reset()
+{
+    for( ThreadStats *st = head.load( std::memory_order_acquire ) ; st ; st = st->next )
+        clear( st );
+}
+
+void write_text( std::ostream &out )
+{
+    Merged m[Zones];
+    Row    r[Zones];
+    int threads = merge( m );
+    rows( m , r );
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize    prec  = out.precision();
+
+    out << "# Profiler: " << threads << " threads , period " << get_period()
+        << " , " << ns_per_tick() << " ns/tick , clock overhead "
+        << overhead * ns_per_tick() << " ns ( subtracted )" << std::endl;
+    out << std::left << std::setw( 20 ) << "# zone" << std::right
+        << std::setw( 12 ) << "calls" << std::setw( 10 ) << "samples"
+        << std::setw( 10 ) << "mean_ns" << std::setw( 10 ) << "p50_ns"
+        << std::setw( 10 ) << "p99_ns" << std::setw( 12 ) << "max_ns"
+        << std::setw( 10 ) << "step_ns" << std::setw( 9 ) << "share" << std::endl;
+
+    out << std::fixed << std::setprecision( 1 );
+    for( int z = 0 ; z < Zones ; z++ )
+    {
+        if( !m[z].samples ) continue;
+
+        out << std::left << std::setw( 20 ) << name( z ) << std::right;
+        if( m[z].calls ) out << std::setw( 12 ) << m[z].calls;
+        else             out << std::setw( 12 ) << "-";
+        out << std::setw( 10 ) << m[z].samples
+            << std::setw( 10 ) << r[z].mean << std::setw( 10 ) << r[z].p50
+            << std::setw( 10 ) << r[z].p99  << std::setw( 12 ) << r[z].max
+            << std::setw( 10 ) << r[z].per_step << std::setw( 8 ) << r[z].share << "%" << std::endl;
+    }
+
+    out.flags( flags );
+    out.precision( prec );
+}
+
+void write_json( std::ostream &out )
+{
+    Merged m[Zones];
+    Row    r[Zones];
+    merge( m );
+    rows( m , r );
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize    prec  = out.precision();
+    out.unsetf( std::ios::floatfield );
+    out.precision( 6 );
+
+    out << "{\n  \"period\": " << get_period() << ",\n  \"ns_per_tick\": " << ns_per_tick()
+        << ",\n  \"overhead_ns\": " << overhead * ns_per_tick() << ",\n  \"zones\": [";
+    bool first = true;
+    for( int z = 0 ; z < Zones ; z++ )
+    {
+        if( !m[z].samples ) continue;
+
+        out << ( first ? "\n" : ",\n" )
+            << "    { \"name\": \"" << name( z ) << "\", \"root\": " << ( m[z].calls ? "true" : "false" )
+            << ", \"calls\": " << m[z].calls
+            << ", \"samples\": " << m[z].samples
+            << ", \"mean_ns\": " << r[z].mean
+            << ", \"p50_ns\": " << r[z].p50
+            << ", \"p99_ns\": " << r[z].p99
+            << ", \"max_ns\": " << r[z].max
+            << ", \"step_ns\": " << r[z].per_step
+            << ", \"share\": " << r[z].share << " }";
+        first = false;
+    }
+    out << "\n  ]\n}" << std::endl;
+
+    out.flags( flags );
+    out.precision( prec );
+}
+
+void dump_at_exit( const char *txt_path , const char *json_path )
+{
+    origin();
+
+    bool first = !txt_file && !json_file;
+    txt_file  = txt_path;
+    json_file = json_path;
+    if( first ) atexit( at_exit );
+}
+
+}
@@ -0,0 +1,216 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+
+/// Pomiar czasu stopni silnika wlaczany w czasie kompilacji ( DME_PROFILE ).
+///
+///     void Engine::update( Atmosphere *atm )
+///     {
+///         DME_PROFILE_ROOT( Profiler::Engine );      // caly krok
+///         ...
+///     void Compressor::update_compressor( ... )
+///     {
+///         DME_PROFILE_SCOPE( Profiler::Compressor ); // strefa w kroku
+///
+/// Bez DME_PROFILE makra sa puste - nic nie zostaje w kodzie. Z DME_PROFILE
+/// mierzony jest co period-ty krok ( strefa ROOT ) , na przemian: raz caly
+/// krok , raz strefy wewnetrzne - pomiar stref nie wchodzi w czas kroku.
+/// Poza mierzonymi krokami strefa wewnetrzna to jeden odczyt flagi watku ,
+/// a ROOT jedno odliczanie - dwa odczyty zegara na strefe w kazdym kroku
+/// kosztowalyby wiecej niz 2% kroku silnika. Zegar: TSC ( x86 ) albo
+/// steady_clock , koszt pary odczytow odejmowany.
+///
+/// Statystyki sa per watek ( bez blokad i bez wspoldzielonych linii cache ) ,
+/// laczone dopiero przy zapisie: srednia , p50 / p99 / max z histogramu
+/// logarytmicznego ( 4 przedzialy na oktawe , blad < 13% ) i udzial strefy
+/// w kroku.
+///
+/// Czasy ( mean , p50 , p99 , max ) sa tylko z krokow probkowanych: czas calego
+/// kroku ma jeden krok na 2 x period , strefy wewnetrzne - jeden inny krok na
+/// 2 x period. Rzadki dlugi krok miedzy probkami nie trafia do p99 ani max -
+/// do pomiaru ogonow set_period( 1 ). calls dodawane jest hurtem przy kazdym
+/// probkowanym kroku , wiec nie zawiera krokow po ostatniej probce watku
+/// ( do period - 1 na watek ).
+namespace Profiler
+{
+    enum Zone
+    {
+        Engine = 0,             ///< Engine::update ( caly krok )
+        Intake,
+        Compressor,
+        CombustionChamber,
+        Turbine,
+        Turbine_f,
+        Zones
+    };
+
+    enum { Bins = 256 };
+
+    const char *name( int zone );
+
+    /// Statystyki jednego watku - pisze tylko wlasciciel , czytac mozna w trakcie
+    struct ThreadStats
+    {
+        std::atomic<uint64_t> calls[Zones];     ///< wywolania strefy ROOT
+        std::atomic<uint64_t> steps[Zones];     ///< kroki ROOT z mierzonymi strefami wewnetrznymi
+        std::atomic<uint64_t> samples[Zones];
+        std::atomic<uint64_t> ticks[Zones];
+        std::atomic<uint64_t> max[Zones];
+        std::atomic<uint64_t> hist[Zones][Bins];
+
+        int countdown;
+        int reload;                             ///< okres , od ktorego liczy countdown
+        int phase;
+        int inner;                              ///< 1 - mierzone strefy wewnetrzne
+        ThreadStats *next;
+    };
+
+#if defined( __GNUC__ )
+    extern __thread ThreadStats *tls;      ///< bez funkcji opakowujacej thread_local
+#else
+    extern thread_local ThreadStats *tls;
+#endif
+    ThreadStats &attach();                  ///< rejestracja statystyk biezacego watku
+
+    /// Statystyki biezacego watku ( rejestrowane przy 1. uzyciu )
+    inline ThreadStats &local()
+    {
+        ThreadStats *st = tls;
+        return st ? *st : attach();
+    }
+
+    void   set_period( int N );             ///< co ktory krok ROOT jest mierzony ( 1 - kazdy )
+    int    get_period();
+
+    uint64_t now();                         ///< [takty]
+    double   ns_per_tick();
+
+    inline int bin( uint64_t t )
+    {
+        if( t < 8 ) return int( t );
+#if defined( __GNUC__ )
+        int e = 63 - __builtin_clzll( t );
+#else
+        int e = 0;
+        while( t >> ( e + 1 ) ) e++;
+#endif
+        return 4 * ( e - 1 ) + int( ( t >> ( e - 2 ) ) & 3 );
+    }
+
+    extern uint64_t overhead;               ///< [takty] - koszt pary odczytow now()
+
+    inline void bump( std::atomic<uint64_t> &a , uint64_t d )
+    {
+        a.store( a.load( std::memory_order_relaxed ) + d , std::memory_order_relaxed );
+    }
+
+    inline void add( ThreadStats &st , int zone , uint64_t t )
+    {
+        t = t > overhead ? t - overhead : 0;
+
+        bump( st.samples[zone] , 1 );
+        bump( st.ticks[zone] , t );
+        if( t > st.max[zone].load( std::memory_order_relaxed ) ) st.max[zone].store( t , std::memory_order_relaxed );
+        bump( st.hist[zone][bin( t )] , 1 );
+    }
+
+    /// Caly krok - decyduje , ktore kroki sa mierzone
+    class Root
+    {
+    public:
+        explicit Root( int Zone ) : st( local() ) , zone( Zone ) , t0( 0 ) , sampled( false )
+        {
+            if( --st.countdown > 0 ) return;
+
+            /// wywolania liczone hurtem przy pomiarze - bez zapisu w kazdym kroku
+            bump( st.calls[zone] , uint64_t( st.reload ) );
+            st.countdown = st.reload = get_period();
+            sampled = true;
+
+            st.phase ^= 1;
+            if( st.phase )
+                t0 = now();
+            else
+            {
+                bump( st.steps[zone] , 1 );
+                st.inner = 1;
+            }
+        }
+
+        ~Root()
+        {
+            if( !sampled ) return;
+            if( t0 ) add( st , zone , now() - t0 );
+            st.inner = 0;
+        }
+
+    private:
+        ThreadStats &st;
+        int      zone;
+        uint64_t t0;
+        bool     sampled;
+    };
+
+    /// Strefa wewnatrz kroku ROOT
+    class Scope
+    {
+    public:
+        explicit Scope( int Zone ) : st( local() ) , zone( Zone ) , t0( st.inner ? now() : 0 ) {}
+
+        ~Scope()
+        {
+            if( t0 ) add( st , zone , now() - t0 );
+        }
+
+    private:
+        ThreadStats &st;
+        int      zone;
+        uint64_t t0;
+    };
+
+    void reset();                           ///< zerowanie statystyk wszystkich watkow
+
+    void write_text( std::ostream &out );
+    void write_json( std::ostream &out );
+
+    /// Zapis obu raportow przy wyjsciu z programu ( atexit ); 0 - bez danego pliku
+    void dump_at_exit( const char *txt_path , const char *json_path );
+}
+
+#define DME_PROFILE_CAT2( a , b ) a##b
+#define DME_PROFILE_CAT( a , b ) DME_PROFILE_CAT2( a , b )
+
+#if defined( DME_PROFILE )
+#define DME_PROFILE_ROOT( zone )  Profiler::Root  DME_PROFILE_CAT( dme_profile_ , __LINE__ )( zone )
+#define DME_PROFILE_SCOPE( zone ) Profiler::Scope DME_PROFILE_CAT( dme_profile_ , __LINE__ )( zone )
+#else
+#define DME_PROFILE_ROOT( zone )  ( ( void ) 0 )
+#define DME_PROFILE_SCOPE( zone ) ( ( void ) 0 )
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,153 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "QuantileSketch.h"
+#include <math.h>
+
+namespace
+{
+
+double const min_value = 1.0e-300;
+
+}
+
+QuantileSketch::QuantileSketch( double Alpha )
+{
+    alpha        = Alpha;
+    gamma        = ( 1.0 + alpha ) / ( 1.0 - alpha );
+    inv_ln_gamma = 1.0 / log( gamma );
+
+    zero = 0;
+    n    = 0;
+    lo_x = hi_x = 0.0;
+}
+
+void QuantileSketch::clear()
+{
+    pos = Store();
+    neg = Store();
+    zero = 0;
+    n    = 0;
+    lo_x = hi_x = 0.0;
+}
+
+int QuantileSketch::index( double ax ) const
+{
+    return int( ceil( log( ax ) * inv_ln_gamma ) );
+}
+
+/// srodek kubelka ( gamma^(i-1) , gamma^i ] w sensie bledu wzglednego
+double QuantileSketch::value( int i ) const
+{
+    return 2.0 * pow( gamma , i ) / ( gamma + 1.0 );
+}
+
+void QuantileSketch::Store::add( int i , uint64_t k )
+{
+    if( c.empty() )
+    {
+        lo = i;
+        c.assign( 1 , 0 );
+    }
+    else if( i < lo )
+    {
+        c.insert( c.begin() , size_t( lo - i ) , 0 );
+        lo = i;
+    }
+    else if( i >= lo + int( c.size() ) )
+        c.resize( size_t( i - lo + 1 ) , 0 );
+
+    c[ i - lo ] += k;
+}
+
+void QuantileSketch::Store::merge( Store const &o )
+{
+    if( o.c.empty() ) return;
+
+    /// zakres raz , potem sumowanie
+    add( o.lo , 0 );
+    add( o.lo + int( o.c.size() ) - 1 , 0 );
+    for( size_t j = 0 ; j < o.c.size() ; j++ )
+        c[ o.lo - lo + int( j ) ] += o.c[j];
+}
+
+void QuantileSketch::add( double x )
+{
+    if( x != x ) return;
+
+    if( x > min_value )       pos.add( index( x ) , 1 );
+    else if( x < -min_value ) neg.add( index( -x ) , 1 );
+    else                      zero++;
+
+    if( n == 0 || x < lo_x ) lo_x = x;
+    if( n == 0 || x > hi_x ) hi_x = x;
+    n++;
+}
+
+bool QuantileSketch::merge( QuantileSketch const &o )
+{
+    if( o.alpha != alpha ) return false;
+    if( o.n == 0 ) return true;
+
+    pos.merge( o.pos );
+    neg.merge( o.neg );
+    zero += o.zero;
+
+    if( n == 0 || o.lo_x < lo_x ) lo_x = o.lo_x;
+    if( n == 0 || o.hi_x > hi_x ) hi_x = o.hi_x;
+    n += o.n;
+    return true;
+}
+
+double QuantileSketch::quantile( double q ) const
+{
+    if( n == 0 ) return 0.0;
+    if( q <= 0.0 ) return lo_x;
+    if( q >= 1.0 ) return hi_x;
+
+    uint64_t rank = uint64_t( q * double( n - 1 ) );
+    uint64_t s = 0;
+    double v = hi_x;
+    bool found = false;
+
+    /// ujemne od najwiekszego modulu , zero , dodatnie rosnaco
+    for( int j = int( neg.c.size() ) - 1 ; j >= 0 && !found ; j-- )
+    {
+        s += neg.c[j];
+        if( s > rank ) { v = -value( neg.lo + j ); found = true; }
+    }
+    if( !found )
+    {
+        s += zero;
+        if( s > rank ) { v = 0.0; found = true; }
+    }
+    for( size_t j = 0 ; j < pos.c.size() && !found ; j++ )
+    {
+        s += pos.c[j];
+        if( s > rank ) { v = value( pos.lo + int( j ) ); found = true; }
+    }
+
+    if( v < lo_x ) v = lo_x;
+    if( v > hi_x ) v = hi_x;
+    return v;
+}
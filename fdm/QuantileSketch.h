@@ -0,0 +1,78 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Szkic kwantyli o stalym bledzie wzglednym ( DDSketch , Masson i in. 2019 ).
+///
+/// | x | trafia do kubelka i = ceil( ln | x | / ln gamma ) , gamma = ( 1 + a ) / ( 1 - a ) ,
+/// osobno dodatnie i ujemne; kwantyl zwracany jest ze srodka kubelka , wiec
+/// blad wzgledny jest <= a niezaleznie od rozkladu i liczby probek. Pamiec
+/// rosnie z zakresem wartosci ( ln( max / min ) / 2a kubelkow ) , nie z liczba
+/// probek. Kubelki to liczniki calkowite - merge() jest dokladne i nie zalezy
+/// od kolejnosci , szkice watkow mozna laczyc w dowolnym porzadku.
+class QuantileSketch
+{
+public:
+    explicit QuantileSketch( double Alpha = 1.0e-4 );
+
+    void add( double x );
+    bool merge( QuantileSketch const &o );      ///< false - rozne alpha
+    void clear();
+
+    uint64_t count()     const { return n; }
+    double   get_alpha() const { return alpha; }
+    size_t   buckets()   const { return pos.c.size() + neg.c.size(); }
+
+    /// Kwantyl q z [ 0 , 1 ] ( obciety do [ min , max ] ); 0 gdy pusty
+    double quantile( double q ) const;
+
+private:
+    struct Store
+    {
+        int lo;                                 ///< indeks pierwszego kubelka
+        std::vector<uint64_t> c;
+
+        Store() : lo( 0 ) {}
+        void add( int i , uint64_t k );
+        void merge( Store const &o );
+    };
+
+    int    index( double ax ) const;            ///< ax > 0
+    double value( int i ) const;
+
+    double alpha;
+    double gamma;
+    double inv_ln_gamma;
+
+    Store    pos , neg;
+    uint64_t zero;                              ///< | x | < min_value
+    uint64_t n;
+    double   lo_x , hi_x;                       ///< dokladne min i max
+};
+
+#endif // QUANTILESKETCH_H
@@ -0,0 +1,660 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Recorder.h"
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+namespace
+{
+
+const char *names[Recorder::Channels] =
+{
+    "t" , "H_alt" , "Mach" , "n_wc" , "throttle" ,
+    "TH" , "T1s" , "T2s" , "T3s" , "T4s" , "T5s" ,
+    "ph" , "p1s" , "p2s" , "p3s" , "p4s" , "p5s" ,
+    "mh" , "m1"  , "m2"  , "m3"  , "m4"  , "m5"  ,
+    "ch" , "c1"  , "c2"  , "c3"  , "c4"  , "c5"  ,
+    "P_turbine" , "P_free"
+};
+
+inline uint64_t bits_of( double v )  { uint64_t u; memcpy( &u , &v , 8 ); return u; }
+inline double   from_bits( uint64_t u ) { double v; memcpy( &v , &u , 8 ); return v; }
+
+/// Zera wiodace / koncowe , x != 0
+inline int clz64( uint64_t x )
+{
+#if defined( __GNUC__ )
+    return __builtin_clzll( x );
+#else
+    int n = 0;
+    while( !( x & ( uint64_t( 1 ) << 63 ) ) ) { x <<= 1; n++; }
+    return n;
+#endif
+}
+
+inline int ctz64( uint64_t x )
+{
+#if defined( __GNUC__ )
+    return __builtin_ctzll( x );
+#else
+    int n = 0;
+    while( !( x & 1 ) ) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/// Zapis bitow od najstarszego
+class BitWriter
+{
+public:
+    explicit BitWriter( std::vector<uint8_t> &Out ) : out( Out ) , acc( 0 ) , n( 0 ) {}
+
+    void put( uint64_t v , int bits )               ///< 1 .. 64 bitow
+    {
+        if( bits > 32 )
+        {
+            put( v >> 32 , bits - 32 );
+            v &= 0xFFFFFFFFu;
+            bits = 32;
+        }
+        acc = ( acc << bits ) | ( v & ( ( uint64_t( 1 ) << bits ) - 1 ) );
+        n += bits;
+        while( n >= 8 )
+        {
+            n -= 8;
+            out.push_back( uint8_t( acc >> n ) );
+        }
+    }
+
+    void flush()
+    {
+        if( n ) out.push_back( uint8_t( acc << ( 8 - n ) ) );
+        n = 0;
+    }
+
+private:
+    std::vector<uint8_t> &out;
+    uint64_t acc;
+    int n;
+};
+
+class BitReader
+{
+public:
+    BitReader( uint8_t const *P , size_t bytes ) : p( P ) , end( P + bytes ) , acc( 0 ) , n( 0 ) , over( false ) {}
+
+    uint64_t get( int bits )                        ///< 1 .. 64 bitow
+    {
+        if( bits > 32 )
+        {
+            uint64_t hi = get( bits - 32 );
+            return ( hi << 32 ) | get( 32 );
+        }
+        while( n < bits )
+        {
+            if( p < end ) acc = ( acc << 8 ) | *p++;
+            else        { acc <<= 8; over = true; }
+            n += 8;
+        }
+        n -= bits;
+        return ( acc >> n ) & ( ( uint64_t( 1 ) << bits ) - 1 );
+    }
+
+    bool ok() const { return !over; }
+
+private:
+    uint8_t const *p , *end;
+    uint64_t acc;
+    int n;
+    bool over;
+};
+
+/// Dlugosc kodu XOR w bitach - bez zapisu , do wyboru kodowania
+uint64_t xor_bits( double const *v , int n )
+{
+    uint64_t bits = 64;
+    uint64_t prev = bits_of( v[0] );
+
+    int plz = -1 , ptz = 0;
+    for( int i = 1 ; i < n ; i++ )
+    {
+        uint64_t u = bits_of( v[i] );
+        uint64_t x = u ^ prev;
+        prev = u;
+
+        if( !x ) { bits += 1; continue; }
+
+        int lz = clz64( x );
+        int tz = ctz64( x );
+        if( lz > 31 ) lz = 31;
+
+        if( plz >= 0 && lz >= plz && tz >= ptz ) bits += 2 + 64 - plz - ptz;
+        else
+        {
+            bits += 13 + 64 - lz - tz;
+            plz = lz;
+            ptz = tz;
+        }
+    }
+    return bits;
+}
+
+void encode_xor( double const *v , int n , std::vector<uint8_t> &out )
+{
+    BitWriter w( out );
+    uint64_t prev = bits_of( v[0] );
+    w.put( prev , 64 );
+
+    int plz = -1 , ptz = 0;
+    for( int i = 1 ; i < n ; i++ )
+    {
+        uint64_t u = bits_of( v[i] );
+        uint64_t x = u ^ prev;
+        prev = u;
+
+        if( !x ) { w.put( 0 , 1 ); continue; }
+
+        int lz = clz64( x );
+        int tz = ctz64( x );
+        if( lz > 31 ) lz = 31;
+
+        if( plz >= 0 && lz >= plz && tz >= ptz )
+        {
+            w.put( 2 , 2 );
+            w.put( x >> ptz , 64 - plz - ptz );
+        }
+        else
+        {
+            int len = 64 - lz - tz;
+            w.put( 3 , 2 );
+            w.put( lz , 5 );
+            w.put( len - 1 , 6 );
+            w.put( x >> tz , len );
+            plz = lz;
+            ptz = tz;
+        }
+    }
+    w.flush();
+}
+
+bool decode_xor( uint8_t const *p , size_t bytes , double *v , int n )
+{
+    BitReader r( p , bytes );
+    uint64_t prev = r.get( 64 );
+    v[0] = from_bits( prev );
+
+    int plz = -1 , ptz = 0;
+    for( int i = 1 ; i < n ; i++ )
+    {
+        if( r.get( 1 ) )
+        {
+            if( r.get( 1 ) )
+            {
+                plz = int( r.get( 5 ) );
+                int len = int( r.get( 6 ) ) + 1;
+                ptz = 64 - plz - len;
+                if( ptz < 0 ) return false;
+            }
+            else if( plz < 0 ) return false;
+
+            prev ^= r.get( 64 - plz - ptz ) << ptz;
+        }
+        v[i] = from_bits( prev );
+    }
+    return r.ok();
+}
+
+/// Przewidywanie liniowe na bitach liczby: u_i ~ 2 u_i-1 - u_i-2 ( arytmetyka
+/// modulo 2^64 , wiec dokladnie odwracalne ); reszta zigzag , zapisana dlugoscia
+uint64_t delta_bits( double const *v , int n )
+{
+    uint64_t bits = 64;
+    uint64_t u1 = bits_of( v[0] ) , u0 = u1;
+
+    for( int i = 1 ; i < n ; i++ )
+    {
+        uint64_t u = bits_of( v[i] );
+        uint64_t pred = i == 1 ? u1 : 2 * u1 - u0;
+        int64_t  d = int64_t( u - pred );
+        uint64_t z = ( uint64_t( d ) << 1 ) ^ uint64_t( d >> 63 );
+        u0 = u1;
+        u1 = u;
+
+        bits += z ? 7 + 64 - clz64( z ) : 1;
+    }
+    return bits;
+}
+
+void encode_delta( double const *v , int n , std::vector<uint8_t> &out )
+{
+    BitWriter w( out );
+    uint64_t u1 = bits_of( v[0] ) , u0 = u1;
+    w.put( u1 , 64 );
+
+    for( int i = 1 ; i < n ; i++ )
+    {
+        uint64_t u = bits_of( v[i] );
+        uint64_t pred = i == 1 ? u1 : 2 * u1 - u0;
+        int64_t  d = int64_t( u - pred );
+        uint64_t z = ( uint64_t( d ) << 1 ) ^ uint64_t( d >> 63 );
+        u0 = u1;
+        u1 = u;
+
+        if( !z ) { w.put( 0 , 1 ); continue; }
+
+        int nb = 64 - clz64( z );
+        w.put( 1 , 1 );
+        w.put( nb - 1 , 6 );
+        w.put( z , nb );
+    }
+    w.flush();
+}
+
+bool decode_delta( uint8_t const *p , size_t bytes , double *v , int n )
+{
+    BitReader r( p , bytes );
+    uint64_t u1 = r.get( 64 ) , u0 = u1;
+    v[0] = from_bits( u1 );
+
+    for( int i = 1 ; i < n ; i++ )
+    {
+        uint64_t pred = i == 1 ? u1 : 2 * u1 - u0;
+        uint64_t z = 0;
+        if( r.get( 1 ) ) z = r.get( int( r.get( 6 ) ) + 1 );
+
+        uint64_t u = pred + ( ( z >> 1 ) ^ ( ~( z & 1 ) + 1 ) );
+        u0 = u1;
+        u1 = u;
+        v[i] = from_bits( u );
+    }
+    return r.ok();
+}
+
+}
+
+const char *Recorder::channel_name( int c )
+{
+    return c >= 0 && c < Channels ? names[c] : "?";
+}
+
+int Recorder::channel( const char *name )
+{
+    for( int c = 0 ; c < Channels ; c++ )
+        if( !strcmp( names[c] , name ) ) return c;
+    return -1;
+}
+
+Recorder::Codec Recorder::encode( double const *v , int n , std::vector<uint8_t> &out )
+{
+    out.clear();
+    if( n <= 0 ) return Xor;
+
+    if( delta_bits( v , n ) < xor_bits( v , n ) )
+    {
+        encode_delta( v , n , out );
+        return Delta;
+    }
+    encode_xor( v , n , out );
+    return Xor;
+}
+
+bool Recorder::decode( Codec c , uint8_t const *p , size_t bytes , double *v , int n )
+{
+    if( n <= 0 ) return true;
+    return c == Delta ? decode_delta( p , bytes , v , n ) : decode_xor( p , bytes , v , n );
+}
+
+Recorder::Recorder( int Block_rows , int Blocks )
+{
+    block_rows = Block_rows > 1 ? Block_rows : 2;
+    blocks.resize( Blocks > 1 ? Blocks : 2 );
+
+    cur     = -1;
+    offset  = 0;
+    quit    = false;
+    failed  = false;
+    opened  = false;
+    nrows   = 0;
+    nstalls = 0;
+    written.store( 0 );
+}
+
+Recorder::~Recorder()
+{
+    close();
+}
+
+bool Recorder::open( const char *path )
+{
+    close();
+
+    f.rdbuf()->pubsetbuf( 0 , 0 );                  // bloki i tak pisane w calosci
+    f.open( path , std::ios::binary | std::ios::trunc );
+    if( !f )
+    {
+        std::cerr << "Recorder: " << path << ": cannot open" << std::endl;
+        return false;
+    }
+
+    FileHeader h = { file_magic , version , uint32_t( Channels ) , uint32_t( block_rows ) };
+    f.write( reinterpret_cast<const char*>( &h ) , sizeof( h ) );
+    offset = sizeof( h );
+
+    index.clear();
+    free_q.clear();
+    full_q.clear();
+    for( size_t i = 0 ; i < blocks.size() ; i++ )
+    {
+        blocks[i].rows = 0;
+        free_q.push_back( int( i ) );
+    }
+
+    cur     = -1;
+    quit    = false;
+    failed  = !f;
+    opened  = true;
+    nrows   = 0;
+    nstalls = 0;
+    written.store( offset );
+
+    thread = std::thread( &Recorder::writer , this );
+    return true;
+}
+
+bool Recorder::close()
+{
+    if( !opened ) return true;
+
+    if( cur >= 0 )
+    {
+        if( blocks[cur].rows ) submit();
+        else
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            free_q.push_back( cur );
+            cur = -1;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        quit = true;
+    }
+    cv.notify_all();
+    thread.join();
+
+    Tail tail = { offset , uint32_t( index.size() ) , index_magic };
+    if( !index.empty() )
+        f.write( reinterpret_cast<const char*>( index.data() ) , index.size() * sizeof( IndexEntry ) );
+    f.write( reinterpret_cast<const char*>( &tail ) , sizeof( tail ) );
+    f.close();
+
+    written.fetch_add( index.size() * sizeof( IndexEntry ) + sizeof( tail ) , std::memory_order_relaxed );
+    opened = false;
+
+    if( failed || f.fail() )
+    {
+        std::cerr << "Recorder: write error" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Recorder::record( Engine const &eng , double t , double H_alt )
+{
+    Engine::Temp     const &T = eng.get_temp();
+    Engine::Press    const &p = eng.get_press();
+    Engine::MassFlow const &m = eng.get_mS();
+    Engine::Speed    const &c = eng.get_speed();
+
+    double row[Channels] =
+    {
+        t , H_alt , eng.get_Mach() , eng.get_n_wc() , eng.get_throttle() ,
+        T.TH , T.T1s , T.T2s , T.T3s , T.T4s , T.T5s ,
+        p.ph , p.p1s , p.p2s , p.p3s , p.p4s , p.p5s ,
+        m.mh , m.m1  , m.m2  , m.m3  , m.m4  , m.m5  ,
+        c.ch , c.c1  , c.c2  , c.c3  , c.c4  , c.c5  ,
+        eng.get_Pt() , eng.get_P_free()
+    };
+    record( row );
+}
+
+void Recorder::record( double const row[Channels] )
+{
+    if( !opened ) return;
+
+    if( cur < 0 )
+    {
+        std::unique_lock<std::mutex> lock( mtx );
+        if( free_q.empty() )
+        {
+            nstalls++;
+            cv.wait( lock , [this]{ return !free_q.empty(); } );
+        }
+        cur = free_q.front();
+        free_q.pop_front();
+        blocks[cur].rows = 0;
+
+        /// bloki alokowane przy pierwszym uzyciu - krotki start , krotkie przebiegi
+        if( blocks[cur].col.empty() ) blocks[cur].col.resize( size_t( Channels ) * block_rows );
+    }
+
+    Block &b = blocks[cur];
+    double *col = b.col.data() + b.rows;
+    for( int c = 0 ; c < Channels ; c++ ) col[ size_t( c ) * block_rows ] = row[c];
+
+    nrows++;
+    if( ++b.rows == block_rows ) submit();
+}
+
+void Recorder::submit()
+{
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        full_q.push_back( cur );
+        cur = -1;
+    }
+    cv.notify_all();
+}
+
+void Recorder::writer()
+{
+    for( ;; )
+    {
+        int i;
+        {
+            std::unique_lock<std::mutex> lock( mtx );
+            cv.wait( lock , [this]{ return !full_q.empty() || quit; } );
+            if( full_q.empty() ) break;
+            i = full_q.front();
+            full_q.pop_front();
+        }
+
+        bool ok = write_block( blocks[i] );
+
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            if( !ok ) failed = true;
+            free_q.push_back( i );
+        }
+        cv.notify_all();
+    }
+}
+
+bool Recorder::write_block( Block const &b )
+{
+    BlockHeader h;
+    memset( &h , 0 , sizeof( h ) );
+    h.magic   = block_magic;
+    h.rows    = uint32_t( b.rows );
+    h.t_first = b.col[ size_t( C_t ) * block_rows ];
+    h.t_last  = b.col[ size_t( C_t ) * block_rows + b.rows - 1 ];
+
+    out.resize( sizeof( h ) );
+    for( int c = 0 ; c < Channels ; c++ )
+    {
+        h.codec[c] = uint8_t( encode( b.col.data() + size_t( c ) * block_rows , b.rows , col ) );
+        h.bytes[c] = uint32_t( col.size() );
+        out.insert( out.end() , col.begin() , col.end() );
+    }
+    memcpy( out.data() , &h , sizeof( h ) );
+
+    f.write( reinterpret_cast<const char*>( out.data() ) , out.size() );
+    if( !f ) return false;
+
+    IndexEntry e = { offset , h.t_first , h.t_last , h.rows };
+    index.push_back( e );
+    offset += out.size();
+    written.fetch_add( out.size() , std::memory_order_relaxed );
+    return true;
+}
+
+RecordReader::RecordReader()
+{
+    scanned = false;
+}
+
+bool RecordReader::open( const char *path )
+{
+    name = path;
+    index.clear();
+    scanned = false;
+
+    f.close();
+    f.clear();
+    f.open( path , std::ios::binary );
+
+    Recorder::FileHeader h;
+    if( !f || !f.read( reinterpret_cast<char*>( &h ) , sizeof( h ) ) ||
+        h.magic != Recorder::file_magic || h.version != Recorder::version || h.channels != Recorder::Channels )
+    {
+        std::cerr << "RecordReader: " << path << ": not a recorder file" << std::endl;
+        return false;
+    }
+
+    f.seekg( 0 , std::ios::end );
+    uint64_t size = uint64_t( f.tellg() );
+
+    Recorder::Tail tail;
+    if( size >= sizeof( h ) + sizeof( tail ) )
+    {
+        f.seekg( size - sizeof( tail ) );
+        f.read( reinterpret_cast<char*>( &tail ) , sizeof( tail ) );
+
+        if( f && tail.magic == Recorder::index_magic &&
+            tail.index_offset + uint64_t( tail.blocks ) * sizeof( Recorder::IndexEntry ) + sizeof( tail ) == size )
+        {
+            index.resize( tail.blocks );
+            f.seekg( tail.index_offset );
+            if( tail.blocks && !f.read( reinterpret_cast<char*>( index.data() ) , tail.blocks * sizeof( Recorder::IndexEntry ) ) )
+            {
+                std::cerr << "RecordReader: " << path << ": bad index" << std::endl;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    /// brak indeksu - przerwany zapis; bloki od poczatku az do pierwszego niepelnego
+    f.clear();
+    scanned = true;
+    uint64_t pos = sizeof( h );
+    Recorder::BlockHeader b;
+
+    while( pos + sizeof( b ) <= size )
+    {
+        f.seekg( pos );
+        if( !f.read( reinterpret_cast<char*>( &b ) , sizeof( b ) ) || b.magic != Recorder::block_magic ) break;
+
+        uint64_t len = sizeof( b );
+        for( int c = 0 ; c < Recorder::Channels ; c++ ) len += b.bytes[c];
+        if( pos + len > size ) break;
+
+        Recorder::IndexEntry e = { pos , b.t_first , b.t_last , b.rows };
+        index.push_back( e );
+        pos += len;
+    }
+    f.clear();
+    return true;
+}
+
+uint64_t RecordReader::rows() const
+{
+    uint64_t n = 0;
+    for( size_t i = 0 ; i < index.size() ; i++ ) n += index[i].rows;
+    return n;
+}
+
+bool RecordReader::read_column( Recorder::BlockHeader const &h , uint64_t offset , int c , double *v )
+{
+    uint64_t pos = offset + sizeof( h );
+    for( int k = 0 ; k < c ; k++ ) pos += h.bytes[k];
+
+    buf.resize( h.bytes[c] );
+    f.seekg( pos );
+    if( h.bytes[c] && !f.read( reinterpret_cast<char*>( buf.data() ) , h.bytes[c] ) ) return false;
+
+    return Recorder::decode( Recorder::Codec( h.codec[c] ) , buf.data() , buf.size() , v , int( h.rows ) );
+}
+
+bool RecordReader::read( int channel , double t0 , double t1 , std::vector<double> &t , std::vector<double> &v )
+{
+    t.clear();
+    v.clear();
+    if( channel < 0 || channel >= Recorder::Channels ) return false;
+
+    /// pierwszy blok konczacy sie nie wczesniej niz t0
+    size_t i = std::lower_bound( index.begin() , index.end() , t0 ,
+                                 []( Recorder::IndexEntry const &e , double x ){ return e.t_last < x; } ) - index.begin();
+
+    for( ; i < index.size() && index[i].t_first <= t1 ; i++ )
+    {
+        Recorder::BlockHeader h;
+        f.seekg( index[i].offset );
+        if( !f.read( reinterpret_cast<char*>( &h ) , sizeof( h ) ) || h.magic != Recorder::block_magic )
+        {
+            std::cerr << "RecordReader: " << name << ": bad block " << i << std::endl;
+            return false;
+        }
+
+        tcol.resize( h.rows );
+        vcol.resize( h.rows );
+        if( !read_column( h , index[i].offset , Recorder::C_t , tcol.data() ) ||
+            ( channel != Recorder::C_t && !read_column( h , index[i].offset , channel , vcol.data() ) ) )
+        {
+            std::cerr << "RecordReader: " << name << ": corrupt block " << i << std::endl;
+            return false;
+        }
+        double const *val = channel == Recorder::C_t ? tcol.data() : vcol.data();
+
+        for( uint32_t k = 0 ; k < h.rows ; k++ )
+            if( tcol[k] >= t0 && tcol[k] <= t1 )
+            {
+                t.push_back( tcol[k] );
+                v.push_back( val[k] );
+            }
+    }
+    return true;
+}
@@ -0,0 +1,170 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <Engine.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/// Kolumnowy rejestrator przebiegow z kompresja , do dlugich symulacji.
+///
+/// Wiersz to wszystkie kanaly ( Channel ) z jednego kroku. Wiersze trafiaja do
+/// bloku kolumnowego ( kanal po kanale ); pelny blok przejmuje watek zapisu ,
+/// ktory kompresuje kazda kolumne i zapisuje blok jednym duzym write. Watek
+/// symulacji tylko kopiuje liczby - czeka ( stalls ) jedynie wtedy , gdy wszystkie
+/// bloki czekaja na zapis.
+///
+/// Kolumna kodowana jest bitowo na dwa sposoby , zostaje krotszy:
+///  - XOR z poprzednia wartoscia ( jak Gorilla ) - dla wartosci stalych i skokow ,
+///  - delta drugiego rzedu na bitach liczby ( int64 ) - dla przebiegow gladkich ,
+///    w ktorych XOR zostawia szum ostatnich bitow mantysy.
+/// Oba sa bezstratne - odczyt zwraca te same bity.
+///
+/// Plik: naglowek , bloki ( kazdy z wlasnym naglowkiem: wiersze , zakres czasu ,
+/// rozmiary kolumn ) i na koncu indeks blokow. Bez indeksu ( przerwany zapis )
+/// RecordReader odtwarza go z naglowkow blokow.
+class Recorder
+{
+public:
+    enum Channel
+    {
+        C_t , C_H_alt , C_Mach , C_n_wc , C_throttle ,
+        C_TH , C_T1s , C_T2s , C_T3s , C_T4s , C_T5s ,
+        C_ph , C_p1s , C_p2s , C_p3s , C_p4s , C_p5s ,
+        C_mh , C_m1  , C_m2  , C_m3  , C_m4  , C_m5  ,
+        C_ch , C_c1  , C_c2  , C_c3  , C_c4  , C_c5  ,
+        C_P_turbine , C_P_free ,
+        Channels
+    };
+
+    static const char *channel_name( int c );
+    static int channel( const char *name );         ///< -1 - nie ma takiego
+
+    /// Block_rows - wiersze w bloku , Blocks - bloki w obiegu miedzy watkami
+    explicit Recorder( int Block_rows = 8192 , int Blocks = 4 );
+    ~Recorder();                                    ///< close()
+
+    bool open( const char *path );                  ///< false - blad ( opis na cerr )
+    bool close();                                   ///< false - blad zapisu
+
+    /// Wiersz z silnika po Engine::update
+    void record( Engine const &eng , double t , double H_alt );
+    void record( double const row[Channels] );
+
+    uint64_t rows()    const { return nrows; }
+    uint64_t bytes()   const { return written.load( std::memory_order_relaxed ); }
+    uint64_t stalls()  const { return nstalls; }    ///< ile razy record czekal na wolny blok
+
+    /// Naglowek pliku , bloku i pozycja indeksu - wspolne z RecordReader
+    struct FileHeader  { uint32_t magic , version , channels , block_rows; };
+    struct BlockHeader
+    {
+        uint32_t magic , rows;
+        double   t_first , t_last;
+        uint32_t bytes[Channels];
+        uint8_t  codec[Channels];
+    };
+    struct IndexEntry  { uint64_t offset; double t_first , t_last; uint64_t rows; };
+    struct Tail        { uint64_t index_offset; uint32_t blocks , magic; };
+
+    static const uint32_t file_magic  = 0x52454D44;  ///< "DMER"
+    static const uint32_t block_magic = 0x42454D44;  ///< "DMEB"
+    static const uint32_t index_magic = 0x49454D44;  ///< "DMEI"
+    static const uint32_t version     = 1;
+
+    enum Codec { Xor , Delta };
+
+    /// Kompresja / dekompresja jednej kolumny ( n wartosci )
+    static Codec encode( double const *v , int n , std::vector<uint8_t> &out );
+    static bool  decode( Codec c , uint8_t const *p , size_t bytes , double *v , int n );
+
+private:
+    Recorder( Recorder const & );
+    Recorder & operator=( Recorder const & );
+
+    struct Block
+    {
+        std::vector<double> col;                    ///< Channels x block_rows
+        int rows;
+    };
+
+    void submit();
+    void writer();
+    bool write_block( Block const &b );
+
+    int block_rows;
+    std::vector<Block> blocks;
+    int cur;                                        ///< blok wypelniany , -1 - brak
+
+    std::ofstream f;
+    uint64_t offset;
+    std::vector<IndexEntry> index;
+    std::vector<uint8_t> out , col;
+
+    std::thread thread;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<int> free_q , full_q;
+    bool quit , failed , opened;
+
+    uint64_t nrows , nstalls;
+    std::atomic<uint64_t> written;
+};
+
+/// Odczyt pliku rejestratora - kanal w zakresie czasu bez rozpakowywania calosci.
+class RecordReader
+{
+public:
+    RecordReader();
+
+    bool open( const char *path );                  ///< false - blad ( opis na cerr )
+
+    uint64_t rows()    const;
+    int      blocks()  const { return int( index.size() ); }
+    double   t_begin() const { return index.empty() ? 0.0 : index.front().t_first; }
+    double   t_end()   const { return index.empty() ? 0.0 : index.back().t_last;  }
+    bool     recovered() const { return scanned; }  ///< indeks odtworzony z naglowkow blokow
+
+    /// Wartosci kanalu dla t0 <= t <= t1 ; czyta tylko bloki nachodzace na zakres
+    /// i tylko kolumny czasu i kanalu
+    bool read( int channel , double t0 , double t1 , std::vector<double> &t , std::vector<double> &v );
+
+private:
+    bool read_column( Recorder::BlockHeader const &h , uint64_t offset , int c , double *v );
+
+    std::ifstream f;
+    std::string name;
+    std::vector<Recorder::IndexEntry> index;
+    std::vector<uint8_t> buf;
+    std::vector<double> tcol , vcol;
+    bool scanned;
+};
+
+#endif // RECORDER_H
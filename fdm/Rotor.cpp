@@ -0,0 +1,79 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Rotor.h"
+
+namespace
+{
+
+double const Omega_min = 1.0;       ///< [rad/s] - dolne ograniczenie mianownika bilansu
+
+}
+
+Rotor::Rotor()
+{
+    inertia    = 4000.0;
+    ratio      = 80.0;
+    eta_g      = 0.98;
+    P_r        = 700000.0;
+    Omega_r    = 27.0;
+    c_min      = 0.3;
+    collective = 0.5;
+
+    init( Omega_r );
+}
+
+void Rotor::init( double Omega0 )
+{
+    Omega  = Omega0;
+    P_in   = 0.0;
+    P_load = load( Omega );
+}
+
+void Rotor::set_load( double P_ref , double Omega_ref , double C_min )
+{
+    P_r     = P_ref;
+    Omega_r = Omega_ref;
+    c_min   = C_min;
+}
+
+double Rotor::load( double W ) const
+{
+    double x = W / Omega_r;
+    return P_r * ( c_min + ( 1.0 - c_min ) * collective ) * x * x * x;
+}
+
+double Rotor::accel( double P_shaft , double W ) const
+{
+    double Wd = W > Omega_min ? W : Omega_min;
+    return ( eta_g * P_shaft - load( W ) ) / ( inertia * Wd );
+}
+
+void Rotor::update( double P_shaft , double dt )
+{
+    P_in   = eta_g * P_shaft;
+    P_load = load( Omega );
+
+    Omega += accel( P_shaft , Omega ) * dt;
+    if( Omega < 0.0 ) Omega = 0.0;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef ROTOR_H
+#define ROTOR_H
+
+/// Wirnik nosny z przekladnia - wspolne obciazenie turbin swobodnych.
+///
+/// Stan: predkosc katowa wirnika Omega [rad/s]. Bilans mocy na wale:
+///     J Omega dOmega/dt = eta_g sum( P_i ) - P_load( Omega )
+/// P_load = P_ref ( c_min + ( 1 - c_min ) collective ) ( Omega / Omega_ref )^3 -
+/// moc profilowa i indukowana przy stalym skoku ogolnym rosnie z szescianem
+/// predkosci. Turbiny swobodne kreca sie z predkoscia ratio * Omega.
+class Rotor
+{
+public:
+    Rotor();
+
+    void init( double Omega0 );                             ///< [rad/s]
+
+    void set_inertia( double J ) { inertia = J; }           ///< [kg m2]
+    void set_gear( double Ratio , double Eta ) { ratio = Ratio; eta_g = Eta; }
+    void set_load( double P_ref , double Omega_ref , double C_min );
+    void set_collective( double C ) { collective = C; }     ///< [0 , 1]
+
+    double load( double Omega ) const;                      ///< [W] - zapotrzebowanie wirnika
+
+    /// dOmega/dt [rad/s2] przy predkosci W dla sumy mocy turbin swobodnych P_shaft [W]
+    double accel( double P_shaft , double W ) const;
+
+    /// Krok dt [s] dla sumy mocy turbin swobodnych P_shaft [W]
+    void update( double P_shaft , double dt );
+
+    double get_Omega()     const { return Omega; }
+    double get_Omega_ref() const { return Omega_r; }
+    double get_n_ft()      const { return ratio * Omega; }  ///< [rad/s] - turbiny swobodne
+    double get_P_in()      const { return P_in; }           ///< [W] - za przekladnia
+    double get_P_load()    const { return P_load; }
+    double get_collective()const { return collective; }
+    double get_ratio()     const { return ratio; }
+    double get_eta_g()     const { return eta_g; }
+
+    template <class Archive> void serialize( Archive &ar )
+    {
+        ar & inertia & ratio & eta_g & P_r & Omega_r & c_min & collective & Omega & P_in & P_load;
+    }
+
+private:
+    double inertia;
+    double ratio;
+    double eta_g;
+    double P_r;                 ///< [W] - moc przy Omega_ref i pelnym skoku
+    double Omega_r;
+    double c_min;               ///< udzial mocy przy zerowym skoku
+    double collective;
+
+    double Omega;
+    double P_in;
+    double P_load;
+};
+
+#endif // ROTOR_H
@@ -0,0 +1,139 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Scenario.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdlib.h>
+
+namespace
+{
+
+void fail( const char *path , std::string const &msg )
+{
+    std::cerr << "Scenario: " << path << ": " << msg << std::endl;
+}
+
+/// Wiersz bez komentarza , separatory CSV zamienione na spacje
+std::string clean( std::string line )
+{
+    size_t c = line.find( '#' );
+    if( c != std::string::npos ) line.erase( c );
+    for( size_t i = 0 ; i < line.size() ; i++ )
+        if( line[i] == ',' || line[i] == ';' || line[i] == '\t' || line[i] == '\r' ) line[i] = ' ';
+    return line;
+}
+
+}
+
+Scenario::Scenario()
+{
+    dt = 0.0;
+}
+
+bool Scenario::read( const char *path )
+{
+    t.clear(); H.clear(); Ma.clear(); thr.clear(); n.clear();
+    dt = 0.0;
+
+    std::ifstream in( path );
+    if( !in ) { fail( path , "cannot open" ); return false; }
+
+    std::string line;
+    int row = 0;
+    int cols = 0;
+
+    while( std::getline( in , line ) )
+    {
+        row++;
+        std::istringstream ss( clean( line ) );
+        std::string word;
+        if( !( ss >> word ) ) continue;
+
+        char *end = 0;
+        double v = strtod( word.c_str() , &end );
+
+        if( *end )
+        {
+            if( word != "dt" || !( ss >> dt ) || dt <= 0.0 )
+            {
+                fail( path , "bad entry at line " + std::to_string( row ) );
+                return false;
+            }
+            continue;
+        }
+
+        double vals[5] = { v , 0.0 , 0.0 , 0.0 , 0.0 };
+        int k = 1;
+        while( k < 5 && ss >> vals[k] ) k++;
+        ss >> std::ws;                  /// spacje po 5. kolumnie ( po usunieciu komentarza , CR )
+
+        if( k < 4 || !ss.eof() || ( cols && k != cols ) )
+        {
+            fail( path , "expected 4 or 5 columns at line " + std::to_string( row ) );
+            return false;
+        }
+        if( !t.empty() && vals[0] <= t.back() )
+        {
+            fail( path , "time not increasing at line " + std::to_string( row ) );
+            return false;
+        }
+        cols = k;
+
+        t.push_back( vals[0] );
+        H.push_back( vals[1] );
+        Ma.push_back( vals[2] );
+        thr.push_back( vals[3] );
+        if( k == 5 ) n.push_back( vals[4] );
+    }
+
+    if( t.empty() ) { fail( path , "no data" ); return false; }
+    return true;
+}
+
+Scenario::Input Scenario::at( double tt , TableCursor<double> &cur ) const
+{
+    Input in;
+    int m = rows();
+
+    if( m == 1 || tt <= t.front() || tt >= t.back() )
+    {
+        int i = ( m == 1 || tt <= t.front() ) ? 0 : m - 1;
+        in.H_alt    = H[i];
+        in.Mach     = Ma[i];
+        in.throttle = thr[i];
+        in.n_wc     = n.empty() ? 0.0 : n[i];
+        return in;
+    }
+
+    int i = cur.locate( tt , t.data() , m );
+    double w = ( tt - t[i] ) / ( t[i+1] - t[i] );
+
+    in.H_alt    = H[i]   + ( H[i+1]   - H[i] )   * w;
+    in.Mach     = Ma[i]  + ( Ma[i+1]  - Ma[i] )  * w;
+    in.throttle = thr[i] + ( thr[i+1] - thr[i] ) * w;
+    in.n_wc     = n.empty() ? 0.0 : n[i] + ( n[i+1] - n[i] ) * w;
+    return in;
+}
@@ -0,0 +1,71 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <Table.h>
+#include <vector>
+
+/// Scenariusz przebiegu - historia czasowa wejsc silnika.
+///
+/// Plik tekstowy , wiersz danych: t [s] , H [m] , Mach , throttle i opcjonalnie
+/// n_wc [rad/s] ( we wszystkich wierszach albo w zadnym ); czas rosnacy.
+/// Pary "nazwa wartosc": dt [s] - krok ( domyslnie podany przez wywolujacego ).
+/// Separatory i komentarze jak w decku tekstowym:
+///
+///     dt 0.001
+///     # t     H      Mach  throttle  n_wc
+///     0       0      0.0   0.3       3000
+///     20      1500   0.25  0.8       4200
+///
+/// Miedzy wierszami wejscia interpolowane liniowo , poza zakresem stale.
+class Scenario
+{
+public:
+    struct Input
+    {
+        double H_alt;           ///< [m]
+        double Mach;
+        double throttle;
+        double n_wc;            ///< [rad/s] - 0 gdy scenariusz go nie podaje
+    };
+
+    Scenario();
+
+    bool read( const char *path );              ///< false - blad ( opis na cerr )
+
+    int    rows()    const { return int( t.size() ); }
+    double t_begin() const { return t.empty() ? 0.0 : t.front(); }
+    double t_end()   const { return t.empty() ? 0.0 : t.back(); }
+    double get_dt()  const { return dt; }       ///< 0 - nie podany
+    bool   has_n_wc()const { return !n.empty(); }
+
+    /// Wejscia w chwili tt; kursor pamieta przedzial ( kolejne chwile rosna )
+    Input at( double tt , TableCursor<double> &cur ) const;
+
+private:
+    std::vector<double> t , H , Ma , thr , n;
+    double dt;
+};
+
+#endif // SCENARIO_H
@@ -0,0 +1,121 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+/// Binarny zapis stanu symulacji ( Engine::save / Engine::restore ).
+///
+/// Bufor ma stala pojemnosc: zapis tylko kopiuje bajty pod kolejne
+/// przesuniecia , wiec kolejne migawki tego samego silnika nie alokuja.
+/// Bufor rosnie tylko wtedy , gdy stan sie nie miesci ( pierwszy zapis ).
+/// Format to surowe bajty pol w kolejnosci serialize() - migawka jest wazna
+/// dla tej samej wersji programu i tego samego decku , nie do archiwizacji.
+class Snapshot
+{
+public:
+    explicit Snapshot( size_t Capacity = 1024 ) : buf( Capacity ) , used( 0 ) {}
+
+    void clear()                        { used = 0; }
+    size_t size() const                 { return used; }
+    size_t capacity() const             { return buf.size(); }
+    unsigned char const *data() const   { return buf.data(); }
+    unsigned char       *data()         { return buf.data(); }
+
+    /// Miejsce na n bajtow na koncu
+    unsigned char *append( size_t n )
+    {
+        if( used + n > buf.size() ) buf.resize( 2 * ( used + n ) );
+        unsigned char *p = buf.data() + used;
+        used += n;
+        return p;
+    }
+
+    /// Kopia z zewnetrznego bufora ( np. z pliku )
+    void assign( void const *p , size_t n )
+    {
+        used = 0;
+        memcpy( append( n ) , p , n );
+    }
+
+private:
+    std::vector<unsigned char> buf;
+    size_t used;
+};
+
+/// Archiwum zapisu - ar & x dopisuje bajty x
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter( Snapshot &S ) : s( S ) {}
+
+    bool loading() const { return false; }
+    bool ok() const      { return true; }
+
+    template <class T> SnapshotWriter &operator&( T const &v )
+    {
+        static_assert( std::is_trivially_copyable<T>::value , "Snapshot: trivially copyable fields only" );
+        memcpy( s.append( sizeof( T ) ) , &v , sizeof( T ) );
+        return *this;
+    }
+
+private:
+    Snapshot &s;
+};
+
+/// Archiwum odczytu - ar & x czyta bajty do x; za koncem bufora nic nie
+/// zmienia i ustawia blad ( ok() == false )
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader( Snapshot const &S ) : s( S ) , pos( 0 ) , good( true ) {}
+
+    bool loading() const { return true; }
+    bool ok() const      { return good; }
+    bool at_end() const  { return pos == s.size(); }
+
+    template <class T> SnapshotReader &operator&( T &v )
+    {
+        static_assert( std::is_trivially_copyable<T>::value , "Snapshot: trivially copyable fields only" );
+        if( !good || pos + sizeof( T ) > s.size() )
+        {
+            good = false;
+            return *this;
+        }
+        memcpy( &v , s.data() + pos , sizeof( T ) );
+        pos += sizeof( T );
+        return *this;
+    }
+
+private:
+    Snapshot const &s;
+    size_t pos;
+    bool   good;
+};
+
+#endif // SNAPSHOT_H
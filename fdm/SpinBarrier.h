@@ -0,0 +1,81 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SPINBARRIER_H
+#define SPINBARRIER_H
+
+#include <atomic>
+#include <thread>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+/// Bariera dla stalej grupy n watkow , czekanie aktywne.
+///
+/// Ostatni przychodzacy zeruje licznik i zwieksza pokolenie; pozostali czekaja
+/// na zmiane pokolenia ( jedno slowo atomowe , bez muteksu i wywolan systemu ).
+/// Po spin_limit obrotach watek oddaje procesor ( yield ) - gdy watkow jest
+/// wiecej niz rdzeni , bariera nie blokuje systemu.
+class SpinBarrier
+{
+public:
+    explicit SpinBarrier( int N , int Spin_limit = 1 << 10 )
+        : n( N ) , spin_limit( Spin_limit ) , count( 0 ) , generation( 0 ) {}
+
+    void wait()
+    {
+        unsigned g = generation.load( std::memory_order_acquire );
+
+        if( count.fetch_add( 1 , std::memory_order_acq_rel ) == n - 1 )
+        {
+            count.store( 0 , std::memory_order_relaxed );
+            generation.store( g + 1 , std::memory_order_release );
+            return;
+        }
+
+        int spins = 0;
+        while( generation.load( std::memory_order_acquire ) == g )
+        {
+            if( ++spins < spin_limit )
+                pause();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    static void pause()
+    {
+#if defined( __x86_64__ ) || defined( __i386__ )
+        _mm_pause();
+#endif
+    }
+
+    int const n;
+    int const spin_limit;
+
+    alignas( 64 ) std::atomic<int>      count;
+    alignas( 64 ) std::atomic<unsigned> generation;
+};
+
+#endif // SPINBARRIER_H
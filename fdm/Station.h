@@ -0,0 +1,115 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef STATION_H
+#define STATION_H
+
+#include <enginedata.h>
+#include <cmath>
+
+/// Wzory przekrojow silnika dla jednego punktu pracy.
+///
+/// Wspolne dla elementow silnika ( Intake::update_intake , Compressor::update_compressor ,
+/// CombustionChamber::update_comchamber , Turbine::update_turbine , Turbine_f::update_turbine_f ),
+/// stopni Pipeline i skalarnej sciezki StationKernels. Odczyt charakterystyk
+/// i opoznienie komory zostaja u wywolujacego. T - double albo float; dla double
+/// kolejnosc dzialan jak w elementach silnika - Engine::update i TurboShaftPipeline
+/// daja identyczne wyniki. pow / sqrt bez kwalifikacji ( using std::pow ) - dla
+/// T = Dual<N> ( Dual.h ) wybierane sa przeciazenia dualne , tak CycleSolver
+/// liczy przez te same wzory jakobian i sensitivities().
+namespace Station
+{
+    /// Wspolczynniki strat modelu
+    static double const sigma_H1 = 0.96;        ///< [-] - odzysk cisnienia spietrzenia we wlocie
+    static double const sig_34   = 0.9578;      ///< [-] - odzysk cisnienia w komorze spalania
+    static double const eta_Twc  = 0.99;        ///< [-] - sprawnosc turbiny sprezarki
+
+    /// T1 , pH_s ( spietrzenie otoczenia ) , p1 , c1
+    template <class T> inline void intake( T TH , T pH , T Ma , T sigma ,
+                                           T &T1 , T &pH_s , T &p1 , T &c1 )
+    {
+        using namespace EngineConst;
+        using std::pow;
+        using std::sqrt;
+
+        T b_Ma2 = T( 1.0 ) + T( ( k_p - 1.0 ) / 2.0 ) * Ma * Ma;
+
+        T1   = TH * b_Ma2;
+        pH_s = pH * pow( b_Ma2 , T( k_p / ( k_p - 1.0 ) ) );
+        p1   = sigma * pH_s;
+        c1   = sqrt( ( T1 - TH ) * T( 2.0 ) * T( k_p ) / T( k_p - 1.0 ) * T( R_p ) );
+    }
+
+    /// T3 , p3 , m3 dla odczytanych z charakterystyki sprez , eta , mZR
+    template <class T> inline void compressor( T T2 , T p2 , T sprez , T eta , T mZR ,
+                                               T &T3 , T &p3 , T &m3 )
+    {
+        using namespace EngineConst;
+        using std::pow;
+        using std::sqrt;
+
+        m3 = mZR * ( p2 / T( p0 ) ) * sqrt( T( T0 ) / T2 );
+        p3 = sprez * p2;
+        T3 = T2 * ( T( 1.0 ) + ( pow( sprez , T( ( k_p - 1.0 ) / k_p ) ) - T( 1.0 ) ) * T( 1.0 ) / eta );
+    }
+
+    /// p4 , T4_tt ( przed opoznieniem cieplnym komory ) , c4 , m4
+    template <class T> inline void chamber( T p3 , T T3 , T m3 , T c3 , T q_pal , T sig ,
+                                            T eta_ks , T W_opal , T Cp ,
+                                            T &p4 , T &T4_tt , T &c4 , T &m4 )
+    {
+        using namespace EngineConst;
+
+        p4    = sig * p3;
+        T4_tt = T( 1.0 ) / m3 * ( q_pal * eta_ks * W_opal ) / Cp + T3;
+        c4    = ( T( 1.0 ) - p4 / p3 ) * T( R_s ) * T3 / c3 + c3;
+        m4    = m3 + q_pal;
+    }
+
+    /// p5 , T5 , c5 , Pt ; T5 na wejsciu - stan z poprzedniego kroku ( p5 liczone z niego )
+    template <class T> inline void turbine( T p4 , T T4 , T m4 , T eps , T eta , T A_t , T Cp ,
+                                            T &p5 , T &T5 , T &c5 , T &Pt )
+    {
+        using namespace EngineConst;
+        using std::pow;
+
+        p5 = p4 * pow( T5 / T4 , T( k_s / ( k_s - 1.0 ) ) );
+        T5 = T4 * ( T( 1.0 ) - ( T( 1.0 ) - pow( eps , T( ( 1.0 - k_s ) / k_s ) ) ) * eta );
+
+        T ro_T = p5 / ( T( R_s ) * T5 );
+
+        c5 = m4 / ( ro_T * A_t );
+        Pt = m4 * Cp * ( T4 - T5 );
+    }
+
+    /// T6 , wpt - turbina swobodna rozprezajaca do p0
+    template <class T> inline void turbine_f( T p5 , T T5 , T Cp , T &T6 , T &wpt )
+    {
+        using namespace EngineConst;
+        using std::pow;
+
+        T6  = T5 * pow( T( p0 ) / p5 , T( ( k_s - 1.0 ) / k_s ) );
+        wpt = Cp * ( T5 - T6 );
+    }
+}
+
+#endif // STATION_H
@@ -0,0 +1,373 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "StationKernels.h"
+#include <enginedata.h>
+#include <Station.h>
+#include <math.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace EngineConst;
+
+namespace StationKernels
+{
+#if defined( DME_KERNELS_X86 )
+    extern Table const table_avx2;
+    extern Table const table_avx512;
+
+    extern TableF const table_avx2_f;
+    extern TableF const table_avx512_f;
+#endif
+}
+
+namespace
+{
+
+/// Sciezka skalarna - wzory elementow silnika ( Station.h ) punkt po punkcie
+
+template <class T> void s_intake( int n , const T *TH , const T *pH , const T *Ma ,
+                                  T sigma_H1 , T *T1 , T *p1 , T *c1 )
+{
+    T pH_s;
+    for( int i = 0 ; i < n ; i++ )
+        Station::intake( TH[i] , pH[i] , Ma[i] , sigma_H1 , T1[i] , pH_s , p1[i] , c1[i] );
+}
+
+template <class T> void s_compressor( int n , const T *T2 , const T *p2 ,
+                                      const T *sprez , const T *eta , const T *mZR ,
+                                      T *T3 , T *p3 , T *m3 )
+{
+    for( int i = 0 ; i < n ; i++ )
+        Station::compressor( T2[i] , p2[i] , sprez[i] , eta[i] , mZR[i] , T3[i] , p3[i] , m3[i] );
+}
+
+template <class T> void s_turbine( int n , const T *p4 , const T *T4 , const T *m4 ,
+                                   const T *eps , T eta_Twc , T A_t , T Cp ,
+                                   T *p5 , T *T5 , T *c5 , T *Pt )
+{
+    for( int i = 0 ; i < n ; i++ )
+        Station::turbine( p4[i] , T4[i] , m4[i] , eps[i] , eta_Twc , A_t , Cp , p5[i] , T5[i] , c5[i] , Pt[i] );
+}
+
+template <class T> void s_turbine_f( int n , const T *p5 , const T *T5 , T Cp ,
+                                     T *T6 , T *wpt )
+{
+    for( int i = 0 ; i < n ; i++ )
+        Station::turbine_f( p5[i] , T5[i] , Cp , T6[i] , wpt[i] );
+}
+
+template <class T> void s_pow( int n , const T *x , T e , T *y )
+{
+    for( int i = 0 ; i < n ; i++ )
+        y[i] = std::pow( x[i] , e );
+}
+
+/// Przedzial szukany od poczatku ( kilkanascie wezlow ) i interpolacja w nim -
+/// k_map sumuje przedzialy , wyniki rowne z dokladnoscia zaokraglen
+template <class T> void s_map( int n , const T *x , const T *T_in , T scale , T *x_zr ,
+                               StationKernels::BasicMap<T> const &m , T * const *y )
+{
+    for( int i = 0 ; i < n ; i++ )
+    {
+        T a = x[i];
+        if( T_in ) { a = a * std::sqrt( T( T0 ) / T_in[i] ); x_zr[i] = a; }
+        a = a * scale;
+
+        if( m.segs < 1 )
+        {
+            for( int c = 0 ; c < m.cols ; c++ ) y[c][i] = m.y0[c];
+            continue;
+        }
+
+        int k = 0;
+        while( k + 1 < m.segs && a > m.hi[k] ) k++;
+
+        T t = a > m.lo[k] ? a : m.lo[k];
+        t = ( t < m.hi[k] ? t : m.hi[k] ) - m.lo[k];
+        for( int c = 0 ; c < m.cols ; c++ ) y[c][i] = m.y[c][k] + t * m.slope[c][k];
+    }
+}
+
+template <class T> void s_chamber( int n , const T *p3 , const T *T3 , const T *m3 , const T *c3 , const T *q ,
+                                   T q_k , T sig_34 , T k_T , T *primed , T *T_ch ,
+                                   T *p4 , T *T4 , T *m4 , T *c4 )
+{
+    for( int i = 0 ; i < n ; i++ )
+    {
+        p4[i] = sig_34 * p3[i];
+
+        T T4_tt = q[i] * q_k / m3[i] + T3[i];
+
+        c4[i] = ( T( 1.0 ) - p4[i] / p3[i] ) * T( R_s ) * T3[i] / c3[i] + c3[i];
+
+        T Tc = primed[i] > T( 0 ) ? T_ch[i] : T4_tt;
+        Tc = Tc + ( T4_tt - Tc ) * k_T;
+        T_ch[i]   = Tc;
+        T4[i]     = Tc;
+        m4[i]     = m3[i] + q[i];
+        primed[i] = T( 1 );
+    }
+}
+
+StationKernels::Table const table_scalar =
+{
+    s_intake<double> , s_compressor<double> , s_turbine<double> , s_turbine_f<double> , s_pow<double> ,
+    s_map<double> , s_chamber<double>
+};
+
+StationKernels::TableF const table_scalar_f =
+{
+    s_intake<float> , s_compressor<float> , s_turbine<float> , s_turbine_f<float> , s_pow<float> ,
+    s_map<float> , s_chamber<float>
+};
+
+StationKernels::Isa current = StationKernels::detect();
+
+template <class T> double rel_err( T const *a , T const *b , int n )
+{
+    double err = 0.0;
+    for( int i = 0 ; i < n ; i++ )
+    {
+        /// NaN tylko po jednej stronie - wariant nie zachowuje sie jak std::pow
+        if( std::isnan( double( a[i] ) ) || std::isnan( double( b[i] ) ) )
+        {
+            if( std::isnan( double( a[i] ) ) != std::isnan( double( b[i] ) ) ) return HUGE_VAL;
+            continue;
+        }
+        double d = fabs( double( a[i] ) - double( b[i] ) ) / ( fabs( double( b[i] ) ) > 0.0 ? fabs( double( b[i] ) ) : 1.0 );
+        if( d > err ) err = d;
+    }
+    return err;
+}
+
+}
+
+StationKernels::Isa StationKernels::detect()
+{
+#if defined( DME_KERNELS_X86 )
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx512f" ) ) return Avx512;
+    if( __builtin_cpu_supports( "avx2" ) )    return Avx2;
+#endif
+    return Scalar;
+}
+
+StationKernels::Isa StationKernels::active()
+{
+    return current;
+}
+
+StationKernels::Isa StationKernels::select( Isa isa )
+{
+    Isa best = detect();
+    current = ( isa > best ) ? best : isa;
+    return current;
+}
+
+const char *StationKernels::name( Isa isa )
+{
+    switch( isa )
+    {
+        case Avx2:   return "AVX2";
+        case Avx512: return "AVX-512";
+        default:     return "scalar";
+    }
+}
+
+const StationKernels::Table &StationKernels::table( Isa isa )
+{
+#if defined( DME_KERNELS_X86 )
+    switch( isa )
+    {
+        case Avx2:   return table_avx2;
+        case Avx512: return table_avx512;
+        default:     break;
+    }
+#else
+    (void)isa;
+#endif
+    return table_scalar;
+}
+
+const StationKernels::TableF &StationKernels::table_f( Isa isa )
+{
+#if defined( DME_KERNELS_X86 )
+    switch( isa )
+    {
+        case Avx2:   return table_avx2_f;
+        case Avx512: return table_avx512_f;
+        default:     break;
+    }
+#else
+    (void)isa;
+#endif
+    return table_scalar_f;
+}
+
+namespace
+{
+
+/// Najwiekszy blad wzgledny vec wzgledem ref - wejscia liczone w double , zaokraglane do T
+template <class T> double check( StationKernels::BasicTable<T> const &ref ,
+                                 StationKernels::BasicTable<T> const &vec , int n )
+{
+    std::vector<T> in( 8 * n ) , out_r( 8 * n ) , out_v( 8 * n );
+    T *TH  = &in[0];     T *pH  = TH  + n;
+    T *Ma  = pH + n;     T *sp  = Ma  + n;
+    T *eta = sp + n;     T *mz  = eta + n;
+    T *T5  = mz + n;     T *eps = T5  + n;
+
+    /// obwiednia: H = 0..11 km , Ma = 0..0.9 , charakterystyki w typowych zakresach
+    for( int i = 0 ; i < n ; i++ )
+    {
+        double u = ( i + 0.5 ) / n;
+        double v = fmod( i * 0.6180339887498949 , 1.0 );
+
+        TH[i]  = T( 288.15 - 71.5 * u );
+        pH[i]  = T( 101325.0 * pow( double( TH[i] ) / 288.15 , 5.2559 ) );
+        Ma[i]  = T( 0.9 * v );
+        sp[i]  = T( 1.0 + 7.0 * v );
+        eta[i] = T( 0.6 + 0.3 * u );
+        mz[i]  = T( 0.2 + 2.0 * u );
+        T5[i]  = T( 600.0 + 500.0 * v );
+        eps[i] = T( 1.05 + 4.0 * u );
+    }
+
+    double err = 0.0;
+    double e;
+
+    T *r0 = &out_r[0] , *r1 = r0 + n , *r2 = r1 + n , *r3 = r2 + n;
+    T *v0 = &out_v[0] , *v1 = v0 + n , *v2 = v1 + n , *v3 = v2 + n;
+
+    ref.intake( n , TH , pH , Ma , T( Station::sigma_H1 ) , r0 , r1 , r2 );
+    vec.intake( n , TH , pH , Ma , T( Station::sigma_H1 ) , v0 , v1 , v2 );
+    e = rel_err( v0 , r0 , 3 * n );   if( e > err ) err = e;
+
+    ref.compressor( n , r0 , r1 , sp , eta , mz , r0 + 3*n , r1 + 3*n , r2 + 3*n );
+    vec.compressor( n , r0 , r1 , sp , eta , mz , v0 + 3*n , v1 + 3*n , v2 + 3*n );
+    e = rel_err( v0 + 3*n , r0 + 3*n , 3 * n );   if( e > err ) err = e;
+
+    /// turbina nadpisuje T5 - kazdy wariant na swojej kopii
+    std::vector<T> T5r( T5 , T5 + n ) , T5v( T5 , T5 + n );
+    std::vector<T> T4( n ) , p4( n );
+    for( int i = 0 ; i < n ; i++ ) { T4[i] = T5[i] + T( 250.0 ); p4[i] = T( 3.0e5 ) + T( 5.0e5 ) * eta[i]; }
+
+    ref.turbine( n , &p4[0] , &T4[0] , mz , eps , T( 0.89 ) , T( 0.05 ) , T( 1172.3 ) , r0 , &T5r[0] , r1 , r2 );
+    vec.turbine( n , &p4[0] , &T4[0] , mz , eps , T( 0.89 ) , T( 0.05 ) , T( 1172.3 ) , v0 , &T5v[0] , v1 , v2 );
+    e = rel_err( v0 , r0 , 3 * n );           if( e > err ) err = e;
+    e = rel_err( &T5v[0] , &T5r[0] , n );     if( e > err ) err = e;
+
+    ref.turbine_f( n , r0 , &T5r[0] , T( 1172.3 ) , r3 , r3 + n );
+    vec.turbine_f( n , r0 , &T5r[0] , T( 1172.3 ) , v3 , v3 + n );
+    e = rel_err( v3 , r3 , n );               if( e > err ) err = e;
+
+    /// wpt jest roznica dwoch bliskich temperatur - blad odniesiony do Cp * T5
+    for( int i = 0 ; i < n ; i++ )
+    {
+        e = fabs( double( v3[n+i] ) - double( r3[n+i] ) ) / ( 1172.3 * T5r[i] );
+        if( e > err ) err = e;
+    }
+
+    /// charakterystyka: predkosc zredukowana i wartosci przed , w i za tablica ,
+    /// trzy kolumny; argument wprost ( T_in == 0 ) - jedna kolumna
+    {
+        T const xt[8] = { T( 10000 ) , T( 15000 ) , T( 20000 ) , T( 25000 ) ,
+                          T( 30000 ) , T( 32000 ) , T( 40000 ) , T( 45000 ) };
+        T const y0[8] = { T( 1.2 ) , T( 1.6 ) , T( 2.2 ) , T( 3.0 ) , T( 4.0 ) , T( 5.2 ) , T( 6.1 ) , T( 6.6 ) };
+        T const y1[8] = { T( 0.60 ) , T( 0.68 ) , T( 0.74 ) , T( 0.78 ) , T( 0.80 ) , T( 0.81 ) , T( 0.80 ) , T( 0.78 ) };
+        T const y2[8] = { T( 0.3 ) , T( 0.6 ) , T( 0.9 ) , T( 1.2 ) , T( 1.5 ) , T( 1.8 ) , T( 2.0 ) , T( 2.1 ) };
+        T const * const ys[3] = { y0 , y1 , y2 };
+
+        std::vector<T> store;
+        StationKernels::BasicMap<T> m;
+        StationKernels::make_map( 8 , xt , ys , 3 , store , m );
+
+        std::vector<T> nw( n ) , zr( 2 * n ) , yr( 3 * n ) , yv( 3 * n );
+        for( int i = 0 ; i < n ; i++ ) nw[i] = T( 500.0 + 8500.0 * ( i + 0.5 ) / n );
+
+        T * const ry[3] = { &yr[0] , &yr[n] , &yr[2*n] };
+        T * const vy[3] = { &yv[0] , &yv[n] , &yv[2*n] };
+        ref.map( n , &nw[0] , T5 , T( 9.5492965964254 ) , &zr[0] , m , ry );
+        vec.map( n , &nw[0] , T5 , T( 9.5492965964254 ) , &zr[n] , m , vy );
+        e = rel_err( &zr[n] , &zr[0] , n );       if( e > err ) err = e;
+        e = rel_err( &yv[0] , &yr[0] , 3 * n );   if( e > err ) err = e;
+
+        m.cols = 1;
+        ref.map( n , eta , 0 , T( 45000.0 / 0.9 ) , 0 , m , ry );
+        vec.map( n , eta , 0 , T( 45000.0 / 0.9 ) , 0 , m , vy );
+        e = rel_err( &yv[0] , &yr[0] , n );       if( e > err ) err = e;
+    }
+
+    /// komora - polowa punktow juz zainicjowana
+    {
+        std::vector<T> q( n ) , c3( n ) , pr_r( n ) , pr_v( n ) , Tc_r( n ) , Tc_v( n ) , o_r( 4 * n ) , o_v( 4 * n );
+        for( int i = 0 ; i < n ; i++ )
+        {
+            q[i]  = T( 0.005 + 0.03 * eta[i] );
+            c3[i] = T( 80.0 + 100.0 * eta[i] );
+            pr_r[i] = pr_v[i] = T( i & 1 );
+            Tc_r[i] = Tc_v[i] = T( 900.0 + 300.0 * eta[i] );
+        }
+        T const q_k = T( 0.96 * 41868000.0 / 1172.3 );
+        ref.chamber( n , p4.data() , T5 , mz , &c3[0] , &q[0] , q_k , T( Station::sig_34 ) , T( 0.1 ) ,
+                     &pr_r[0] , &Tc_r[0] , &o_r[0] , &o_r[n] , &o_r[2*n] , &o_r[3*n] );
+        vec.chamber( n , p4.data() , T5 , mz , &c3[0] , &q[0] , q_k , T( Station::sig_34 ) , T( 0.1 ) ,
+                     &pr_v[0] , &Tc_v[0] , &o_v[0] , &o_v[n] , &o_v[2*n] , &o_v[3*n] );
+        e = rel_err( &o_v[0] , &o_r[0] , 4 * n );    if( e > err ) err = e;
+        e = rel_err( &Tc_v[0] , &Tc_r[0] , n );     if( e > err ) err = e;
+        e = rel_err( &pr_v[0] , &pr_r[0] , n );     if( e > err ) err = e;
+    }
+
+    /// potega poza dziedzina ( NaN , x < 0 , 0 ) i zapis tylko n punktow - za koncem
+    /// kolumny wartownik , ktorego zaden wariant nie moze nadpisac
+    int const pad = 16;
+    std::vector<T> x( n ) , y_r( n ) , y_v( n + pad , T( -7.0 ) );
+    for( int i = 0 ; i < n ; i++ )
+    {
+        double const c[] = { std::numeric_limits<double>::quiet_NaN() , -1.0 , 0.0 , 2.5 };
+        x[i] = T( i % 5 < 4 ? c[ i % 5 ] : 0.5 + 3.0 * i / n );
+    }
+    ref.pow_fixed( n , &x[0] , T( 1.4 / 0.4 ) , &y_r[0] );
+    vec.pow_fixed( n , &x[0] , T( 1.4 / 0.4 ) , &y_v[0] );
+    e = rel_err( &y_v[0] , &y_r[0] , n );     if( e > err ) err = e;
+    for( int i = n ; i < n + pad ; i++ )
+        if( y_v[i] != T( -7.0 ) ) return HUGE_VAL;
+
+    return err;
+}
+
+}
+
+double StationKernels::validate( Isa isa , int n )
+{
+    if( isa > detect() ) return 0.0;
+    return check( table_scalar , table( isa ) , n );
+}
+
+double StationKernels::validate_f( Isa isa , int n )
+{
+    if( isa > detect() ) return 0.0;
+    return check( table_scalar_f , table_f( isa ) , n );
+}
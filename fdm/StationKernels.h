@@ -0,0 +1,208 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef STATIONKERNELS_H
+#define STATIONKERNELS_H
+
+/// Wektorowe obliczenia przekrojow silnika dla wielu punktow pracy naraz.
+///
+/// Kazda funkcja liczy n niezaleznych punktow ( silnikow floty albo punktow
+/// obwiedni ) z kolumn wejsciowych do kolumn wyjsciowych - tak jak
+/// Intake::update_intake , Compressor::update_compressor , Turbine::update_turbine
+/// i Turbine_f::update_turbine_f; charakterystyki czyta map() ( BasicMap ) ,
+/// komore z opoznieniem liczy chamber(). Wariant jest wybierany w czasie pracy wg mozliwosci procesora:
+/// AVX2 ( 4 punkty ), AVX-512 ( 8 ), albo skalarny z std::pow ( SSE2 z 2 punktami
+/// nie byl szybszy od skalarnego ). Kazda funkcja ma tez wersje float ( TableF ) -
+/// 8 i 16 punktow w wektorze.
+///
+/// Potegi o stalych wykladnikach izentropy ( EngineConst::k_p , k_s ) liczone sa
+/// jako exp( e * log( x ) ) na wielomianach; blad wzgledny wzgledem sciezki
+/// skalarnej nie przekracza Tolerance ( patrz validate() ).
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define DME_KERNELS_X86 1
+#endif
+
+#include <cstddef>
+#include <vector>
+
+namespace StationKernels
+{
+    /// Charakterystyka odcinkowo liniowa bez szukania przedzialu:
+    /// y( x ) = y0 + sum_k slope[k] * ( min( max( x , lo[k] ) , hi[k] ) - lo[k] ).
+    /// Ta sama funkcja co interpolacja w przedziale ( poza tablica - wartosci
+    /// skrajne ) , wektorowo bez odczytow rozproszonych - wszystkie punkty
+    /// przechodza te same przedzialy. Dla tablic decku ( kilkanascie wezlow )
+    /// tansze od szukania przedzialu punkt po punkcie. Wariant skalarny szuka
+    /// przedzialu i interpoluje w nim ( wynik rowny z dokladnoscia zaokraglen ).
+    /// Dane w store ( make_map ).
+    template <class T> struct BasicMap
+    {
+        enum { MaxCols = 3 };
+
+        int segs;                       ///< liczba przedzialow ( wezly - 1 )
+        int cols;
+        T const *lo , *hi;              ///< granice przedzialow
+        T const *slope[MaxCols];        ///< nachylenia kolumn w przedzialach
+        T const *y[MaxCols];            ///< wartosci kolumn w wezlach ( segs + 1 )
+        T y0[MaxCols];                  ///< wartosci w pierwszym wezle
+    };
+
+    typedef BasicMap<double> Map;
+    typedef BasicMap<float>  MapF;
+
+    /// Przedzialy i nachylenia kolumn y[c] ( n wezlow x ) do store; m wskazuje na store.
+    /// n == 0 - mapa zer
+    template <class T> void make_map( int n , T const *x , T const * const y[] , int cols ,
+                                      std::vector<T> &store , BasicMap<T> &m )
+    {
+        int s = n > 1 ? n - 1 : 0;
+        store.assign( std::size_t( s ) * ( 2 + cols ) + std::size_t( s + 1 ) * cols , T( 0 ) );
+        T *p = &store[0];
+
+        m.segs = s;
+        m.cols = cols;
+        m.lo   = p;
+        m.hi   = p + s;
+        for( int k = 0 ; k < s ; k++ ) { p[k] = x[k]; p[s+k] = x[k+1]; }
+        for( int c = 0 ; c < cols ; c++ )
+        {
+            T *sl = p + ( 2 + c ) * s;
+            for( int k = 0 ; k < s ; k++ ) sl[k] = ( y[c][k+1] - y[c][k] ) / ( x[k+1] - x[k] );
+            T *yc = p + ( 2 + cols ) * s + c * ( s + 1 );
+            for( int k = 0 ; k < n ; k++ ) yc[k] = y[c][k];
+            m.slope[c] = sl;
+            m.y[c]     = yc;
+            m.y0[c]    = n > 0 ? y[c][0] : T( 0 );
+        }
+    }
+
+    enum Isa
+    {
+        Scalar = 0,
+        Avx2,
+        Avx512
+    };
+
+    static double const Tolerance  = 1.0e-13;   ///< [-] - dopuszczalny blad wzgledny
+    static double const ToleranceF = 1.0e-5;    ///< [-] - to samo dla float
+
+    /// Warianty dla typu obliczen T ( double albo float - dwa razy wiecej punktow w wektorze )
+    template <class T> struct BasicTable
+    {
+        void (*intake)( int n , const T *TH , const T *pH , const T *Ma ,
+                        T sigma_H1 , T *T1 , T *p1 , T *c1 );
+
+        void (*compressor)( int n , const T *T2 , const T *p2 ,
+                            const T *sprez , const T *eta , const T *mZR ,
+                            T *T3 , T *p3 , T *m3 );
+
+        void (*turbine)( int n , const T *p4 , const T *T4 , const T *m4 ,
+                         const T *eps , T eta_Twc , T A_t , T Cp ,
+                         T *p5 , T *T5 , T *c5 , T *Pt );
+
+        void (*turbine_f)( int n , const T *p5 , const T *T5 , T Cp ,
+                           T *T6 , T *wpt );
+
+        void (*pow_fixed)( int n , const T *x , T e , T *y );
+
+        /// x_zr = x sqrt( T0 / T_in ) ( predkosc zredukowana ) , y[c] = mapa( x_zr * scale );
+        /// T_in == 0 - y[c] = mapa( x * scale ) , x_zr nie jest zapisywane
+        void (*map)( int n , const T *x , const T *T_in , T scale , T *x_zr ,
+                     BasicMap<T> const &m , T * const *y );
+
+        /// Komora z opoznieniem cieplnym ( jak CombustionChamber::update_comchamber ):
+        /// p4 , T4 , m4 , c4 i stan T_ch; q_k = eta_ks W_opal / Cp , k_T - wzmocnienie
+        /// opoznienia. primed - 0 / 1 na punkt: punkt niezainicjowany startuje z T4
+        /// bez opoznienia
+        void (*chamber)( int n , const T *p3 , const T *T3 , const T *m3 , const T *c3 , const T *q ,
+                         T q_k , T sig_34 , T k_T , T *primed , T *T_ch ,
+                         T *p4 , T *T4 , T *m4 , T *c4 );
+    };
+
+    typedef BasicTable<double> Table;
+    typedef BasicTable<float>  TableF;
+
+    Isa detect();                       ///< najlepszy wariant dostepny na tym procesorze
+    Isa active();                       ///< aktualnie uzywany wariant
+    Isa select( Isa isa );              ///< wymuszenie wariantu ( ograniczone do detect() )
+    const char *name( Isa isa );
+
+    const Table  &table( Isa isa );
+    const TableF &table_f( Isa isa );
+
+    /// T1 , p1 , c1 - wylot wlotu
+    inline void intake( int n , const double *TH , const double *pH , const double *Ma ,
+                        double sigma_H1 , double *T1 , double *p1 , double *c1 )
+    { table( active() ).intake( n , TH , pH , Ma , sigma_H1 , T1 , p1 , c1 ); }
+
+    /// T3 , p3 , m3 - wylot sprezarki dla odczytanych z charakterystyki sprez , eta , mZR
+    inline void compressor( int n , const double *T2 , const double *p2 ,
+                            const double *sprez , const double *eta , const double *mZR ,
+                            double *T3 , double *p3 , double *m3 )
+    { table( active() ).compressor( n , T2 , p2 , sprez , eta , mZR , T3 , p3 , m3 ); }
+
+    /// p5 , T5 , c5 , Pt - wylot turbiny; T5 na wejsciu to stan z poprzedniego kroku
+    inline void turbine( int n , const double *p4 , const double *T4 , const double *m4 ,
+                         const double *eps , double eta_Twc , double A_t , double Cp ,
+                         double *p5 , double *T5 , double *c5 , double *Pt )
+    { table( active() ).turbine( n , p4 , T4 , m4 , eps , eta_Twc , A_t , Cp , p5 , T5 , c5 , Pt ); }
+
+    /// T6 , wpt - turbina swobodna rozprezajaca do p0
+    inline void turbine_f( int n , const double *p5 , const double *T5 , double Cp ,
+                           double *T6 , double *wpt )
+    { table( active() ).turbine_f( n , p5 , T5 , Cp , T6 , wpt ); }
+
+    /// y = x^e dla x >= 0
+    inline void pow_fixed( int n , const double *x , double e , double *y )
+    { table( active() ).pow_fixed( n , x , e , y ); }
+
+    /// To samo w pojedynczej precyzji
+    inline void intake( int n , const float *TH , const float *pH , const float *Ma ,
+                        float sigma_H1 , float *T1 , float *p1 , float *c1 )
+    { table_f( active() ).intake( n , TH , pH , Ma , sigma_H1 , T1 , p1 , c1 ); }
+
+    inline void compressor( int n , const float *T2 , const float *p2 ,
+                            const float *sprez , const float *eta , const float *mZR ,
+                            float *T3 , float *p3 , float *m3 )
+    { table_f( active() ).compressor( n , T2 , p2 , sprez , eta , mZR , T3 , p3 , m3 ); }
+
+    inline void turbine( int n , const float *p4 , const float *T4 , const float *m4 ,
+                         const float *eps , float eta_Twc , float A_t , float Cp ,
+                         float *p5 , float *T5 , float *c5 , float *Pt )
+    { table_f( active() ).turbine( n , p4 , T4 , m4 , eps , eta_Twc , A_t , Cp , p5 , T5 , c5 , Pt ); }
+
+    inline void turbine_f( int n , const float *p5 , const float *T5 , float Cp ,
+                           float *T6 , float *wpt )
+    { table_f( active() ).turbine_f( n , p5 , T5 , Cp , T6 , wpt ); }
+
+    inline void pow_fixed( int n , const float *x , float e , float *y )
+    { table_f( active() ).pow_fixed( n , x , e , y ); }
+
+    /// Najwiekszy blad wzgledny wariantu isa wzgledem skalarnego na n punktach obwiedni
+    double validate( Isa isa , int n = 4096 );
+
+    /// To samo dla wariantow float ( wzgledem skalarnego float )
+    double validate_f( Isa isa , int n = 4096 );
+}
+
+#endif // STATIONKERNELS_H
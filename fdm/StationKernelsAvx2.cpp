@@ -0,0 +1,162 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <StationKernels.h>
+
+#if defined( DME_KERNELS_X86 )
+
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <immintrin.h>
+#include <enginedata.h>
+
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+
+namespace
+{
+
+struct Vd
+{
+    typedef double S;
+    __m256d v;
+    enum { W = 4 };
+    Vd() {}
+    Vd( __m256d x ) : v( x ) {}
+    static Vd set1( double x ) { return _mm256_set1_pd( x ); }
+    static Vd load( const double *p ) { return _mm256_loadu_pd( p ); }
+    void store( double *p ) const { _mm256_storeu_pd( p , v ); }
+
+    /// Maska pierwszych r < W miejsc
+    static __m256i mask( int r ) { return _mm256_cmpgt_epi64( _mm256_set1_epi64x( r ) , _mm256_setr_epi64x( 0 , 1 , 2 , 3 ) ); }
+    static Vd load_n( const double *p , int r )
+    {
+        __m256i m = mask( r );
+        return _mm256_blendv_pd( _mm256_set1_pd( 1.0 ) , _mm256_maskload_pd( p , m ) , _mm256_castsi256_pd( m ) );
+    }
+    void store_n( double *p , int r ) const { _mm256_maskstore_pd( p , mask( r ) , v ); }
+};
+
+inline Vd operator+( Vd a , Vd b ) { return _mm256_add_pd( a.v , b.v ); }
+inline Vd operator-( Vd a , Vd b ) { return _mm256_sub_pd( a.v , b.v ); }
+inline Vd operator*( Vd a , Vd b ) { return _mm256_mul_pd( a.v , b.v ); }
+inline Vd operator/( Vd a , Vd b ) { return _mm256_div_pd( a.v , b.v ); }
+inline Vd vsqrt( Vd a )            { return _mm256_sqrt_pd( a.v ); }
+inline Vd vmin( Vd a , Vd b )      { return _mm256_min_pd( a.v , b.v ); }
+inline Vd vmax( Vd a , Vd b )      { return _mm256_max_pd( a.v , b.v ); }
+
+inline Vd vsel_gt( Vd a , Vd b , Vd x , Vd y )
+{
+    return _mm256_blendv_pd( y.v , x.v , _mm256_cmp_pd( a.v , b.v , _CMP_GT_OQ ) );
+}
+
+inline Vd vmant( Vd x , Vd &e )
+{
+    __m256i b  = _mm256_castpd_si256( x.v );
+    __m256i ex = _mm256_or_si256( _mm256_srli_epi64( b , 52 ) , _mm256_set1_epi64x( 0x4330000000000000ll ) );
+    e = _mm256_sub_pd( _mm256_castsi256_pd( ex ) , _mm256_set1_pd( 4503599627370496.0 + 1023.0 ) );
+    b = _mm256_or_si256( _mm256_and_si256( b , _mm256_set1_epi64x( 0x000FFFFFFFFFFFFFll ) ) ,
+                         _mm256_set1_epi64x( 0x3FF0000000000000ll ) );
+    return _mm256_castsi256_pd( b );
+}
+
+inline Vd vexp2i( Vd t )
+{
+    __m256i b = _mm256_add_epi64( _mm256_castpd_si256( t.v ) , _mm256_set1_epi64x( 1023 ) );
+    return _mm256_castsi256_pd( _mm256_slli_epi64( b , 52 ) );
+}
+
+struct Vf
+{
+    typedef float S;
+    __m256 v;
+    enum { W = 8 };
+    Vf() {}
+    Vf( __m256 x ) : v( x ) {}
+    static Vf set1( float x ) { return _mm256_set1_ps( x ); }
+    static Vf load( const float *p ) { return _mm256_loadu_ps( p ); }
+    void store( float *p ) const { _mm256_storeu_ps( p , v ); }
+
+    static __m256i mask( int r ) { return _mm256_cmpgt_epi32( _mm256_set1_epi32( r ) , _mm256_setr_epi32( 0 , 1 , 2 , 3 , 4 , 5 , 6 , 7 ) ); }
+    static Vf load_n( const float *p , int r )
+    {
+        __m256i m = mask( r );
+        return _mm256_blendv_ps( _mm256_set1_ps( 1.0f ) , _mm256_maskload_ps( p , m ) , _mm256_castsi256_ps( m ) );
+    }
+    void store_n( float *p , int r ) const { _mm256_maskstore_ps( p , mask( r ) , v ); }
+};
+
+inline Vf operator+( Vf a , Vf b ) { return _mm256_add_ps( a.v , b.v ); }
+inline Vf operator-( Vf a , Vf b ) { return _mm256_sub_ps( a.v , b.v ); }
+inline Vf operator*( Vf a , Vf b ) { return _mm256_mul_ps( a.v , b.v ); }
+inline Vf operator/( Vf a , Vf b ) { return _mm256_div_ps( a.v , b.v ); }
+inline Vf vsqrt( Vf a )            { return _mm256_sqrt_ps( a.v ); }
+inline Vf vmin( Vf a , Vf b )      { return _mm256_min_ps( a.v , b.v ); }
+inline Vf vmax( Vf a , Vf b )      { return _mm256_max_ps( a.v , b.v ); }
+
+inline Vf vsel_gt( Vf a , Vf b , Vf x , Vf y )
+{
+    return _mm256_blendv_ps( y.v , x.v , _mm256_cmp_ps( a.v , b.v , _CMP_GT_OQ ) );
+}
+
+inline Vf vmant( Vf x , Vf &e )
+{
+    __m256i b  = _mm256_castps_si256( x.v );
+    __m256i ex = _mm256_or_si256( _mm256_srli_epi32( b , 23 ) , _mm256_set1_epi32( 0x4B000000 ) );
+    e = _mm256_sub_ps( _mm256_castsi256_ps( ex ) , _mm256_set1_ps( 8388608.0f + 127.0f ) );
+    b = _mm256_or_si256( _mm256_and_si256( b , _mm256_set1_epi32( 0x007FFFFF ) ) ,
+                         _mm256_set1_epi32( 0x3F800000 ) );
+    return _mm256_castsi256_ps( b );
+}
+
+inline Vf vexp2i( Vf t )
+{
+    __m256i b = _mm256_add_epi32( _mm256_castps_si256( t.v ) , _mm256_set1_epi32( 127 ) );
+    return _mm256_castsi256_ps( _mm256_slli_epi32( b , 23 ) );
+}
+
+}
+
+#include <StationKernelsImpl.h>
+
+#pragma GCC pop_options
+
+namespace StationKernels
+{
+    extern Table const table_avx2;
+    Table const table_avx2 =
+    {
+        k_intake<Vd> , k_compressor<Vd> , k_turbine<Vd> , k_turbine_f<Vd> , k_pow<Vd> ,
+        k_map<Vd> , k_chamber<Vd>
+    };
+
+    extern TableF const table_avx2_f;
+    TableF const table_avx2_f =
+    {
+        k_intake<Vf> , k_compressor<Vf> , k_turbine<Vf> , k_turbine_f<Vf> , k_pow<Vf> ,
+        k_map<Vf> , k_chamber<Vf>
+    };
+}
+
+#endif
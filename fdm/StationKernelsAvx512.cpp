@@ -0,0 +1,159 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <StationKernels.h>
+
+#if defined( DME_KERNELS_X86 )
+
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+/// avx512fintrin.h ( GCC 12 ) inicjuje wektory z set1 / undefined przez __Y = __Y -
+/// ostrzezenia -Wuninitialized / -Wmaybe-uninitialized z naglowka , nie z tego pliku
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#include <enginedata.h>
+
+#pragma GCC push_options
+#pragma GCC target( "avx512f" )
+
+namespace
+{
+
+struct Vd
+{
+    typedef double S;
+    __m512d v;
+    enum { W = 8 };
+    Vd() {}
+    Vd( __m512d x ) : v( x ) {}
+    static Vd set1( double x ) { return _mm512_set1_pd( x ); }
+    static Vd load( const double *p ) { return _mm512_loadu_pd( p ); }
+    void store( double *p ) const { _mm512_storeu_pd( p , v ); }
+
+    /// Maska pierwszych r < W miejsc
+    static Vd load_n( const double *p , int r ) { return _mm512_mask_loadu_pd( _mm512_set1_pd( 1.0 ) , __mmask8( ( 1u << r ) - 1 ) , p ); }
+    void store_n( double *p , int r ) const { _mm512_mask_storeu_pd( p , __mmask8( ( 1u << r ) - 1 ) , v ); }
+};
+
+inline Vd operator+( Vd a , Vd b ) { return _mm512_add_pd( a.v , b.v ); }
+inline Vd operator-( Vd a , Vd b ) { return _mm512_sub_pd( a.v , b.v ); }
+inline Vd operator*( Vd a , Vd b ) { return _mm512_mul_pd( a.v , b.v ); }
+inline Vd operator/( Vd a , Vd b ) { return _mm512_div_pd( a.v , b.v ); }
+inline Vd vsqrt( Vd a )            { return _mm512_sqrt_pd( a.v ); }
+inline Vd vmin( Vd a , Vd b )      { return _mm512_min_pd( a.v , b.v ); }
+inline Vd vmax( Vd a , Vd b )      { return _mm512_max_pd( a.v , b.v ); }
+
+inline Vd vsel_gt( Vd a , Vd b , Vd x , Vd y )
+{
+    return _mm512_mask_blend_pd( _mm512_cmp_pd_mask( a.v , b.v , _CMP_GT_OQ ) , y.v , x.v );
+}
+
+inline Vd vmant( Vd x , Vd &e )
+{
+    __m512i b  = _mm512_castpd_si512( x.v );
+    __m512i ex = _mm512_or_si512( _mm512_srli_epi64( b , 52 ) , _mm512_set1_epi64( 0x4330000000000000ll ) );
+    e = _mm512_sub_pd( _mm512_castsi512_pd( ex ) , _mm512_set1_pd( 4503599627370496.0 + 1023.0 ) );
+    b = _mm512_or_si512( _mm512_and_si512( b , _mm512_set1_epi64( 0x000FFFFFFFFFFFFFll ) ) ,
+                         _mm512_set1_epi64( 0x3FF0000000000000ll ) );
+    return _mm512_castsi512_pd( b );
+}
+
+inline Vd vexp2i( Vd t )
+{
+    __m512i b = _mm512_add_epi64( _mm512_castpd_si512( t.v ) , _mm512_set1_epi64( 1023 ) );
+    return _mm512_castsi512_pd( _mm512_slli_epi64( b , 52 ) );
+}
+
+struct Vf
+{
+    typedef float S;
+    __m512 v;
+    enum { W = 16 };
+    Vf() {}
+    Vf( __m512 x ) : v( x ) {}
+    static Vf set1( float x ) { return _mm512_set1_ps( x ); }
+    static Vf load( const float *p ) { return _mm512_loadu_ps( p ); }
+    void store( float *p ) const { _mm512_storeu_ps( p , v ); }
+
+    static Vf load_n( const float *p , int r ) { return _mm512_mask_loadu_ps( _mm512_set1_ps( 1.0f ) , __mmask16( ( 1u << r ) - 1 ) , p ); }
+    void store_n( float *p , int r ) const { _mm512_mask_storeu_ps( p , __mmask16( ( 1u << r ) - 1 ) , v ); }
+};
+
+inline Vf operator+( Vf a , Vf b ) { return _mm512_add_ps( a.v , b.v ); }
+inline Vf operator-( Vf a , Vf b ) { return _mm512_sub_ps( a.v , b.v ); }
+inline Vf operator*( Vf a , Vf b ) { return _mm512_mul_ps( a.v , b.v ); }
+inline Vf operator/( Vf a , Vf b ) { return _mm512_div_ps( a.v , b.v ); }
+inline Vf vsqrt( Vf a )            { return _mm512_sqrt_ps( a.v ); }
+inline Vf vmin( Vf a , Vf b )      { return _mm512_min_ps( a.v , b.v ); }
+inline Vf vmax( Vf a , Vf b )      { return _mm512_max_ps( a.v , b.v ); }
+
+inline Vf vsel_gt( Vf a , Vf b , Vf x , Vf y )
+{
+    return _mm512_mask_blend_ps( _mm512_cmp_ps_mask( a.v , b.v , _CMP_GT_OQ ) , y.v , x.v );
+}
+
+inline Vf vmant( Vf x , Vf &e )
+{
+    __m512i b  = _mm512_castps_si512( x.v );
+    __m512i ex = _mm512_or_si512( _mm512_srli_epi32( b , 23 ) , _mm512_set1_epi32( 0x4B000000 ) );
+    e = _mm512_sub_ps( _mm512_castsi512_ps( ex ) , _mm512_set1_ps( 8388608.0f + 127.0f ) );
+    b = _mm512_or_si512( _mm512_and_si512( b , _mm512_set1_epi32( 0x007FFFFF ) ) ,
+                         _mm512_set1_epi32( 0x3F800000 ) );
+    return _mm512_castsi512_ps( b );
+}
+
+inline Vf vexp2i( Vf t )
+{
+    __m512i b = _mm512_add_epi32( _mm512_castps_si512( t.v ) , _mm512_set1_epi32( 127 ) );
+    return _mm512_castsi512_ps( _mm512_slli_epi32( b , 23 ) );
+}
+
+}
+
+#include <StationKernelsImpl.h>
+
+#pragma GCC pop_options
+
+namespace StationKernels
+{
+    extern Table const table_avx512;
+    Table const table_avx512 =
+    {
+        k_intake<Vd> , k_compressor<Vd> , k_turbine<Vd> , k_turbine_f<Vd> , k_pow<Vd> ,
+        k_map<Vd> , k_chamber<Vd>
+    };
+
+    extern TableF const table_avx512_f;
+    TableF const table_avx512_f =
+    {
+        k_intake<Vf> , k_compressor<Vf> , k_turbine<Vf> , k_turbine_f<Vf> , k_pow<Vf> ,
+        k_map<Vf> , k_chamber<Vf>
+    };
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,413 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+/// Wspolne cialo wektorowych wariantow StationKernels.
+///
+/// Plik dolaczany jest do kazdego StationKernels*.cpp po zdefiniowaniu typow Vd
+/// i Vf ( wektor double i float dla danego zestawu instrukcji, typ skalarny
+/// w V::S , load_n / store_n dla pierwszych r < W punktow ) i zawiera wszystko w anonimowej przestrzeni nazw - kazda jednostka
+/// kompilacji ma wlasne kopie skompilowane pod swoj zestaw instrukcji. Nie ma
+/// straznika naglowka celowo.
+///
+/// Naglowki systemowe ( string.h , stdint.h , math.h ) i enginedata.h musza byc
+/// dolaczone PRZED #pragma GCC target - inaczej ich funkcje inline zostalyby
+/// skompilowane pod nowszy zestaw instrukcji i mogly trafic do reszty programu.
+
+namespace
+{
+
+/// Stale log / exp dla typu skalarnego - ln2 rozbite tak, ze k * LN2_HI jest dokladne
+template <class T> struct Num;
+
+template <> struct Num<double>
+{
+    static double ln2_hi() { return 6.93147180369123816490e-01; }
+    static double ln2_lo() { return 1.90821492927058770002e-10; }
+    static double magic()  { return 6755399441055744.0; }    ///< 1.5 * 2^52 - zaokraglanie do calkowitej
+    static double y_min()  { return -708.0; }
+    static double y_max()  { return  709.0; }
+};
+
+template <> struct Num<float>
+{
+    static float ln2_hi() { return 0.693359375f; }
+    static float ln2_lo() { return -2.12194440e-4f; }
+    static float magic()  { return 12582912.0f; }            ///< 1.5 * 2^23
+    static float y_min()  { return -87.0f; }
+    static float y_max()  { return  88.0f; }
+};
+
+double const LOG2E  = 1.44269504088896338700e+00;
+double const SQRT2  = 1.41421356237309504880e+00;
+
+/// ln( x ) dla x > 0 : x = m * 2^e , m w [ sqrt(2)/2 , sqrt(2) ) ,
+/// ln( m ) = 2 atanh( f ) , f = ( m - 1 ) / ( m + 1 ) , |f| < 0.172 ,
+/// szereg do f^23 ( double ) albo f^11 ( float )
+template<class V> inline V vlog( V x )
+{
+    typedef Num<typename V::S> N;
+
+    V e;
+    V m = vmant( x , e );
+
+    e = vsel_gt( m , V::set1( SQRT2 ) , e + V::set1( 1.0 ) , e );
+    m = vsel_gt( m , V::set1( SQRT2 ) , m * V::set1( 0.5 ) , m );
+
+    V f = ( m - V::set1( 1.0 ) ) / ( m + V::set1( 1.0 ) );
+    V s = f * f;
+
+    V p;
+    if( sizeof( typename V::S ) == sizeof( double ) )
+    {
+        p = V::set1( 1.0 / 23.0 );
+        p = p * s + V::set1( 1.0 / 21.0 );
+        p = p * s + V::set1( 1.0 / 19.0 );
+        p = p * s + V::set1( 1.0 / 17.0 );
+        p = p * s + V::set1( 1.0 / 15.0 );
+        p = p * s + V::set1( 1.0 / 13.0 );
+        p = p * s + V::set1( 1.0 / 11.0 );
+    }
+    else
+        p = V::set1( 1.0 / 11.0 );
+    p = p * s + V::set1( 1.0 /  9.0 );
+    p = p * s + V::set1( 1.0 /  7.0 );
+    p = p * s + V::set1( 1.0 /  5.0 );
+    p = p * s + V::set1( 1.0 /  3.0 );
+
+    V f2 = f + f;
+    V lm = f2 + f2 * s * p;
+
+    return e * V::set1( N::ln2_hi() ) + ( e * V::set1( N::ln2_lo() ) + lm );
+}
+
+/// exp( y ) : y = k ln2 + r , |r| <= ln2 / 2 , szereg Taylora do r^13 ( double ) albo r^8 ( float )
+template<class V> inline V vexp( V y )
+{
+    typedef Num<typename V::S> N;
+
+    y = vmin( vmax( y , V::set1( N::y_min() ) ) , V::set1( N::y_max() ) );
+
+    V t = y * V::set1( LOG2E ) + V::set1( N::magic() );
+    V k = t - V::set1( N::magic() );
+    V r = ( y - k * V::set1( N::ln2_hi() ) ) - k * V::set1( N::ln2_lo() );
+
+    V p;
+    if( sizeof( typename V::S ) == sizeof( double ) )
+    {
+        p = V::set1( 1.0 / 6227020800.0 );
+        p = p * r + V::set1( 1.0 / 479001600.0 );
+        p = p * r + V::set1( 1.0 / 39916800.0 );
+        p = p * r + V::set1( 1.0 / 3628800.0 );
+        p = p * r + V::set1( 1.0 / 362880.0 );
+        p = p * r + V::set1( 1.0 / 40320.0 );
+    }
+    else
+        p = V::set1( 1.0 / 40320.0 );
+    p = p * r + V::set1( 1.0 / 5040.0 );
+    p = p * r + V::set1( 1.0 / 720.0 );
+    p = p * r + V::set1( 1.0 / 120.0 );
+    p = p * r + V::set1( 1.0 / 24.0 );
+    p = p * r + V::set1( 1.0 / 6.0 );
+    p = p * r + V::set1( 0.5 );
+    p = p * r + V::set1( 1.0 );
+    p = p * r + V::set1( 1.0 );
+
+    return p * vexp2i( t );
+}
+
+/// x^e dla x >= 0 ( 0^e = 0 , e > 0 ). Jak std::pow: NaN dla x < 0 i dla NaN -
+/// sqrt( x ) * 0 jest zerem dla x = 0 , a NaN dla x < 0 i dla NaN
+template<class V> inline V vpow( V x , V e )
+{
+    V zero = V::set1( 0.0 );
+    return vsel_gt( x , zero , vexp( e * vlog( x ) ) , vsqrt( x ) * zero );
+}
+
+///////////////////////////////////////////////////////////////
+
+/// Wzory przekrojow dla jednego wektora punktow
+
+template<class V> inline void intake_step( V T_H , V p_H , V M , V sigma , V &T1 , V &p1 , V &c1 )
+{
+    using namespace EngineConst;
+
+    V b = V::set1( 1.0 ) + V::set1( ( k_p - 1.0 ) / 2.0 ) * M * M;
+
+    T1 = T_H * b;
+    p1 = sigma * p_H * vpow( b , V::set1( k_p / ( k_p - 1.0 ) ) );
+    c1 = vsqrt( ( T1 - T_H ) * V::set1( 2.0 * k_p / ( k_p - 1.0 ) * R_p ) );
+}
+
+template<class V> inline void compressor_step( V T , V p , V sp , V eta , V mZR , V &T3 , V &p3 , V &m3 )
+{
+    using namespace EngineConst;
+
+    V const one = V::set1( 1.0 );
+
+    m3 = mZR * ( p / V::set1( p0 ) ) * vsqrt( V::set1( T0 ) / T );
+    p3 = sp * p;
+    T3 = T * ( one + ( vpow( sp , V::set1( ( k_p - 1.0 ) / k_p ) ) - one ) / eta );
+}
+
+/// T_5 na wejsciu - stan z poprzedniego kroku
+template<class V> inline void turbine_step( V p_4 , V T_4 , V m , V eps , V T_5 , V eta , V R_A , V Cp ,
+                                            V &p5 , V &T5 , V &c5 , V &Pt )
+{
+    using namespace EngineConst;
+
+    V const one = V::set1( 1.0 );
+
+    p5 = p_4 * vpow( T_5 / T_4 , V::set1( k_s / ( k_s - 1.0 ) ) );
+    T5 = T_4 * ( one - ( one - vpow( eps , V::set1( ( 1.0 - k_s ) / k_s ) ) ) * eta );
+    c5 = m * T5 * R_A / p5;
+    Pt = m * Cp * ( T_4 - T5 );
+}
+
+template<class V> inline void turbine_f_step( V p5 , V T_5 , V Cp , V &T6 , V &wpt )
+{
+    using namespace EngineConst;
+
+    T6  = T_5 * vpow( V::set1( p0 ) / p5 , V::set1( ( k_s - 1.0 ) / k_s ) );
+    wpt = Cp * ( T_5 - T6 );
+}
+
+///////////////////////////////////////////////////////////////
+
+/// Pelne wektory , a koniec kolumny ( r < W punktow ) jednym wektorem z maska -
+/// V::load_n / store_n czytaja i zapisuja tylko r punktow ( wolne miejsca = 1 ) ,
+/// zadnych dostepow za koncem kolumny
+
+template<class V> void k_intake( int n , const typename V::S *TH , const typename V::S *pH ,
+                                 const typename V::S *Ma , typename V::S sigma_H1 ,
+                                 typename V::S *T1 , typename V::S *p1 , typename V::S *c1 )
+{
+    V const sigma = V::set1( sigma_H1 );
+    V T , p , c;
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        intake_step( V::load( TH + i ) , V::load( pH + i ) , V::load( Ma + i ) , sigma , T , p , c );
+        T.store( T1 + i );
+        p.store( p1 + i );
+        c.store( c1 + i );
+    }
+    if( int r = n - i )
+    {
+        intake_step( V::load_n( TH + i , r ) , V::load_n( pH + i , r ) , V::load_n( Ma + i , r ) , sigma , T , p , c );
+        T.store_n( T1 + i , r );
+        p.store_n( p1 + i , r );
+        c.store_n( c1 + i , r );
+    }
+}
+
+template<class V> void k_compressor( int n , const typename V::S *T2 , const typename V::S *p2 ,
+                                     const typename V::S *sprez , const typename V::S *eta ,
+                                     const typename V::S *mZR ,
+                                     typename V::S *T3 , typename V::S *p3 , typename V::S *m3 )
+{
+    V T , p , m;
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        compressor_step( V::load( T2 + i ) , V::load( p2 + i ) , V::load( sprez + i ) ,
+                         V::load( eta + i ) , V::load( mZR + i ) , T , p , m );
+        T.store( T3 + i );
+        p.store( p3 + i );
+        m.store( m3 + i );
+    }
+    if( int r = n - i )
+    {
+        compressor_step( V::load_n( T2 + i , r ) , V::load_n( p2 + i , r ) , V::load_n( sprez + i , r ) ,
+                         V::load_n( eta + i , r ) , V::load_n( mZR + i , r ) , T , p , m );
+        T.store_n( T3 + i , r );
+        p.store_n( p3 + i , r );
+        m.store_n( m3 + i , r );
+    }
+}
+
+template<class V> void k_turbine( int n , const typename V::S *p4 , const typename V::S *T4 ,
+                                  const typename V::S *m4 , const typename V::S *eps ,
+                                  typename V::S eta_Twc , typename V::S A_t , typename V::S Cp ,
+                                  typename V::S *p5 , typename V::S *T5 , typename V::S *c5 ,
+                                  typename V::S *Pt )
+{
+    using namespace EngineConst;
+
+    V const eta  = V::set1( eta_Twc );
+    V const R_A  = V::set1( R_s / A_t );
+    V const v_Cp = V::set1( Cp );
+    V p , T , c , P;
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        turbine_step( V::load( p4 + i ) , V::load( T4 + i ) , V::load( m4 + i ) , V::load( eps + i ) ,
+                      V::load( T5 + i ) , eta , R_A , v_Cp , p , T , c , P );
+        p.store( p5 + i );
+        T.store( T5 + i );
+        c.store( c5 + i );
+        P.store( Pt + i );
+    }
+    if( int r = n - i )
+    {
+        turbine_step( V::load_n( p4 + i , r ) , V::load_n( T4 + i , r ) , V::load_n( m4 + i , r ) ,
+                      V::load_n( eps + i , r ) , V::load_n( T5 + i , r ) , eta , R_A , v_Cp , p , T , c , P );
+        p.store_n( p5 + i , r );
+        T.store_n( T5 + i , r );
+        c.store_n( c5 + i , r );
+        P.store_n( Pt + i , r );
+    }
+}
+
+template<class V> void k_turbine_f( int n , const typename V::S *p5 , const typename V::S *T5 ,
+                                    typename V::S Cp , typename V::S *T6 , typename V::S *wpt )
+{
+    V const v_Cp = V::set1( Cp );
+    V T , w;
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        turbine_f_step( V::load( p5 + i ) , V::load( T5 + i ) , v_Cp , T , w );
+        T.store( T6 + i );
+        w.store( wpt + i );
+    }
+    if( int r = n - i )
+    {
+        turbine_f_step( V::load_n( p5 + i , r ) , V::load_n( T5 + i , r ) , v_Cp , T , w );
+        T.store_n( T6 + i , r );
+        w.store_n( wpt + i , r );
+    }
+}
+
+template<class V> void k_pow( int n , const typename V::S *x , typename V::S e , typename V::S *y )
+{
+    V const v_e = V::set1( e );
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+        vpow( V::load( x + i ) , v_e ).store( y + i );
+    if( int r = n - i )
+        vpow( V::load_n( x + i , r ) , v_e ).store_n( y + i , r );
+}
+
+/// Wszystkie kolumny mapy w a - suma po wszystkich przedzialach ( BasicMap )
+template<class V> inline void map_step( V a , StationKernels::BasicMap<typename V::S> const &m ,
+                                        V acc[StationKernels::BasicMap<typename V::S>::MaxCols] )
+{
+    for( int c = 0 ; c < m.cols ; c++ ) acc[c] = V::set1( m.y0[c] );
+    for( int k = 0 ; k < m.segs ; k++ )
+    {
+        V lo = V::set1( m.lo[k] );
+        V t  = vmin( vmax( a , lo ) , V::set1( m.hi[k] ) ) - lo;
+        for( int c = 0 ; c < m.cols ; c++ ) acc[c] = acc[c] + t * V::set1( m.slope[c][k] );
+    }
+}
+
+template<class V> void k_map( int n , const typename V::S *x , const typename V::S *T_in ,
+                              typename V::S scale , typename V::S *x_zr ,
+                              StationKernels::BasicMap<typename V::S> const &m , typename V::S * const *y )
+{
+    using namespace EngineConst;
+
+    V const sc = V::set1( scale );
+    V const t0 = V::set1( T0 );
+    V acc[StationKernels::BasicMap<typename V::S>::MaxCols];
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        V a = V::load( x + i );
+        if( T_in ) { a = a * vsqrt( t0 / V::load( T_in + i ) ); a.store( x_zr + i ); }
+        map_step( a * sc , m , acc );
+        for( int c = 0 ; c < m.cols ; c++ ) acc[c].store( y[c] + i );
+    }
+    if( int r = n - i )
+    {
+        V a = V::load_n( x + i , r );
+        if( T_in ) { a = a * vsqrt( t0 / V::load_n( T_in + i , r ) ); a.store_n( x_zr + i , r ); }
+        map_step( a * sc , m , acc );
+        for( int c = 0 ; c < m.cols ; c++ ) acc[c].store_n( y[c] + i , r );
+    }
+}
+
+template<class V> inline void chamber_step( V p3 , V T3 , V m3 , V c3 , V q , V q_k , V sig , V k_T ,
+                                            V &primed , V &Tc , V &p4 , V &T4 , V &m4 , V &c4 )
+{
+    using namespace EngineConst;
+
+    p4 = sig * p3;
+
+    V T4_tt = q * q_k / m3 + T3;
+
+    c4 = ( V::set1( 1.0 ) - p4 / p3 ) * V::set1( R_s ) * T3 / c3 + c3;
+
+    Tc = vsel_gt( primed , V::set1( 0.0 ) , Tc , T4_tt );
+    Tc = Tc + ( T4_tt - Tc ) * k_T;
+    T4 = Tc;
+    m4 = m3 + q;
+    primed = V::set1( 1.0 );
+}
+
+template<class V> void k_chamber( int n , const typename V::S *p3 , const typename V::S *T3 ,
+                                  const typename V::S *m3 , const typename V::S *c3 , const typename V::S *q ,
+                                  typename V::S q_k , typename V::S sig_34 , typename V::S k_T ,
+                                  typename V::S *primed , typename V::S *T_ch ,
+                                  typename V::S *p4 , typename V::S *T4 , typename V::S *m4 , typename V::S *c4 )
+{
+    V const v_q = V::set1( q_k ) , v_sig = V::set1( sig_34 ) , v_k = V::set1( k_T );
+    V pr , Tc , p , T , m , c;
+    int i = 0;
+
+    for( ; i + V::W <= n ; i += V::W )
+    {
+        pr = V::load( primed + i );
+        Tc = V::load( T_ch + i );
+        chamber_step( V::load( p3 + i ) , V::load( T3 + i ) , V::load( m3 + i ) , V::load( c3 + i ) ,
+                      V::load( q + i ) , v_q , v_sig , v_k , pr , Tc , p , T , m , c );
+        pr.store( primed + i );
+        Tc.store( T_ch + i );
+        p.store( p4 + i );
+        T.store( T4 + i );
+        m.store( m4 + i );
+        c.store( c4 + i );
+    }
+    if( int r = n - i )
+    {
+        pr = V::load_n( primed + i , r );
+        Tc = V::load_n( T_ch + i , r );
+        chamber_step( V::load_n( p3 + i , r ) , V::load_n( T3 + i , r ) , V::load_n( m3 + i , r ) ,
+                      V::load_n( c3 + i , r ) , V::load_n( q + i , r ) , v_q , v_sig , v_k , pr , Tc , p , T , m , c );
+        pr.store_n( primed + i , r );
+        Tc.store_n( T_ch + i , r );
+        p.store_n( p4 + i , r );
+        T.store_n( T4 + i , r );
+        m.store_n( m4 + i , r );
+        c.store_n( c4 + i , r );
+    }
+}
+
+}
@@ -0,0 +1,618 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#include "Surrogate.h"
+#include <EngineDeck.h>
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+
+static_assert( sizeof( CycleSolver::Point ) % sizeof( double ) == 0 , "CycleSolver::Point - same liczby double" );
+
+namespace
+{
+
+const char *names[Surrogate::Keys] = { "n_wc" , "T4s" , "m3" , "T5s" , "P_free" };
+
+size_t const fields[Surrogate::Keys] =
+{
+    offsetof( CycleSolver::Point , n_wc ) , offsetof( CycleSolver::Point , T4s ) ,
+    offsetof( CycleSolver::Point , m3 )   , offsetof( CycleSolver::Point , T5s ) ,
+    offsetof( CycleSolver::Point , P_free )
+};
+
+int const Fields = int( sizeof( CycleSolver::Point ) / sizeof( double ) );
+
+struct FileHeader { uint32_t magic , version , outputs , degree , cells , samples , terms , nodes; };
+
+uint32_t const file_magic = 0x53454D44;     ///< "DMES"
+uint32_t const version    = 2;              ///< 2 - wyjscia kluczowe , float , komorki dzielone
+int const      MaxDegree  = 8;
+
+/// T_0 .. T_d w u
+void chebyshev( double u , int d , double *T )
+{
+    T[0] = 1.0;
+    if( d > 0 ) T[1] = u;
+    for( int k = 2 ; k <= d ; k++ ) T[k] = 2.0 * u * T[k-1] - T[k-2];
+}
+
+/// Najmniejsze kwadraty A c = B ( A - m x p , kolumnami; B - m x nrhs ) przez
+/// odbicia Householdera. Wynik w pierwszych p wierszach kolumn B; false - rzad < p
+bool least_squares( std::vector<double> &A , int m , int p , std::vector<double> &B , int nrhs )
+{
+    for( int j = 0 ; j < p ; j++ )
+    {
+        double *a = &A[ size_t( j ) * m ];
+        double s = 0.0;
+        for( int i = j ; i < m ; i++ ) s += a[i] * a[i];
+        double norm = sqrt( s );
+        if( norm == 0.0 ) return false;
+
+        double alpha = a[j] > 0.0 ? -norm : norm;
+        a[j] -= alpha;
+        double vv = 0.0;                                // | v |^2
+        for( int i = j ; i < m ; i++ ) vv += a[i] * a[i];
+
+        /// H = I - 2 v v' / v'v dla pozostalych kolumn A i dla B
+        for( int k = j + 1 ; k < p ; k++ )
+        {
+            double *c = &A[ size_t( k ) * m ] , d = 0.0;
+            for( int i = j ; i < m ; i++ ) d += a[i] * c[i];
+            d = 2.0 * d / vv;
+            for( int i = j ; i < m ; i++ ) c[i] -= d * a[i];
+        }
+        for( int k = 0 ; k < nrhs ; k++ )
+        {
+            double *c = &B[ size_t( k ) * m ] , d = 0.0;
+            for( int i = j ; i < m ; i++ ) d += a[i] * c[i];
+            d = 2.0 * d / vv;
+            for( int i = j ; i < m ; i++ ) c[i] -= d * a[i];
+        }
+        a[j] = alpha;                                   // diagonala R
+    }
+
+    double rmax = 0.0;
+    for( int j = 0 ; j < p ; j++ ) rmax = std::max( rmax , fabs( A[ size_t( j ) * m + j ] ) );
+
+    for( int j = p - 1 ; j >= 0 ; j-- )
+    {
+        double r = A[ size_t( j ) * m + j ];
+        if( fabs( r ) <= 1.0e-12 * rmax ) return false;
+        for( int k = 0 ; k < nrhs ; k++ )
+        {
+            double *c = &B[ size_t( k ) * m ];
+            double s = c[j];
+            for( int i = j + 1 ; i < p ; i++ ) s -= A[ size_t( i ) * m + j ] * c[i];
+            c[j] = s / r;
+        }
+    }
+    return true;
+}
+
+/// Wyrazy wielomianu stopnia calkowitego <= d: T_a T_b T_c
+std::vector<uint8_t> basis_powers( int d )
+{
+    std::vector<uint8_t> pw;
+    for( int k = 0 ; k <= d ; k++ )
+        for( int a = k ; a >= 0 ; a-- )
+            for( int b = k - a ; b >= 0 ; b-- )
+            {
+                pw.push_back( uint8_t( a ) );
+                pw.push_back( uint8_t( b ) );
+                pw.push_back( uint8_t( k - a - b ) );
+            }
+    return pw;
+}
+
+uint64_t deck_checksum( std::weak_ptr<EngineData> Dat )
+{
+    std::shared_ptr<EngineData> d = Dat.lock();
+    return d && d->is_sealed() ? EngineDeck::checksum( d->header() , d->arena_bytes() ) : 0;
+}
+
+}
+
+Surrogate::Surrogate()
+{
+    degree  = 2;
+    samples = 4;
+    cells   = 6;
+    safety  = 2.0;
+
+    refine_tol = 1.0e-3;
+    max_depth  = 3;
+
+    for( int i = 0 ; i < 3 ; i++ ) lo[i] = hi[i] = 0.0;
+    deck_sum = 0;
+    for( int k = 0 ; k < Keys ; k++ ) fit_err[k] = 0.0;
+}
+
+const char *Surrogate::output_name( int k )
+{
+    return k >= 0 && k < Keys ? names[k] : "?";
+}
+
+int Surrogate::field( int k )
+{
+    return int( fields[k] / sizeof( double ) );
+}
+
+size_t Surrogate::get_bytes() const
+{
+    return first.size() * sizeof( uint32_t ) + child.size() * sizeof( int32_t ) + power.size() + coef.size() * sizeof( float ) +
+           cell_err.size() * sizeof( float );
+}
+
+std::string Surrogate::path_for( const char *deck )
+{
+    return std::string( deck ) + ".sur";
+}
+
+bool Surrogate::inside( double H_alt , double Mach , double throttle ) const
+{
+    return !first.empty() &&
+           H_alt    >= lo[0] && H_alt    <= hi[0] &&
+           Mach     >= lo[1] && Mach     <= hi[1] &&
+           throttle >= lo[2] && throttle <= hi[2];
+}
+
+int Surrogate::locate( double const x[3] , double u[3] ) const
+{
+    int c[3];
+    for( int i = 0 ; i < 3 ; i++ )
+    {
+        double f = ( x[i] - lo[i] ) / ( hi[i] - lo[i] ) * cells;
+        c[i] = int( f );
+        if( c[i] < 0 )      c[i] = 0;
+        if( c[i] >= cells ) c[i] = cells - 1;
+        u[i] = 2.0 * ( f - c[i] ) - 1.0;
+    }
+
+    /// komorka podzielona - osemka dziecka z polowek osi , u przeskalowane do niej
+    int n = ( c[0] * cells + c[1] ) * cells + c[2];
+    while( child[n] >= 0 )
+    {
+        int k = 0;
+        for( int i = 0 ; i < 3 ; i++ )
+        {
+            int h = u[i] >= 0.0;
+            k = 2 * k + h;
+            u[i] = 2.0 * u[i] + ( h ? -1.0 : 1.0 );
+        }
+        n = child[n] + k;
+    }
+    return n;
+}
+
+void Surrogate::poly( int c , double const u[3] , float acc[Stride] ) const
+{
+    double T[3][MaxDegree+1];
+    for( int i = 0 ; i < 3 ; i++ ) chebyshev( u[i] , degree , T[i] );
+
+    for( int o = 0 ; o < Stride ; o++ ) acc[o] = 0.0f;
+
+    uint8_t const *pw = &power[ size_t( first[c] ) * 3 ];
+    float   const *cf = &coef[ size_t( first[c] ) * Stride ];
+    for( uint32_t k = first[c] ; k < first[c+1] ; k++ , pw += 3 , cf += Stride )
+    {
+        float b = float( T[0][ pw[0] ] * T[1][ pw[1] ] * T[2][ pw[2] ] );
+        for( int o = 0 ; o < Stride ; o++ ) acc[o] += b * cf[o];
+    }
+}
+
+bool Surrogate::eval( double H_alt , double Mach , double throttle , double y[Keys] , double err[Keys] ) const
+{
+    if( !inside( H_alt , Mach , throttle ) ) return false;
+
+    double x[3] = { H_alt , Mach , throttle } , u[3];
+    int c = locate( x , u );
+
+    float const *e = &cell_err[ size_t( c ) * Keys ];
+    if( e[0] == HUGE_VALF ) return false;
+
+    float acc[Stride];
+    poly( c , u , acc );
+
+    for( int k = 0 ; k < Keys ; k++ ) y[k] = acc[k];
+    if( err ) for( int k = 0 ; k < Keys ; k++ ) err[k] = e[k] + NoiseFloor * fabs( y[k] );
+    return true;
+}
+
+bool Surrogate::train( std::weak_ptr<EngineData> Dat , double const Lo[3] , double const Hi[3] )
+{
+    first.clear();
+    child.clear();
+    power.clear();
+    coef.clear();
+    cell_err.clear();
+
+    for( int i = 0 ; i < 3 ; i++ )
+        if( !( Hi[i] > Lo[i] ) )
+        {
+            std::cerr << "Surrogate: empty range" << std::endl;
+            return false;
+        }
+
+    std::vector<uint8_t> all = basis_powers( degree );
+    int p = int( all.size() / 3 );
+    if( degree < 1 || degree > MaxDegree || cells < 1 || cells > 64 || samples < 2 ||
+        samples * samples * samples < 2 * p || max_depth < 0 || max_depth > MaxDepth )
+    {
+        std::cerr << "Surrogate: bad degree , samples , cells or depth ( " << samples << "^3 points for "
+                  << p << " terms )" << std::endl;
+        return false;
+    }
+
+    for( int i = 0 ; i < 3 ; i++ ) { lo[i] = Lo[i]; hi[i] = Hi[i]; }
+    deck_sum = deck_checksum( Dat );
+
+    /// komorki do dopasowania - najpierw siatka cells^3 , dzielone dopisuja 8 dzieci
+    /// na koniec; komorka: dolny rog , krawedz ( ulamek obszaru ) i poziom
+    struct Box { double x[3] , w; int depth; };
+    std::vector<Box> box;
+    for( int ci = 0 ; ci < cells * cells * cells ; ci++ )
+    {
+        Box b = { { double( ci / ( cells * cells ) ) / cells , double( ( ci / cells ) % cells ) / cells ,
+                    double( ci % cells ) / cells } , 1.0 / cells , 0 };
+        box.push_back( b );
+    }
+
+    /// wezly ( 2 * k ) i srodki ( 2 * k + 1 ) siatki komorki o kroku pol odstepu
+    /// wezlow - przebieg punkt po punkcie , kolejne rozwiazania startuja z pamieci
+    /// podrecznej
+    int s2 = 2 * ( samples - 1 ) , g = s2 + 1 , m = samples * samples * samples;
+    std::vector<double> Y( size_t( g ) * g * g * Keys );
+    std::vector<bool>   ok( size_t( g ) * g * g );
+    auto at = [g]( int a , int b , int c ) { return ( size_t( a ) * g + b ) * g + c; };
+    auto lattice = []( int a , int b , int c ) { return ( a & 1 ) == ( b & 1 ) && ( b & 1 ) == ( c & 1 ); };
+
+    CycleSolver solver( Dat );
+    Atmosphere atm;
+
+    first.assign( 1 , 0 );
+    for( int o = 0 ; o < Keys ; o++ ) fit_err[o] = 0.0;
+
+    std::vector<double> basis( size_t( m ) * p ) , A , B( size_t( m ) * Keys ) , full( size_t( p ) * Keys );
+    std::vector<size_t> rows( m );
+    int empty_cells = 0 , leaves = 0;
+
+    /// baza w wezlach - ta sama w kazdej komorce
+    for( int a = 0 , r = 0 ; a <= s2 ; a += 2 )
+        for( int b = 0 ; b <= s2 ; b += 2 )
+            for( int c = 0 ; c <= s2 ; c += 2 , r++ )
+            {
+                int idx[3] = { a , b , c };
+                double T[3][MaxDegree+1];
+                for( int i = 0 ; i < 3 ; i++ ) chebyshev( 2.0 * idx[i] / s2 - 1.0 , degree , T[i] );
+                for( int j = 0 ; j < p ; j++ )
+                    basis[ size_t( j ) * m + r ] = T[0][ all[3*j] ] * T[1][ all[3*j+1] ] * T[2][ all[3*j+2] ];
+                rows[r] = at( a , b , c );
+            }
+
+    for( size_t ci = 0 ; ci < box.size() ; ci++ )
+    {
+        Box const bx = box[ci];
+        child.push_back( -1 );
+        cell_err.resize( cell_err.size() + Keys , 0.0f );
+        float *ce = &cell_err[ ci * Keys ];
+
+        /// punkty komorki
+        bool good = true;
+        double ymin[Keys];
+        for( int o = 0 ; o < Keys ; o++ ) ymin[o] = HUGE_VAL;
+        for( int a = 0 ; a <= s2 && good ; a++ )
+            for( int b = 0 ; b <= s2 && good ; b++ )
+                for( int c = 0 ; c <= s2 && good ; c++ )
+                {
+                    if( !lattice( a , b , c ) ) continue;
+
+                    int idx[3] = { a , b , c };
+                    double x[3];
+                    for( int i = 0 ; i < 3 ; i++ ) x[i] = lo[i] + ( hi[i] - lo[i] ) * ( bx.x[i] + bx.w * idx[i] / s2 );
+
+                    CycleSolver::Point pt;
+                    good = ok[ at( a , b , c ) ] = solver.solve( &atm , x[0] , x[1] , x[2] , pt );
+                    double const *v = reinterpret_cast<double const*>( &pt );
+                    for( int o = 0 ; o < Keys ; o++ )
+                    {
+                        Y[ at( a , b , c ) * Keys + o ] = v[ field( o ) ];
+                        ymin[o] = std::min( ymin[o] , fabs( v[ field( o ) ] ) );
+                    }
+                }
+        if( !good )
+        {
+            for( int o = 0 ; o < Keys ; o++ ) ce[o] = HUGE_VALF;
+            first.push_back( first.back() );
+            empty_cells++;
+            continue;
+        }
+
+        A = basis;
+        for( int o = 0 ; o < Keys ; o++ )
+            for( int k = 0 ; k < m ; k++ ) B[ size_t( o ) * m + k ] = Y[ rows[k] * Keys + o ];
+
+        if( !least_squares( A , m , p , B , Keys ) )
+        {
+            std::cerr << "Surrogate: singular fit" << std::endl;
+            first.clear();
+            return false;
+        }
+        for( int o = 0 ; o < Keys ; o++ )
+            for( int j = 0 ; j < p ; j++ ) full[ size_t( j ) * Keys + o ] = B[ size_t( o ) * m + j ];
+
+        /// rzadkosc - osobno dla kazdego wyjscia
+        for( int o = 0 ; o < Keys ; o++ )
+        {
+            double rmax = 0.0;
+            for( int k = 0 ; k < m ; k++ )
+            {
+                double v = 0.0;
+                for( int j = 0 ; j < p ; j++ ) v += basis[ size_t( j ) * m + k ] * full[ size_t( j ) * Keys + o ];
+                rmax = std::max( rmax , fabs( v - Y[ rows[k] * Keys + o ] ) );
+            }
+
+            std::vector<int> order( p );
+            for( int j = 0 ; j < p ; j++ ) order[j] = j;
+            std::sort( order.begin() , order.end() , [&]( int a , int b )
+                       { return fabs( full[ size_t( a ) * Keys + o ] ) < fabs( full[ size_t( b ) * Keys + o ] ); } );
+
+            std::vector<bool> keep( p , true );
+            double dropped = 0.0;
+            int    kept    = p;
+            for( int k = 0 ; k < p - 1 ; k++ )
+            {
+                double c = fabs( full[ size_t( order[k] ) * Keys + o ] );
+                if( dropped + c > 0.5 * rmax ) break;
+                dropped += c;
+                keep[ order[k] ] = false;
+                kept--;
+            }
+            if( kept == p ) continue;
+
+            std::vector<double> As( size_t( m ) * kept ) , Bs( m );
+            for( int k = 0 ; k < m ; k++ ) Bs[k] = Y[ rows[k] * Keys + o ];
+            for( int j = 0 , n = 0 ; j < p ; j++ )
+                if( keep[j] ) std::copy( &basis[ size_t( j ) * m ] , &basis[ size_t( j ) * m ] + m , &As[ size_t( n++ ) * m ] );
+
+            if( !least_squares( As , m , kept , Bs , 1 ) ) continue;
+            for( int j = 0 , n = 0 ; j < p ; j++ )
+                full[ size_t( j ) * Keys + o ] = keep[j] ? Bs[ n++ ] : 0.0;
+        }
+
+        for( int j = 0 ; j < p ; j++ )
+        {
+            bool used = false;
+            for( int o = 0 ; o < Keys ; o++ ) used = used || full[ size_t( j ) * Keys + o ] != 0.0;
+            if( !used ) continue;
+
+            power.insert( power.end() , &all[3*j] , &all[3*j] + 3 );
+            for( int o = 0 ; o < Stride ; o++ ) coef.push_back( o < Keys ? float( full[ size_t( j ) * Keys + o ] ) : 0.0f );
+        }
+        first.push_back( uint32_t( power.size() / 3 ) );
+
+        /// oszacowanie bledu - wezly i srodki komorki
+        double e_max[Keys] = { 0.0 };
+        for( int a = 0 ; a <= s2 ; a++ )
+            for( int b = 0 ; b <= s2 ; b++ )
+                for( int c = 0 ; c <= s2 ; c++ )
+                {
+                    if( !lattice( a , b , c ) ) continue;
+
+                    double u[3] = { 2.0 * a / s2 - 1.0 , 2.0 * b / s2 - 1.0 , 2.0 * c / s2 - 1.0 };
+                    float v[Stride];
+                    poly( int( ci ) , u , v );
+                    double const *y = &Y[ at( a , b , c ) * Keys ];
+                    for( int o = 0 ; o < Keys ; o++ ) e_max[o] = std::max( e_max[o] , fabs( v[o] - y[o] ) );
+                }
+
+        /// podzial na 8 - komorka przecina zalamanie , oszacowanie ponad refine_tol
+        bool split = false;
+        for( int o = 0 ; o < Keys ; o++ ) split = split || safety * e_max[o] > refine_tol * ymin[o];
+        if( split && bx.depth < max_depth )
+        {
+            power.resize( size_t( first[ci] ) * 3 );
+            coef.resize( size_t( first[ci] ) * Stride );
+            first.back() = first[ci];
+            child[ci] = int32_t( box.size() );
+
+            double w = 0.5 * bx.w;
+            for( int k = 0 ; k < 8 ; k++ )
+            {
+                Box b = { { bx.x[0] + ( k >> 2 & 1 ) * w , bx.x[1] + ( k >> 1 & 1 ) * w , bx.x[2] + ( k & 1 ) * w } ,
+                          w , bx.depth + 1 };
+                box.push_back( b );
+            }
+            continue;
+        }
+
+        leaves++;
+        for( int o = 0 ; o < Keys ; o++ )
+        {
+            fit_err[o] = std::max( fit_err[o] , e_max[o] );
+            ce[o]      = float( safety * e_max[o] );
+        }
+    }
+
+    if( leaves == 0 )
+    {
+        std::cerr << "Surrogate: no converged cell" << std::endl;
+        first.clear();
+        return false;
+    }
+    if( empty_cells )
+        std::cerr << "Surrogate: " << empty_cells << " of " << empty_cells + leaves << " cells without model" << std::endl;
+    return true;
+}
+
+bool Surrogate::save( const char *path ) const
+{
+    std::ofstream f( path , std::ios::binary | std::ios::trunc );
+    if( !f )
+    {
+        std::cerr << "Surrogate: " << path << ": cannot open" << std::endl;
+        return false;
+    }
+
+    FileHeader h = { file_magic , version , uint32_t( Keys ) , uint32_t( degree ) , uint32_t( cells ) ,
+                     uint32_t( samples ) , uint32_t( get_terms() ) , uint32_t( get_nodes() ) };
+    std::vector<uint8_t> pw( power );
+    pw.resize( ( pw.size() + 7 ) & ~size_t( 7 ) , 0 );
+
+    f.write( reinterpret_cast<const char*>( &h ) , sizeof( h ) );
+    f.write( reinterpret_cast<const char*>( lo ) , sizeof( lo ) );
+    f.write( reinterpret_cast<const char*>( hi ) , sizeof( hi ) );
+    f.write( reinterpret_cast<const char*>( &deck_sum ) , sizeof( deck_sum ) );
+    f.write( reinterpret_cast<const char*>( &safety ) , sizeof( safety ) );
+    f.write( reinterpret_cast<const char*>( fit_err ) , sizeof( fit_err ) );
+    f.write( reinterpret_cast<const char*>( first.data() ) , first.size() * sizeof( uint32_t ) );
+    f.write( reinterpret_cast<const char*>( child.data() ) , child.size() * sizeof( int32_t ) );
+    f.write( reinterpret_cast<const char*>( pw.data() ) , pw.size() );
+    f.write( reinterpret_cast<const char*>( coef.data() ) , coef.size() * sizeof( float ) );
+    f.write( reinterpret_cast<const char*>( cell_err.data() ) , cell_err.size() * sizeof( float ) );
+
+    if( !f )
+    {
+        std::cerr << "Surrogate: " << path << ": write error" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Surrogate::load( const char *path , std::weak_ptr<EngineData> Dat )
+{
+    std::ifstream f( path , std::ios::binary );
+    if( !f )
+    {
+        std::cerr << "Surrogate: " << path << ": cannot open" << std::endl;
+        return false;
+    }
+
+    FileHeader h;
+    if( !f.read( reinterpret_cast<char*>( &h ) , sizeof( h ) ) || h.magic != file_magic || h.version != version ||
+        h.outputs != uint32_t( Keys ) || !h.degree || h.degree > uint32_t( MaxDegree ) ||
+        !h.cells || h.cells > 64 || h.nodes < h.cells * h.cells * h.cells || h.nodes > ( 1u << 26 ) ||
+        h.terms > h.nodes * 165u )
+    {
+        std::cerr << "Surrogate: " << path << ": not a surrogate model" << std::endl;
+        return false;
+    }
+
+    size_t nc = h.nodes;
+    double L[3] , U[3] , S , E[Keys];
+    uint64_t sum;
+    std::vector<uint32_t> fi( nc + 1 );
+    std::vector<int32_t>  ch( nc );
+    std::vector<uint8_t>  pw( ( size_t( h.terms ) * 3 + 7 ) & ~size_t( 7 ) );
+    std::vector<float>    c( size_t( h.terms ) * Stride );
+    std::vector<float>    ce( nc * Keys );
+
+    f.read( reinterpret_cast<char*>( L ) , sizeof( L ) );
+    f.read( reinterpret_cast<char*>( U ) , sizeof( U ) );
+    f.read( reinterpret_cast<char*>( &sum ) , sizeof( sum ) );
+    f.read( reinterpret_cast<char*>( &S ) , sizeof( S ) );
+    f.read( reinterpret_cast<char*>( E ) , sizeof( E ) );
+    f.read( reinterpret_cast<char*>( fi.data() ) , fi.size() * sizeof( uint32_t ) );
+    f.read( reinterpret_cast<char*>( ch.data() ) , ch.size() * sizeof( int32_t ) );
+    f.read( reinterpret_cast<char*>( pw.data() ) , pw.size() );
+    f.read( reinterpret_cast<char*>( c.data() ) , c.size() * sizeof( float ) );
+    f.read( reinterpret_cast<char*>( ce.data() ) , ce.size() * sizeof( float ) );
+
+    if( !f )
+    {
+        std::cerr << "Surrogate: " << path << ": truncated" << std::endl;
+        return false;
+    }
+
+    bool good = fi[0] == 0 && fi[nc] == h.terms;
+    for( size_t k = 0 ; k < nc && good ; k++ ) good = fi[k] <= fi[k+1];
+    /// dzieci za rodzicem - locate() konczy sie w lisciu
+    for( size_t k = 0 ; k < nc && good ; k++ ) good = ch[k] == -1 || ( size_t( ch[k] ) > k && size_t( ch[k] ) + 8 <= nc );
+    for( size_t k = 0 ; k < size_t( h.terms ) * 3 && good ; k++ ) good = pw[k] <= h.degree;
+    for( int i = 0 ; i < 3 && good ; i++ ) good = U[i] > L[i];
+    if( !good )
+    {
+        std::cerr << "Surrogate: " << path << ": corrupt model" << std::endl;
+        return false;
+    }
+    if( sum != deck_checksum( Dat ) )
+    {
+        std::cerr << "Surrogate: " << path << ": trained on another deck" << std::endl;
+        return false;
+    }
+
+    pw.resize( size_t( h.terms ) * 3 );
+    degree  = int( h.degree );
+    samples = int( h.samples );
+    cells   = int( h.cells );
+    safety  = S;
+    for( int i = 0 ; i < 3 ; i++ ) { lo[i] = L[i]; hi[i] = U[i]; }
+    for( int k = 0 ; k < Keys ; k++ ) fit_err[k] = E[k];
+    deck_sum = sum;
+    first.swap( fi );
+    child.swap( ch );
+    power.swap( pw );
+    coef.swap( c );
+    cell_err.swap( ce );
+    return true;
+}
+
+SurrogateCycle::SurrogateCycle( std::weak_ptr<EngineData> Dat , Surrogate const &S ) : sur( S ) , full( Dat )
+{
+    for( int p = 0 ; p < CycleSolver::Params ; p++ ) par0[p] = full.get_param( CycleSolver::Param( p ) );
+    set_tolerance( 1.0e-3 );
+    last = false;
+    reset_stats();
+}
+
+bool SurrogateCycle::solve( Atmosphere *atm , double H_alt , double Mach , double throttle , CycleSolver::Point &out )
+{
+    /// Mach , throttle i eta_ks ustawia solve()
+    bool defaults = true;
+    for( int p = CycleSolver::P_sigma_H1 ; p < CycleSolver::Params && defaults ; p++ )
+        defaults = p == CycleSolver::P_eta_ks || full.get_param( CycleSolver::Param( p ) ) == par0[p];
+
+    double y[Surrogate::Keys] , err[Surrogate::Keys];
+    if( defaults && sur.eval( H_alt , Mach , throttle , y , err ) )
+    {
+        bool ok = true;
+        for( int k = 0 ; k < Surrogate::Keys && ok ; k++ ) ok = err[k] <= tol[k] * fabs( y[k] );
+        if( ok )
+        {
+            double *v = reinterpret_cast<double*>( &out );
+            for( int i = 0 ; i < Fields ; i++ ) v[i] = NAN;
+            for( int k = 0 ; k < Surrogate::Keys ; k++ ) v[ Surrogate::field( k ) ] = y[k];
+
+            full.set_point( atm , H_alt , Mach , throttle );
+            full.inlet_point( out );
+            last = true;
+            stats.hits++;
+            return true;
+        }
+    }
+
+    last = false;
+    stats.fallbacks++;
+    return full.solve( atm , H_alt , Mach , throttle , out );
+}
@@ -0,0 +1,193 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <CycleSolver.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/// Model zastepczy ustalonego punktu pracy - do petli optymalizacji , ktore
+/// licza obieg miliony razy.
+///
+/// Modelowane sa tylko wyjscia kluczowe ( Key: n_wc , T4s , m3 , T5s , P_free ) -
+/// predkosc wytwornicy , temperatury ograniczen , wydatek i moc na wale.
+/// Pozostale pola CycleSolver::Point liczy tylko pelny obieg.
+/// Trenowany prostopadloscian ( H , Mach , throttle ) podzielony na cells^3
+/// komorek; w kazdej wyjscie kluczowe jest wielomianem ( baza Czebyszewa
+/// zmiennych komorki przeskalowanych do [ -1 , 1 ] , stopien calkowity <= degree ).
+/// Charakterystyki decku sa odcinkowo liniowe - jeden wielomian na caly obszar
+/// zle oddaje zalamania , maly w komorce - dobrze. Komorka , w ktorej
+/// oszacowanie przekracza refine_tol , jest dzielona na 8 ( najwyzej max_depth
+/// razy ) - male komorki tylko przy zalamaniach , bez siatki gestej wszedzie.
+/// Uczenie:
+///   - punkty ustalone z CycleSolver w wezlach siatki komorki ( samples na
+///     krawedz ) - najmniejsze kwadraty ( Householder QR ) osobno w kazdej komorce;
+///   - rzadkosc: dla kazdego wyjscia odrzucane sa najmniejsze wspolczynniki ,
+///     dopoki ich suma ( |T_k| <= 1 ) nie przekroczy polowy bledu dopasowania ,
+///     potem dopasowanie od nowa na pozostalych; wyraz pomijany , gdy jest zerem
+///     we wszystkich wyjsciach;
+///   - oszacowanie bledu: najwiekszy | blad | w komorce na wezlach i na
+///     srodkach miedzy wezlami ( nie uzytych do dopasowania ) razy safety ,
+///     plus NoiseFloor | y | - szum pelnego obiegu ( tolerancja CycleSolver ,
+///     tablice atmosfery ) , ktorego nie widac w komorkach dopasowanych prawie
+///     dokladnie. Komorka z punktem bez zbieznosci nie ma modelu.
+/// Wspolczynniki i oszacowania sa float ( blad zaokraglenia ~1e-7 wzglednie ,
+/// wliczony w oszacowanie - liczy je ten sam poly() ).
+/// Domyslnie cells 6 , degree 2 , samples 4 , refine_tol 1e-3 , max_depth 3:
+/// wyraz to Stride float ( pol linii cache ) , komorka najwyzej 10 wyrazow -
+/// eval() czyta kilka linii; oszacowanie ponizej 1e-3 w prawie calym obszarze.
+/// Obliczenie: zejscie do liscia ( polowki osi ) , wielomiany Czebyszewa trzech
+/// zmiennych , potem dla kazdego wyrazu jeden wiersz wspolczynnikow wszystkich
+/// wyjsc ( Stride liczb , ciagle w pamieci - petla wektoryzowana przez
+/// kompilator ). Na granicy komorek model jest nieciagly ( skok w granicach bledu ).
+///
+/// Plik obok decku ( path_for ) zawiera sume kontrolna decku - load() odrzuca
+/// model uczony na innym decku. Uczenie - przy domyslnych parametrach
+/// CycleSolver ( set_param ).
+class Surrogate
+{
+public:
+    /// Wyjscia modelowane - field() to ich indeks w CycleSolver::Point
+    enum Key { K_n_wc = 0 , K_T4s , K_m3 , K_T5s , K_P_free , Keys , Stride = ( Keys + 7 ) & ~7 };
+
+    static constexpr double NoiseFloor = 1.0e-5;       ///< [-] - wzgledny blad dodawany do oszacowania
+
+    Surrogate();
+
+    void set_degree( int D )     { degree = D; }         ///< stopien calkowity wielomianu komorki
+    void set_samples( int N )    { samples = N; }        ///< wezly uczace na krawedz komorki
+    void set_cells( int N )      { cells = N; }          ///< komorki na os
+    void set_safety( double S )  { safety = S; }         ///< mnoznik najwiekszego bledu
+
+    /// Podzial komorek: oszacowanie ponad Tol | y | ( wzglednie ) - komorka dzielona
+    /// na 8 , najwyzej Depth razy ( 0 - bez podzialu )
+    void set_refinement( double Tol , int Depth ) { refine_tol = Tol; max_depth = Depth; }
+
+    /// Uczenie w prostopadloscianie lo..hi ( H , Mach , throttle ); false - za malo
+    /// zbieznych punktow albo zly zakres ( opis na cerr )
+    bool train( std::weak_ptr<EngineData> Dat , double const lo[3] , double const hi[3] );
+
+    bool save( const char *path ) const;
+
+    /// false - nie model , uszkodzony plik albo suma decku inna niz Dat
+    bool load( const char *path , std::weak_ptr<EngineData> Dat );
+
+    /// Plik modelu dla decku: deck + ".sur"
+    static std::string path_for( const char *deck );
+
+    bool empty() const { return first.empty(); }
+    int  get_cells() const { return cells; }                         ///< komorki na os przed podzialem
+    int  get_nodes() const { return int( child.size() ); }           ///< komorki , takze podzielone
+    int  get_degree() const { return degree; }
+    int  get_terms() const { return int( power.size() / 3 ); }     ///< wyrazy wszystkich komorek
+    size_t get_bytes() const;                                       ///< rozmiar tablic modelu
+
+    double const *get_lo() const { return lo; }
+    double const *get_hi() const { return hi; }
+
+    bool inside( double H_alt , double Mach , double throttle ) const;
+
+    /// Wyjscia kluczowe w punkcie ( y[k] - Key ) i oszacowanie ich bledu ( err
+    /// moze byc 0 ). false - poza obszarem albo komorka bez modelu ( y nieustalone )
+    bool eval( double H_alt , double Mach , double throttle , double y[Keys] , double err[Keys] = 0 ) const;
+
+    /// Najwiekszy zmierzony blad wyjscia w calym obszarze ( bez safety )
+    double get_fit_error( int k ) const { return fit_err[k]; }
+
+    static const char *output_name( int k );
+
+    /// Indeks wyjscia k w CycleSolver::Point ( jako tablicy double )
+    static int field( int k );
+
+private:
+    /// Komorka punktu i wspolrzedne w niej ( [ -1 , 1 ] )
+    int  locate( double const x[3] , double u[3] ) const;
+    void poly( int c , double const u[3] , float acc[Stride] ) const;
+
+    static int const MaxDepth = 6;
+
+    int    degree , samples , cells;
+    double safety;
+    double refine_tol;
+    int    max_depth;
+
+    double lo[3] , hi[3];
+    uint64_t deck_sum;
+
+    std::vector<uint32_t> first;        ///< komorki + 1 - pierwszy wyraz komorki ( podzielona - bez wyrazow )
+    std::vector<int32_t>  child;        ///< komorki - pierwsze z 8 dzieci , -1 - lisc
+    std::vector<uint8_t>  power;        ///< wyrazy x 3 - stopnie T_k w H , Mach , throttle
+    std::vector<float>    coef;         ///< wyrazy x Stride
+    std::vector<float>    cell_err;     ///< komorki x Keys ( HUGE_VALF - komorka bez modelu )
+    double fit_err[Keys];
+};
+
+/// Punkt pracy z modelu zastepczego , a gdy punkt jest poza obszarem albo
+/// oszacowanie bledu ktoregos wyjscia kluczowego przekracza jego tolerancje -
+/// z pelnego obiegu ( CycleSolver , wlot ... turbina swobodna ). Pelny obieg
+/// takze wtedy , gdy parametry solver() sa inne niz domyslne - model ich nie zna.
+/// Punkt z modelu ( last_surrogate() ) ma wyjscia kluczowe , wlot i paliwo
+/// ( TH , pH , T2s , p2s , q_pal - wzory zamkniete z CycleSolver::set_point );
+/// pozostale pola sa NaN - kto ich potrzebuje , liczy pelny obieg.
+///
+/// Domyslna tolerancja 1e-3 ( wzgledna , kazde wyjscie kluczowe ); komorki
+/// przecinajace zalamania charakterystyk jej nie spelniaja i wracaja do pelnego
+/// obiegu.
+class SurrogateCycle
+{
+public:
+    struct Stats
+    {
+        long hits;                      ///< punkty z modelu zastepczego
+        long fallbacks;                 ///< punkty z pelnego obiegu
+    };
+
+    SurrogateCycle( std::weak_ptr<EngineData> Dat , Surrogate const &S );
+
+    /// Dopuszczalny blad wzgledny ( oszacowanie / | wartosc | ) - wszystkich wyjsc
+    /// kluczowych albo jednego ( Surrogate::Key , np. luzniej dla wyjsc , ktore
+    /// wywolujacego nie interesuja )
+    void set_tolerance( double Rel )          { for( int k = 0 ; k < Surrogate::Keys ; k++ ) tol[k] = Rel; }
+    void set_tolerance( int k , double Rel )  { tol[k] = Rel; }
+    double get_tolerance( int k ) const       { return tol[k]; }
+
+    bool solve( Atmosphere *atm , double H_alt , double Mach , double throttle , CycleSolver::Point &out );
+
+    bool last_surrogate() const { return last; }      ///< ostatni punkt z modelu zastepczego
+
+    CycleSolver & solver() { return full; }
+    Stats const & get_stats() const { return stats; }
+    void          reset_stats() { stats.hits = stats.fallbacks = 0; }
+
+private:
+    Surrogate const &sur;
+    CycleSolver full;
+    double par0[CycleSolver::Params];   ///< parametry domyslne
+    double tol[Surrogate::Keys];
+    bool   last;
+    Stats  stats;
+};
+
+#endif // SURROGATE_H
@@ -0,0 +1,195 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Sweep.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+
+Sweep::Sweep( std::weak_ptr<EngineData> Dat )
+{
+    dat = Dat.lock();
+
+    max_steps = 200;
+    tol       = 1.0e-6;
+    grain     = 64;
+    time_s    = 0.0;
+    precision = Double;
+}
+
+void Sweep::set_grid( std::vector<double> const &H , std::vector<double> const &Ma ,
+                      std::vector<double> const &thr , std::vector<double> const &n )
+{
+    points.clear();
+    points.reserve( H.size() * Ma.size() * thr.size() * n.size() );
+
+    for( size_t i = 0 ; i < H.size() ; i++ )
+        for( size_t j = 0 ; j < Ma.size() ; j++ )
+            for( size_t k = 0 ; k < thr.size() ; k++ )
+                for( size_t l = 0 ; l < n.size() ; l++ )
+                {
+                    Point p = { H[i] , Ma[j] , thr[k] , n[l] };
+                    points.push_back( p );
+                }
+}
+
+void Sweep::run( ThreadPool &pool , Atmosphere *atm )
+{
+    results.resize( points.size() );
+
+    workers.resize( pool.size() );
+    for( size_t w = 0 ; w < workers.size() ; w++ )
+    {
+        /// flota na grain silnikow raz na watek - porcje licza jej poczatek
+        Worker &wk = workers[w];
+        if( precision == Float )
+        {
+            if( !wk.fleet_f )
+                wk.fleet_f = std::make_shared<EngineFleetF>( dat , grain );
+            else if( wk.fleet_f->capacity() < grain )
+                wk.fleet_f->resize( grain );
+        }
+        else if( !wk.fleet )
+            wk.fleet = std::make_shared<EngineFleet>( dat , grain );
+        else if( wk.fleet->capacity() < grain )
+            wk.fleet->resize( grain );
+        wk.T4_prev.resize( grain );
+        wk.T5_prev.resize( grain );
+        wk.steps.resize( grain );
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    pool.parallel_for( long( points.size() ) , grain , [&]( long b , long e , int w )
+    {
+        run_chunk( b , e , w , atm );
+    } );
+
+    time_s = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+    cout << "Sweep: " << points.size() << " points on " << pool.size() << " threads"
+         << ( precision == Float ? " ( float )" : "" ) << " in "
+         << time_s << " s - " << get_rate() << " points/s" << endl;
+}
+
+void Sweep::run_chunk( long b , long e , int w , Atmosphere *atm )
+{
+    Worker &wk = workers[w];
+
+    if( precision == Float )
+        run_fleet( *wk.fleet_f , wk , b , e , atm );
+    else
+        run_fleet( *wk.fleet , wk , b , e , atm );
+}
+
+template <class F>
+void Sweep::run_fleet( F &f , Worker &wk , long b , long e , Atmosphere *atm )
+{
+    int n = int( e - b );
+    f.set_active( n );
+    f.init_fleet();
+
+    for( int i = 0 ; i < n ; i++ )
+    {
+        Point const &p = points[ b + i ];
+        f.set_H_alt( i , p.H_alt );
+        f.set_Mach( i , p.Mach );
+        f.set_throttle( i , p.throttle );
+        f.set_n_wc( i , p.n_wc );
+    }
+
+    typename F::Temp const &T = f.get_temp();
+    std::vector<int> &steps = wk.steps;
+    std::fill( steps.begin() , steps.begin() + n , 0 );
+
+    int s = 0;
+    int open = n;
+    while( open > 0 && s < max_steps )
+    {
+        for( int i = 0 ; i < n ; i++ )
+        {
+            wk.T4_prev[i] = T.T4s[i];
+            wk.T5_prev[i] = T.T5s[i];
+        }
+
+        f.update_alt( atm );
+        s++;
+
+        open = 0;
+        for( int i = 0 ; i < n ; i++ )
+        {
+            if( steps[i] ) continue;
+
+            double d4 = fabs( T.T4s[i] - wk.T4_prev[i] );
+            double d5 = fabs( T.T5s[i] - wk.T5_prev[i] );
+
+            if( s > 1 && d4 <= tol * fabs( T.T4s[i] ) && d5 <= tol * fabs( T.T5s[i] ) )
+                steps[i] = s;
+            else
+                open++;
+        }
+    }
+
+    for( int i = 0 ; i < n ; i++ )
+    {
+        typename F::Lane L = f.lane( i );
+        Result &r = results[ b + i ];
+
+        r.TH  = L.get_TH();    r.pH  = L.get_pH();
+        r.T1s = L.get_T1_s();  r.p1s = L.get_p1_s();  r.c1 = L.get_c1();
+        r.T3s = L.get_T3_s();  r.p3s = L.get_p3_s();  r.m3 = L.get_m3();
+        r.T4s = L.get_T4_s();  r.p4s = L.get_p4_s();  r.m4 = L.get_m4();
+        r.T5s = L.get_T5_s();  r.p5s = L.get_p5_s();  r.Pt = L.get_Pt();
+        r.T6s = L.get_T6_s();  r.wpt = L.get_wpt();
+
+        r.settled = steps[i] > 0;
+        r.steps   = r.settled ? steps[i] : s;
+    }
+}
+
+bool Sweep::write( const char *path ) const
+{
+    std::ofstream out( path );
+    if( !out ) return false;
+
+    out << "# H_alt Mach throttle n_wc TH pH T1s p1s c1 T3s p3s m3 T4s p4s m4 T5s p5s Pt T6s wpt steps settled\n";
+    out.precision( 10 );
+
+    for( size_t i = 0 ; i < points.size() && i < results.size() ; i++ )
+    {
+        Point  const &p = points[i];
+        Result const &r = results[i];
+
+        out << p.H_alt << " " << p.Mach << " " << p.throttle << " " << p.n_wc << " "
+            << r.TH  << " " << r.pH  << " "
+            << r.T1s << " " << r.p1s << " " << r.c1 << " "
+            << r.T3s << " " << r.p3s << " " << r.m3 << " "
+            << r.T4s << " " << r.p4s << " " << r.m4 << " "
+            << r.T5s << " " << r.p5s << " " << r.Pt << " "
+            << r.T6s << " " << r.wpt << " "
+            << r.steps << " " << r.settled << "\n";
+    }
+    return bool( out );
+}
@@ -0,0 +1,119 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <EngineFleet.h>
+#include <ThreadPool.h>
+#include <memory>
+#include <vector>
+
+/// Przeglad obwiedni pracy: wysokosc x Mach x przepustnica x predkosc wirnika.
+///
+/// Punkty ( siatka albo lista ) dzielone sa na porcje po grain punktow i liczone
+/// na wszystkich watkach puli z podkradaniem pracy. Kazdy watek ma wlasna flote
+/// EngineFleet o rozmiarze porcji - punkty porcji to silniki floty, krokowane
+/// lancuchem wlot -> sprezarka -> komora -> turbina -> turbina swobodna az do
+/// ustalenia ( zmiana T4 i T5 miedzy krokami < tol ) albo max_steps krokow.
+/// Wynik punktu i zapisywany jest pod indeksem i - kolejnosc siatki bez blokad.
+/// set_precision( Float ) liczy floty w pojedynczej precyzji ( EngineFleetF ) -
+/// do szybkiego przegladu , zakres stosowalnosci: tools/precision.
+class Sweep
+{
+public:
+    enum Precision
+    {
+        Double = 0,
+        Float
+    };
+
+    struct Point
+    {
+        double H_alt;           ///< [m]
+        double Mach;            ///< [-]
+        double throttle;        ///< [-]
+        double n_wc;            ///< [rad/s]
+    };
+
+    struct Result
+    {
+        double TH , pH;
+        double T1s , p1s , c1;
+        double T3s , p3s , m3;
+        double T4s , p4s , m4;
+        double T5s , p5s , Pt;
+        double T6s , wpt;
+        int    steps;           ///< liczba krokow do ustalenia
+        bool   settled;
+    };
+
+    Sweep( std::weak_ptr<EngineData> Dat );
+
+    /// Siatka w kolejnosci H ( najwolniej ) , Mach , throttle , n_wc ( najszybciej )
+    void set_grid( std::vector<double> const &H , std::vector<double> const &Ma ,
+                   std::vector<double> const &thr , std::vector<double> const &n );
+    void set_points( std::vector<Point> const &Points ) { points = Points; }
+
+    void set_settle( int Max_steps , double Tol ) { max_steps = Max_steps; tol = Tol; }
+    void set_grain( int Grain ) { grain = Grain; }
+    void set_precision( Precision p ) { precision = p; }
+    Precision get_precision() const   { return precision; }
+
+    void run( ThreadPool &pool , Atmosphere *atm );
+
+    std::vector<Point>  const & get_points()  const { return points;  }
+    std::vector<Result> const & get_results() const { return results; }
+
+    double get_time() const { return time_s; }                          ///< [s]
+    double get_rate() const { return time_s > 0.0 ? points.size() / time_s : 0.0; }  ///< [punkty/s]
+
+    bool write( const char *path ) const;       ///< tekst, jeden punkt na wiersz
+
+private:
+    void run_chunk( long b , long e , int w , Atmosphere *atm );
+
+    struct Worker;
+    template <class F> void run_fleet( F &f , Worker &wk , long b , long e , Atmosphere *atm );
+
+    std::shared_ptr<EngineData> dat;
+
+    std::vector<Point>  points;
+    std::vector<Result> results;
+
+    int    max_steps;
+    double tol;
+    int    grain;
+    double time_s;
+    Precision precision;
+
+    struct Worker
+    {
+        std::shared_ptr<EngineFleet>  fleet;
+        std::shared_ptr<EngineFleetF> fleet_f;
+        std::vector<double> T4_prev , T5_prev;
+        std::vector<int>    steps;
+    };
+    std::vector<Worker> workers;
+};
+
+#endif // SWEEP_H
@@ -0,0 +1,249 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <vector>
+#include <math.h>
+
+/// Kursor tablicy - pamieta ostatni przedzial [ x[zs] , x[zs+1] ] i szuka
+/// nastepnego od niego ( hunt ): krok 1, 2, 4 ... w strone x, potem polowienie.
+/// Przy wolno zmieniajacym sie argumencie ( kolejne kroki symulacji ) przedzial
+/// zwykle sie nie zmienia albo przesuwa o jeden - koszt O(1) zamiast O(log n).
+template <class TYP> class TableCursor
+{
+public:
+    TableCursor() : zs( 0 ) {}
+
+    void reset() { zs = 0; }
+    int  index() const { return zs; }
+
+    template <class Archive> void serialize( Archive &ar ) { ar & zs; }
+
+    /// zs takie, ze x_data[zs] <= x < x_data[zs+1] ( obciete do [ 0 , n-2 ] )
+    int locate( TYP x , const TYP x_data[] , int n )
+    {
+        if( zs > n - 2 ) zs = n - 2;
+        if( zs < 0 )     zs = 0;
+
+        int lo = zs , hi;
+        int inc = 1;
+
+        if( x >= x_data[lo] )
+        {
+            if( lo == n - 2 || x < x_data[lo+1] ) return zs;
+
+            hi = lo + 1;
+            while( hi < n - 1 && x >= x_data[hi] )
+            {
+                lo  = hi;
+                hi += inc;
+                inc += inc;
+            }
+            if( hi > n - 1 ) hi = n - 1;
+        }
+        else
+        {
+            if( lo == 0 ) return zs;
+
+            hi = lo;
+            lo = hi - 1;
+            while( lo > 0 && x < x_data[lo] )
+            {
+                hi  = lo;
+                lo -= inc;
+                inc += inc;
+            }
+            if( lo < 0 ) lo = 0;
+        }
+
+        while( hi - lo > 1 )
+        {
+            int z = ( lo + hi ) / 2;
+            if( x < x_data[z] )
+                hi = z;
+            else
+                lo = z;
+        }
+
+        zs = lo;
+        return zs;
+    }
+
+    /// To samo co Interpolation() , ale z pamiecia przedzialu; n == 0 - zero
+    TYP interpolate( TYP x , const TYP y_val[] , const TYP x_data[] , int n )
+    {
+        if( n < 1 ) return TYP( 0 );
+        if( x <= x_data[0] )        { return y_val[0];   }
+        else if( x >= x_data[n-1] ) { return y_val[n-1]; }
+
+        int i = locate( x , x_data , n );
+        return y_val[i] + ( y_val[i+1] - y_val[i] ) / ( x_data[i+1] - x_data[i] ) * ( x - x_data[i] );
+    }
+
+    /// Argument z pochodnymi ( Dual.h ) - przedzial wg wartosci , pochodna = nachylenie odcinka
+    template <class X> X interpolate( X const &x , const TYP y_val[] , const TYP x_data[] , int n )
+    {
+        if( n < 1 ) return X( TYP( 0 ) );
+        TYP xv = TYP( x );
+        if( xv <= x_data[0] )        { return X( y_val[0] );   }
+        else if( xv >= x_data[n-1] ) { return X( y_val[n-1] ); }
+
+        int i = locate( xv , x_data , n );
+        return ( x - x_data[i] ) * ( ( y_val[i+1] - y_val[i] ) / ( x_data[i+1] - x_data[i] ) ) + y_val[i];
+    }
+
+private:
+    int zs;
+};
+
+/// Tablica z jednym argumentem i N kolumnami wartosci ( np. charakterystyka
+/// sprezarki: rpm -> sprez , eta , mZR ). Przedzial szukany jest raz, a
+/// wszystkie kolumny interpolowane tym samym wspolczynnikiem.
+/// Odwrotnosci dlugosci przedzialow liczone sa przy bind() albo brane
+/// z zapieczetowanego decku ( EngineData::seal ); dla siatki
+/// rownomiernej przedzial wyznaczany jest bez szukania: ( x - x0 ) / dx.
+/// Tablica nie posiada danych - wskazuje na kolumny EngineData.
+template <class TYP , int N> class MultiTable
+{
+public:
+    MultiTable() : x_data( 0 ) , n( 0 ) , inv( 0 ) , uniform( false ) , x0( 0 ) , inv_h( 0 ) {}
+
+    void bind( const TYP *X , const TYP * const Y[N] , int size , const TYP *Inv = 0 )
+    {
+        x_data = X;
+        n      = size;
+        for( int c = 0 ; c < N ; c++ ) y_val[c] = Y[c];
+
+        inv = Inv;
+        inv_dx.clear();
+        if( !inv )
+        {
+            inv_dx.assign( n > 1 ? n - 1 : 1 , TYP( 0 ) );
+            for( int i = 0 ; i + 1 < n ; i++ )
+                inv_dx[i] = TYP( 1 ) / ( x_data[i+1] - x_data[i] );
+        }
+
+        x0      = n > 0 ? x_data[0] : TYP( 0 );
+        inv_h   = n > 1 ? TYP( n - 1 ) / ( x_data[n-1] - x_data[0] ) : TYP( 0 );
+        uniform = n > 1;
+        for( int i = 0 ; i + 1 < n && uniform ; i++ )
+        {
+            TYP h = ( x_data[n-1] - x_data[0] ) / TYP( n - 1 );
+            if( fabs( double( x_data[i+1] - x_data[i] - h ) ) > 1.0e-9 * fabs( double( h ) ) )
+                uniform = false;
+        }
+    }
+
+    int  size()       const { return n; }
+    bool is_uniform() const { return uniform; }
+
+    /// Wartosci wszystkich kolumn w x , przedzial szukany od cur.
+    /// Tablica pusta ( n == 0 , deck bez tablic ) - zera.
+    void lookup( TYP x , TYP out[N] , TableCursor<TYP> &cur ) const
+    {
+        if( n < 1 )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = TYP( 0 );
+            return;
+        }
+        if( x <= x_data[0] )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = y_val[c][0];
+            return;
+        }
+        if( x >= x_data[n-1] )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = y_val[c][n-1];
+            return;
+        }
+
+        int i;
+        if( uniform )
+        {
+            i = int( ( x - x0 ) * inv_h );
+            if( i > n - 2 ) i = n - 2;
+        }
+        else
+            i = cur.locate( x , x_data , n );
+
+        TYP w = ( x - x_data[i] ) * ( inv ? inv[i] : inv_dx[i] );
+
+        for( int c = 0 ; c < N ; c++ )
+            out[c] = y_val[c][i] + ( y_val[c][i+1] - y_val[c][i] ) * w;
+    }
+
+    void lookup( TYP x , TYP out[N] ) { lookup( x , out , cur ); }
+
+    /// Argument z pochodnymi ( Dual.h ) - ten sam przedzial i wspolczynnik
+    /// co dla wartosci x , pochodne kolumn = nachylenie odcinka * dx
+    template <class X> void lookup( X const &x , X out[N] , TableCursor<TYP> &cur ) const
+    {
+        if( n < 1 )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = X( TYP( 0 ) );
+            return;
+        }
+        TYP xv = TYP( x );
+        if( xv <= x_data[0] )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = X( y_val[c][0] );
+            return;
+        }
+        if( xv >= x_data[n-1] )
+        {
+            for( int c = 0 ; c < N ; c++ ) out[c] = X( y_val[c][n-1] );
+            return;
+        }
+
+        int i;
+        if( uniform )
+        {
+            i = int( ( xv - x0 ) * inv_h );
+            if( i > n - 2 ) i = n - 2;
+        }
+        else
+            i = cur.locate( xv , x_data , n );
+
+        X w = ( x - x_data[i] ) * ( inv ? inv[i] : inv_dx[i] );
+
+        for( int c = 0 ; c < N ; c++ )
+            out[c] = w * ( y_val[c][i+1] - y_val[c][i] ) + y_val[c][i];
+    }
+
+private:
+    const TYP *x_data;
+    const TYP *y_val[N];
+    int n;
+
+    const TYP *inv;             ///< 1 / ( x[i+1] - x[i] ) z decku albo 0
+    std::vector<TYP> inv_dx;    ///< 1 / ( x[i+1] - x[i] ) liczone przy bind()
+
+    bool uniform;
+    TYP  x0;
+    TYP  inv_h;                 ///< ( n - 1 ) / ( x[n-1] - x[0] ) dla siatki rownomiernej
+
+    TableCursor<TYP> cur;
+};
+
+#endif // TABLE_H
@@ -0,0 +1,167 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Telemetry.h"
+#include <new>
+#include <string.h>
+
+Telemetry::Telemetry( int Capacity )
+{
+    uint64_t n = 2;
+    while( n < uint64_t( Capacity ) ) n <<= 1;
+    mask = n - 1;
+    step = 0;
+
+    buf = static_cast<Slot*>( aligned_malloc( sizeof( Slot ) * n , CacheLine ) );
+    for( uint64_t i = 0 ; i < n ; i++ )
+    {
+        Slot *s = new( buf + i ) Slot;
+        s->seq.store( 0 , std::memory_order_relaxed );
+        for( int w = 0 ; w < Words ; w++ ) s->word[w].store( 0 , std::memory_order_relaxed );
+    }
+
+    head.store( 0 , std::memory_order_release );
+}
+
+Telemetry::~Telemetry()
+{
+    for( uint64_t i = 0 ; i <= mask ; i++ ) buf[i].~Slot();
+    aligned_free( buf );
+}
+
+void Telemetry::publish( Snapshot const &snap )
+{
+    uint64_t idx = head.load( std::memory_order_relaxed );
+    Slot &s = buf[idx & mask];
+
+    uint64_t w[Words];
+    w[Words-1] = 0;
+    memcpy( w , &snap , sizeof( Snapshot ) );
+
+    s.seq.store( 2 * idx + 1 , std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    for( int i = 0 ; i < Words ; i++ ) s.word[i].store( w[i] , std::memory_order_relaxed );
+
+    s.seq.store( 2 * idx + 2 , std::memory_order_release );
+    head.store( idx + 1 , std::memory_order_release );
+}
+
+void Telemetry::publish( Engine const &eng , double t , double H_alt )
+{
+    Snapshot snap;
+    snap.step      = step++;
+    snap.t         = t;
+    snap.H_alt     = H_alt;
+    snap.Mach      = eng.get_Mach();
+    snap.n_wc      = eng.get_n_wc();
+    snap.throttle  = eng.get_throttle();
+    snap.temp      = eng.get_temp();
+    snap.press     = eng.get_press();
+    snap.mS        = eng.get_mS();
+    snap.speed     = eng.get_speed();
+    snap.P_turbine = eng.get_Pt();
+
+    publish( snap );
+}
+
+Telemetry::Reader Telemetry::reader( bool Oldest ) const
+{
+    uint64_t h = head.load( std::memory_order_acquire );
+    uint64_t n = mask + 1;
+
+    return Reader( this , Oldest ? ( h > n ? h - n : 0 ) : h );
+}
+
+bool Telemetry::Reader::read( uint64_t idx , Snapshot &out ) const
+{
+    Slot const &s = ring->buf[idx & ring->mask];
+
+    if( s.seq.load( std::memory_order_acquire ) != 2 * idx + 2 ) return false;
+
+    uint64_t w[Words];
+    for( int i = 0 ; i < Words ; i++ ) w[i] = s.word[i].load( std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if( s.seq.load( std::memory_order_relaxed ) != 2 * idx + 2 ) return false;
+
+    memcpy( &out , w , sizeof( Snapshot ) );
+    return true;
+}
+
+uint64_t Telemetry::Reader::pending() const
+{
+    return ring ? ring->head.load( std::memory_order_acquire ) - next : 0;
+}
+
+int Telemetry::Reader::drain( Snapshot *out , int max )
+{
+    if( !ring ) return 0;
+
+    int got = 0;
+    while( got < max )
+    {
+        uint64_t h = ring->head.load( std::memory_order_acquire );
+        if( next == h ) break;
+
+        /// wyprzedzony - skok do najstarszej migawki ktora jeszcze jest w pierscieniu
+        uint64_t n = ring->mask + 1;
+        if( h - next > n )
+        {
+            lost += h - n - next;
+            next  = h - n;
+        }
+
+        if( read( next , out[got] ) )
+        {
+            got++;
+            next++;
+        }
+        else
+        {
+            /// slot nadpisany w trakcie czytania - producent jest juz o caly pierscien dalej
+            lost++;
+            next++;
+        }
+    }
+    return got;
+}
+
+bool Telemetry::Reader::latest( Snapshot &out )
+{
+    if( !ring ) return false;
+
+    for( ;; )
+    {
+        uint64_t h = ring->head.load( std::memory_order_acquire );
+        if( next == h ) return false;
+
+        next = h - 1;
+
+        if( read( next , out ) )
+        {
+            next++;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Engine.h>
+#include <atomic>
+#include <stdint.h>
+
+/// Pierscien telemetrii: watek symulacji -> GUI , rejestratory.
+///
+/// Jeden producent ( publish ) i dowolna liczba czytelnikow ( Reader ) -
+/// kazdy czytelnik ma wlasny kursor i czyta wszystkie migawki, nikt nikomu
+/// nie zabiera danych. publish() nigdy nie czeka: pisze do slotu
+/// head % capacity i przesuwa head , nawet jesli czytelnik jest daleko w
+/// tyle. Slot chroniony jest licznikiem sekwencji ( seqlock ): nieparzysty
+/// - zapis w toku , 2 * ( indeks + 1 ) - migawka o danym indeksie gotowa.
+/// Czytelnik ktory zostal wyprzedzony o wiecej niz capacity migawek
+/// przeskakuje do najstarszej dostepnej i liczy utracone ( get_lost ).
+///
+/// Dane slotu to slowa std::atomic<uint64_t> zapisywane i czytane relaxed -
+/// na x86 zwykle mov , a wyscig z zapisem jest zdefiniowany.
+class Telemetry
+{
+public:
+    struct Snapshot
+    {
+        uint64_t step;
+        double   t;                     ///< [s] - czas symulacji
+        double   H_alt;                 ///< [m]
+        double   Mach , n_wc , throttle;
+
+        Engine::Temp     temp;          ///< TH .. T5s
+        Engine::Press    press;         ///< ph .. p5s
+        Engine::MassFlow mS;            ///< mh .. m5
+        Engine::Speed    speed;         ///< ch .. c5
+        double           P_turbine;     ///< [W]
+    };
+
+    enum { Words = ( sizeof( Snapshot ) + 7 ) / 8 };
+
+    class Reader
+    {
+    public:
+        Reader() : ring( 0 ) , next( 0 ) , lost( 0 ) {}
+
+        /// Do max kolejnych migawek do out; zwraca liczbe przeczytanych
+        int drain( Snapshot *out , int max );
+
+        /// Najnowsza migawka ( pomija zalegle ); false - brak nowych
+        bool latest( Snapshot &out );
+
+        uint64_t get_lost() const { return lost; }      ///< migawki nadpisane przed przeczytaniem
+        uint64_t pending()  const;                      ///< migawki czekajace ( moze byc > capacity )
+
+    private:
+        friend class Telemetry;
+        explicit Reader( Telemetry const *Ring , uint64_t Next ) : ring( Ring ) , next( Next ) , lost( 0 ) {}
+
+        bool read( uint64_t idx , Snapshot &out ) const;
+
+        Telemetry const *ring;
+        uint64_t next;
+        uint64_t lost;
+    };
+
+    explicit Telemetry( int Capacity = 4096 );     ///< zaokraglane w gore do potegi 2
+    ~Telemetry();
+
+    /// Zapis migawki - wait-free , wywoluje tylko watek symulacji
+    void publish( Snapshot const &snap );
+
+    /// Migawka silnika po Engine::update
+    void publish( Engine const &eng , double t , double H_alt );
+
+    /// Czytelnik od najnowszej migawki ( Oldest - od najstarszej dostepnej )
+    Reader reader( bool Oldest = false ) const;
+
+    int      capacity()  const { return int( mask + 1 ); }
+    uint64_t published() const { return head.load( std::memory_order_acquire ); }
+
+private:
+    Telemetry( Telemetry const & );
+    Telemetry & operator=( Telemetry const & );
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        std::atomic<uint64_t> word[Words];
+    };
+
+    Slot    *buf;
+    uint64_t mask;
+    uint64_t step;                                  ///< licznik producenta
+
+    std::atomic<uint64_t> head;                     ///< liczba opublikowanych migawek
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,170 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "ThreadPool.h"
+#include <assert.h>
+
+ThreadPool::ThreadPool( int Threads )
+    : ranges( Threads > 0 ? Threads : ( std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1 ) )
+{
+    nthreads   = int( ranges.size() );
+    job        = 0;
+    job_grain  = 1;
+    generation = 0;
+    active     = 0;
+    quit       = false;
+
+    for( int w = 0 ; w < nthreads ; w++ )
+        ranges[w].r = 0;
+
+    for( int w = 1 ; w < nthreads ; w++ )
+        threads.push_back( std::thread( &ThreadPool::worker , this , w ) );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        quit = true;
+    }
+    wake.notify_all();
+
+    for( size_t i = 0 ; i < threads.size() ; i++ )
+        threads[i].join();
+}
+
+bool ThreadPool::take( int w , long &b , long &e )
+{
+    std::atomic<uint64_t> &r = ranges[w].r;
+    uint64_t cur = r.load( std::memory_order_acquire );
+
+    for(;;)
+    {
+        uint32_t rb = uint32_t( cur >> 32 ) , re = uint32_t( cur );
+        if( rb >= re ) return false;
+
+        uint32_t nb = ( re - rb > job_grain ) ? rb + uint32_t( job_grain ) : re;
+        if( r.compare_exchange_weak( cur , pack( nb , re ) , std::memory_order_acq_rel ) )
+        {
+            b = rb;
+            e = nb;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::steal( int w , long &b , long &e )
+{
+    for( int k = 1 ; k < nthreads ; k++ )
+    {
+        int v = ( w + k ) % nthreads;
+        std::atomic<uint64_t> &r = ranges[v].r;
+        uint64_t cur = r.load( std::memory_order_acquire );
+
+        for(;;)
+        {
+            uint32_t rb = uint32_t( cur >> 32 ) , re = uint32_t( cur );
+            if( rb >= re ) break;
+
+            /// ofiara zostawia sobie poczatek, zlodziej bierze polowe od konca
+            uint32_t mid = rb + ( re - rb ) / 2;
+            if( re - rb <= job_grain ) mid = rb;
+
+            if( r.compare_exchange_weak( cur , pack( rb , mid ) , std::memory_order_acq_rel ) )
+            {
+                /// skradziona reszta staje sie wlasnym zakresem ( moga ja podkradac inni )
+                ranges[w].r.store( pack( mid , re ) , std::memory_order_release );
+                return take( w , b , e );
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work( int w )
+{
+    long b , e;
+    for(;;)
+    {
+        while( take( w , b , e ) )
+            ( *job )( b , e , w );
+
+        if( !steal( w , b , e ) )
+            break;
+
+        ( *job )( b , e , w );
+    }
+}
+
+void ThreadPool::worker( int w )
+{
+    long seen = 0;
+
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock( mtx );
+            wake.wait( lock , [&]{ return quit || generation != seen; } );
+            if( quit ) return;
+            seen = generation;
+        }
+
+        work( w );
+
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            if( --active == 0 ) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallel_for( long n , long grain , Body const &body )
+{
+    assert( n >= 0 && n < ( 1L << 32 ) - 1 );
+    if( n <= 0 ) return;
+
+    if( grain < 1 ) grain = 1;
+
+    job       = &body;
+    job_grain = grain;
+
+    for( int w = 0 ; w < nthreads ; w++ )
+    {
+        uint32_t b = uint32_t( n * w / nthreads );
+        uint32_t e = uint32_t( n * ( w + 1 ) / nthreads );
+        ranges[w].r.store( pack( b , e ) , std::memory_order_relaxed );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        active = nthreads - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    work( 0 );
+
+    std::unique_lock<std::mutex> lock( mtx );
+    done.wait( lock , [&]{ return active == 0; } );
+    job = 0;
+}
@@ -0,0 +1,84 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/// Pula watkow z podkradaniem pracy ( work stealing ) dla petli po indeksach.
+///
+/// parallel_for( n , grain , body ) dzieli [ 0 , n ) na rowne zakresy, po jednym
+/// na watek. Watek bierze ze swojego zakresu porcje po grain od poczatku; gdy
+/// zakres sie skonczy, podkrada polowe reszty od konca zakresu innego watku.
+/// Zakres kazdego watku to jedno 64-bitowe slowo atomowe ( poczatek , koniec ),
+/// wiec branie i podkradanie to pojedyncze CAS - bez wspolnej blokady.
+/// Muteks sluzy tylko do usypiania i budzenia watkow miedzy zadaniami.
+/// Watek wywolujacy pracuje jako watek 0.
+class ThreadPool
+{
+public:
+    typedef std::function<void( long begin , long end , int worker )> Body;
+
+    explicit ThreadPool( int Threads = 0 );      ///< 0 - std::thread::hardware_concurrency()
+    ~ThreadPool();
+
+    int size() const { return nthreads; }
+
+    void parallel_for( long n , long grain , Body const &body );
+
+private:
+    struct alignas( 64 ) Range
+    {
+        std::atomic<uint64_t> r;                ///< ( begin << 32 ) | end
+    };
+
+    static uint64_t pack( uint32_t b , uint32_t e ) { return ( uint64_t( b ) << 32 ) | e; }
+
+    bool take( int w , long &b , long &e );     ///< porcja z wlasnego zakresu
+    bool steal( int w , long &b , long &e );    ///< polowa zakresu innego watku
+
+    void worker( int w );
+    void work( int w );
+
+    int nthreads;
+    std::vector<std::thread> threads;
+    std::vector<Range> ranges;
+
+    Body const *job;
+    long job_grain;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    long generation;
+    int  active;
+    bool quit;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,229 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "enginedata.h"
+#include <assert.h>
+#include <string.h>
+
+namespace
+{
+
+/// Dlugosci tablic w kolejnosci DeckHeader::Table
+void table_sizes( int sk , int ck , int tk , int n[DeckHeader::Tables] )
+{
+    n[DeckHeader::RPM]   = n[DeckHeader::SPREZ] = n[DeckHeader::ETA] = n[DeckHeader::MZR] = sk;
+    n[DeckHeader::Q_THR] = n[DeckHeader::Q_TAB] = ck;
+    n[DeckHeader::RPM_T] = n[DeckHeader::EPST]  = n[DeckHeader::MTWC] = tk;
+    n[DeckHeader::INV_RPM]   = sk;
+    n[DeckHeader::INV_Q_THR] = ck;
+    n[DeckHeader::INV_RPM_T] = tk;
+}
+
+size_t line( size_t bytes )
+{
+    return ( ( bytes + CacheLine - 1 ) / CacheLine ) * CacheLine;
+}
+
+/// Zapis do zapieczetowanego decku - blad programu , takze w wersji bez assert
+void sealed_write( char const *what )
+{
+    std::cerr << "EngineData::" << what << ": deck is sealed ( read-only , shared )" << std::endl;
+    abort();
+}
+
+void inverse( double const *x , int n , double *inv )
+{
+    for( int i = 0 ; i + 1 < n ; i++ ) inv[i] = 1.0 / ( x[i+1] - x[i] );
+    if( n > 0 ) inv[n-1] = 0.0;
+}
+
+}
+
+EngineData::EngineData( int Test ) :
+    eta_ks( sc.eta_ks ) , Cp( sc.Cp ) , W_opal( sc.W_opal ) ,
+    A_compressor( sc.A_compressor ) , D_compressor( sc.D_compressor ) , Dw_compressor( sc.Dw_compressor ) ,
+    D_turbine( sc.D_turbine ) , Dw_turbine( sc.Dw_turbine ) , A_turbine( sc.A_turbine )
+{
+    test = Test;
+
+    sk = ck = tk = 0;
+    sc = Scalars();
+
+    block = 0;
+    owned = false;
+    bind( 0 , false );
+}
+
+EngineData::~EngineData()
+{
+    if( owned ) aligned_free( block );
+
+    cout << "~EngineData Destructor ->" << test << endl;
+}
+
+size_t EngineData::arena_size( int Sk , int Ck , int Tk )
+{
+    int n[DeckHeader::Tables];
+    table_sizes( Sk , Ck , Tk , n );
+
+    size_t bytes = line( sizeof( DeckHeader ) );
+    for( int t = 0 ; t < DeckHeader::Tables ; t++ )
+        bytes += line( sizeof( double ) * n[t] );
+    return bytes;
+}
+
+void EngineData::allocate( int Sk , int Ck , int Tk )
+{
+    if( is_sealed() ) sealed_write( "allocate" );
+
+    size_t bytes = arena_size( Sk , Ck , Tk );
+    void *b = aligned_malloc( bytes , CacheLine );
+    assert( b );
+    memset( b , 0 , bytes );
+
+    int n[DeckHeader::Tables];
+    table_sizes( Sk , Ck , Tk , n );
+
+    DeckHeader *h = static_cast<DeckHeader*>( b );
+    h->sk     = Sk;
+    h->ck     = Ck;
+    h->tk     = Tk;
+    h->sealed = 0;
+    h->bytes  = int64_t( bytes );
+
+    size_t off = line( sizeof( DeckHeader ) );
+    for( int t = 0 ; t < DeckHeader::Tables ; t++ )
+    {
+        h->offset[t] = int64_t( off );
+        off += line( sizeof( double ) * n[t] );
+    }
+
+    if( owned ) aligned_free( block );
+    bind( b , true );
+}
+
+void EngineData::bind( void *Block , bool Owned )
+{
+    block = Block;
+    owned = Owned;
+
+    if( !block )
+    {
+        rpm_tab = sprez_tab = eta_tab = mZR_tab = 0;
+        q_pal_thr = q_pal_tab = 0;
+        rpm_tab_t = epsT_roz_tab = mTwc_zr_tab = 0;
+        inv_rpm_tab = inv_q_pal_thr = inv_rpm_tab_t = 0;
+        return;
+    }
+
+    DeckHeader const *h = header();
+    char *base = static_cast<char*>( block );
+
+    sk = h->sk;
+    ck = h->ck;
+    tk = h->tk;
+
+    if( h->sealed )
+    {
+        sc.eta_ks = h->eta_ks;
+        sc.Cp     = h->Cp;
+        sc.W_opal = h->W_opal;
+
+        sc.A_compressor  = h->A_compressor;
+        sc.D_compressor  = h->D_compressor;
+        sc.Dw_compressor = h->Dw_compressor;
+        sc.D_turbine     = h->D_turbine;
+        sc.Dw_turbine    = h->Dw_turbine;
+        sc.A_turbine     = h->A_turbine;
+    }
+
+    rpm_tab      = reinterpret_cast<double const*>( base + h->offset[DeckHeader::RPM] );
+    sprez_tab    = reinterpret_cast<double const*>( base + h->offset[DeckHeader::SPREZ] );
+    eta_tab      = reinterpret_cast<double const*>( base + h->offset[DeckHeader::ETA] );
+    mZR_tab      = reinterpret_cast<double const*>( base + h->offset[DeckHeader::MZR] );
+    q_pal_thr    = reinterpret_cast<double const*>( base + h->offset[DeckHeader::Q_THR] );
+    q_pal_tab    = reinterpret_cast<double const*>( base + h->offset[DeckHeader::Q_TAB] );
+    rpm_tab_t    = reinterpret_cast<double const*>( base + h->offset[DeckHeader::RPM_T] );
+    epsT_roz_tab = reinterpret_cast<double const*>( base + h->offset[DeckHeader::EPST] );
+    mTwc_zr_tab  = reinterpret_cast<double const*>( base + h->offset[DeckHeader::MTWC] );
+
+    if( h->sealed )
+    {
+        inv_rpm_tab   = reinterpret_cast<double const*>( base + h->offset[DeckHeader::INV_RPM] );
+        inv_q_pal_thr = reinterpret_cast<double const*>( base + h->offset[DeckHeader::INV_Q_THR] );
+        inv_rpm_tab_t = reinterpret_cast<double const*>( base + h->offset[DeckHeader::INV_RPM_T] );
+    }
+    else
+        inv_rpm_tab = inv_q_pal_thr = inv_rpm_tab_t = 0;
+}
+
+double *EngineData::table( DeckHeader::Table t )
+{
+    assert( block );
+    if( header()->sealed ) sealed_write( "Builder" );
+    return reinterpret_cast<double*>( static_cast<char*>( block ) + header()->offset[t] );
+}
+
+EngineData::Builder::Builder( EngineData &Dat ) :
+    eta_ks( Dat.sc.eta_ks ) , Cp( Dat.sc.Cp ) , W_opal( Dat.sc.W_opal ) ,
+    A_compressor( Dat.sc.A_compressor ) , D_compressor( Dat.sc.D_compressor ) , Dw_compressor( Dat.sc.Dw_compressor ) ,
+    D_turbine( Dat.sc.D_turbine ) , Dw_turbine( Dat.sc.Dw_turbine ) , A_turbine( Dat.sc.A_turbine )
+{
+    rpm_tab      = Dat.table( DeckHeader::RPM );
+    sprez_tab    = Dat.table( DeckHeader::SPREZ );
+    eta_tab      = Dat.table( DeckHeader::ETA );
+    mZR_tab      = Dat.table( DeckHeader::MZR );
+    q_pal_thr    = Dat.table( DeckHeader::Q_THR );
+    q_pal_tab    = Dat.table( DeckHeader::Q_TAB );
+    rpm_tab_t    = Dat.table( DeckHeader::RPM_T );
+    epsT_roz_tab = Dat.table( DeckHeader::EPST );
+    mTwc_zr_tab  = Dat.table( DeckHeader::MTWC );
+}
+
+void EngineData::seal()
+{
+    assert( block );
+    if( header()->sealed ) return;
+    assert( owned );
+
+    DeckHeader *h = static_cast<DeckHeader*>( block );
+    char *base = static_cast<char*>( block );
+
+    inverse( rpm_tab   , sk , reinterpret_cast<double*>( base + h->offset[DeckHeader::INV_RPM] ) );
+    inverse( q_pal_thr , ck , reinterpret_cast<double*>( base + h->offset[DeckHeader::INV_Q_THR] ) );
+    inverse( rpm_tab_t , tk , reinterpret_cast<double*>( base + h->offset[DeckHeader::INV_RPM_T] ) );
+
+    h->eta_ks = sc.eta_ks;
+    h->Cp     = sc.Cp;
+    h->W_opal = sc.W_opal;
+
+    h->A_compressor  = sc.A_compressor;
+    h->D_compressor  = sc.D_compressor;
+    h->Dw_compressor = sc.Dw_compressor;
+    h->D_turbine     = sc.D_turbine;
+    h->Dw_turbine    = sc.Dw_turbine;
+    h->A_turbine     = sc.A_turbine;
+
+    h->sealed = 1;
+    bind( block , owned );
+}
@@ -23,6 +23,7 @@
 #ifndef ENGINEDATA_H
 #define ENGINEDATA_H
 #include <math.h>
+#include <stdint.h>
 #include <Fun.h>
 
 //////////////////////////////////////////////////////////
@@ -40,10 +41,78 @@ namespace EngineConst
     static double const n_30_PI = 30.0/M_PI;   /// [1/rad] - 30 / PI
     static double const n_PI_30 = M_PI/30.0;   /// [rad]   - PI / 30
     static double const ro0     = 1.2255;      /// [ kg/m3 ]
+    static double const dt_ref  = 0.001;       /// [s] - krok nominalny ( 1 kHz )
+    static double const tau_ks  = 0.0094912;   /// [s] - stala czasowa T4 komory ( -dt_ref / ln 0.9 - dawne 0.1 na krok przy 1 kHz )
+
+    /// Te same stale w typie obliczen T ( double albo float ): Const<T>::k_p ...
+    /// Dla T = double wartosci sa identyczne z powyzszymi.
+    template <class T> struct Const
+    {
+        static constexpr T k_p     = T( 1.4 );
+        static constexpr T k_s     = T( 1.33 );
+        static constexpr T R_p     = T( 287.14 );
+        static constexpr T R_s     = T( 287.43 );
+        static constexpr T n_po    = T( 1.48 );
+        static constexpr T p0      = T( 101325 );
+        static constexpr T T0      = T( 288.15 );
+        static constexpr T Tmin    = T( 0.01 );
+        static constexpr T n_30_PI = T( 30.0/M_PI );
+        static constexpr T n_PI_30 = T( M_PI/30.0 );
+        static constexpr T ro0     = T( 1.2255 );
+    };
+
+    template <class T> constexpr T Const<T>::k_p;
+    template <class T> constexpr T Const<T>::k_s;
+    template <class T> constexpr T Const<T>::R_p;
+    template <class T> constexpr T Const<T>::R_s;
+    template <class T> constexpr T Const<T>::n_po;
+    template <class T> constexpr T Const<T>::p0;
+    template <class T> constexpr T Const<T>::T0;
+    template <class T> constexpr T Const<T>::Tmin;
+    template <class T> constexpr T Const<T>::n_30_PI;
+    template <class T> constexpr T Const<T>::n_PI_30;
+    template <class T> constexpr T Const<T>::ro0;
 }
 
 //////////////////////////////////////////////////////////
 
+/// Naglowek bloku tablic charakterystyk - na poczatku bloku, przesuniecia
+/// tablic liczone od poczatku bloku ( blok mozna przeniesc albo zmapowac z pliku )
+struct DeckHeader
+{
+    enum Table
+    {
+        RPM = 0 , SPREZ , ETA , MZR ,           ///< sprezarka    - sk
+        Q_THR , Q_TAB ,                         ///< komora       - ck
+        RPM_T , EPST , MTWC ,                   ///< turbina      - tk
+        INV_RPM , INV_Q_THR , INV_RPM_T ,       ///< 1 / dx przedzialow ( liczone w seal() )
+        Tables
+    };
+
+    int32_t sk , ck , tk;
+    int32_t sealed;
+    int64_t bytes;                              ///< rozmiar calego bloku
+    int64_t offset[Tables];                     ///< [B] - poczatek tablicy w bloku
+
+    /// wielkosci skalarne decku ( zapisywane w seal() )
+    double eta_ks , Cp , W_opal;
+    double A_compressor , D_compressor , Dw_compressor;
+    double D_turbine , Dw_turbine , A_turbine;
+};
+
+//////////////////////////////////////////////////////////
+
+/// Charakterystyki silnika ( deck ).
+///
+/// Wszystkie tablice leza w jednym bloku wyrownanym do 64 B: naglowek
+/// DeckHeader, potem kolejne tablice, kazda od nowej linii cache. Po
+/// wypelnieniu tablic seal() liczy tablice pochodne i od tej chwili deck
+/// jest tylko do odczytu - moze go wspoldzielic dowolna liczba silnikow
+/// ( TurboShaftEngine( deck ) , EngineFleet , Sweep , CycleSolver ).
+/// Publiczne wskazniki tablic i wielkosci skalarne sa const; tablice i skalary
+/// wypelnia sie przed seal() przez EngineData::Builder ( EngineDeck::read_text ,
+/// decki syntetyczne ). allocate() i Builder na zapieczetowanym decku
+/// przerywaja program ( takze bez assert ) - blok czytaja inne silniki.
 struct EngineData
 {
 public:
@@ -51,51 +120,92 @@ public:
     int sk;
 
     int test;
-    EngineData( int Test ) { test = Test; }
+    EngineData( int Test );
+    ~EngineData();
+
+    /// Jeden blok na wszystkie tablice - rozmiary sk , ck , tk; tylko przed seal()
+    void allocate( int Sk , int Ck , int Tk );
+
+    /// Wskazniki tablic z gotowego bloku ( np. zmapowanego z pliku ); Owned - zwolnic w destruktorze
+    void bind( void *Block , bool Owned );
 
-    ~EngineData()
+    void seal();
+    bool is_sealed() const { return block && header()->sealed; }
+
+    DeckHeader const * header() const { return static_cast<DeckHeader const*>( block ); }
+    size_t arena_bytes() const { return block ? size_t( header()->bytes ) : 0; }
+
+    static size_t arena_size( int Sk , int Ck , int Tk );
+
+    /// Zapis tablic i skalarow po allocate() , przed seal() - te same nazwy co w EngineData
+    class Builder
     {
-        erase (rpm_tab);
-        erase (sprez_tab);
-        erase (eta_tab);
-        erase (mZR_tab);
-        erase (q_pal_thr);
-        erase (q_pal_tab);
-        erase (rpm_tab_t);
-        erase (epsT_roz_tab);
+    public:
+        explicit Builder( EngineData &Dat );
 
-        cout << "~EngineData Destructor ->" << test << endl;
-    }
+        double *rpm_tab , *sprez_tab , *eta_tab , *mZR_tab;
+        double *q_pal_thr , *q_pal_tab;
+        double *rpm_tab_t , *epsT_roz_tab , *mTwc_zr_tab;
 
-    double *rpm_tab;
-    double *sprez_tab;
-    double *eta_tab;
-    double *mZR_tab;
+        double &eta_ks , &Cp , &W_opal;
+        double &A_compressor , &D_compressor , &Dw_compressor;
+        double &D_turbine , &Dw_turbine , &A_turbine;
+    };
+
+    double const *rpm_tab;
+    double const *sprez_tab;
+    double const *eta_tab;
+    double const *mZR_tab;
 
 
     /// COMBUSTION CHAMBER:
     int ck;
-    double eta_ks;              ///< [-] - Sprawnosc komory spalania
-    double Cp;                  ///< [ J / ( kg * K ) ] - cieplo wlasciwe
-    double W_opal;              ///< [J/kg] - Wartosc opalowa
+    double const &eta_ks;       ///< [-] - Sprawnosc komory spalania
+    double const &Cp;           ///< [ J / ( kg * K ) ] - cieplo wlasciwe
+    double const &W_opal;       ///< [J/kg] - Wartosc opalowa
 
-    double * q_pal_thr;          ///< wydatek paliwa w zaleznosci od polozenia throttle
-    double * q_pal_tab;          ///< wydatek paliwa w zaleznosci od polozenia throttle
+    double const *q_pal_thr;     ///< wydatek paliwa w zaleznosci od polozenia throttle
+    double const *q_pal_tab;     ///< wydatek paliwa w zaleznosci od polozenia throttle
 
     /// TURBINE:
     int tk;
 
-    double *rpm_tab_t;
-    double *epsT_roz_tab;
+    double const *rpm_tab_t;
+    double const *epsT_roz_tab;
+    double const *mTwc_zr_tab;   ///< zredukowany wydatek turbiny w zaleznosci od rpm_tab_t
+
+    /// 1 / ( x[i+1] - x[i] ) - dostepne po seal() , inaczej 0
+    double const *inv_rpm_tab;
+    double const *inv_q_pal_thr;
+    double const *inv_rpm_tab_t;
 
     /////////////////////////////////
-    double A_compressor;
-    double D_compressor;
-    double Dw_compressor;
+    double const &A_compressor;
+    double const &D_compressor;
+    double const &Dw_compressor;
 
-    double D_turbine;
-    double Dw_turbine;
-    double A_turbine;
+    double const &D_turbine;
+    double const &Dw_turbine;
+    double const &A_turbine;
+
+private:
+    EngineData( EngineData const & );
+    EngineData & operator=( EngineData const & );
+
+    /// Tablica t do zapisu - tylko przed seal()
+    double *table( DeckHeader::Table t );
+
+    /// Wielkosci skalarne - zapis przez Builder , po seal() kopia z naglowka
+    struct Scalars
+    {
+        double eta_ks , Cp , W_opal;
+        double A_compressor , D_compressor , Dw_compressor;
+        double D_turbine , Dw_turbine , A_turbine;
+    };
+    Scalars sc;
+
+    void *block;
+    bool  owned;
 };
 
 //////////////////////////////////////////////////////////
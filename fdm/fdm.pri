@@ -1,10 +1,66 @@
 HEADERS += \
+    $$PWD/CycleSolver.h \
+    $$PWD/Dual.h \
+    $$PWD/Dynamics.h \
     $$PWD/Engine.h \
+    $$PWD/LinearModel.h \
+    $$PWD/Pipeline.h \
+    $$PWD/Profiler.h \
+    $$PWD/Recorder.h \
+    $$PWD/Rotor.h \
+    $$PWD/Scenario.h \
+    $$PWD/EngineFleet.h \
+    $$PWD/Executive.h \
+    $$PWD/MonteCarlo.h \
+    $$PWD/MultiEngine.h \
+    $$PWD/Philox.h \
+    $$PWD/QuantileSketch.h \
+    $$PWD/Snapshot.h \
+    $$PWD/SpinBarrier.h \
+    $$PWD/Station.h \
+    $$PWD/StationKernels.h \
+    $$PWD/Surrogate.h \
+    $$PWD/Sweep.h \
+    $$PWD/Telemetry.h \
+    $$PWD/ThreadPool.h \
+    $$PWD/StationKernelsImpl.h \
     $$PWD/Atmosphere.h \
     $$PWD/enginedata.h \
+    $$PWD/EngineDeck.h \
+    $$PWD/Table.h \
     $$PWD/Fun.h
 
 SOURCES += \
+    $$PWD/CycleSolver.cpp \
+    $$PWD/Dynamics.cpp \
     $$PWD/Engine.cpp \
+    $$PWD/EngineFleet.cpp \
+    $$PWD/LinearModel.cpp \
+    $$PWD/Profiler.cpp \
+    $$PWD/Recorder.cpp \
+    $$PWD/Rotor.cpp \
+    $$PWD/Scenario.cpp \
+    $$PWD/Executive.cpp \
+    $$PWD/MonteCarlo.cpp \
+    $$PWD/MultiEngine.cpp \
+    $$PWD/QuantileSketch.cpp \
+    $$PWD/StationKernels.cpp \
+    $$PWD/Surrogate.cpp \
+    $$PWD/Sweep.cpp \
+    $$PWD/Telemetry.cpp \
+    $$PWD/ThreadPool.cpp \
+    $$PWD/StationKernelsAvx2.cpp \
+    $$PWD/StationKernelsAvx512.cpp \
     $$PWD/Atmosphere.cpp \
+    $$PWD/enginedata.cpp \
+    $$PWD/EngineDeck.cpp \
     $$PWD/Fun.cpp
+
+# Warianty AVX2 / AVX-512 wybierane w czasie pracy ( #pragma GCC target ),
+# bez sklejania mnozenia z dodawaniem wyniki nie zaleza od wariantu
+gcc|clang: QMAKE_CXXFLAGS += -ffp-contract=off
+
+unix:!macx: LIBS += -lpthread
+
+# Pomiar czasu stopni ( Profiler.h ): qmake CONFIG+=profile
+profile: DEFINES += DME_PROFILE
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# fdm - model silnika jako biblioteka statyczna , bez Qt
+#
+# Aplikacje linkujace biblioteke dolaczaja fdmlib.pri zamiast fdm.pri
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = fdm
+TEMPLATE = lib
+CONFIG += staticlib console c++11
+
+DESTDIR = $$shadowed( $$PWD/../lib )
+
+INCLUDEPATH += $$PWD \
+               $$PWD/..
+
+include ( fdm.pri )
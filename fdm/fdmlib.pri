@@ -0,0 +1,18 @@
+
+# Linkowanie z biblioteka statyczna fdm ( fdm.pro ) zamiast kompilacji zrodel
+
+INCLUDEPATH += $$PWD \
+               $$PWD/..
+
+FDM_LIB_DIR = $$shadowed( $$PWD/../lib )
+
+LIBS += -L$$FDM_LIB_DIR -lfdm
+
+win32-msvc*: PRE_TARGETDEPS += $$FDM_LIB_DIR/fdm.lib
+else:        PRE_TARGETDEPS += $$FDM_LIB_DIR/libfdm.a
+
+gcc|clang: QMAKE_CXXFLAGS += -ffp-contract=off
+
+unix:!macx: LIBS += -lpthread
+
+profile: DEFINES += DME_PROFILE
@@ -24,15 +24,120 @@
 
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow( std::shared_ptr<EngineData> Dat , QWidget *parent ) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    telemetry( 1 << 16 ),
+    chunk( Chunk )
 {
     ui->setupUi(this);
+    resize( 1000 , 700 );
+
+    static const char * const T_name[Stations] = { "TH" , "T1s" , "T2s" , "T3s" , "T4s" , "T5s" };
+    static const char * const p_name[Stations] = { "ph" , "p1s" , "p2s" , "p3s" , "p4s" , "p5s" };
+    static const QColor color[Stations] = { QColor( 120 , 120 , 255 ) , QColor( 80 , 200 , 255 ) ,
+                                            QColor( 80 , 255 , 160 ) , QColor( 255 , 230 , 80 ) ,
+                                            QColor( 255 , 120 , 60 ) , QColor( 255 , 80 , 200 ) };
+
+    plot_T = new PlotWidget( "Temperatura" , "K" , this );
+    plot_p = new PlotWidget( "Cisnienie" , "Pa" , this );
+    for( int i = 0 ; i < Stations ; i++ )
+    {
+        plot_T->add_series( &temp[i]  , T_name[i] , color[i] );
+        plot_p->add_series( &press[i] , p_name[i] , color[i] );
+    }
+
+    slider = new QSlider( Qt::Horizontal , this );
+    slider->setRange( 0 , 100 );
+    slider->setValue( 50 );
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget( new QLabel( "throttle" , this ) );
+    controls->addWidget( slider );
+
+    QVBoxLayout *layout = new QVBoxLayout( ui->centralWidget );
+    layout->addLayout( controls );
+    layout->addWidget( plot_T , 1 );
+    layout->addWidget( plot_p , 1 );
+
+    status = new QLabel( this );
+    ui->statusBar->addWidget( status , 1 );
+
+    frame_ms = frame_max_ms = 0.0;
+    last_step = 0;
+    last_wall = 0.0;
+
+    reader = telemetry.reader();
+
+    worker = new SimWorker( Dat , &telemetry , this );
+    worker->set_rate( 1000.0 );
+    worker->set_throttle( 0.5 );
+    worker->start( QThread::HighPriority );
+
+    connect( slider , &QSlider::valueChanged , this , &MainWindow::throttle_changed );
+    connect( &timer , &QTimer::timeout , this , &MainWindow::refresh );
+
+    wall.start();
+    timer.start( display_ms );
 }
 
 MainWindow::~MainWindow()
 {
+    timer.stop();
+    worker->stop();
+    worker->wait();
+
     delete ui;
 }
+
+void MainWindow::throttle_changed( int value )
+{
+    worker->set_throttle( value / 100.0 );
+}
+
+void MainWindow::refresh()
+{
+    clock.start();
+
+    /// odbior - najwyzej tyle migawek ile miesci pierscien , reszta liczy sie jako utracone
+    uint64_t step = last_step;
+    int budget = telemetry.capacity();
+    int n;
+    while( budget > 0 && ( n = reader.drain( &chunk[0] , qMin( budget , int( Chunk ) ) ) ) > 0 )
+    {
+        for( int k = 0 ; k < n ; k++ )
+        {
+            Telemetry::Snapshot const &s = chunk[k];
+            double const T[Stations] = { s.temp.TH , s.temp.T1s , s.temp.T2s , s.temp.T3s , s.temp.T4s , s.temp.T5s };
+            double const p[Stations] = { s.press.ph , s.press.p1s , s.press.p2s , s.press.p3s , s.press.p4s , s.press.p5s };
+            for( int i = 0 ; i < Stations ; i++ )
+            {
+                temp[i].add( s.t , T[i] );
+                press[i].add( s.t , p[i] );
+            }
+        }
+        step = chunk[n-1].step + 1;
+        budget -= n;
+    }
+
+    /// rysowanie od razu ( repaint ) - wchodzi w czas klatki
+    plot_T->repaint();
+    plot_p->repaint();
+
+    double ms = clock.nsecsElapsed() * 1.0e-6;
+    frame_ms = frame_ms * 0.9 + ms * 0.1;
+    if( ms > frame_max_ms ) frame_max_ms = ms;
+
+    double now = wall.nsecsElapsed() * 1.0e-9;
+    double rate = now > last_wall ? ( step - last_step ) / ( now - last_wall ) : 0.0;
+    last_step = step;
+    last_wall = now;
+
+    status->setText( QString( "UI frame %1 ms ( max %2 ms )   |   model step %3 , %4 Hz   |   samples %5 , span %6 , lost %7" )
+                     .arg( frame_ms , 0 , 'f' , 2 ).arg( frame_max_ms , 0 , 'f' , 2 )
+                     .arg( step ).arg( rate , 0 , 'f' , 0 )
+                     .arg( temp[0].samples() ).arg( temp[0].span() ).arg( reader.get_lost() ) );
+}
@@ -26,21 +26,64 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QSlider>
+#include <memory>
+#include <vector>
+
+#include <Telemetry.h>
+#include "MinMaxSeries.h"
+#include "PlotWidget.h"
+#include "SimWorker.h"
 
 namespace Ui {
 class MainWindow;
 }
 
+/// Okno symulacji: model liczy w SimWorker , okno co display_ms odbiera
+/// migawki z pierscienia Telemetry do przebiegow MinMaxSeries i rysuje
+/// temperatury i cisnienia przekrojow. Czas klatki okna ( odbior + rysowanie )
+/// widoczny jest na pasku stanu obok tempa modelu i liczby utraconych migawek.
+/// Niesprawdzone - nie kompilowane z Qt ani uruchamiane ( README ).
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = 0);
+    explicit MainWindow( std::shared_ptr<EngineData> Dat , QWidget *parent = 0 );
     ~MainWindow();
 
+private slots:
+    void refresh();
+    void throttle_changed( int value );
+
 private:
+    enum { Stations = 6 , Chunk = 1024 };
+    static const int display_ms = 16;
+
     Ui::MainWindow *ui;
+
+    Telemetry          telemetry;
+    Telemetry::Reader  reader;
+    SimWorker         *worker;
+
+    MinMaxSeries temp[Stations];    ///< TH , T1s .. T5s
+    MinMaxSeries press[Stations];   ///< ph , p1s .. p5s
+    std::vector<Telemetry::Snapshot> chunk;
+
+    PlotWidget *plot_T;
+    PlotWidget *plot_p;
+    QSlider    *slider;
+    QLabel     *status;
+
+    QTimer        timer;
+    QElapsedTimer clock;            ///< czas klatki okna
+    QElapsedTimer wall;             ///< tempo modelu
+    double   frame_ms , frame_max_ms;
+    uint64_t last_step;
+    double   last_wall;
 };
 
 #endif // MAINWINDOW_H
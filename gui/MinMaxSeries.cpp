@@ -0,0 +1,99 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#include "MinMaxSeries.h"
+
+MinMaxSeries::MinMaxSeries( int Capacity )
+{
+    capacity = Capacity < 2 ? 2 : Capacity & ~1;
+    buckets.reserve( capacity );
+    clear();
+}
+
+void MinMaxSeries::clear()
+{
+    buckets.clear();
+    open   = Bucket();
+    open_n = 0;
+    span_n = 1;
+    count  = 0;
+}
+
+void MinMaxSeries::add( double t , double v )
+{
+    if( !open_n )
+    {
+        open.t0  = t;
+        open.min = open.max = v;
+    }
+    else
+    {
+        if( v < open.min ) open.min = v;
+        if( v > open.max ) open.max = v;
+    }
+    open.t1   = t;
+    open.last = v;
+    count++;
+
+    if( ++open_n < span_n ) return;
+
+    buckets.push_back( open );
+    open_n = 0;
+
+    if( int( buckets.size() ) == capacity ) compact();
+}
+
+void MinMaxSeries::compact()
+{
+    int n = int( buckets.size() ) / 2;
+    for( int i = 0 ; i < n ; i++ )
+    {
+        Bucket const &a = buckets[2*i];
+        Bucket const &b = buckets[2*i+1];
+        Bucket m;
+        m.t0   = a.t0;
+        m.t1   = b.t1;
+        m.min  = a.min < b.min ? a.min : b.min;
+        m.max  = a.max > b.max ? a.max : b.max;
+        m.last = b.last;
+        buckets[i] = m;
+    }
+    buckets.resize( n );
+    span_n *= 2;
+}
+
+bool MinMaxSeries::range( double t0 , double t1 , double &lo , double &hi ) const
+{
+    bool any = false;
+    for( int i = 0 ; i < size() ; i++ )
+    {
+        Bucket const &b = at( i );
+        if( b.t1 < t0 || b.t0 > t1 ) continue;
+
+        if( !any ) { lo = b.min; hi = b.max; any = true; }
+        if( b.min < lo ) lo = b.min;
+        if( b.max > hi ) hi = b.max;
+    }
+    return any;
+}
@@ -0,0 +1,74 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#ifndef MINMAXSERIES_H
+#define MINMAXSERIES_H
+
+#include <vector>
+#include <stdint.h>
+
+/// Przebieg czasowy z decymacja min / max o ograniczonej pamieci.
+///
+/// Probki zbierane sa w kubelkach po span probek ( min , max , ostatnia ).
+/// Gdy kubelkow jest capacity, sasiednie pary sa laczone , a span
+/// podwajany - pamiec jest stala , caly przebieg od poczatku zostaje ,
+/// tylko z coraz mniejsza rozdzielczoscia. Min / max kubelka zachowuje
+/// szpilki , ktorych zwykle przerzedzanie by nie pokazalo.
+class MinMaxSeries
+{
+public:
+    struct Bucket
+    {
+        double t0 , t1;         ///< [s] - czas pierwszej i ostatniej probki
+        double min , max;
+        double last;
+    };
+
+    explicit MinMaxSeries( int Capacity = 4096 );
+
+    void add( double t , double v );
+    void clear();
+
+    /// Kubelki zamkniete + otwarty ( ostatni , jesli ma probki )
+    int size() const { return int( buckets.size() ) + ( open_n ? 1 : 0 ); }
+    Bucket const & at( int i ) const { return i < int( buckets.size() ) ? buckets[i] : open; }
+
+    uint64_t samples() const { return count; }
+    int      span()    const { return span_n; }     ///< probek na kubelek
+
+    /// Zakres wartosci w przedziale czasu [ t0 , t1 ] ; false - brak danych
+    bool range( double t0 , double t1 , double &lo , double &hi ) const;
+
+private:
+    void compact();
+
+    std::vector<Bucket> buckets;
+    Bucket   open;
+    int      open_n;
+    int      span_n;
+    int      capacity;
+    uint64_t count;
+};
+
+#endif // MINMAXSERIES_H
@@ -0,0 +1,128 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#include "PlotWidget.h"
+#include <QPainter>
+#include <QPolygonF>
+#include <math.h>
+
+PlotWidget::PlotWidget( QString const &Title , QString const &Unit , QWidget *parent ) :
+    QWidget( parent ),
+    title( Title ),
+    unit( Unit )
+{
+    setAttribute( Qt::WA_OpaquePaintEvent );
+}
+
+void PlotWidget::add_series( MinMaxSeries const *series , QString const &name , QColor const &color )
+{
+    Trace tr = { series , name , color };
+    traces.push_back( tr );
+}
+
+void PlotWidget::paintEvent( QPaintEvent * )
+{
+    QPainter painter( this );
+    painter.fillRect( rect() , QColor( 24 , 24 , 28 ) );
+
+    int const margin_l = 60 , margin_r = 10 , margin_t = 20 , margin_b = 20;
+    QRect area( margin_l , margin_t , width() - margin_l - margin_r , height() - margin_t - margin_b );
+    if( area.width() < 2 || area.height() < 2 ) return;
+
+    /// zakres czasu i wartosci wszystkich serii
+    double t0 = 0 , t1 = 0 , lo = 0 , hi = 0;
+    bool any = false;
+    for( int s = 0 ; s < traces.size() ; s++ )
+    {
+        MinMaxSeries const &ser = *traces[s].series;
+        if( !ser.size() ) continue;
+
+        double a = ser.at( 0 ).t0 , b = ser.at( ser.size() - 1 ).t1 , l , h;
+        ser.range( a , b , l , h );
+        if( !any ) { t0 = a; t1 = b; lo = l; hi = h; any = true; }
+        t0 = qMin( t0 , a ); t1 = qMax( t1 , b );
+        lo = qMin( lo , l ); hi = qMax( hi , h );
+    }
+
+    painter.setPen( QColor( 200 , 200 , 200 ) );
+    painter.drawText( margin_l , margin_t - 5 , title + " [" + unit + "]" );
+    painter.setPen( QColor( 70 , 70 , 80 ) );
+    painter.drawRect( area );
+    if( !any ) return;
+
+    if( hi - lo < 1.0e-9 * ( fabs( hi ) + 1.0 ) ) { lo -= 0.5; hi += 0.5; }
+    double pad = 0.05 * ( hi - lo );
+    lo -= pad; hi += pad;
+    if( t1 <= t0 ) t1 = t0 + 1.0e-3;
+
+    painter.setPen( QColor( 160 , 160 , 160 ) );
+    painter.drawText( 2 , area.top() + 10 , QString::number( hi , 'g' , 5 ) );
+    painter.drawText( 2 , area.bottom() , QString::number( lo , 'g' , 5 ) );
+    painter.drawText( area.left() , height() - 4 , QString::number( t0 , 'f' , 2 ) + " s" );
+    painter.drawText( area.right() - 60 , height() - 4 , QString::number( t1 , 'f' , 2 ) + " s" );
+
+    int const W = area.width();
+    double const kx = ( W - 1 ) / ( t1 - t0 );
+    double const ky = area.height() / ( hi - lo );
+
+    col_min.resize( W );
+    col_max.resize( W );
+
+    QPolygonF line;
+    line.reserve( 2 * W );
+
+    for( int s = 0 ; s < traces.size() ; s++ )
+    {
+        MinMaxSeries const &ser = *traces[s].series;
+
+        col_min.fill( HUGE_VAL );
+        col_max.fill( -HUGE_VAL );
+
+        for( int i = 0 ; i < ser.size() ; i++ )
+        {
+            MinMaxSeries::Bucket const &b = ser.at( i );
+            int xa = qBound( 0 , int( ( b.t0 - t0 ) * kx ) , W - 1 );
+            int xb = qBound( 0 , int( ( b.t1 - t0 ) * kx ) , W - 1 );
+            for( int x = xa ; x <= xb ; x++ )
+            {
+                if( b.min < col_min[x] ) col_min[x] = b.min;
+                if( b.max > col_max[x] ) col_max[x] = b.max;
+            }
+        }
+
+        /// min i max kazdej kolumny - obwiednia z zachowanymi szpilkami
+        line.clear();
+        for( int x = 0 ; x < W ; x++ )
+        {
+            if( col_min[x] > col_max[x] ) continue;
+            double px = area.left() + x;
+            line << QPointF( px , area.bottom() - ( col_min[x] - lo ) * ky );
+            line << QPointF( px , area.bottom() - ( col_max[x] - lo ) * ky );
+        }
+
+        painter.setPen( traces[s].color );
+        painter.drawPolyline( line );
+        painter.drawText( area.left() + 6 + 50 * s , area.top() + 14 , traces[s].name );
+    }
+}
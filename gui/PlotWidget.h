@@ -0,0 +1,67 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#ifndef PLOTWIDGET_H
+#define PLOTWIDGET_H
+
+#include <QWidget>
+#include <QColor>
+#include <QString>
+#include <QVector>
+#include "MinMaxSeries.h"
+
+/// Wykres przebiegow MinMaxSeries - caly przebieg na szerokosci okna.
+///
+/// Kazda kolumna pikseli dostaje min / max kubelkow , ktore w nia wpadaja ,
+/// wiec rysowanie kosztuje O( kubelki + szerokosc ) niezaleznie od liczby
+/// probek. Wykres nie posiada danych - serie naleza do MainWindow.
+class PlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PlotWidget( QString const &Title , QString const &Unit , QWidget *parent = 0 );
+
+    void add_series( MinMaxSeries const *series , QString const &name , QColor const &color );
+
+    QSize minimumSizeHint() const override { return QSize( 300 , 150 ); }
+
+protected:
+    void paintEvent( QPaintEvent * ) override;
+
+private:
+    struct Trace
+    {
+        MinMaxSeries const *series;
+        QString name;
+        QColor  color;
+    };
+
+    QString title , unit;
+    QVector<Trace> traces;
+
+    QVector<double> col_min , col_max;      ///< bufory kolumn - bez alokacji w kazdej klatce
+};
+
+#endif // PLOTWIDGET_H
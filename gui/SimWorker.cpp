@@ -0,0 +1,82 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#include "SimWorker.h"
+
+SimWorker::SimWorker( std::shared_ptr<EngineData> Dat , Telemetry *Tel , QObject *parent ) :
+    QThread( parent ),
+    dat( Dat ),
+    telemetry( Tel ),
+    rate( 1000.0 ),
+    quit( false ),
+    H_alt( 0.0 ),
+    Mach( 0.0 ),
+    n_wc( 3000.0 ),
+    throttle( 0.5 )
+{
+}
+
+SimWorker::~SimWorker()
+{
+    stop();
+    wait();
+}
+
+void SimWorker::stop()
+{
+    quit = true;
+    exec.stop();
+}
+
+void SimWorker::run()
+{
+    EngineConstruct construct;
+    TurboShaftEngine builder( dat );
+    construct.CreateEngine( builder );
+    std::shared_ptr<Engine> engine = builder.GetEngine().lock();
+
+    Atmosphere atm;
+    double t = 0.0;
+
+    exec.set_rate( rate );
+    exec.set_policy( Executive::Skip );
+
+    exec.run( [&]( double dt )
+    {
+        if( quit ) { exec.stop(); return; }
+
+        double H = H_alt.load();
+        atm.update( H );
+
+        engine->set_Mach    ( Mach.load() );
+        engine->set_n_wc    ( n_wc.load() );
+        engine->set_throttle( throttle.load() );
+        engine->update( &atm , dt );
+
+        t += dt;
+        telemetry->publish( *engine , t , H );
+    } );
+
+    exec.export_report( "executive.txt" );
+}
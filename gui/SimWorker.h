@@ -0,0 +1,69 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+
+#ifndef SIMWORKER_H
+#define SIMWORKER_H
+
+#include <QThread>
+#include <Engine.h>
+#include <Executive.h>
+#include <Telemetry.h>
+#include <atomic>
+#include <memory>
+
+/// Watek modelu: Engine::update w petli Executive , migawka kazdego kroku
+/// do pierscienia Telemetry. Z GUI watek wymienia tylko wejscia ( atomowe )
+/// i pierscien - okno moze stanac na dowolnie dlugo , model liczy dalej.
+class SimWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    SimWorker( std::shared_ptr<EngineData> Dat , Telemetry *Tel , QObject *parent = 0 );
+    ~SimWorker();
+
+    void set_rate    ( double Hz )  { rate = Hz; }         ///< [Hz] - przed start()
+    void set_H_alt   ( double H )   { H_alt.store( H );      }
+    void set_Mach    ( double Ma )  { Mach.store( Ma );      }
+    void set_n_wc    ( double n )   { n_wc.store( n );       }
+    void set_throttle( double thr ) { throttle.store( thr ); }
+
+    void stop();
+
+    Executive const & get_executive() const { return exec; }   ///< po zakonczeniu watku
+
+protected:
+    void run() override;
+
+private:
+    std::shared_ptr<EngineData> dat;
+    Telemetry *telemetry;
+    Executive  exec;
+    double     rate;
+
+    std::atomic<bool>   quit;
+    std::atomic<double> H_alt , Mach , n_wc , throttle;
+};
+
+#endif // SIMWORKER_H
@@ -2,7 +2,13 @@ FORMS += \
     $$PWD/MainWindow.ui
 
 HEADERS += \
-    $$PWD/MainWindow.h
+    $$PWD/MainWindow.h \
+    $$PWD/MinMaxSeries.h \
+    $$PWD/PlotWidget.h \
+    $$PWD/SimWorker.h
 
 SOURCES += \
-    $$PWD/MainWindow.cpp
+    $$PWD/MainWindow.cpp \
+    $$PWD/MinMaxSeries.cpp \
+    $$PWD/PlotWidget.cpp \
+    $$PWD/SimWorker.cpp
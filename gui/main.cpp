@@ -0,0 +1,61 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "MainWindow.h"
+#include <QApplication>
+
+#include <EngineDeck.h>
+#include <Profiler.h>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+#if defined( DME_PROFILE )
+    Profiler::dump_at_exit( "profile.txt" , "profile.json" );
+#endif
+
+    if( argc < 2 )
+    {
+        cerr << "usage: DME-kit deck ( .txt / .csv - deck tekstowy , inaczej binarny )" << endl;
+        return 2;
+    }
+
+    std::string path = argv[1];
+    bool text = path.size() > 4 && ( path.compare( path.size() - 4 , 4 , ".txt" ) == 0 ||
+                                     path.compare( path.size() - 4 , 4 , ".csv" ) == 0 );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( argv[1] ) : EngineDeck::open( argv[1] );
+    if( !dat ) return 1;
+
+    /// model w watku SimWorker , okno tylko odbiera migawki Telemetry
+    MainWindow w( dat );
+    w.show();
+
+    return a.exec();
+}
@@ -0,0 +1,51 @@
+#-------------------------------------------------
+#
+# Budowa bez GUI: biblioteka fdm i narzedzia ( tools/ )
+#
+#   qmake headless.pro && make
+#
+# Narzedzia linkuja lib/libfdm.a ( fdm/fdmlib.pri ) - zrodla modelu
+# kompilowane sa raz
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += fdm \
+           runner \
+           kernelcheck \
+           bench \
+           precision \
+           deckconv \
+           montecarlo \
+           twin \
+           pipebench \
+           recdump \
+           lpv \
+           surrogate
+
+fdm.subdir = fdm
+
+runner.subdir      = tools/runner
+kernelcheck.subdir = tools/kernelcheck
+bench.subdir       = tools/bench
+precision.subdir   = tools/precision
+deckconv.subdir    = tools/deckconv
+montecarlo.subdir  = tools/montecarlo
+twin.subdir        = tools/twin
+pipebench.subdir   = tools/pipebench
+recdump.subdir     = tools/recdump
+lpv.subdir         = tools/lpv
+surrogate.subdir   = tools/surrogate
+
+runner.depends      = fdm
+kernelcheck.depends = fdm
+bench.depends       = fdm
+precision.depends   = fdm
+deckconv.depends    = fdm
+montecarlo.depends  = fdm
+twin.depends        = fdm
+pipebench.depends   = fdm
+recdump.depends     = fdm
+lpv.depends         = fdm
+surrogate.depends   = fdm
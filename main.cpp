@@ -21,42 +21,62 @@
 * IN THE SOFTWARE.
 ******************************************************************************/
 
-#include "MainWindow.h"
-#include <QApplication>
-
 #include <Engine.h>
+#include <EngineDeck.h>
+#include <Profiler.h>
 #include <iostream>
+#include <string>
+#include <stdlib.h>
 
 using namespace std;
 
-
+/// Przebieg modelu bez GUI ( domyslny cel DME-kit.pro ).
+///
+/// DME-kit deck [kroki]
+///
+/// Silnik na decku ( .txt / .csv - tekstowy , inaczej binarny ) liczony
+/// Engine::update krok po kroku ( dt_ref ) , na koncu stan przekrojow.
+/// GUI ( gui/main.cpp ) - osobno , CONFIG+=dme_gui ( README ).
 int main(int argc, char *argv[])
 {
-    std::shared_ptr<Engine> engine;
+#if defined( DME_PROFILE )
+    Profiler::dump_at_exit( "profile.txt" , "profile.json" );
+#endif
 
-    EngineConstruct construct;
-    TurboShaftEngine builder;
-    construct.CreateEngine( builder );
-    engine = builder.GetEngine().lock();
+    if( argc < 2 )
+    {
+        cerr << "usage: DME-kit deck [steps] ( .txt / .csv - deck tekstowy , inaczej binarny )" << endl;
+        return 2;
+    }
 
-    Atmosphere *atm = new Atmosphere();
+    std::string path = argv[1];
+    bool text = path.size() > 4 && ( path.compare( path.size() - 4 , 4 , ".txt" ) == 0 ||
+                                     path.compare( path.size() - 4 , 4 , ".csv" ) == 0 );
 
-    int k = 0;
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( argv[1] ) : EngineDeck::open( argv[1] );
+    if( !dat ) return 1;
 
-//    while (1) /// Run
-    {
+    long steps = argc > 2 ? atol( argv[2] ) : 1000;
 
-       engine->update( atm );
+    EngineConstruct construct;
+    TurboShaftEngine builder( dat );
+    construct.CreateEngine( builder );
+    std::shared_ptr<Engine> engine = builder.GetEngine().lock();
 
-    }
+    /// srodek charakterystyki sprezarki , jak w MultiEngine
+    engine->set_n_wc( 0.5 * ( dat->rpm_tab[0] + dat->rpm_tab[ dat->sk - 1 ] ) * EngineConst::n_PI_30 );
+    engine->set_throttle( 0.5 );
 
+    Atmosphere atm;
 
+    for( long k = 0 ; k < steps ; k++ )
+        engine->update( &atm );
 
-//    QApplication a(argc, argv);
-//    MainWindow w;
-//    w.show();
+    Engine::Temp  const &T = engine->get_temp();
+    Engine::Press const &p = engine->get_press();
 
-//    return a.exec();
+    cout << "steps " << steps << "  T3s " << T.T3s << "  T4s " << T.T4s << "  T5s " << T.T5s
+         << "  p3s " << p.p3s << "  m3 " << engine->get_mS().m3 << endl;
 
     return 0;
 }
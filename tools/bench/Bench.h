@@ -0,0 +1,129 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <math.h>
+
+/// Maly zestaw do mikropomiarow bez zaleznosci.
+///
+/// Przypadek to funkcja liczaca iters powtorzen operacji; ops - liczba
+/// jednostek na powtorzenie ( np. silniki floty ). Liczba powtorzen jest
+/// dobierana tak , by jedna proba trwala min_time , potem warmup prob
+/// bez zapisu i reps prob mierzonych. Wynik w ns na jednostke:
+/// mediana , srednia , odchylenie , min , max , MAD i przedzial ufnosci 95%.
+namespace Bench
+{
+    /// Zapobiega usunieciu wyniku przez optymalizator
+    template <class T> inline void keep( T const &value )
+    {
+#if defined( __GNUC__ )
+        asm volatile( "" : : "g"( &value ) : "memory" );
+#else
+        static volatile char sink;
+        sink = *reinterpret_cast<volatile const char*>( &value );
+#endif
+    }
+
+    struct Result
+    {
+        std::string name;
+        std::string unit;           ///< jednostka ops ( "call" , "engine-step" , ... )
+        long   iters;               ///< powtorzen na probe
+        long   ops;                 ///< jednostek na powtorzenie
+        int    reps;
+        double median , mean , stddev , min , max , mad , ci95;   ///< [ns / jednostka]
+
+        double rate() const { return median > 0.0 ? 1.0e9 / median : 0.0; }  ///< [jednostek/s]
+    };
+
+    struct Options
+    {
+        int    warmup   = 2;
+        int    reps     = 15;
+        double min_time = 0.02;     ///< [s] - czas jednej proby
+        std::string filter;         ///< tylko przypadki zawierajace filter
+    };
+
+    typedef std::function<void( long iters )> Body;
+
+    inline double seconds( Body const &body , long iters )
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        body( iters );
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+    }
+
+    inline bool run( Options const &opt , std::string const &name , std::string const &unit ,
+                     long ops , Body const &body , Result &r )
+    {
+        if( !opt.filter.empty() && name.find( opt.filter ) == std::string::npos ) return false;
+
+        /// dobor powtorzen - podwajanie az proba trwa min_time
+        long iters = 1;
+        double t;
+        while( ( t = seconds( body , iters ) ) < opt.min_time && iters < ( 1L << 40 ) )
+            iters = t > 0.0 ? std::max( iters * 2 , long( iters * opt.min_time / t * 1.1 ) ) : iters * 2;
+
+        for( int w = 0 ; w < opt.warmup ; w++ ) seconds( body , iters );
+
+        std::vector<double> ns( opt.reps );
+        for( int k = 0 ; k < opt.reps ; k++ )
+            ns[k] = seconds( body , iters ) * 1.0e9 / ( double( iters ) * ops );
+
+        std::vector<double> s = ns;
+        std::sort( s.begin() , s.end() );
+
+        r.name  = name;
+        r.unit  = unit;
+        r.iters = iters;
+        r.ops   = ops;
+        r.reps  = opt.reps;
+        r.min   = s.front();
+        r.max   = s.back();
+        r.median = s.size() % 2 ? s[s.size()/2] : 0.5 * ( s[s.size()/2-1] + s[s.size()/2] );
+
+        double sum = 0.0;
+        for( size_t k = 0 ; k < s.size() ; k++ ) sum += s[k];
+        r.mean = sum / s.size();
+
+        double var = 0.0;
+        for( size_t k = 0 ; k < s.size() ; k++ ) var += ( s[k] - r.mean ) * ( s[k] - r.mean );
+        r.stddev = s.size() > 1 ? sqrt( var / ( s.size() - 1 ) ) : 0.0;
+        r.ci95   = 1.96 * r.stddev / sqrt( double( s.size() ) );
+
+        for( size_t k = 0 ; k < s.size() ; k++ ) s[k] = fabs( s[k] - r.median );
+        std::sort( s.begin() , s.end() );
+        r.mad = s[s.size()/2];
+
+        return true;
+    }
+}
+
+#endif // BENCH_H
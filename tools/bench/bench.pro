@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# bench - pomiary modulu fdm ( bez Qt )
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = bench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
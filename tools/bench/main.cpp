@@ -0,0 +1,391 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include "Bench.h"
+#include <Engine.h>
+#include <EngineFleet.h>
+#include <Pipeline.h>
+#include <Profiler.h>
+#include <SpinBarrier.h>
+#include <StationKernels.h>
+#include <Table.h>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <string.h>
+#include <stdlib.h>
+#include <thread>
+
+using namespace std;
+
+/// Pomiary modulu fdm bez Qt.
+///
+/// bench [--reps N] [--warmup N] [--min-time s] [--filter tekst] [--json plik]
+///
+/// Deck jest syntetyczny ( rozmiary jak w Engine::init_Engine ) - wyniki nie
+/// zaleza od plikow. JSON: jeden wynik w wierszu , latwo porownac dwa przebiegi.
+/// Z DME_PROFILE ( CONFIG+=profile ) raport stref w profile.txt / profile.json.
+namespace
+{
+
+std::shared_ptr<EngineData> make_deck()
+{
+    std::shared_ptr<EngineData> d = std::make_shared<EngineData>( 0 );
+    d->allocate( 8 , 13 , 10 );
+    EngineData::Builder b( *d );
+
+    double const rpm[8] = { 10000 , 15000 , 20000 , 25000 , 30000 , 35000 , 40000 , 45000 };
+    double const spr[8] = { 1.2 , 1.6 , 2.2 , 3.0 , 4.0 , 5.2 , 6.1 , 6.6 };
+    double const eta[8] = { 0.60 , 0.68 , 0.74 , 0.78 , 0.80 , 0.81 , 0.80 , 0.78 };
+    double const mzr[8] = { 0.3 , 0.6 , 0.9 , 1.2 , 1.5 , 1.8 , 2.0 , 2.1 };
+    for( int i = 0 ; i < 8 ; i++ )
+    {
+        b.rpm_tab[i] = rpm[i]; b.sprez_tab[i] = spr[i]; b.eta_tab[i] = eta[i]; b.mZR_tab[i] = mzr[i];
+    }
+    for( int i = 0 ; i < 13 ; i++ )
+    {
+        b.q_pal_thr[i] = i / 12.0;
+        b.q_pal_tab[i] = 0.005 + 0.03 * i / 12.0;
+    }
+    for( int i = 0 ; i < 10 ; i++ )
+    {
+        b.rpm_tab_t[i] = 8000 + 4000 * i; b.epsT_roz_tab[i] = 1.1 + 0.4 * i; b.mTwc_zr_tab[i] = 0.4 + 0.05 * i;
+    }
+
+    b.W_opal = 41868000.0;
+    b.Cp     = 1172.30;
+    b.eta_ks = 0.96;
+    b.A_compressor = 0.1;
+    b.A_turbine    = 0.05;
+
+    d->seal();
+    return d;
+}
+
+/// Wolno zmienny argument ( jak w symulacji ) i skaczacy ( jak w przegladzie obwiedni )
+inline double slow( long i , double lo , double hi ) { return lo + ( hi - lo ) * double( i % 4096 ) / 4096.0; }
+inline double jump( long i , double lo , double hi ) { return lo + ( hi - lo ) * double( ( i * 2654435761u ) % 4096 ) / 4096.0; }
+
+double const Ma  = 0.2;
+double const n0  = 3000.0;      ///< [rad/s]
+
+/// Obieg bariery w izolacji: watek mierzacy i N - 1 pomocnikow , kazdy obieg to
+/// jedno wait() w kazdym watku. Pomocnicy zyja przez caly przypadek i licza
+/// obiegi do target ( -1 - koniec ) , wiec pomiar nie obejmuje tworzenia watkow.
+class BarrierLoop
+{
+public:
+    explicit BarrierLoop( int N ) : bar( N ) , target( 0 )
+    {
+        for( int k = 1 ; k < N ; k++ )
+            helpers.emplace_back( [this]()
+            {
+                long done = 0;
+                for( ;; )
+                {
+                    long t = target.load( std::memory_order_acquire );
+                    if( t < 0 ) return;
+                    while( done < t ) { bar.wait(); done++; }
+                    std::this_thread::yield();
+                }
+            } );
+    }
+
+    ~BarrierLoop()
+    {
+        target.store( -1 , std::memory_order_release );
+        for( size_t k = 0 ; k < helpers.size() ; k++ ) helpers[k].join();
+    }
+
+    void run( long iters )
+    {
+        total += iters;
+        target.store( total , std::memory_order_release );
+        for( long i = 0 ; i < iters ; i++ ) bar.wait();
+    }
+
+private:
+    SpinBarrier bar;
+    std::atomic<long> target;
+    long total = 0;
+    std::vector<std::thread> helpers;
+};
+
+}
+
+int main( int argc , char *argv[] )
+{
+#if defined( DME_PROFILE )
+    Profiler::dump_at_exit( "profile.txt" , "profile.json" );
+#endif
+
+    Bench::Options opt;
+    const char *json = 0;
+
+    for( int a = 1 ; a < argc ; a++ )
+    {
+        if(      !strcmp( argv[a] , "--reps" )     && a + 1 < argc ) opt.reps     = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--warmup" )   && a + 1 < argc ) opt.warmup   = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--min-time" ) && a + 1 < argc ) opt.min_time = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--filter" )   && a + 1 < argc ) opt.filter   = argv[++a];
+        else if( !strcmp( argv[a] , "--json" )     && a + 1 < argc ) json         = argv[++a];
+        else
+        {
+            cerr << "usage: bench [--reps N] [--warmup N] [--min-time s] [--filter text] [--json file]" << endl;
+            return 2;
+        }
+    }
+    if( opt.reps < 1 ) opt.reps = 1;
+
+    std::shared_ptr<EngineData> dat = make_deck();
+    Atmosphere atm;
+    atm.update( 1000.0 );
+
+    std::vector<Bench::Result> results;
+    Bench::Result r;
+
+    /// --- interpolacja
+    {
+        std::vector<double> x( 64 ) , y( 64 );
+        for( int i = 0 ; i < 64 ; i++ ) { x[i] = i * i + i; y[i] = sqrt( double( i ) ); }
+
+        if( Bench::run( opt , "interp/Interpolation/8" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) s += Interpolation( jump( i , 0 , 56 ) , &y[0] , &x[0] , 8 ); Bench::keep( s ); } , r ) )
+            results.push_back( r );
+
+        if( Bench::run( opt , "interp/Interpolation/64" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) s += Interpolation( jump( i , 0 , 4032 ) , &y[0] , &x[0] , 64 ); Bench::keep( s ); } , r ) )
+            results.push_back( r );
+
+        TableCursor<double> cur;
+        if( Bench::run( opt , "interp/TableCursor/64/slow" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) s += cur.interpolate( slow( i , 0 , 4032 ) , &y[0] , &x[0] , 64 ); Bench::keep( s ); } , r ) )
+            results.push_back( r );
+
+        if( Bench::run( opt , "interp/TableCursor/64/jump" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) s += cur.interpolate( jump( i , 0 , 4032 ) , &y[0] , &x[0] , 64 ); Bench::keep( s ); } , r ) )
+            results.push_back( r );
+
+        MultiTable<double,3> map;
+        double const * const cols[3] = { dat->sprez_tab , dat->eta_tab , dat->mZR_tab };
+        map.bind( dat->rpm_tab , cols , dat->sk , dat->inv_rpm_tab );
+        if( Bench::run( opt , "interp/MultiTable3/8" , "call" , 1 , [&]( long n )
+            { double v[3] , s = 0; for( long i = 0 ; i < n ; i++ ) { map.lookup( slow( i , 9000 , 46000 ) , v ); s += v[0] + v[1] + v[2]; } Bench::keep( s ); } , r ) )
+            results.push_back( r );
+    }
+
+    /// --- atmosfera
+    {
+        Atmosphere a;
+        if( Bench::run( opt , "atm/update/table" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) { a.update( jump( i , 0 , 15000 ) ); s += a.get_T(); } Bench::keep( s ); } , r ) )
+            results.push_back( r );
+
+        a.set_mode( Atmosphere::Exact );
+        if( Bench::run( opt , "atm/update/exact" , "call" , 1 , [&]( long n )
+            { double s = 0; for( long i = 0 ; i < n ; i++ ) { a.update( jump( i , 0 , 15000 ) ); s += a.get_T(); } Bench::keep( s ); } , r ) )
+            results.push_back( r );
+        a.set_mode( Atmosphere::Table );
+
+        std::vector<double> H( 1024 ) , T( 1024 ) , p( 1024 ) , ro( 1024 ) , c( 1024 );
+        for( int i = 0 ; i < 1024 ; i++ ) H[i] = jump( i , 0 , 15000 );
+        if( Bench::run( opt , "atm/batch/1024" , "point" , 1024 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) { a.update( &H[0] , 1024 , &T[0] , &p[0] , &ro[0] , &c[0] ); Bench::keep( T[0] ); } } , r ) )
+            results.push_back( r );
+    }
+
+    /// --- stopnie ( wejscia z ustalonego kroku calego silnika )
+    {
+        TurboShaftPipeline pipe( dat );
+        pipe.set_inputs( Ma , n0 , 0.6 );
+        for( int i = 0 ; i < 200 ; i++ ) pipe.step( &atm );
+
+        Stage::Flow f1 = pipe.get<0>().out , f3 = pipe.get<1>().out , f4 = pipe.get<2>().out , f5 = pipe.get<3>().out;
+
+        Intake intake( dat );
+        if( Bench::run( opt , "stage/Intake" , "call" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) { intake.update_intake( atm.get_T() , atm.get_p() , slow( i , 0.1 , 0.3 ) ); } Bench::keep( intake.get_p1_s() ); } , r ) )
+            results.push_back( r );
+
+        Compressor comp( dat );
+        if( Bench::run( opt , "stage/Compressor" , "call" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) comp.update_compressor( f1.p , f1.T , f1.c , slow( i , 2900 , 3100 ) , 0.6 ); Bench::keep( comp.get_T3_s() ); } , r ) )
+            results.push_back( r );
+
+        CombustionChamber comb( dat );
+        if( Bench::run( opt , "stage/CombustionChamber" , "call" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) comb.update_comchamber( f3.p , f3.T , f3.m , f3.c , slow( i , 0.5 , 0.7 ) ); Bench::keep( comb.get_T4_s() ); } , r ) )
+            results.push_back( r );
+
+        Turbine trb( dat );
+        if( Bench::run( opt , "stage/Turbine" , "call" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) trb.update_turbine( f4.p , f4.T + slow( i , 0 , 1 ) , f4.m , f4.c , n0 ); Bench::keep( trb.get_T5_s() ); } , r ) )
+            results.push_back( r );
+
+        Turbine_f trbf( dat );
+        if( Bench::run( opt , "stage/Turbine_f" , "call" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) trbf.update_turbine_f( f5.p , f5.T + slow( i , 0 , 1 ) , f5.m , f5.c , n0 ); Bench::keep( trbf.get_T6_s() ); } , r ) )
+            results.push_back( r );
+    }
+
+    /// --- caly krok silnika
+    {
+        EngineConstruct construct;
+        TurboShaftEngine builder( dat );
+        construct.CreateEngine( builder );
+        std::shared_ptr<Engine> engine = builder.GetEngine().lock();
+        engine->set_Mach( Ma );
+        engine->set_n_wc( n0 );
+
+        if( Bench::run( opt , "engine/step/builder" , "engine-step" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) { engine->set_throttle( slow( i , 0.5 , 0.8 ) ); engine->update( &atm ); } Bench::keep( engine->get_temp() ); } , r ) )
+            results.push_back( r );
+
+        TurboShaftPipeline pipe( dat );
+        if( Bench::run( opt , "engine/step/pipeline" , "engine-step" , 1 , [&]( long n )
+            { Stage::Flow f; for( long i = 0 ; i < n ; i++ ) { pipe.set_inputs( Ma , n0 , slow( i , 0.5 , 0.8 ) ); f = pipe.step( &atm ); } Bench::keep( f ); } , r ) )
+            results.push_back( r );
+
+        /// migawka stanu silnika z atmosfera ( Engine::save / restore )
+        Snapshot snap;
+        engine->save( snap , &atm );
+        if( Bench::run( opt , "engine/snapshot/save" , "snapshot" , 1 , [&]( long n )
+            { for( long i = 0 ; i < n ; i++ ) engine->save( snap , &atm ); Bench::keep( snap.size() ); } , r ) )
+            results.push_back( r );
+
+        if( Bench::run( opt , "engine/snapshot/restore" , "snapshot" , 1 , [&]( long n )
+            { bool ok = true; for( long i = 0 ; i < n ; i++ ) ok &= engine->restore( snap , &atm ); Bench::keep( ok ); } , r ) )
+            results.push_back( r );
+    }
+
+    /// --- flota: 1 / 10 / 1000 / 10000 silnikow
+    {
+        int const sizes[] = { 1 , 10 , 1000 , 10000 };
+        for( int s = 0 ; s < 4 ; s++ )
+        {
+            int N = sizes[s];
+            EngineFleet fleet( dat , N );
+            for( int i = 0 ; i < N ; i++ )
+            {
+                fleet.set_Mach( i , Ma );
+                fleet.set_n_wc( i , n0 + i % 100 );
+                fleet.set_throttle( i , 0.5 + 0.3 * ( i % 17 ) / 17.0 );
+            }
+
+            if( Bench::run( opt , "fleet/" + std::to_string( N ) , "engine-step" , N , [&]( long n )
+                { for( long i = 0 ; i < n ; i++ ) fleet.update( &atm ); Bench::keep( fleet.lane( 0 ).get_T5_s() ); } , r ) )
+                results.push_back( r );
+        }
+
+        /// to samo w pojedynczej precyzji
+        for( int s = 2 ; s < 4 ; s++ )
+        {
+            int N = sizes[s];
+            EngineFleetF fleet( dat , N );
+            for( int i = 0 ; i < N ; i++ )
+            {
+                fleet.set_Mach( i , Ma );
+                fleet.set_n_wc( i , n0 + i % 100 );
+                fleet.set_throttle( i , 0.5 + 0.3 * ( i % 17 ) / 17.0 );
+            }
+
+            if( Bench::run( opt , "fleet/float/" + std::to_string( N ) , "engine-step" , N , [&]( long n )
+                { for( long i = 0 ; i < n ; i++ ) fleet.update( &atm ); Bench::keep( fleet.lane( 0 ).get_T5_s() ); } , r ) )
+                results.push_back( r );
+        }
+    }
+
+    /// --- bariera MultiEngine w izolacji ( ns na obieg ) - ponizej kroku silnika przy 1 kHz
+    {
+        int const threads[] = { 2 , 4 };
+        for( int s = 0 ; s < 2 ; s++ )
+        {
+            if( !opt.filter.empty() && ( "barrier/SpinBarrier/" + std::to_string( threads[s] ) ).find( opt.filter ) == std::string::npos )
+                continue;
+
+            BarrierLoop loop( threads[s] );
+            if( Bench::run( opt , "barrier/SpinBarrier/" + std::to_string( threads[s] ) , "round-trip" , 1 ,
+                            [&]( long n ) { loop.run( n ); } , r ) )
+                results.push_back( r );
+        }
+    }
+
+    /// --- raport
+    cout << "# isa " << StationKernels::name( StationKernels::active() )
+         << " , reps " << opt.reps << " , warmup " << opt.warmup << " , min-time " << opt.min_time << " s" << endl;
+    cout << std::left << std::setw( 30 ) << "# case" << std::right
+         << std::setw( 11 ) << "median_ns" << std::setw( 10 ) << "mad_ns" << std::setw( 10 ) << "ci95_ns"
+         << std::setw( 10 ) << "min_ns" << std::setw( 10 ) << "max_ns" << std::setw( 16 ) << "per_s" << "  unit" << endl;
+
+    cout << std::fixed;
+    for( size_t k = 0 ; k < results.size() ; k++ )
+    {
+        Bench::Result const &q = results[k];
+        cout << std::left << std::setw( 30 ) << q.name << std::right << std::setprecision( 2 )
+             << std::setw( 11 ) << q.median << std::setw( 10 ) << q.mad << std::setw( 10 ) << q.ci95
+             << std::setw( 10 ) << q.min << std::setw( 10 ) << q.max
+             << std::setprecision( 0 ) << std::setw( 16 ) << q.rate() << "  " << q.unit << endl;
+    }
+
+    /// bariera wzgledem kroku silnika - wymaganie MultiEngine
+    {
+        double step = 0.0;
+        for( size_t k = 0 ; k < results.size() ; k++ )
+            if( results[k].name == "engine/step/builder" ) step = results[k].median;
+
+        unsigned cores = std::thread::hardware_concurrency();
+        for( size_t k = 0 ; k < results.size() ; k++ )
+        {
+            Bench::Result const &q = results[k];
+            if( q.name.compare( 0 , 20 , "barrier/SpinBarrier/" ) ) continue;
+
+            unsigned N = unsigned( atoi( q.name.c_str() + 20 ) );
+            cout << "# " << q.name << std::setprecision( 2 );
+            if( step > 0.0 ) cout << " : " << q.median / step << " x engine/step/builder";
+            if( cores < N )  cout << " - " << N << " watki na " << cores << " rdzeniach: przelaczanie watkow , nie koszt bariery";
+            cout << endl;
+        }
+    }
+
+    if( json )
+    {
+        std::ofstream out( json );
+        out << std::setprecision( 6 );
+        out << "{\n  \"version\": 1,\n  \"isa\": \"" << StationKernels::name( StationKernels::active() )
+            << "\",\n  \"reps\": " << opt.reps << ",\n  \"results\": [\n";
+        for( size_t k = 0 ; k < results.size() ; k++ )
+        {
+            Bench::Result const &q = results[k];
+            out << "    { \"name\": \"" << q.name << "\", \"unit\": \"" << q.unit
+                << "\", \"ops\": " << q.ops << ", \"iters\": " << q.iters
+                << ", \"median_ns\": " << q.median << ", \"mean_ns\": " << q.mean
+                << ", \"stddev_ns\": " << q.stddev << ", \"mad_ns\": " << q.mad
+                << ", \"ci95_ns\": " << q.ci95 << ", \"min_ns\": " << q.min << ", \"max_ns\": " << q.max
+                << ", \"per_s\": " << q.rate() << " }" << ( k + 1 < results.size() ? "," : "" ) << "\n";
+        }
+        out << "  ]\n}" << endl;
+        if( !out ) { cerr << "bench: cannot write " << json << endl; return 1; }
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# deckconv - deck tekstowy / CSV -> binarny deck silnika ( EngineDeck )
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = deckconv
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,58 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <EngineDeck.h>
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+/// deckconv deck.txt deck.bin [nazwa]   - deck tekstowy / CSV -> binarny
+/// deckconv -c deck.bin                 - sprawdzenie pliku binarnego
+int main( int argc , char *argv[] )
+{
+    if( argc == 3 && !strcmp( argv[1] , "-c" ) )
+    {
+        std::shared_ptr<EngineData> dat = EngineDeck::open( argv[2] , true );
+        if( !dat ) return 1;
+
+        cout << argv[2] << ": sk " << dat->sk << " ck " << dat->ck << " tk " << dat->tk
+             << " , " << dat->arena_bytes() << " B - ok" << endl;
+        return 0;
+    }
+
+    if( argc < 3 || argc > 4 )
+    {
+        cerr << "usage: deckconv deck.txt deck.bin [name]" << endl
+             << "       deckconv -c deck.bin" << endl;
+        return 2;
+    }
+
+    std::shared_ptr<EngineData> dat = EngineDeck::read_text( argv[1] );
+    if( !dat ) return 1;
+
+    if( !EngineDeck::write( *dat , argv[2] , argc == 4 ? argv[3] : 0 ) ) return 1;
+
+    cout << argv[1] << " -> " << argv[2] << " ( " << dat->arena_bytes() << " B )" << endl;
+    return 0;
+}
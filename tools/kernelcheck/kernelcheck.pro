@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# kernelcheck - warianty StationKernels wzgledem skalarnego
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = kernelcheck
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,78 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <StationKernels.h>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+/// Sprawdzenie wszystkich wariantow StationKernels dostepnych na tym procesorze
+/// wzgledem skalarnego ( std::pow ), bez pliku silnika.
+///
+/// kernelcheck
+///
+/// Dla kazdego wariantu do detect() i n = 1 .. 33 ( kazda dlugosc konca kolumny
+/// dla W = 4 , 8 , 16 ) oraz 4096: najwiekszy blad wzgledny double i float ,
+/// potegi poza dziedzina ( NaN jak w std::pow ) i brak zapisu za koncem kolumny.
+/// Kod wyjscia 1 gdy ktorykolwiek wariant przekracza Tolerance / ToleranceF.
+
+int main()
+{
+    using namespace StationKernels;
+
+    Isa const best = detect();
+    int fail = 0;
+
+    cout << "detected: " << name( best ) << "\n";
+
+    for( int k = Scalar + 1 ; k <= best ; k++ )
+    {
+        Isa const isa = Isa( k );
+        double err = 0.0 , err_f = 0.0;
+        int n_bad = 0;
+
+        for( int n = 1 ; n <= 34 ; n++ )
+        {
+            int const len = ( n <= 33 ) ? n : 4096;
+            double e   = validate( isa , len );
+            double e_f = validate_f( isa , len );
+
+            if( e > Tolerance || e_f > ToleranceF )
+            {
+                if( n_bad++ == 0 ) cerr << name( isa ) << ": n = " << len << " error " << e << " float " << e_f << "\n";
+            }
+            if( e > err )     err = e;
+            if( e_f > err_f ) err_f = e_f;
+        }
+
+        cout << setw( 8 ) << name( isa ) << "  double " << setw( 12 ) << err
+             << "  float " << setw( 12 ) << err_f
+             << "  " << ( n_bad ? "FAIL" : "ok" ) << "\n";
+        if( n_bad ) fail = 1;
+    }
+
+    if( best == Scalar ) cout << "no vector variant on this processor\n";
+
+    return fail;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# lpv - modele liniowe na siatce punktow pracy i symulacja LPV
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = lpv
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
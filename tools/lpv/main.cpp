@@ -0,0 +1,313 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <Engine.h>
+#include <EngineDeck.h>
+#include <LinearModel.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Modele liniowe na siatce i symulacja LPV.
+///
+/// lpv deck [--H list] [--Mach list] [--throttle list] [--refine tol] [--save file]
+///          [--load file] [--point H Mach throttle] [--dt s] [--seconds s] [--gate e]
+///
+/// list - wartosci po przecinku. Buduje ( albo wczytuje ) harmonogram modeli ,
+/// os przepustnicy zageszczana z --refine ( LPVSchedule::set_refinement , 0 - bez ).
+/// --point wypisuje A , B , C , D interpolowane w punkcie. Bez --point porownuje
+/// LPV z pelnym modelem dynamicznym ( RK4 , 1 ms ) na skokach przepustnicy i
+/// podaje bledy oraz czas liczenia sekundy lotu: Engine::update , Dynamics , LPV
+/// z krokiem 1 ms ( ten sam co Dynamics ) i z krokiem --dt.
+/// Blad odniesiony jest do zakresu wyjscia w probie i do jego sredniej. Bramka
+/// dokladnosci: wyjscia z bledem powyzej --gate zakresu ( domyslnie 0.1 ) sa
+/// wypisane , kod wyjscia 3.
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+bool parse_list( const char *s , vector<double> &v )
+{
+    v.clear();
+    while( *s )
+    {
+        char *end;
+        v.push_back( strtod( s , &end ) );
+        if( end == s ) return false;
+        s = *end == ',' ? end + 1 : end;
+    }
+    return !v.empty();
+}
+
+/// Przepustnica w probie: skok w gore , w dol i rampa
+double throttle_at( double t )
+{
+    if( t < 1.0 ) return 0.4;
+    if( t < 5.0 ) return 0.7;
+    if( t < 8.0 ) return 0.5;
+    return 0.5 + 0.3 * ( t - 8.0 ) / 4.0 < 0.8 ? 0.5 + 0.3 * ( t - 8.0 ) / 4.0 : 0.8;
+}
+
+double seconds_since( Clock::time_point t0 )
+{
+    return std::chrono::duration<double>( Clock::now() - t0 ).count();
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: lpv deck [--H list] [--Mach list] [--throttle list] [--refine tol] [--save file]\n"
+                "                [--load file] [--point H Mach throttle] [--dt s] [--seconds s] [--gate e]" << endl;
+        return 2;
+    }
+
+    vector<double> H = { 0.0 , 1000.0 , 2000.0 , 3000.0 };
+    vector<double> M = { 0.0 , 0.1 , 0.2 };
+    vector<double> T = { 0.2 , 0.3 , 0.4 , 0.5 , 0.6 , 0.7 , 0.8 , 0.9 , 1.0 };
+    const char *save = 0 , *load = 0;
+    bool point = false;
+    double pH = 0.0 , pM = 0.0 , pt = 0.0;
+    double dt = 0.01 , seconds = 12.0 , gate = 0.1 , refine = -1.0;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        bool ok = true;
+        if(      !strcmp( argv[a] , "--H" )        && a + 1 < argc ) ok = parse_list( argv[++a] , H );
+        else if( !strcmp( argv[a] , "--Mach" )     && a + 1 < argc ) ok = parse_list( argv[++a] , M );
+        else if( !strcmp( argv[a] , "--throttle" ) && a + 1 < argc ) ok = parse_list( argv[++a] , T );
+        else if( !strcmp( argv[a] , "--save" )     && a + 1 < argc ) save    = argv[++a];
+        else if( !strcmp( argv[a] , "--load" )     && a + 1 < argc ) load    = argv[++a];
+        else if( !strcmp( argv[a] , "--dt" )       && a + 1 < argc ) dt      = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--seconds" )  && a + 1 < argc ) seconds = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--gate" )     && a + 1 < argc ) gate    = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--refine" )   && a + 1 < argc ) refine  = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--point" )    && a + 3 < argc )
+        {
+            point = true;
+            pH = atof( argv[++a] );
+            pM = atof( argv[++a] );
+            pt = atof( argv[++a] );
+        }
+        else ok = false;
+
+        if( !ok )
+        {
+            cerr << "lpv: bad option " << argv[a] << endl;
+            return 2;
+        }
+    }
+    if( dt <= 0.0 || seconds <= 0.0 )
+    {
+        cerr << "lpv: bad --dt or --seconds" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    LPVSchedule sched;
+    if( refine >= 0.0 ) sched.set_refinement( refine , 129 );
+    Clock::time_point t0 = Clock::now();
+    if( load ? !sched.load( load ) : !sched.build( dat , H , M , T ) ) return 1;
+
+    cout << std::fixed << std::setprecision( 3 )
+         << ( load ? "loaded " : "built " ) << sched.points() << " models ( "
+         << sched.get_H().size() << " H x " << sched.get_Mach().size() << " Mach x "
+         << sched.get_throttle().size() << " throttle ) in " << seconds_since( t0 ) * 1.0e3 << " ms\n";
+
+    if( save && !sched.save( save ) ) return 1;
+
+    if( point )
+    {
+        LinearModel m;
+        TableCursor<double> cur[3];
+        sched.interpolate( pH , pM , pt , m , cur );
+
+        const char *xn[LinearModel::Nx] = { "n_gg" , "T4" , "Omega" };
+        cout << std::scientific << std::setprecision( 5 ) << "\n# x0 , A | B\n";
+        for( int i = 0 ; i < LinearModel::Nx ; i++ )
+        {
+            cout << std::setw( 10 ) << xn[i] << std::setw( 14 ) << m.x0[i] << "  ";
+            for( int j = 0 ; j < LinearModel::Nx ; j++ ) cout << std::setw( 14 ) << m.A[i][j];
+            cout << "  |" << std::setw( 14 ) << m.B[i][0] << "\n";
+        }
+        cout << "\n# y0 , C | D\n";
+        for( int i = 0 ; i < LinearModel::Ny ; i++ )
+        {
+            cout << std::setw( 10 ) << LinearModel::output_name( i ) << std::setw( 14 ) << m.y0[i] << "  ";
+            for( int j = 0 ; j < LinearModel::Nx ; j++ ) cout << std::setw( 14 ) << m.C[i][j];
+            cout << "  |" << std::setw( 14 ) << m.D[i][0] << "\n";
+        }
+        return 0;
+    }
+
+    /// proba: srodek siatki H i Mach , skoki przepustnicy
+    double H0 = 0.5 * ( sched.get_H().front() + sched.get_H().back() );
+    double M0 = 0.5 * ( sched.get_Mach().front() + sched.get_Mach().back() );
+    Atmosphere atm;
+
+    Dynamics d( dat );
+    d.set_scheme( Dynamics::RK4 );
+    d.set_step( 0.001 );
+    d.set_schedule( [H0 , M0]( double t ) { Dynamics::Input in = { H0 , M0 , throttle_at( t ) }; return in; } );
+    if( !d.trim( &atm ) )
+    {
+        cerr << "lpv: no steady point at start" << endl;
+        return 1;
+    }
+
+    LPVModel lpv( sched );
+    lpv.init( H0 , M0 , throttle_at( 0.0 ) );
+
+    double err[LinearModel::Ny] = { 0.0 } , range[LinearModel::Ny] = { 0.0 } , mean[LinearModel::Ny] = { 0.0 };
+    double lo[LinearModel::Ny] , hi[LinearModel::Ny];
+    double err_x[LinearModel::Nx] = { 0.0 };
+
+    long n = long( seconds / dt + 0.5 );
+    for( long k = 0 ; k <= n ; k++ )
+    {
+        double t = k * dt;
+        if( k )
+        {
+            /// wejscie z poczatku kroku - jak w RK4 , ktore skok w t widzi dopiero w t
+            lpv.set_input( H0 , M0 , throttle_at( t - dt ) );
+            lpv.step( dt );
+            d.advance( &atm , t );
+        }
+
+        Dynamics::Output o;
+        d.output( &atm , o );
+        double y[LinearModel::Ny] , yl[LinearModel::Ny];
+        LinearModel::outputs( o , y );
+        lpv.output( yl );
+
+        for( int i = 0 ; i < LinearModel::Ny ; i++ )
+        {
+            if( !k || y[i] < lo[i] ) lo[i] = y[i];
+            if( !k || y[i] > hi[i] ) hi[i] = y[i];
+            if( fabs( yl[i] - y[i] ) > err[i] ) err[i] = fabs( yl[i] - y[i] );
+            mean[i] += fabs( y[i] ) / ( n + 1 );
+        }
+        for( int i = 0 ; i < LinearModel::Nx ; i++ )
+            if( fabs( lpv.get_x()[i] - d.get_x()[i] ) > err_x[i] ) err_x[i] = fabs( lpv.get_x()[i] - d.get_x()[i] );
+    }
+
+    cout << "\n# LPV ( dt = " << dt << " s ) vs Dynamics RK4 ( 1 ms ) at H = " << H0 << " m , Mach = " << M0
+         << " , " << seconds << " s of throttle steps\n"
+         << "#      output     max |err|        range   err / range    err / mean\n" << std::setprecision( 4 );
+    std::string poor;
+    for( int i = 0 ; i < LinearModel::Ny ; i++ )
+    {
+        range[i] = hi[i] - lo[i];
+        double rel = range[i] > 0.0 ? err[i] / range[i] : 0.0;
+        cout << std::setw( 14 ) << LinearModel::output_name( i ) << std::setw( 14 ) << err[i]
+             << std::setw( 13 ) << range[i] << std::setw( 14 ) << rel
+             << std::setw( 14 ) << ( mean[i] > 0.0 ? err[i] / mean[i] : 0.0 ) << "\n";
+        if( rel > gate ) poor += std::string( " " ) + LinearModel::output_name( i );
+    }
+    cout << std::setw( 14 ) << "n_gg" << std::setw( 14 ) << err_x[0] << "\n"
+         << std::setw( 14 ) << "Omega" << std::setw( 14 ) << err_x[2] << "\n";
+    cout << "# accuracy gate ( err / range <= " << gate << " ): "
+         << ( poor.empty() ? std::string( "ok" ) : "FAIL -" + poor ) << "\n";
+
+    /// czas sekundy lotu
+    const int reps = 20;
+    double s_engine , s_dyn;
+    {
+        EngineConstruct construct;
+        TurboShaftEngine builder( dat );
+        construct.CreateEngine( builder );
+        std::shared_ptr<Engine> e = builder.GetEngine().lock();
+        e->set_n_wc( d.get_x()[0] );
+        atm.update( H0 );
+        e->set_Mach( M0 );
+        e->update( &atm );
+
+        t0 = Clock::now();
+        for( int r = 0 ; r < reps ; r++ )
+            for( int k = 0 ; k < 1000 ; k++ )
+            {
+                e->set_throttle( throttle_at( k * 0.001 ) );
+                e->update( &atm , 0.001 );
+            }
+        s_engine = seconds_since( t0 ) / reps;
+    }
+    {
+        double x[Dynamics::States];
+        for( int i = 0 ; i < Dynamics::States ; i++ ) x[i] = d.get_x()[i];
+
+        t0 = Clock::now();
+        for( int r = 0 ; r < reps ; r++ )
+        {
+            d.set_state( 0.0 , x );
+            d.advance( &atm , 1.0 );
+        }
+        s_dyn = seconds_since( t0 ) / reps;
+    }
+    auto lpv_second = [&]( double h )
+    {
+        long steps = long( 1.0 / h + 0.5 );
+        int  r_lpv = int( reps * 0.1 / h );
+        Clock::time_point t1 = Clock::now();
+        for( int r = 0 ; r < r_lpv ; r++ )
+        {
+            lpv.init( H0 , M0 , 0.4 );
+            for( long k = 1 ; k <= steps ; k++ )
+            {
+                lpv.set_input( H0 , M0 , throttle_at( ( k - 1 ) * h ) );
+                lpv.step( h );
+            }
+        }
+        return seconds_since( t1 ) / r_lpv;
+    };
+    double s_lpv1 = lpv_second( 0.001 );
+    double s_lpv  = lpv_second( dt );
+
+    /// porownanie przy tym samym kroku ( 1 ms ) - przyspieszenie modelu , a nie
+    /// wiekszego kroku , ktory niejawny Euler dopuszcza
+    cout << "\n# time per simulated second\n" << std::setprecision( 2 )
+         << "Engine::update ( 1 ms )  " << std::setw( 10 ) << s_engine * 1.0e6 << " us\n"
+         << "Dynamics RK4 ( 1 ms )    " << std::setw( 10 ) << s_dyn * 1.0e6 << " us\n"
+         << "LPV ( 1 ms )             " << std::setw( 10 ) << s_lpv1 * 1.0e6 << " us  ( x"
+         << std::setprecision( 1 ) << s_dyn / s_lpv1 << " vs Dynamics , x" << s_engine / s_lpv1
+         << " vs Engine::update at equal step )\n" << std::setprecision( 2 )
+         << "LPV ( " << std::setprecision( 3 ) << dt << " s )          " << std::setprecision( 2 )
+         << std::setw( 10 ) << s_lpv * 1.0e6 << " us  ( x" << std::setprecision( 0 ) << s_dyn / s_lpv
+         << " vs Dynamics , x" << s_engine / s_lpv << " vs Engine::update with the larger step )" << endl;
+
+    return poor.empty() ? 0 : 3;
+}
@@ -0,0 +1,309 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <EngineDeck.h>
+#include <MonteCarlo.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Propagacja niepewnosci parametrow obiegu w ustalonym punkcie pracy.
+///
+/// montecarlo deck [--samples n] [--threads n] [--seed s] [--H m] [--Mach m]
+///                 [--throttle t] [--alpha a] [--normal p=srednia,odch[,obciecie]]
+///                 [--uniform p=min,max] [--tri p=min,moda,max] [--check] [--out plik]
+///
+/// p to nazwa parametru CycleSolver ( sigma_H1 , eta_S , sig_34 , eta_ks ,
+/// eta_Twc , sprez , mZR , mTwc , Mach , throttle ). Bez --normal / --uniform /
+/// --tri uzywany jest zestaw domyslny: straty cisnienia , sprawnosci i rozrzut
+/// charakterystyk. --check liczy to samo na jednym watku i sprawdza , czy
+/// statystyki sa identyczne bit w bit , oraz porownuje CycleSolver::sensitivities()
+/// w punkcie nominalnym z roznicami centralnymi ( kod 3 gdy ktores nie przejdzie ).
+namespace
+{
+
+bool find_param( const char *name , size_t len , CycleSolver::Param &p )
+{
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+    {
+        const char *n = CycleSolver::param_name( CycleSolver::Param( k ) );
+        if( strlen( n ) == len && !strncmp( n , name , len ) )
+        {
+            p = CycleSolver::Param( k );
+            return true;
+        }
+    }
+    return false;
+}
+
+/// "p=a,b[,c]" -> parametr i do trzech liczb; zwraca liczbe liczb albo -1
+int parse_spec( const char *s , CycleSolver::Param &p , double v[3] )
+{
+    const char *eq = strchr( s , '=' );
+    if( !eq || !find_param( s , size_t( eq - s ) , p ) ) return -1;
+
+    int k = 0;
+    const char *c = eq + 1;
+    while( k < 3 && *c )
+    {
+        char *e;
+        v[k++] = strtod( c , &e );
+        if( e == c ) return -1;
+        c = *e == ',' ? e + 1 : e;
+    }
+    return *c ? -1 : k;
+}
+
+/// Dopuszczalny blad elastycznosci pochodnych dualnych wzgledem roznic centralnych
+double const SensTolerance = 1.0e-6;
+
+double output( CycleSolver::Point const &p , int y )
+{
+    double const v[CycleSolver::Outputs] = { p.n_wc , p.epsT , p.T4s , p.T5s , p.T6s , p.m3 , p.P_turbine , p.P_free };
+    return v[y];
+}
+
+double nominal( MonteCarlo::Input const &in )
+{
+    switch( in.dist )
+    {
+    case MonteCarlo::Uniform:    return 0.5 * ( in.a + in.b );
+    case MonteCarlo::Triangular: return in.b;
+    default:                     return in.a;
+    }
+}
+
+/// sensitivities() w punkcie nominalnym wzgledem roznic centralnych
+/// ( y( p + h ) - y( p - h ) ) / 2h , h = 1e-5 max( | p | , 0.1 ) - solver
+/// zbiezny do 1e-13. Dla kazdego parametru najwiekszy po wyjsciach blad
+/// elastycznosci | dy - dy_fd | max( | p | , 0.1 ) / | y |.
+bool check_sensitivities( std::shared_ptr<EngineData> const &dat , MonteCarlo const &mc ,
+                          Atmosphere *atm , double H )
+{
+    double p[CycleSolver::Params];
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+        p[k] = nominal( mc.get_input( CycleSolver::Param( k ) ) );
+
+    CycleSolver cs( dat );
+    cs.set_tolerance( 1.0e-13 );
+    cs.set_max_iter( 200 );
+
+    CycleSolver::Point pt;
+    CycleSolver::Sensitivity s;
+    if( !cs.solve( atm , H , p , pt ) || !cs.sensitivities( s ) )
+    {
+        cerr << "montecarlo: no steady point for the sensitivity check" << endl;
+        return false;
+    }
+
+    bool ok = true;
+    cout << "sensitivities vs central differences ( tolerance " << SensTolerance << " )\n";
+
+    for( int k = 0 ; k < CycleSolver::Params ; k++ )
+    {
+        double scale = std::max( fabs( p[k] ) , 0.1 );
+        double h = 1.0e-5 * scale;
+        double q[CycleSolver::Params];
+        memcpy( q , p , sizeof( q ) );
+
+        CycleSolver::Point hi , lo;
+        q[k] = p[k] + h;
+        bool conv = cs.solve( atm , H , q , hi );
+        q[k] = p[k] - h;
+        conv = cs.solve( atm , H , q , lo ) && conv;
+
+        double err = 0.0;
+        int worst = 0;
+        for( int y = 0 ; y < CycleSolver::Outputs && conv ; y++ )
+        {
+            double fd = ( output( hi , y ) - output( lo , y ) ) / ( 2.0 * h );
+            double e  = fabs( s.dy[y][k] - fd ) * scale / fabs( s.y[y] );
+            if( e > err ) { err = e; worst = y; }
+        }
+
+        bool pass = conv && err <= SensTolerance;
+        cout << std::setw( 10 ) << CycleSolver::param_name( CycleSolver::Param( k ) ) << "  ";
+        if( conv ) cout << std::setw( 12 ) << err << "  " << std::left << std::setw( 10 )
+                        << CycleSolver::output_name( CycleSolver::Output( worst ) ) << std::right;
+        else       cout << std::setw( 24 ) << "not converged";
+        cout << "  " << ( pass ? "ok" : "FAIL" ) << "\n";
+        if( !pass ) ok = false;
+    }
+    return ok;
+}
+
+bool same( MonteCarlo const &a , MonteCarlo const &b )
+{
+    double const q[] = { 0.01 , 0.05 , 0.5 , 0.95 , 0.99 };
+
+    for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+    {
+        MonteCarlo::Stats const &s = a.get_stats( CycleSolver::Output( y ) );
+        MonteCarlo::Stats const &t = b.get_stats( CycleSolver::Output( y ) );
+        if( s.n != t.n || memcmp( &s.mean , &t.mean , sizeof( double ) ) || memcmp( &s.m2 , &t.m2 , sizeof( double ) ) )
+            return false;
+        for( int k = 0 ; k < 5 ; k++ )
+            if( s.quantile( q[k] ) != t.quantile( q[k] ) ) return false;
+    }
+    return a.get_failed() == b.get_failed();
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: montecarlo deck [--samples n] [--threads n] [--seed s] [--H m] [--Mach m] [--throttle t]\n"
+                "                       [--alpha a] [--normal p=mean,sd[,clip]] [--uniform p=lo,hi]\n"
+                "                       [--tri p=lo,mode,hi] [--check] [--out file]" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    MonteCarlo mc( dat );
+
+    const char *out_path = 0;
+    long samples = 100000;
+    int threads = 0;
+    unsigned long long seed = 0;
+    double alpha = 1.0e-4;
+    double H = 0.0 , Mach = 0.2 , throttle = 0.7;
+    bool check = false , custom = false;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        CycleSolver::Param p;
+        double v[3];
+        int k;
+
+        if(      !strcmp( argv[a] , "--samples" )  && a + 1 < argc ) samples  = atol( argv[++a] );
+        else if( !strcmp( argv[a] , "--threads" )  && a + 1 < argc ) threads  = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--seed" )     && a + 1 < argc ) seed     = strtoull( argv[++a] , 0 , 0 );
+        else if( !strcmp( argv[a] , "--H" )        && a + 1 < argc ) H        = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--Mach" )     && a + 1 < argc ) Mach     = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--throttle" ) && a + 1 < argc ) throttle = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--alpha" )    && a + 1 < argc ) alpha    = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--out" )      && a + 1 < argc ) out_path = argv[++a];
+        else if( !strcmp( argv[a] , "--check" ) )                    check    = true;
+        else if( !strcmp( argv[a] , "--normal" ) && a + 1 < argc && ( k = parse_spec( argv[a+1] , p , v ) ) >= 2 )
+        {
+            mc.set_normal( p , v[0] , v[1] , k > 2 ? v[2] : 4.0 );
+            custom = true; a++;
+        }
+        else if( !strcmp( argv[a] , "--uniform" ) && a + 1 < argc && parse_spec( argv[a+1] , p , v ) == 2 )
+        {
+            mc.set_uniform( p , v[0] , v[1] );
+            custom = true; a++;
+        }
+        else if( !strcmp( argv[a] , "--tri" ) && a + 1 < argc && parse_spec( argv[a+1] , p , v ) == 3 )
+        {
+            mc.set_triangular( p , v[0] , v[1] , v[2] );
+            custom = true; a++;
+        }
+        else
+        {
+            cerr << "montecarlo: bad option " << argv[a] << ( a + 1 < argc ? string( " " ) + argv[a+1] : string() ) << endl;
+            return 2;
+        }
+    }
+
+    /// --Mach / --throttle nie nadpisuja rozkladu podanego wprost
+    if( mc.get_input( CycleSolver::P_Mach ).dist == MonteCarlo::Fixed )
+        mc.set_fixed( CycleSolver::P_Mach , Mach );
+    if( mc.get_input( CycleSolver::P_throttle ).dist == MonteCarlo::Fixed )
+        mc.set_fixed( CycleSolver::P_throttle , throttle );
+    mc.set_altitude( H );
+
+    if( !custom )
+    {
+        mc.set_normal( CycleSolver::P_sigma_H1 , 0.96 , 0.005 , 3.0 );
+        mc.set_normal( CycleSolver::P_sig_34 , 0.9578 , 0.004 , 3.0 );
+        mc.set_normal( CycleSolver::P_eta_S , 1.0 , 0.01 );
+        mc.set_normal( CycleSolver::P_eta_ks , dat->eta_ks , 0.005 , 2.0 );
+        mc.set_triangular( CycleSolver::P_eta_Twc , 0.97 , 0.99 , 1.0 );
+        mc.set_normal( CycleSolver::P_sprez , 1.0 , 0.01 );
+        mc.set_normal( CycleSolver::P_mZR , 1.0 , 0.01 );
+        mc.set_normal( CycleSolver::P_mTwc , 1.0 , 0.01 );
+    }
+
+    mc.set_seed( seed );
+    mc.set_alpha( alpha );
+
+    ThreadPool pool( threads );
+    Atmosphere atm;
+
+    if( !mc.run( pool , &atm , samples ) ) return 1;
+
+    cout << "# H " << H << " m , " << mc.get_samples() << " samples , " << mc.get_failed() << " not converged\n";
+    cout << std::left << std::setw( 10 ) << "output" << std::right;
+    const char * const head[] = { "mean" , "sd" , "p01" , "p50" , "p99" , "min" , "max" };
+    for( int k = 0 ; k < 7 ; k++ ) cout << std::setw( 14 ) << head[k];
+    cout << "\n" << std::setprecision( 7 );
+
+    for( int y = 0 ; y < CycleSolver::Outputs ; y++ )
+    {
+        MonteCarlo::Stats const &s = mc.get_stats( CycleSolver::Output( y ) );
+        cout << std::left << std::setw( 10 ) << CycleSolver::output_name( CycleSolver::Output( y ) ) << std::right
+             << std::setw( 14 ) << s.mean << std::setw( 14 ) << sqrt( s.variance() )
+             << std::setw( 14 ) << s.quantile( 0.01 ) << std::setw( 14 ) << s.quantile( 0.5 )
+             << std::setw( 14 ) << s.quantile( 0.99 )
+             << std::setw( 14 ) << s.min << std::setw( 14 ) << s.max << "\n";
+    }
+
+    if( out_path && !mc.write( out_path ) )
+    {
+        cerr << "montecarlo: cannot write " << out_path << endl;
+        return 1;
+    }
+
+    if( check )
+    {
+        ThreadPool one( 1 );
+        MonteCarlo ref( dat );
+        for( int k = 0 ; k < CycleSolver::Params ; k++ )
+            ref.set_input( CycleSolver::Param( k ) , mc.get_input( CycleSolver::Param( k ) ) );
+        ref.set_altitude( H );
+        ref.set_seed( seed );
+        ref.set_alpha( alpha );
+        if( !ref.run( one , &atm , samples ) ) return 1;
+
+        bool ok = same( mc , ref );
+        cout << "reproducible on 1 vs " << pool.size() << " threads: " << ( ok ? "yes" : "NO" ) << endl;
+
+        bool sens = check_sensitivities( dat , mc , &atm , H );
+        if( !ok || !sens ) return 3;
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# montecarlo - propagacja niepewnosci parametrow obiegu
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = montecarlo
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,116 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <Engine.h>
+#include <EngineDeck.h>
+#include <Pipeline.h>
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Porownanie kroku silnika: EngineBuilder ( wywolania wirtualne , shared_ptr )
+/// i TurboShaftPipeline ( stopnie skladane w czasie kompilacji ).
+///
+/// pipebench deck [kroki]   - deck tekstowy ( .txt , .csv ) albo binarny
+namespace
+{
+
+double const Ma  = 0.2;
+double const n0  = 3000.0;      ///< [rad/s]
+
+double throttle( long i ) { return 0.5 + 0.3 * double( i % 1000 ) / 1000.0; }
+
+double seconds( std::chrono::steady_clock::time_point t0 )
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: pipebench deck [steps]" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    long steps = argc > 2 ? atol( argv[2] ) : 1000000;
+
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    Atmosphere atm;
+    atm.update( 1000.0 );
+
+    /// EngineBuilder
+    EngineConstruct construct;
+    TurboShaftEngine builder( dat );
+    construct.CreateEngine( builder );
+    std::shared_ptr<Engine> engine = builder.GetEngine().lock();
+
+    engine->set_Mach( Ma );
+    engine->set_n_wc( n0 );
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for( long i = 0 ; i < steps ; i++ )
+    {
+        engine->set_throttle( throttle( i ) );
+        engine->update( &atm );
+    }
+    double t_dyn = seconds( t0 );
+
+    /// Pipeline
+    TurboShaftPipeline pipe( dat );
+    Stage::Flow f = Stage::Flow();
+
+    t0 = std::chrono::steady_clock::now();
+    for( long i = 0 ; i < steps ; i++ )
+    {
+        pipe.set_inputs( Ma , n0 , throttle( i ) );
+        f = pipe.step( &atm );
+    }
+    double t_sta = seconds( t0 );
+
+    Engine::Temp  const &T = engine->get_temp();
+    Engine::Press const &p = engine->get_press();
+
+    double d = fabs( pipe.get<2>().out.T - T.T4s ) / T.T4s;
+    d = max( d , fabs( pipe.get<3>().out.T - T.T5s ) / T.T5s );
+    d = max( d , fabs( pipe.get<3>().out.p - p.p5s ) / p.p5s );
+
+    cout << "steps       " << steps << endl
+         << "builder     " << t_dyn / steps * 1.0e9 << " ns/step" << endl
+         << "pipeline    " << t_sta / steps * 1.0e9 << " ns/step" << endl
+         << "speedup     " << t_dyn / t_sta << endl
+         << "max rel err " << d << "   ( T6 " << f.T << " K )" << endl;
+
+    return 0;
+}
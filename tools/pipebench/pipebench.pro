@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# pipebench - krok silnika: EngineBuilder i Pipeline
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = pipebench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,233 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <EngineDeck.h>
+#include <StationKernels.h>
+#include <Sweep.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Raport dokladnosci obliczen float wzgledem double na obwiedni pracy.
+///
+/// precision deck [--tol e] [--threads n] [--out plik]
+///
+/// Ta sama siatka H x Mach x throttle x n_wc liczona przez Sweep w obu
+/// precyzjach ( EngineFleet / EngineFleetF ) do ustalenia. Dla kazdej wielkosci
+/// przekroju: mediana , p99 i maksimum bledu wzglednego oraz punkt maksimum;
+/// potem mapa H x Mach najwiekszego bledu T4 , T5 , Pt , wpt - komorki powyzej
+/// tol oznaczone '*'. Na koncu czas obu przebiegow.
+namespace
+{
+
+struct Field
+{
+    const char *name;
+    double Sweep::Result::*v;
+};
+
+Field const fields[] =
+{
+    { "TH"  , &Sweep::Result::TH  } , { "pH"  , &Sweep::Result::pH  } ,
+    { "T1s" , &Sweep::Result::T1s } , { "p1s" , &Sweep::Result::p1s } , { "c1" , &Sweep::Result::c1 } ,
+    { "T3s" , &Sweep::Result::T3s } , { "p3s" , &Sweep::Result::p3s } , { "m3" , &Sweep::Result::m3 } ,
+    { "T4s" , &Sweep::Result::T4s } , { "p4s" , &Sweep::Result::p4s } , { "m4" , &Sweep::Result::m4 } ,
+    { "T5s" , &Sweep::Result::T5s } , { "p5s" , &Sweep::Result::p5s } , { "Pt" , &Sweep::Result::Pt } ,
+    { "T6s" , &Sweep::Result::T6s } , { "wpt" , &Sweep::Result::wpt }
+};
+int const Fields = sizeof( fields ) / sizeof( fields[0] );
+
+/// Wielkosci, dla ktorych liczona jest mapa obwiedni
+int const key_fields[] = { 8 , 11 , 13 , 15 };      ///< T4s , T5s , Pt , wpt
+
+double rel( double f , double d )
+{
+    if( d != d || f != f ) return 1.0;                      ///< NaN w ktorejkolwiek precyzji
+    return fabs( f - d ) / ( fabs( d ) > 0.0 ? fabs( d ) : 1.0 );
+}
+
+double quantile( std::vector<double> v , double q )
+{
+    if( v.empty() ) return 0.0;
+    size_t k = size_t( q * ( v.size() - 1 ) );
+    std::nth_element( v.begin() , v.begin() + k , v.end() );
+    return v[k];
+}
+
+std::vector<double> range( double a , double b , int n )
+{
+    std::vector<double> v( n );
+    for( int i = 0 ; i < n ; i++ ) v[i] = n > 1 ? a + ( b - a ) * i / ( n - 1 ) : a;
+    return v;
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: precision deck [--tol e] [--threads n] [--out file]" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    const char *out_path = 0;
+    double tol = 1.0e-4;
+    int threads = 0;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        if(      !strcmp( argv[a] , "--tol" )     && a + 1 < argc ) tol      = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--threads" ) && a + 1 < argc ) threads  = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--out" )     && a + 1 < argc ) out_path = argv[++a];
+        else
+        {
+            cerr << "precision: unknown option " << argv[a] << endl;
+            return 2;
+        }
+    }
+
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    /// obwiednia: n_wc w zakresie charakterystyki sprezarki [rad/s]
+    std::vector<double> H   = range( 0.0 , 12000.0 , 13 );
+    std::vector<double> Ma  = range( 0.05 , 0.85 , 9 );
+    std::vector<double> thr = range( 0.1 , 1.0 , 10 );
+    std::vector<double> n   = range( dat->rpm_tab[0] * EngineConst::n_PI_30 ,
+                                     dat->rpm_tab[ dat->sk - 1 ] * EngineConst::n_PI_30 , 8 );
+
+    ThreadPool pool( threads );
+    Atmosphere atm;
+
+    Sweep sd( dat ) , sf( dat );
+    sd.set_grid( H , Ma , thr , n );
+    sf.set_grid( H , Ma , thr , n );
+    sf.set_precision( Sweep::Float );
+
+    sd.run( pool , &atm );
+    sf.run( pool , &atm );
+
+    std::vector<Sweep::Point>  const &pt = sd.get_points();
+    std::vector<Sweep::Result> const &rd = sd.get_results();
+    std::vector<Sweep::Result> const &rf = sf.get_results();
+    size_t np = pt.size();
+
+    std::ostringstream rep;
+    rep << "# float vs double - " << np << " points , isa " << StationKernels::name( StationKernels::active() )
+        << " , kernel error double " << StationKernels::validate( StationKernels::active() )
+        << " float " << StationKernels::validate_f( StationKernels::active() ) << "\n";
+    rep << "# H 0..12 km , Mach 0.05..0.85 , throttle 0.1..1 , n_wc " << n.front() << ".." << n.back() << " rad/s\n\n";
+
+    /// bledy kazdej wielkosci
+    std::vector< std::vector<double> > err( Fields , std::vector<double>( np ) );
+    long unsettled_d = 0 , unsettled_f = 0 , steps_diff = 0;
+
+    for( size_t i = 0 ; i < np ; i++ )
+    {
+        for( int k = 0 ; k < Fields ; k++ )
+            err[k][i] = rel( rf[i].*fields[k].v , rd[i].*fields[k].v );
+
+        unsettled_d += !rd[i].settled;
+        unsettled_f += !rf[i].settled;
+        steps_diff  += labs( long( rf[i].steps - rd[i].steps ) );
+    }
+
+    rep << std::left << std::setw( 6 ) << "field" << std::right
+        << std::setw( 12 ) << "median" << std::setw( 12 ) << "p99" << std::setw( 12 ) << "max"
+        << "   at ( H , Mach , throttle , n_wc )\n";
+    rep << std::scientific << std::setprecision( 2 );
+
+    for( int k = 0 ; k < Fields ; k++ )
+    {
+        size_t at = std::max_element( err[k].begin() , err[k].end() ) - err[k].begin();
+        rep << std::left << std::setw( 6 ) << fields[k].name << std::right
+            << std::setw( 12 ) << quantile( err[k] , 0.5 )
+            << std::setw( 12 ) << quantile( err[k] , 0.99 )
+            << std::setw( 12 ) << err[k][at]
+            << std::defaultfloat << std::setprecision( 6 ) << "   ( " << pt[at].H_alt << " , " << pt[at].Mach << " , "
+            << pt[at].throttle << " , " << pt[at].n_wc << " )\n" << std::scientific << std::setprecision( 2 );
+    }
+
+    /// mapa H x Mach - najwiekszy blad T4 , T5 , Pt , wpt po throttle i n_wc
+    size_t per_cell = thr.size() * n.size();
+    long cells_over = 0 , points_over = 0;
+
+    rep << "\n# max rel err of T4s , T5s , Pt , wpt over throttle x n_wc ; '*' - above tol " << tol << "\n";
+    rep << std::setw( 8 ) << "H \\ Ma";
+    for( size_t j = 0 ; j < Ma.size() ; j++ ) rep << std::fixed << std::setprecision( 2 ) << std::setw( 10 ) << Ma[j];
+    rep << "\n";
+
+    for( size_t h = 0 ; h < H.size() ; h++ )
+    {
+        rep << std::fixed << std::setprecision( 0 ) << std::setw( 8 ) << H[h];
+        for( size_t j = 0 ; j < Ma.size() ; j++ )
+        {
+            size_t b = ( h * Ma.size() + j ) * per_cell;
+            double m = 0.0;
+            for( size_t i = b ; i < b + per_cell ; i++ )
+            {
+                double e = 0.0;
+                for( int k = 0 ; k < 4 ; k++ ) e = std::max( e , err[ key_fields[k] ][i] );
+                if( e > tol ) points_over++;
+                m = std::max( m , e );
+            }
+            if( m > tol ) cells_over++;
+            rep << std::scientific << std::setprecision( 1 ) << std::setw( 9 ) << m << ( m > tol ? '*' : ' ' );
+        }
+        rep << "\n";
+    }
+
+    rep << std::defaultfloat << std::setprecision( 6 ) << "\n";
+    rep << "points above tol   " << points_over << " / " << np << "\n";
+    rep << "cells above tol    " << cells_over << " / " << H.size() * Ma.size() << "\n";
+    rep << "unsettled          double " << unsettled_d << " , float " << unsettled_f << "\n";
+    rep << "settle steps diff  " << double( steps_diff ) / np << " per point\n";
+    rep << "time               double " << sd.get_time() << " s , float " << sf.get_time() << " s , speedup "
+        << ( sf.get_time() > 0.0 ? sd.get_time() / sf.get_time() : 0.0 ) << "\n";
+
+    cout << rep.str();
+
+    if( out_path )
+    {
+        std::ofstream out( out_path );
+        out << rep.str();
+        if( !out )
+        {
+            cerr << "precision: cannot write " << out_path << endl;
+            return 1;
+        }
+    }
+
+    return points_over ? 3 : 0;
+}
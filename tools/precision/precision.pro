@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# precision - raport dokladnosci float / double na obwiedni
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = precision
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
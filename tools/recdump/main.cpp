@@ -0,0 +1,95 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <Recorder.h>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Odczyt pliku rejestratora.
+///
+/// recdump file [channel...] [--from t] [--to t]
+///
+/// Bez kanalow - opis pliku i lista kanalow. Z kanalami - kolumny t i kanalow
+/// dla --from <= t <= --to ; czytane sa tylko bloki z tego zakresu czasu.
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: recdump file [channel...] [--from t] [--to t]" << endl;
+        return 2;
+    }
+
+    double t0 = -1.0e300 , t1 = 1.0e300;
+    vector<int> ch;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        if(      !strcmp( argv[a] , "--from" ) && a + 1 < argc ) t0 = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--to" )   && a + 1 < argc ) t1 = atof( argv[++a] );
+        else
+        {
+            int c = Recorder::channel( argv[a] );
+            if( c < 0 )
+            {
+                cerr << "recdump: unknown channel " << argv[a] << endl;
+                return 2;
+            }
+            ch.push_back( c );
+        }
+    }
+
+    RecordReader r;
+    if( !r.open( argv[1] ) ) return 1;
+
+    if( ch.empty() )
+    {
+        cout << "rows:   " << r.rows() << "\n"
+             << "blocks: " << r.blocks() << ( r.recovered() ? " ( index rebuilt - file not closed )" : "" ) << "\n"
+             << "t:      " << r.t_begin() << " .. " << r.t_end() << " s\n"
+             << "channels:";
+        for( int c = 0 ; c < Recorder::Channels ; c++ ) cout << " " << Recorder::channel_name( c );
+        cout << endl;
+        return 0;
+    }
+
+    vector<double> t;
+    vector< vector<double> > v( ch.size() );
+    for( size_t k = 0 ; k < ch.size() ; k++ )
+        if( !r.read( ch[k] , t0 , t1 , t , v[k] ) ) return 1;
+
+    cout << "# t";
+    for( size_t k = 0 ; k < ch.size() ; k++ ) cout << " " << Recorder::channel_name( ch[k] );
+    cout << "\n" << std::setprecision( 10 );
+
+    for( size_t i = 0 ; i < t.size() ; i++ )
+    {
+        cout << t[i];
+        for( size_t k = 0 ; k < ch.size() ; k++ ) cout << " " << v[k][i];
+        cout << "\n";
+    }
+    return 0;
+}
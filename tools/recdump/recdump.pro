@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# recdump - odczyt kanalow z pliku rejestratora ( Recorder.h )
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = recdump
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,370 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <Engine.h>
+#include <Dynamics.h>
+#include <EngineDeck.h>
+#include <Profiler.h>
+#include <Recorder.h>
+#include <Scenario.h>
+#include <ThreadPool.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Wsadowe przebiegi scenariuszy bez GUI , wiele scenariuszy naraz w jednym procesie.
+///
+/// fdmrun deck scenario... [@list] [--threads n] [--out dir] [--every n]
+///        [--dt s] [--record] [--scheme rk4|rk45|implicit] [--tol r] [--verbose]
+///
+/// Kazdy scenariusz ( Scenario.h ) liczony jest na wlasnym silniku i atmosferze;
+/// scenariusze rozdziela pula watkow. Wyniki co --every krokow strumieniowo do
+/// <out>/<nazwa scenariusza>.out , z --record wszystkie kanaly binarnie do
+/// <out>/<nazwa>.rec ( Recorder.h ). @list - plik ze sciezkami scenariuszy , po
+/// jednej w wierszu. --scheme liczy zamiast lancucha Engine::update model
+/// dynamiczny ( Dynamics.h ): n_wc to stan , kolumna n_wc scenariusza jest
+/// pomijana , a --dt jest krokiem RK4 i pierwszym krokiem schematow adaptacyjnych
+/// ( --tol ). Komunikaty biblioteki na cout sa wyciszone bez --verbose.
+/// Na koncu czas od startu procesu do pierwszego kroku i przepustowosc.
+/// Z DME_PROFILE ( CONFIG+=profile ) raport stref w profile.txt / profile.json.
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+struct Job
+{
+    string path;
+    bool   ok;
+    long   steps;
+    double first_ms;            ///< [ms] - od startu procesu do pierwszego kroku
+    double wall_ms;             ///< [ms]
+};
+
+struct Options
+{
+    string out;
+    long   every;
+    double dt;
+    bool   record;
+    int    scheme;              ///< Dynamics::Scheme , -1 - Engine::update
+    double tol;
+};
+
+double ms_since( Clock::time_point t0 )
+{
+    return std::chrono::duration<double , std::milli>( Clock::now() - t0 ).count();
+}
+
+/// Nazwa pliku bez katalogu i rozszerzenia
+string stem( string const &path )
+{
+    size_t s = path.find_last_of( "/\\" );
+    string name = s == string::npos ? path : path.substr( s + 1 );
+    size_t d = name.find_last_of( '.' );
+    return d == string::npos || d == 0 ? name : name.substr( 0 , d );
+}
+
+bool read_list( const char *path , vector<Job> &jobs )
+{
+    ifstream in( path );
+    if( !in )
+    {
+        cerr << "fdmrun: cannot open list " << path << endl;
+        return false;
+    }
+    string line;
+    while( getline( in , line ) )
+    {
+        size_t b = line.find_first_not_of( " \t\r" );
+        if( b == string::npos || line[b] == '#' ) continue;
+        size_t e = line.find_last_not_of( " \t\r" );
+        Job j = { line.substr( b , e - b + 1 ) , false , 0 , 0.0 , 0.0 };
+        jobs.push_back( j );
+    }
+    return true;
+}
+
+/// Scenariusz na modelu dynamicznym , wiersz co every * dt ; zwraca liczbe krokow
+long fly( std::shared_ptr<EngineData> const &dat , Options const &opt , Scenario const &sc ,
+          ostream &f , Job &job , Clock::time_point t_start )
+{
+    Atmosphere atm;
+    TableCursor<double> cur;
+
+    Dynamics d( dat );
+    d.set_scheme( Dynamics::Scheme( opt.scheme ) );
+    d.set_step( sc.get_dt() > 0.0 ? sc.get_dt() : opt.dt );
+    d.set_tolerance( opt.tol );
+    d.set_schedule( [&sc , &cur]( double t )
+    {
+        Scenario::Input in = sc.at( t , cur );
+        Dynamics::Input u = { in.H_alt , in.Mach , in.throttle };
+        return u;
+    } );
+
+    if( !d.trim( &atm , sc.t_begin() ) )
+    {
+        cerr << "fdmrun: " << job.path << ": no steady point at start" << endl;
+        return -1;
+    }
+    job.first_ms = ms_since( t_start );
+
+    double dt = ( sc.get_dt() > 0.0 ? sc.get_dt() : opt.dt ) * opt.every;
+    long total = long( ( sc.t_end() - sc.t_begin() ) / dt + 1.0e-9 );
+
+    for( long k = 0 ; k <= total ; k++ )
+    {
+        double t = sc.t_begin() + k * dt;
+        d.advance( &atm , t );
+
+        Scenario::Input in = sc.at( t , cur );
+        Dynamics::Output o;
+        d.output( &atm , o );
+
+        f << t << ' ' << in.H_alt << ' ' << in.Mach << ' ' << in.throttle << ' ' << o.n_gg
+          << ' ' << o.T3 << ' ' << o.p3 << ' ' << o.m3 << ' ' << o.T4 << ' ' << o.T5
+          << ' ' << o.P_t << ' ' << o.P_free << '\n';
+    }
+    return d.get_stats().steps;
+}
+
+void run( std::shared_ptr<EngineData> const &dat , Options const &opt , Job &job ,
+          Clock::time_point t_start )
+{
+    Clock::time_point t0 = Clock::now();
+
+    Scenario sc;
+    if( !sc.read( job.path.c_str() ) ) return;
+
+    string name = opt.out + "/" + stem( job.path ) + ( opt.record ? ".rec" : ".out" );
+    vector<char> buf( 1 << 16 );
+    ofstream f;
+    Recorder rec;
+
+    if( opt.record )
+    {
+        if( !rec.open( name.c_str() ) ) return;
+    }
+    else
+    {
+        f.rdbuf()->pubsetbuf( buf.data() , buf.size() );
+        f.open( name.c_str() );
+        if( !f )
+        {
+            cerr << "fdmrun: cannot write " << name << endl;
+            return;
+        }
+        f << "# t H Mach throttle n_wc T3s p3s m3 T4s T5s Pt P_free\n" << std::setprecision( 7 );
+    }
+
+    if( opt.scheme >= 0 )
+    {
+        long steps = fly( dat , opt , sc , f , job , t_start );
+        f.close();
+        job.ok      = steps >= 0 && !f.fail();
+        job.steps   = steps;
+        job.wall_ms = ms_since( t0 );
+        return;
+    }
+
+    EngineConstruct construct;
+    TurboShaftEngine builder( dat );
+    construct.CreateEngine( builder );
+    std::shared_ptr<Engine> e = builder.GetEngine().lock();
+
+    /// bez n_wc w scenariuszu - srodek charakterystyki sprezarki , jak w MultiEngine
+    double n0 = 0.5 * ( dat->rpm_tab[0] + dat->rpm_tab[ dat->sk - 1 ] ) * EngineConst::n_PI_30;
+
+    double dt = sc.get_dt() > 0.0 ? sc.get_dt() : opt.dt;
+    long total = long( ( sc.t_end() - sc.t_begin() ) / dt + 1.0e-9 );
+
+    Atmosphere atm;
+    TableCursor<double> cur;
+
+    for( long k = 0 ; k <= total ; k++ )
+    {
+        double t = sc.t_begin() + k * dt;
+        Scenario::Input in = sc.at( t , cur );
+
+        atm.update( in.H_alt );
+        e->set_Mach( in.Mach );
+        e->set_throttle( in.throttle );
+        e->set_n_wc( sc.has_n_wc() ? in.n_wc : n0 );
+
+        /// pierwszy krok turbiny startuje z p5 = 0 - krok rozruchowy poza zapisem
+        if( k == 0 )
+        {
+            e->update( &atm , dt );
+            job.first_ms = ms_since( t_start );
+        }
+        e->update( &atm , dt );
+
+        if( k % opt.every ) continue;
+
+        if( opt.record )
+        {
+            rec.record( *e , t , in.H_alt );
+            continue;
+        }
+
+        Engine::Temp  const &T = e->get_temp();
+        Engine::Press const &p = e->get_press();
+        f << t << ' ' << in.H_alt << ' ' << in.Mach << ' ' << in.throttle << ' ' << e->get_n_wc()
+          << ' ' << T.T3s << ' ' << p.p3s << ' ' << e->get_mS().m3 << ' ' << T.T4s << ' ' << T.T5s
+          << ' ' << e->get_Pt() << ' ' << e->get_P_free() << '\n';
+    }
+
+    if( opt.record ) job.ok = rec.close();
+    else
+    {
+        f.close();
+        job.ok = !f.fail();
+    }
+    job.steps   = total + 1;
+    job.wall_ms = ms_since( t0 );
+
+    if( !job.ok ) cerr << "fdmrun: write error " << name << endl;
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    Clock::time_point t_start = Clock::now();
+
+#if defined( DME_PROFILE )
+    Profiler::dump_at_exit( "profile.txt" , "profile.json" );
+#endif
+
+    if( argc < 3 )
+    {
+        cerr << "usage: fdmrun deck scenario... [@list] [--threads n] [--out dir] [--every n]\n"
+                "              [--dt s] [--record] [--scheme rk4|rk45|implicit] [--tol r] [--verbose]" << endl;
+        return 2;
+    }
+
+    Options opt = { "." , 1 , EngineConst::dt_ref , false , -1 , 1.0e-6 };
+    int threads = 0;
+    bool verbose = false;
+    vector<Job> jobs;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        if(      !strcmp( argv[a] , "--threads" ) && a + 1 < argc ) threads   = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--out" )     && a + 1 < argc ) opt.out   = argv[++a];
+        else if( !strcmp( argv[a] , "--every" )   && a + 1 < argc ) opt.every = atol( argv[++a] );
+        else if( !strcmp( argv[a] , "--dt" )      && a + 1 < argc ) opt.dt    = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--tol" )     && a + 1 < argc ) opt.tol   = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--scheme" )  && a + 1 < argc )
+        {
+            const char *s = argv[++a];
+            opt.scheme = !strcmp( s , "rk4" ) ? Dynamics::RK4 : !strcmp( s , "rk45" ) ? Dynamics::RK45 :
+                         !strcmp( s , "implicit" ) ? Dynamics::Implicit : -2;
+        }
+        else if( !strcmp( argv[a] , "--record" ) )                  opt.record = true;
+        else if( !strcmp( argv[a] , "--verbose" ) )                 verbose   = true;
+        else if( argv[a][0] == '@' )
+        {
+            if( !read_list( argv[a] + 1 , jobs ) ) return 1;
+        }
+        else if( argv[a][0] == '-' && argv[a][1] == '-' )
+        {
+            cerr << "fdmrun: unknown option " << argv[a] << endl;
+            return 2;
+        }
+        else
+        {
+            Job j = { argv[a] , false , 0 , 0.0 , 0.0 };
+            jobs.push_back( j );
+        }
+    }
+    if( jobs.empty() || opt.every < 1 || opt.dt <= 0.0 || threads < 0 || opt.scheme < -1 || opt.tol <= 0.0 )
+    {
+        cerr << "fdmrun: no scenarios or bad --every / --dt / --threads / --scheme / --tol" << endl;
+        return 2;
+    }
+    if( opt.record && opt.scheme >= 0 )
+    {
+        cerr << "fdmrun: --record needs the Engine::update chain ( no --scheme )" << endl;
+        return 2;
+    }
+
+    /// wlasny strumien na buforze cout , sam cout wyciszony ( badbit )
+    ostream out( cout.rdbuf() );
+    if( !verbose ) cout.rdbuf( 0 );
+
+    const char *path = argv[1];
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat )
+    {
+        cout.rdbuf( out.rdbuf() );
+        cout.clear();
+        return 1;
+    }
+
+    ThreadPool pool( threads );
+    Clock::time_point t0 = Clock::now();
+
+    pool.parallel_for( long( jobs.size() ) , 1 , [&]( long b , long e , int )
+    {
+        for( long i = b ; i < e ; i++ ) run( dat , opt , jobs[i] , t_start );
+    } );
+
+    double wall = ms_since( t0 );
+    dat.reset();
+
+    cout.rdbuf( out.rdbuf() );
+    cout.clear();
+
+    long ok = 0 , steps = 0;
+    double first = -1.0;
+    for( size_t i = 0 ; i < jobs.size() ; i++ )
+    {
+        if( !jobs[i].ok ) continue;
+        ok++;
+        steps += jobs[i].steps;
+        if( first < 0.0 || jobs[i].first_ms < first ) first = jobs[i].first_ms;
+
+        if( verbose )
+            out << std::fixed << std::setprecision( 1 ) << std::setw( 10 ) << jobs[i].wall_ms << " ms  "
+                << std::setw( 9 ) << jobs[i].steps << " steps  " << jobs[i].path << "\n";
+    }
+
+    out << std::fixed << std::setprecision( 3 )
+        << "scenarios: " << ok << " / " << jobs.size() << " on " << pool.size() << " threads\n"
+        << "first step: " << first << " ms after start\n"
+        << "wall: " << wall << " ms , " << std::setprecision( 0 ) << steps / ( wall * 1.0e-3 ) << " steps/s" << endl;
+
+    return ok == long( jobs.size() ) ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# fdmrun - wsadowe przebiegi scenariuszy bez GUI
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = fdmrun
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
@@ -0,0 +1,307 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <EngineDeck.h>
+#include <Philox.h>
+#include <Surrogate.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Model zastepczy punktu pracy - uczenie i walidacja.
+///
+/// surrogate deck [--H lo,hi] [--Mach lo,hi] [--throttle lo,hi] [--degree n]
+///                [--samples n] [--cells n] [--safety s] [--refine tol depth] [--tol rel]
+///                [--points n] [--retrain]
+///
+/// Wczytuje model obok decku ( deck.sur ) , a gdy go nie ma albo z --retrain -
+/// uczy w podanym obszarze i zapisuje ( --refine - podzial komorek ,
+/// Surrogate::set_refinement ). Walidacja: losowe punkty w obszarze
+/// powiekszonym o 10 % z kazdej strony , porownanie wyjsc kluczowych z pelnym
+/// CycleSolver - bledy , przekroczenia oszacowania , udzial punktow z modelu i
+/// czas. Czas SurrogateCycle podany dla wszystkich punktow i dla punktow w
+/// obszarze , z przyspieszeniem wzgledem CycleSolver z pamiecia podreczna.
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since( Clock::time_point t0 )
+{
+    return std::chrono::duration<double>( Clock::now() - t0 ).count();
+}
+
+bool parse_range( const char *s , double r[2] )
+{
+    char *end;
+    r[0] = strtod( s , &end );
+    if( end == s || *end != ',' ) return false;
+    s = end + 1;
+    r[1] = strtod( s , &end );
+    return end != s && !*end && r[1] > r[0];
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+    if( argc < 2 )
+    {
+        cerr << "usage: surrogate deck [--H lo,hi] [--Mach lo,hi] [--throttle lo,hi] [--degree n]\n"
+                "                      [--samples n] [--cells n] [--safety s] [--refine tol depth] [--tol rel]\n"
+                "                      [--points n] [--retrain]" << endl;
+        return 2;
+    }
+
+    double range[3][2] = { { 0.0 , 3000.0 } , { 0.0 , 0.3 } , { 0.2 , 1.0 } };
+    Surrogate sur;
+    double tol = 1.0e-3;
+    int points = 20000;
+    bool retrain = false;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        bool ok = true;
+        if(      !strcmp( argv[a] , "--H" )        && a + 1 < argc ) ok = parse_range( argv[++a] , range[0] );
+        else if( !strcmp( argv[a] , "--Mach" )     && a + 1 < argc ) ok = parse_range( argv[++a] , range[1] );
+        else if( !strcmp( argv[a] , "--throttle" ) && a + 1 < argc ) ok = parse_range( argv[++a] , range[2] );
+        else if( !strcmp( argv[a] , "--degree" )   && a + 1 < argc ) sur.set_degree( atoi( argv[++a] ) );
+        else if( !strcmp( argv[a] , "--samples" )  && a + 1 < argc ) sur.set_samples( atoi( argv[++a] ) );
+        else if( !strcmp( argv[a] , "--cells" )    && a + 1 < argc ) sur.set_cells( atoi( argv[++a] ) );
+        else if( !strcmp( argv[a] , "--safety" )   && a + 1 < argc ) sur.set_safety( atof( argv[++a] ) );
+        else if( !strcmp( argv[a] , "--refine" )   && a + 2 < argc )
+        {
+            double t = atof( argv[++a] );
+            sur.set_refinement( t , atoi( argv[++a] ) );
+        }
+        else if( !strcmp( argv[a] , "--tol" )      && a + 1 < argc ) tol    = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--points" )   && a + 1 < argc ) points = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--retrain" ) )                  retrain = true;
+        else ok = false;
+
+        if( !ok )
+        {
+            cerr << "surrogate: bad option " << argv[a] << endl;
+            return 2;
+        }
+    }
+    if( points < 1 || tol <= 0.0 )
+    {
+        cerr << "surrogate: bad --points or --tol" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    std::string file = Surrogate::path_for( path );
+    bool loaded = !retrain && sur.load( file.c_str() , dat );
+
+    Clock::time_point t0 = Clock::now();
+    if( !loaded )
+    {
+        double lo[3] = { range[0][0] , range[1][0] , range[2][0] };
+        double hi[3] = { range[0][1] , range[1][1] , range[2][1] };
+        if( !sur.train( dat , lo , hi ) || !sur.save( file.c_str() ) ) return 1;
+    }
+
+    cout << std::fixed << std::setprecision( 3 )
+         << ( loaded ? "loaded " : "trained " ) << file << " : " << sur.get_terms() << " terms in "
+         << sur.get_cells() << "^3 cells ( " << sur.get_nodes() << " after splitting , degree " << sur.get_degree() << " , "
+         << std::setprecision( 0 ) << sur.get_bytes() / 1024.0 << " KB ) , H " << std::setprecision( 3 )
+         << sur.get_lo()[0] << ".." << sur.get_hi()[0] << " , Mach " << sur.get_lo()[1] << ".." << sur.get_hi()[1]
+         << " , throttle " << sur.get_lo()[2] << ".." << sur.get_hi()[2];
+    if( !loaded ) cout << " in " << seconds_since( t0 ) * 1.0e3 << " ms";
+    cout << "\n";
+
+    /// punkty walidacji
+    vector<double> X( size_t( points ) * 3 );
+    Philox rng( 7 );
+    for( int k = 0 ; k < points ; k++ )
+    {
+        double u[4];
+        rng.uniform2( uint64_t( k ) , 0 , 0 , u );
+        rng.uniform2( uint64_t( k ) , 1 , 0 , u + 2 );
+        for( int i = 0 ; i < 3 ; i++ )
+        {
+            double w = sur.get_hi()[i] - sur.get_lo()[i];
+            X[ size_t( k ) * 3 + i ] = sur.get_lo()[i] - 0.1 * w + 1.2 * w * u[i];
+        }
+    }
+
+    Atmosphere atm;
+    CycleSolver full( dat );
+    vector<CycleSolver::Point> ref( points );
+    vector<bool> ok( points );
+    for( int k = 0 ; k < points ; k++ )
+        ok[k] = full.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , ref[k] );
+
+    double err_max[Surrogate::Keys] = { 0.0 } , rel_max[Surrogate::Keys] = { 0.0 };
+    double rel_sum2[Surrogate::Keys] = { 0.0 } , bound_max[Surrogate::Keys] = { 0.0 };
+    long   over[Surrogate::Keys] = { 0 };
+    long   evaluated = 0;
+
+    for( int k = 0 ; k < points ; k++ )
+    {
+        double v[Surrogate::Keys] , e[Surrogate::Keys];
+        if( !ok[k] || !sur.eval( X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , v , e ) ) continue;
+        evaluated++;
+
+        double const *p = reinterpret_cast<double const*>( &ref[k] );
+        for( int o = 0 ; o < Surrogate::Keys ; o++ )
+        {
+            double r = p[ Surrogate::field( o ) ];
+            double d = fabs( v[o] - r ) , rel = r != 0.0 ? d / fabs( r ) : 0.0;
+            if( d > err_max[o] )   err_max[o] = d;
+            if( rel > rel_max[o] ) rel_max[o] = rel;
+            if( e[o] > bound_max[o] ) bound_max[o] = e[o];
+            if( d > e[o] ) over[o]++;
+            rel_sum2[o] += rel * rel;
+        }
+    }
+
+    cout << "\n# " << points << " random points ( 10 % outside the trained region ) , "
+         << evaluated << " evaluated by the surrogate\n"
+         << "#       output     max |err|   max rel err   rms rel err   max bound  bound exceeded\n"
+         << std::scientific << std::setprecision( 3 );
+    for( int o = 0 ; o < Surrogate::Keys ; o++ )
+        cout << std::setw( 14 ) << Surrogate::output_name( o ) << std::setw( 14 ) << err_max[o]
+             << std::setw( 14 ) << rel_max[o] << std::setw( 14 ) << ( evaluated ? sqrt( rel_sum2[o] / evaluated ) : 0.0 )
+             << std::setw( 12 ) << bound_max[o] << std::setw( 16 ) << over[o] << "\n";
+
+    /// czas
+    const int reps = 5;
+    CycleSolver::Point y;
+    double yk[Surrogate::Keys];
+    volatile double sink = 0.0;                 // wyniki uzywane - petle nie sa usuwane
+
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( int k = 0 ; k < points ; k++ )
+        {
+            full.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y );
+            sink = sink + y.P_free;
+        }
+    double s_full = seconds_since( t0 ) / ( double( reps ) * points );
+
+    full.set_cache( false );
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( int k = 0 ; k < points ; k++ )
+        {
+            full.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y );
+            sink = sink + y.P_free;
+        }
+    double s_cold = seconds_since( t0 ) / ( double( reps ) * points );
+
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( int k = 0 ; k < points ; k++ )
+            if( sur.eval( X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , yk ) ) sink = sink + yk[ Surrogate::K_P_free ];
+    double s_sur = seconds_since( t0 ) / ( double( reps ) * points );
+
+    SurrogateCycle cyc( dat , sur );
+    cyc.set_tolerance( tol );
+    double mixed_err = 0.0;
+    for( int k = 0 ; k < points ; k++ )
+        if( cyc.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y ) && ok[k] && cyc.last_surrogate() )
+        {
+            double const *v = reinterpret_cast<double const*>( &y );
+            double const *r = reinterpret_cast<double const*>( &ref[k] );
+            for( int o = 0 ; o < Surrogate::Keys ; o++ )
+            {
+                int i = Surrogate::field( o );
+                if( r[i] != 0.0 ) mixed_err = std::max( mixed_err , fabs( v[i] - r[i] ) / fabs( r[i] ) );
+            }
+        }
+    SurrogateCycle::Stats st = cyc.get_stats();
+
+    cyc.reset_stats();
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( int k = 0 ; k < points ; k++ )
+        {
+            cyc.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y );
+            sink = sink + y.P_free;
+        }
+    double s_mixed = seconds_since( t0 ) / ( double( reps ) * points );
+
+    /// tylko punkty w obszarze uczenia - CycleSolver i SurrogateCycle
+    vector<int> in;
+    for( int k = 0 ; k < points ; k++ )
+        if( sur.inside( X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] ) ) in.push_back( k );
+
+    full.set_cache( true );
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( size_t j = 0 ; j < in.size() ; j++ )
+        {
+            int k = in[j];
+            full.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y );
+            sink = sink + y.P_free;
+        }
+    double s_full_in = in.empty() ? 0.0 : seconds_since( t0 ) / ( double( reps ) * in.size() );
+
+    cyc.reset_stats();
+    t0 = Clock::now();
+    for( int r = 0 ; r < reps ; r++ )
+        for( size_t j = 0 ; j < in.size() ; j++ )
+        {
+            int k = in[j];
+            cyc.solve( &atm , X[ 3*k ] , X[ 3*k+1 ] , X[ 3*k+2 ] , y );
+            sink = sink + y.P_free;
+        }
+    double s_mixed_in = in.empty() ? 0.0 : seconds_since( t0 ) / ( double( reps ) * in.size() );
+    SurrogateCycle::Stats st_in = cyc.get_stats();
+
+    cout << std::fixed << std::setprecision( 3 )
+         << "\n# time per point\n"
+         << "CycleSolver ( cache )       " << std::setw( 10 ) << s_full  * 1.0e6 << " us\n"
+         << "CycleSolver ( no cache )    " << std::setw( 10 ) << s_cold  * 1.0e6 << " us\n"
+         << "Surrogate::eval             " << std::setw( 10 ) << s_sur   * 1.0e6 << " us  ( x"
+         << std::setprecision( 1 ) << s_full / s_sur << " vs cache , x" << s_cold / s_sur << " vs no cache )\n"
+         << std::setprecision( 3 )
+         << "SurrogateCycle ( tol " << std::scientific << std::setprecision( 1 ) << tol << " ) "
+         << std::fixed << std::setprecision( 3 ) << std::setw( 10 ) << s_mixed * 1.0e6 << " us  ( "
+         << st.hits << " from surrogate , " << st.fallbacks << " full , max rel err "
+         << std::scientific << std::setprecision( 2 ) << mixed_err << " )\n"
+         << std::fixed << std::setprecision( 3 )
+         << "  in the trained region      " << std::setw( 10 ) << s_mixed_in * 1.0e6 << " us  ( "
+         << st_in.hits / reps << " from surrogate , " << st_in.fallbacks / reps << " full ; CycleSolver ( cache ) "
+         << s_full_in * 1.0e6 << " us )\n"
+         << std::setprecision( 2 )
+         << "net speedup vs CycleSolver ( cache ): x" << s_full / s_mixed << " all points , x"
+         << ( s_mixed_in > 0.0 ? s_full_in / s_mixed_in : 0.0 ) << " in the trained region\n";
+
+    return 0;
+}
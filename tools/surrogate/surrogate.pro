@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# surrogate - model zastepczy punktu pracy: uczenie i walidacja
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = surrogate
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )
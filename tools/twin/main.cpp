@@ -0,0 +1,176 @@
+/****************************************************************************//*
+* MIT License
+* Copyright (c) 2020 Dawid Marzec
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom
+* the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+******************************************************************************/
+
+#include <EngineDeck.h>
+#include <MultiEngine.h>
+#include <Profiler.h>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/// Silniki sprzezone wspolnym wirnikiem w krokach ramki.
+///
+/// twin deck [--engines n] [--seconds s] [--rate hz] [--H m] [--Mach m]
+///           [--collective c] [--oei t] [--cpu first] [--check]
+///
+/// Co 0.5 s wypisuje Omega wirnika , przepustnice regulatora i moce silnikow;
+/// --oei t wylacza ostatni silnik w chwili t ( jeden silnik niesprawny ).
+/// Na koncu czasy kroku i czekania na barierze dla kazdego silnika. --check
+/// liczy ten sam scenariusz na jednym watku i porownuje wynik bit w bit.
+/// Z DME_PROFILE ( CONFIG+=profile ) raport stref w profile.txt / profile.json.
+namespace
+{
+
+struct Scenario
+{
+    int    engines;
+    double seconds , rate , H , Mach , collective , oei;
+};
+
+/// Przebieg scenariusza; trace - wydruk co 0.5 s
+void run( MultiEngine &m , Scenario const &sc , Atmosphere *atm , bool trace )
+{
+    double dt = 1.0 / sc.rate;
+    long total = long( sc.seconds * sc.rate + 0.5 );
+    long every = long( 0.5 * sc.rate + 0.5 );
+    long oei_f = sc.oei >= 0.0 ? long( sc.oei * sc.rate + 0.5 ) : -1;
+
+    m.set_Mach( sc.Mach );
+    m.rotor().set_collective( sc.collective );
+
+    for( long f = 0 ; f < total ; )
+    {
+        long n = every;
+        if( f + n > total ) n = total - f;
+        if( oei_f > f && oei_f < f + n ) n = oei_f - f;
+
+        m.run( atm , n , dt );
+        f += n;
+
+        if( f == oei_f )
+        {
+            m.set_trim( m.size() - 1 , 0.0 );
+            if( trace ) cout << "# engine " << m.size() - 1 << " off at t = " << f * dt << " s\n";
+        }
+
+        if( trace && f % every == 0 )
+        {
+            cout << std::fixed << std::setprecision( 2 ) << std::setw( 8 ) << f * dt
+                 << std::setprecision( 4 ) << std::setw( 10 ) << m.rotor().get_Omega()
+                 << std::setw( 10 ) << m.get_throttle();
+            for( int i = 0 ; i < m.size() ; i++ )
+                cout << std::setprecision( 1 ) << std::setw( 12 ) << m.get_power( i ) * 1.0e-3;
+            cout << "\n";
+        }
+    }
+}
+
+}
+
+int main( int argc , char *argv[] )
+{
+#if defined( DME_PROFILE )
+    Profiler::dump_at_exit( "profile.txt" , "profile.json" );
+#endif
+
+    if( argc < 2 )
+    {
+        cerr << "usage: twin deck [--engines n] [--seconds s] [--rate hz] [--H m] [--Mach m]\n"
+                "                 [--collective c] [--oei t] [--cpu first] [--check]" << endl;
+        return 2;
+    }
+
+    Scenario sc = { 2 , 10.0 , 1000.0 , 0.0 , 0.1 , 0.5 , -1.0 };
+    int cpu = -1;
+    bool check = false;
+
+    for( int a = 2 ; a < argc ; a++ )
+    {
+        if(      !strcmp( argv[a] , "--engines" )    && a + 1 < argc ) sc.engines    = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--seconds" )    && a + 1 < argc ) sc.seconds    = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--rate" )       && a + 1 < argc ) sc.rate       = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--H" )          && a + 1 < argc ) sc.H          = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--Mach" )       && a + 1 < argc ) sc.Mach       = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--collective" ) && a + 1 < argc ) sc.collective = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--oei" )        && a + 1 < argc ) sc.oei        = atof( argv[++a] );
+        else if( !strcmp( argv[a] , "--cpu" )        && a + 1 < argc ) cpu           = atoi( argv[++a] );
+        else if( !strcmp( argv[a] , "--check" ) )                      check         = true;
+        else
+        {
+            cerr << "twin: unknown option " << argv[a] << endl;
+            return 2;
+        }
+    }
+    if( sc.engines < 1 || sc.rate <= 0.0 )
+    {
+        cerr << "twin: bad --engines or --rate" << endl;
+        return 2;
+    }
+
+    const char *path = argv[1];
+    size_t len = strlen( path );
+    bool text = len > 4 && ( !strcmp( path + len - 4 , ".txt" ) || !strcmp( path + len - 4 , ".csv" ) );
+
+    std::shared_ptr<EngineData> dat = text ? EngineDeck::read_text( path ) : EngineDeck::open( path );
+    if( !dat ) return 1;
+
+    Atmosphere atm;
+    atm.update( sc.H );
+
+    MultiEngine m( dat , sc.engines );
+    m.set_cpu( cpu );
+
+    cout << "#    t [s]  Omega [rad/s]  throttle   P_free [kW] ...\n";
+    run( m , sc , &atm , true );
+
+    /// czasy - barierze przypisane jest czekanie , w tym nierownowaga krokow
+    cout << "\n# engine   step mean   step p99   wait mean   wait p99  [ns]\n";
+    for( int i = 0 ; i < m.size() ; i++ )
+    {
+        Histogram const &s = m.get_step( i );
+        Histogram const &w = m.get_wait( i );
+        cout << std::setw( 8 ) << i << std::setprecision( 0 )
+             << std::setw( 12 ) << s.mean() << std::setw( 11 ) << s.percentile( 99.0 )
+             << std::setw( 12 ) << w.mean() << std::setw( 11 ) << w.percentile( 99.0 ) << "\n";
+    }
+    cout << "# frame budget at " << std::setprecision( 0 ) << sc.rate << " Hz: " << 1.0e9 / sc.rate << " ns" << endl;
+
+    if( check )
+    {
+        MultiEngine ref( dat , sc.engines );
+        ref.set_threaded( false );
+        run( ref , sc , &atm , false );
+
+        bool ok = ref.rotor().get_Omega() == m.rotor().get_Omega() && ref.get_throttle() == m.get_throttle();
+        for( int i = 0 ; i < m.size() ; i++ )
+            ok = ok && ref.get_power( i ) == m.get_power( i );
+
+        cout << "deterministic vs single thread: " << ( ok ? "yes" : "NO" ) << endl;
+        if( !ok ) return 3;
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# twin - silniki sprzezone wspolnym wirnikiem , watek na silnik
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = twin
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+include ( ../../fdm/fdmlib.pri )